@@ -0,0 +1,136 @@
+//
+// Copyright (C) 2015 Codership Oy <info@codership.com>
+//
+
+#include "cert_hot_keys.hpp"
+
+#include <algorithm>
+
+galera::CertHotKeys::CertHotKeys(size_t const capacity)
+    :
+    hashes_  (),
+    counters_(),
+    capacity_(capacity),
+    total_   (0)
+{
+    hashes_.reserve(2 * capacity_);
+    counters_.reserve(capacity_);
+}
+
+
+void
+galera::CertHotKeys::reset(size_t const capacity)
+{
+    std::vector<uint64_t>().swap(hashes_);
+    std::vector<Counter>().swap(counters_);
+
+    capacity_ = capacity;
+    total_    = 0;
+
+    hashes_.reserve(2 * capacity_);
+    counters_.reserve(capacity_);
+}
+
+
+long
+galera::CertHotKeys::find(uint64_t const h0, uint64_t const h1) const
+{
+    for (size_t i(0); i < hashes_.size(); i += 2)
+    {
+        if (hashes_[i] == h0 && hashes_[i + 1] == h1) return i / 2;
+    }
+
+    return -1;
+}
+
+
+void
+galera::CertHotKeys::record(const KeySet::KeyPart& key)
+{
+    if (gu_unlikely(0 == capacity_)) return;
+
+    uint64_t h0, h1;
+    key.hash_words(h0, h1);
+
+    ++total_;
+
+    long const found(find(h0, h1));
+
+    if (found >= 0)
+    {
+        ++counters_[found].count;
+        return;
+    }
+
+    size_t idx;
+
+    if (counters_.size() < capacity_)
+    {
+        idx = counters_.size();
+        counters_.push_back(Counter());
+        hashes_.push_back(0);
+        hashes_.push_back(0);
+    }
+    else
+    {
+        // replace the least frequent key, inheriting its count as error
+        idx = 0;
+        for (size_t i(1); i < counters_.size(); ++i)
+        {
+            if (counters_[i].count < counters_[idx].count) idx = i;
+        }
+
+        counters_[idx].error = counters_[idx].count;
+    }
+
+    Counter& c(counters_[idx]);
+
+    ++c.count;
+    c.key_size = key.copy_to(c.key, sizeof(c.key));
+
+    hashes_[2 * idx]     = h0;
+    hashes_[2 * idx + 1] = h1;
+}
+
+
+uint64_t
+galera::CertHotKeys::count(const KeySet::KeyPart& key, uint64_t* error) const
+{
+    uint64_t h0, h1;
+    key.hash_words(h0, h1);
+
+    long const found(find(h0, h1));
+
+    if (found < 0)
+    {
+        if (error) *error = 0;
+        return 0;
+    }
+
+    if (error) *error = counters_[found].error;
+    return counters_[found].count;
+}
+
+
+void
+galera::CertHotKeys::print(std::ostream& os, size_t const n) const
+{
+    std::vector<size_t> order(counters_.size());
+
+    for (size_t i(0); i < order.size(); ++i) order[i] = i;
+
+    size_t const num(std::min(n, order.size()));
+
+    std::partial_sort(order.begin(), order.begin() + num, order.end(),
+                      CountGreater(counters_));
+
+    for (size_t i(0); i < num; ++i)
+    {
+        const Counter& c(counters_[order[i]]);
+
+        if (i > 0) os << "; ";
+
+        os << c.count << "(+" << c.error << ") "
+           << KeySet::KeyPart(c.key, c.key_size);
+    }
+}
@@ -0,0 +1,84 @@
+//
+// Copyright (C) 2015 Codership Oy <info@codership.com>
+//
+
+#ifndef GALERA_CERT_HOT_KEYS_HPP
+#define GALERA_CERT_HOT_KEYS_HPP
+
+#include "key_set.hpp"
+
+#include <vector>
+#include <ostream>
+
+namespace galera
+{
+    /*!
+     * Bounded memory heavy hitters sketch over certification keys
+     * (Space-Saving algorithm by Metwally, Agrawal and El Abbadi).
+     *
+     * Tracks at most capacity() keys. Any key recorded more than
+     * total()/capacity() times is guaranteed to be tracked, and the count
+     * reported for a key overestimates its true count by at most the
+     * reported error. Serialized key part including annotation (when it
+     * fits) is kept with the counter, so the key can be printed later.
+     */
+    class CertHotKeys
+    {
+    public:
+
+        explicit CertHotKeys(size_t capacity);
+
+        /*! counts one occurrence of the key */
+        void record(const KeySet::KeyPart& key);
+
+        /*! drops all counters and sets new capacity */
+        void reset(size_t capacity);
+
+        void clear() { reset(capacity_); }
+
+        size_t   capacity() const { return capacity_;        }
+        size_t   size()     const { return counters_.size(); }
+        uint64_t total()    const { return total_;           }
+
+        /*! prints up to n most frequent keys, most frequent first, as
+         *  "count(+error) key" separated by "; " */
+        void print(std::ostream& os, size_t n) const;
+
+        /*! count (with error) of a key, 0 if it is not tracked */
+        uint64_t count(const KeySet::KeyPart& key, uint64_t* error = 0) const;
+
+    private:
+
+        static size_t const MAX_KEY_SIZE = 128;
+
+        struct Counter
+        {
+            uint64_t   count;
+            uint64_t   error;
+            size_t     key_size;
+            gu::byte_t key[MAX_KEY_SIZE];
+        };
+
+        struct CountGreater
+        {
+            CountGreater(const std::vector<Counter>& c) : c_(c) { }
+
+            bool operator()(size_t a, size_t b) const
+            {
+                return c_[a].count > c_[b].count;
+            }
+
+            const std::vector<Counter>& c_;
+        };
+
+        long find(uint64_t h0, uint64_t h1) const;
+
+        /* key hashes are kept apart from the counters for cheaper scans */
+        std::vector<uint64_t> hashes_;   // h0, h1 pairs
+        std::vector<Counter>  counters_;
+        size_t                capacity_;
+        uint64_t              total_;
+    };
+}
+
+#endif // GALERA_CERT_HOT_KEYS_HPP
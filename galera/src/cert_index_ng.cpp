@@ -0,0 +1,257 @@
+//
+// Copyright (C) 2015 Codership Oy <info@codership.com>
+//
+
+#include "cert_index_ng.hpp"
+
+#include "gu_throw.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+galera::CertIndexNG::CertIndexNG()
+    :
+    cur_    (),
+    old_    (),
+    old_pos_(0)
+{}
+
+
+galera::CertIndexNG::~CertIndexNG()
+{
+    clear();
+}
+
+
+void
+galera::CertIndexNG::alloc(Table& t, size_t const cap)
+{
+    assert(cap >= MIN_CAP);
+    assert((cap & (cap - 1)) == 0);
+
+    t.slots = static_cast<KeyEntryNG*>(::calloc(cap, sizeof(KeyEntryNG)));
+
+    if (gu_unlikely(0 == t.slots))
+    {
+        gu_throw_error(ENOMEM) << "Failed to allocate " << cap
+                               << " slots for certification index";
+    }
+
+    t.cap  = cap;
+    t.bits = 0;
+    while ((size_t(1) << t.bits) < cap) ++t.bits;
+    t.used = 0;
+}
+
+
+void
+galera::CertIndexNG::release(Table& t)
+{
+    ::free(t.slots);
+    t = Table();
+}
+
+
+galera::KeyEntryNG*
+galera::CertIndexNG::find(const Table& t, uint64_t const h0, uint64_t const h1)
+{
+    if (0 == t.cap) return 0;
+
+    size_t const mask(t.cap - 1);
+
+    for (size_t i(slot(t, h0)); ; i = (i + 1) & mask)
+    {
+        KeyEntryNG& e(t.slots[i]);
+
+        if (occupied(e))
+        {
+            if (matches(e, h0, h1)) return &e;
+        }
+        else if (e.h0_ != TOMBSTONE)
+        {
+            return 0;
+        }
+    }
+}
+
+
+galera::KeyEntryNG*
+galera::CertIndexNG::place(Table& t, uint64_t const h0)
+{
+    assert(t.used < t.cap);
+
+    size_t const mask(t.cap - 1);
+    size_t i(slot(t, h0));
+
+    while (occupied(t.slots[i])) i = (i + 1) & mask;
+
+    return &t.slots[i];
+}
+
+
+galera::KeyEntryNG*
+galera::CertIndexNG::find(const KeySet::KeyPart& key) const
+{
+    uint64_t h1;
+    uint64_t const h0(key_h0(key, h1));
+
+    KeyEntryNG* ret(find(cur_, h0, h1));
+
+    if (0 == ret && old_.cap > 0) ret = find(old_, h0, h1);
+
+    return ret;
+}
+
+
+galera::KeyEntryNG*
+galera::CertIndexNG::insert(const KeySet::KeyPart& key)
+{
+    assert(0 == find(key));
+
+    uint64_t h1;
+    uint64_t const h0(key_h0(key, h1));
+
+    if (0 == cur_.cap)
+    {
+        alloc(cur_, MIN_CAP);
+    }
+    else if ((size() + 1) * 4 > cur_.cap * 3)
+    {
+        // should not normally happen, migration step is large enough
+        // to finish before the next resize
+        if (old_.cap > 0) migrate(old_.cap);
+
+        resize(cur_.cap * 2);
+    }
+
+    migrate(MIGRATE_STEP);
+
+    KeyEntryNG* const e(place(cur_, h0));
+
+    e->h0_ = h0;
+    e->h1_ = h1;
+    assert(false == e->referenced());
+
+    ++cur_.used;
+
+    return e;
+}
+
+
+void
+galera::CertIndexNG::erase(KeyEntryNG* const e)
+{
+    assert(occupied(*e));
+    assert(false == e->referenced());
+
+    if (old_.cap > 0 && e >= old_.slots && e < old_.slots + old_.cap)
+    {
+        // old table is read only, leave tombstone for probing
+        ::memset(e, 0, sizeof(*e));
+        e->h0_ = TOMBSTONE;
+        --old_.used;
+    }
+    else
+    {
+        assert(e >= cur_.slots && e < cur_.slots + cur_.cap);
+
+        erase_shift(e);
+        --cur_.used;
+
+        if (0 == old_.cap && cur_.cap > MIN_CAP && cur_.used * 8 < cur_.cap)
+        {
+            resize(cur_.cap / 2);
+        }
+    }
+
+    migrate(MIGRATE_STEP);
+}
+
+
+void
+galera::CertIndexNG::clear()
+{
+    release(cur_);
+    release(old_);
+    old_pos_ = 0;
+}
+
+
+void
+galera::CertIndexNG::erase_shift(KeyEntryNG* const e)
+{
+    // backward shift deletion: move subsequent entries of the probe
+    // sequence into the hole so that no tombstones are needed
+    size_t const mask(cur_.cap - 1);
+    size_t       i(e - cur_.slots);
+    size_t       j(i);
+
+    for (;;)
+    {
+        j = (j + 1) & mask;
+
+        KeyEntryNG& ej(cur_.slots[j]);
+
+        if (!occupied(ej)) break;
+
+        size_t const k(slot(cur_, ej.h0_));
+
+        // entry at j may be moved to i only if its home slot k is not
+        // cyclically within (i, j]
+        bool const stays(i <= j ? (i < k && k <= j) : (i < k || k <= j));
+
+        if (!stays)
+        {
+            cur_.slots[i] = ej;
+            i = j;
+        }
+    }
+
+    ::memset(&cur_.slots[i], 0, sizeof(KeyEntryNG));
+}
+
+
+void
+galera::CertIndexNG::resize(size_t const cap)
+{
+    assert(0 == old_.cap);
+
+    old_     = cur_;
+    old_pos_ = 0;
+    cur_     = Table();
+
+    alloc(cur_, cap);
+
+    if (0 == old_.used) release(old_);
+}
+
+
+void
+galera::CertIndexNG::migrate(size_t const n)
+{
+    if (0 == old_.cap) return;
+
+    size_t const end(std::min(old_pos_ + n, old_.cap));
+
+    for (; old_pos_ < end; ++old_pos_)
+    {
+        KeyEntryNG& e(old_.slots[old_pos_]);
+
+        if (occupied(e))
+        {
+            *place(cur_, e.h0_) = e;
+            ++cur_.used;
+            --old_.used;
+
+            ::memset(&e, 0, sizeof(e));
+            e.h0_ = TOMBSTONE;
+        }
+    }
+
+    if (old_pos_ == old_.cap || 0 == old_.used)
+    {
+        release(old_);
+        old_pos_ = 0;
+    }
+}
@@ -0,0 +1,136 @@
+//
+// Copyright (C) 2015 Codership Oy <info@codership.com>
+//
+
+#ifndef GALERA_CERT_INDEX_NG_HPP
+#define GALERA_CERT_INDEX_NG_HPP
+
+#include "key_entry_ng.hpp"
+
+namespace galera
+{
+    /*!
+     * Certification index for version 3 keys.
+     *
+     * Open addressing hash table with linear probing. Entries (key hash and
+     * trx references) are stored inline in the table slots, so there is no
+     * per-key allocation and lookup touches only the table memory.
+     *
+     * Table is grown and shrunk incrementally: on resize a new table is
+     * allocated and the old one is migrated a few slots at a time on each
+     * subsequent insert()/erase(), so that no single operation has to rehash
+     * the whole index. Lookups consult both tables while migration is in
+     * progress.
+     *
+     * Pointers returned by find() and insert() stay valid only until the
+     * next insert() or erase().
+     */
+    class CertIndexNG
+    {
+    public:
+
+        CertIndexNG();
+        ~CertIndexNG();
+
+        /*! returns entry matching the key or NULL if not found */
+        KeyEntryNG* find(const KeySet::KeyPart& key) const;
+
+        /*! inserts new entry for a key which must not be in the index yet */
+        KeyEntryNG* insert(const KeySet::KeyPart& key);
+
+        /*! removes entry previously returned by find() or insert() */
+        void erase(KeyEntryNG* entry);
+
+        /*! removes all entries and releases memory */
+        void clear();
+
+        /*! calls f(KeyEntryNG&) for every entry */
+        template <typename F>
+        void for_each(F& f)
+        {
+            for_each(cur_, f);
+            for_each(old_, f);
+        }
+
+        size_t size()         const { return cur_.used + old_.used; }
+        size_t bucket_count() const { return cur_.cap  + old_.cap;  }
+
+        /*! memory allocated by the index in bytes */
+        size_t mem_usage() const
+        {
+            return bucket_count() * sizeof(KeyEntryNG);
+        }
+
+    private:
+
+        CertIndexNG(const CertIndexNG&);
+        CertIndexNG& operator=(const CertIndexNG&);
+
+        struct Table
+        {
+            Table() : slots(0), cap(0), bits(0), used(0) { }
+
+            KeyEntryNG* slots;
+            size_t      cap;   // power of 2
+            int         bits;  // log2(cap)
+            size_t      used;  // live entries
+        };
+
+        static uint64_t const OCCUPIED = 2;
+        static uint64_t const WIDE     = 1; // if OCCUPIED
+        static uint64_t const TOMBSTONE = 1; // if not OCCUPIED
+
+        static size_t const MIN_CAP      = 1 << 8;
+        static size_t const MIGRATE_STEP = 8;
+
+        static uint64_t key_h0(const KeySet::KeyPart& key, uint64_t& h1)
+        {
+            uint64_t h0;
+            bool const wide(key.hash_words(h0, h1));
+            return (h0 << 2) | OCCUPIED | (wide ? WIDE : 0);
+        }
+
+        static bool occupied(const KeyEntryNG& e)
+        {
+            return (e.h0_ & OCCUPIED);
+        }
+
+        static bool matches(const KeyEntryNG& e, uint64_t h0, uint64_t h1)
+        {
+            // hashes of different width match by the first word only,
+            // same as KeySet::KeyPart::matches()
+            return ((e.h0_ | WIDE) == (h0 | WIDE) &&
+                    (!(e.h0_ & h0 & WIDE) || e.h1_ == h1));
+        }
+
+        static size_t slot(const Table& t, uint64_t h0)
+        {
+            return ((h0 >> 2) * GU_ULONG_LONG(0x9E3779B97F4A7C15)) >>
+                (64 - t.bits);
+        }
+
+        static KeyEntryNG* find(const Table& t, uint64_t h0, uint64_t h1);
+        static KeyEntryNG* place(Table& t, uint64_t h0);
+        static void        alloc(Table& t, size_t cap);
+        static void        release(Table& t);
+
+        template <typename F>
+        static void for_each(Table& t, F& f)
+        {
+            for (size_t i(0); i < t.cap; ++i)
+            {
+                if (occupied(t.slots[i])) f(t.slots[i]);
+            }
+        }
+
+        void erase_shift(KeyEntryNG* entry);
+        void resize(size_t cap);
+        void migrate(size_t n);
+
+        Table  cur_;
+        Table  old_;     // being migrated to cur_
+        size_t old_pos_; // migration cursor in old_
+    };
+}
+
+#endif // GALERA_CERT_INDEX_NG_HPP
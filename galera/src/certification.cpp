@@ -9,6 +9,7 @@
 #include "gu_throw.hpp"
 
 #include <map>
+#include <sstream>
 
 using namespace galera;
 
@@ -24,12 +25,21 @@ static std::string const CERT_PARAM_PREFIX("cert.");
 std::string const galera::Certification::PARAM_LOG_CONFLICTS(CERT_PARAM_PREFIX +
                                                              "log_conflicts");
 
+std::string const galera::Certification::PARAM_HOT_KEYS(CERT_PARAM_PREFIX +
+                                                        "hot_keys");
+
 static std::string const CERT_PARAM_MAX_LENGTH   (CERT_PARAM_PREFIX +
                                                   "max_length");
 static std::string const CERT_PARAM_LENGTH_CHECK (CERT_PARAM_PREFIX +
                                                   "length_check");
 
 static std::string const CERT_PARAM_LOG_CONFLICTS_DEFAULT("no");
+static std::string const CERT_PARAM_HOT_KEYS_DEFAULT("64");
+
+/* how many hot keys to report in status */
+static size_t const CERT_HOT_KEYS_REPORT(10);
+/* each recorded key is a linear scan over tracked ones under cert mutex */
+static long const   CERT_HOT_KEYS_MAX(1024);
 
 /*** It is EXTREMELY important that these constants are the same on all nodes.
  *** Don't change them ever!!! ***/
@@ -40,12 +50,29 @@ void
 galera::Certification::register_params(gu::Config& cnf)
 {
     cnf.add(CERT_PARAM_LOG_CONFLICTS, CERT_PARAM_LOG_CONFLICTS_DEFAULT);
+    cnf.add(Certification::PARAM_HOT_KEYS, CERT_PARAM_HOT_KEYS_DEFAULT);
     /* The defaults below are deliberately not reflected in conf: people
      * should not know about these dangerous setting unless they read RTFM. */
     cnf.add(CERT_PARAM_MAX_LENGTH);
     cnf.add(CERT_PARAM_LENGTH_CHECK);
 }
 
+static size_t
+hot_keys_capacity(const std::string& str)
+{
+    long const capacity(gu::Config::from_config<long>(str)); // throws
+
+    if (capacity < 0 || capacity > CERT_HOT_KEYS_MAX)
+    {
+        gu_throw_error(EINVAL) << "Bad value '" << str << "' for parameter '"
+                               << galera::Certification::PARAM_HOT_KEYS
+                               << "', should be in range [0, "
+                               << CERT_HOT_KEYS_MAX << ']';
+    }
+
+    return capacity;
+}
+
 /* a function to get around unset defaults in ctor initialization list */
 static int
 max_length(const gu::Config& conf)
@@ -120,17 +147,15 @@ galera::Certification::purge_for_trx_v3(TrxHandle* trx)
         const KeySet::KeyPart& kp(keys.next());
         KeySet::Key::Prefix const p(kp.prefix());
 
-        KeyEntryNG ke(kp);
-        CertIndexNG::iterator const ci(cert_index_ng_.find(&ke));
+        KeyEntryNG* const kep(cert_index_ng_.find(kp));
 
-//        assert(ci != cert_index_ng_.end());
-        if (gu_unlikely(cert_index_ng_.end() == ci))
+//        assert(kep != 0);
+        if (gu_unlikely(0 == kep))
         {
             log_warn << "Missing key";
             continue;
         }
 
-        KeyEntryNG* const kep(*ci);
         assert(kep->referenced());
 
         if (kep->ref_trx(p) == trx)
@@ -139,8 +164,7 @@ galera::Certification::purge_for_trx_v3(TrxHandle* trx)
 
             if (kep->referenced() == false)
             {
-                cert_index_ng_.erase(ci);
-                delete kep;
+                cert_index_ng_.erase(kep);
             }
         }
     }
@@ -541,20 +565,18 @@ certify_and_depend_v3(const galera::KeyEntryNG*   const found,
 
 /* returns true on collision, false otherwise */
 static bool
-certify_v3(galera::Certification::CertIndexNG& cert_index_ng,
-           const galera::KeySet::KeyPart&      key,
-           galera::TrxHandle*                  trx,
-           bool const store_keys, bool const   log_conflicts)
+certify_v3(galera::CertIndexNG&         cert_index_ng,
+           const galera::KeySet::KeyPart& key,
+           galera::TrxHandle*             trx,
+           bool const store_keys, bool const log_conflicts)
 {
-    galera::KeyEntryNG ke(key);
-    galera::Certification::CertIndexNG::iterator ci(cert_index_ng.find(&ke));
+    const galera::KeyEntryNG* const kep(cert_index_ng.find(key));
 
-    if (cert_index_ng.end() == ci)
+    if (0 == kep)
     {
         if (store_keys)
         {
-            galera::KeyEntryNG* const kep(new galera::KeyEntryNG(ke));
-            ci = cert_index_ng.insert(kep).first;
+            cert_index_ng.insert(key);
 
             cert_debug << "created new entry";
         }
@@ -564,7 +586,6 @@ certify_v3(galera::Certification::CertIndexNG& cert_index_ng,
     {
         cert_debug << "found existing entry";
 
-        galera::KeyEntryNG* const kep(*ci);
         // Note: For we skip certification for isolated trxs, only
         // cert index and key_list is populated.
         return (!trx->is_toi() &&
@@ -586,46 +607,106 @@ galera::Certification::do_test_v3(TrxHandle* trx, bool store_keys)
     const KeySetIn& key_set(trx->write_set_in().keyset());
     long const      key_count(key_set.count());
     long            processed(0);
+    KeySet::KeyPart dep_key; // key which determined depends_seqno
+
+    /* keys locked by a non-blocking TOI in progress fail any writeset
+     * touching them, including other TOIs. Nothing was added to index yet.
+     * Preordered writesets are exempt: they were committed at the source. */
+    if (gu_unlikely(!nbo_locks_.empty()) && !trx->nbo_end() &&
+        !trx->preordered() && nbo_conflict(trx))
+    {
+        cert_debug << "END CERTIFICATION (NBO conflict): " << *trx;
+        return TEST_FAILED;
+    }
+
+    /* same for keys of other streamed transactions in progress, fragments
+     * of the same transaction only add to its own lock */
+    StreamList::iterator stream(stream_locks_.end());
+
+    if (gu_unlikely(!stream_locks_.empty() || trx->streamed()))
+    {
+        if (!trx->preordered() && stream_conflict(trx))
+        {
+            cert_debug << "END CERTIFICATION (stream conflict): " << *trx;
+            return TEST_FAILED;
+        }
+
+        stream = stream_find(trx);
+
+        if (trx->streamed() && stream == stream_locks_.end())
+        {
+            /* earlier fragments were certified before this node joined
+             * or their locks were dropped, the rest of the stream can't be
+             * applied */
+            cert_debug << "END CERTIFICATION (stream lost): " << *trx;
+            return TEST_FAILED;
+        }
+    }
 
     key_set.rewind();
 
     for (; processed < key_count; ++processed)
     {
         const KeySet::KeyPart& key(key_set.next());
+        wsrep_seqno_t const    depends_seqno(trx->depends_seqno());
 
         if (certify_v3(cert_index_ng_, key, trx, store_keys, log_conflicts_))
         {
+            if (store_keys == true) record_hot_key(hot_conflicts_, key);
             goto cert_fail;
         }
+
+        if (trx->depends_seqno() > depends_seqno) dep_key = key;
     }
 
     trx->set_depends_seqno(std::max(trx->depends_seqno(), last_pa_unsafe_));
 
+    if (gu_unlikely(stream != stream_locks_.end()) && !trx->fragment())
+    {
+        /* final writeset applies the fragments stored so far */
+        trx->set_depends_seqno(std::max(trx->depends_seqno(),
+                                        stream->last_seqno));
+    }
+
     if (store_keys == true)
     {
+        if (dep_key.ptr() && trx->depends_seqno() > last_pa_unsafe_)
+        {
+            record_hot_key(hot_deps_, dep_key);
+        }
+
         assert (key_count == processed);
 
         key_set.rewind();
         for (long i(0); i < key_count; ++i)
         {
             const KeySet::KeyPart& k(key_set.next());
-            KeyEntryNG ke(k);
-            CertIndexNG::const_iterator ci(cert_index_ng_.find(&ke));
+            KeyEntryNG* const kep(cert_index_ng_.find(k));
 
-            if (ci == cert_index_ng_.end())
+            if (0 == kep)
             {
                 gu_throw_fatal << "could not find key '" << k
                                << "' from cert index";
             }
 
-            KeyEntryNG* const kep(*ci);
-
-            kep->ref(k.prefix(), k, trx);
+            kep->ref(k.prefix(), trx);
 
         }
 
         if (trx->pa_unsafe()) last_pa_unsafe_ = trx->global_seqno();
 
+        if (gu_unlikely(trx->nbo_begin())) nbo_lock(trx);
+        if (gu_unlikely(trx->nbo_end()))   nbo_unlock(trx);
+
+        if (gu_unlikely(trx->fragment()))
+        {
+            stream_lock(trx, stream);
+        }
+        else if (gu_unlikely(stream != stream_locks_.end()))
+        {
+            stream_unlock(trx, stream); // commit or rollback
+        }
+
         key_count_ += key_count;
     }
     cert_debug << "END CERTIFICATION (success): " << *trx;
@@ -646,34 +727,26 @@ cert_fail:
          * processed key failed cert and was not added to index */
         for (long i(0); i < processed; ++i)
         {
-            KeyEntryNG ke(key_set.next());
+            const KeySet::KeyPart& k(key_set.next());
 
             // Clean up cert_index_ from entries which were added by this trx
-            CertIndexNG::iterator ci(cert_index_ng_.find(&ke));
+            KeyEntryNG* const kep(cert_index_ng_.find(k));
 
-            if (gu_likely(ci != cert_index_ng_.end()))
+            if (gu_likely(0 != kep))
             {
-                KeyEntryNG* kep(*ci);
-
                 if (kep->referenced() == false)
                 {
-                    // kel was added to cert_index_ by this trx -
-                    // remove from cert_index_ and fall through to delete
-                    cert_index_ng_.erase(ci);
+                    // kep was added to cert_index_ by this trx -
+                    // remove from cert_index_
+                    cert_index_ng_.erase(kep);
                 }
-                else continue;
-
-                assert(kep->referenced() == false);
-
-                delete kep;
-
             }
-            else if(ke.key().shared())
+            else if(k.shared())
             {
                 assert(0); // we actually should never be here, the key should
                            // be either added to cert_index_ or be there already
                 log_warn  << "could not find shared key '"
-                          << ke.key() << "' from cert index";
+                          << k << "' from cert index";
             }
             else { /* exclusive can duplicate shared */ }
         }
@@ -683,10 +756,315 @@ cert_fail:
     return TEST_FAILED;
 }
 
+bool
+galera::Certification::nbo_conflict(TrxHandle* const trx) const
+{
+    const KeySetIn& key_set(trx->write_set_in().keyset());
+    long const      key_count(key_set.count());
+
+    key_set.rewind();
+
+    for (long i(0); i < key_count; ++i)
+    {
+        const KeySet::KeyPart& key(key_set.next());
+
+        for (NBOList::const_iterator n(nbo_locks_.begin());
+             n != nbo_locks_.end(); ++n)
+        {
+            if (n->keys->find(key))
+            {
+                if (gu_unlikely(log_conflicts_ == true))
+                {
+                    log_info << "trx conflict for key " << key << ": "
+                             << *trx << " <--X--> non-blocking TOI "
+                             << n->seqno;
+                }
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+void
+galera::Certification::nbo_lock(TrxHandle* const trx)
+{
+    assert(trx->is_toi());
+
+    NBOLock const nbo = { trx->source_id(), trx->conn_id(),
+                          trx->global_seqno(), new CertIndexNG() };
+
+    const KeySetIn& key_set(trx->write_set_in().keyset());
+    long const      key_count(key_set.count());
+
+    key_set.rewind();
+
+    /* only leaf key parts are locked, shared branches (e.g. schema of
+     * the table being altered) stay available to other writesets */
+    for (long i(0); i < key_count; ++i)
+    {
+        const KeySet::KeyPart& k(key_set.next());
+
+        if (k.prefix() == KeySet::Key::P_EXCLUSIVE && 0 == nbo.keys->find(k))
+        {
+            nbo.keys->insert(k);
+        }
+    }
+
+    nbo_locks_.push_back(nbo);
+
+    log_info << "Non-blocking TOI " << nbo.seqno << " began, locked "
+             << nbo.keys->size() << " keys";
+}
+
+
+void
+galera::Certification::nbo_unlock(TrxHandle* const trx)
+{
+    for (NBOList::iterator n(nbo_locks_.begin()); n != nbo_locks_.end(); ++n)
+    {
+        if (n->source_id == trx->source_id() && n->conn_id == trx->conn_id())
+        {
+            log_info << "Non-blocking TOI " << n->seqno << " ended at "
+                     << trx->global_seqno();
+            delete n->keys;
+            nbo_locks_.erase(n);
+            return;
+        }
+    }
+
+    /* begin event could have been certified before this node joined */
+    log_debug << "No non-blocking TOI to end for " << *trx;
+}
+
+
+void
+galera::Certification::nbo_clear()
+{
+    if (!nbo_locks_.empty())
+    {
+        log_info << "Dropping " << nbo_locks_.size()
+                 << " non-blocking TOI locks";
+    }
+
+    for (NBOList::iterator n(nbo_locks_.begin()); n != nbo_locks_.end(); ++n)
+    {
+        delete n->keys;
+    }
+
+    nbo_locks_.clear();
+}
+
+
+namespace galera
+{
+    static bool
+    view_member(const wsrep_view_info_t& view, const wsrep_uuid_t& id)
+    {
+        for (int i(0); i < view.memb_num; ++i)
+        {
+            if (view.members[i].id == id) return true;
+        }
+
+        return false;
+    }
+}
+
+
+void
+galera::Certification::nbo_drop(const wsrep_view_info_t& view)
+{
+    NBOList::iterator n(nbo_locks_.begin());
+
+    while (n != nbo_locks_.end())
+    {
+        if (view_member(view, n->source_id))
+        {
+            ++n;
+        }
+        else
+        {
+            log_info << "Dropping locks of non-blocking TOI " << n->seqno
+                     << " of departed member " << n->source_id;
+            delete n->keys;
+            n = nbo_locks_.erase(n);
+        }
+    }
+}
+
+
+void
+galera::Certification::drop_locks(const wsrep_view_info_t* const view)
+{
+    gu::Lock lock(mutex_);
+
+    if (view)
+    {
+        nbo_drop(*view);
+        stream_drop(*view);
+    }
+    else
+    {
+        nbo_clear();
+        stream_clear();
+    }
+}
+
+
+bool
+galera::Certification::stream_conflict(TrxHandle* const trx) const
+{
+    const KeySetIn& key_set(trx->write_set_in().keyset());
+    long const      key_count(key_set.count());
+
+    key_set.rewind();
+
+    for (long i(0); i < key_count; ++i)
+    {
+        const KeySet::KeyPart& key(key_set.next());
+
+        for (StreamList::const_iterator s(stream_locks_.begin());
+             s != stream_locks_.end(); ++s)
+        {
+            if (s->trx_id == trx->trx_id() && s->source_id == trx->source_id())
+                continue;
+
+            if (s->exclusive->find(key) ||
+                (key.exclusive() && s->shared->find(key)))
+            {
+                if (gu_unlikely(log_conflicts_ == true))
+                {
+                    log_info << "trx conflict for key " << key << ": "
+                             << *trx << " <--X--> streamed trx "
+                             << s->source_id << ":" << s->trx_id;
+                }
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+galera::Certification::StreamList::iterator
+galera::Certification::stream_find(TrxHandle* const trx)
+{
+    StreamList::iterator s(stream_locks_.begin());
+
+    for (; s != stream_locks_.end(); ++s)
+    {
+        if (s->trx_id == trx->trx_id() && s->source_id == trx->source_id())
+            break;
+    }
+
+    return s;
+}
+
+
+void
+galera::Certification::stream_lock(TrxHandle* const     trx,
+                                   StreamList::iterator stream)
+{
+    assert(trx->fragment());
+
+    if (stream_locks_.end() == stream)
+    {
+        StreamLock const sl = { trx->source_id(), trx->trx_id(),
+                                trx->global_seqno(), new CertIndexNG(),
+                                new CertIndexNG() };
+
+        stream = stream_locks_.insert(stream_locks_.end(), sl);
+
+        log_debug << "Stream " << sl.source_id << ":" << sl.trx_id
+                  << " began at " << sl.last_seqno;
+    }
+
+    stream->last_seqno = trx->global_seqno();
+
+    const KeySetIn& key_set(trx->write_set_in().keyset());
+    long const      key_count(key_set.count());
+
+    key_set.rewind();
+
+    for (long i(0); i < key_count; ++i)
+    {
+        const KeySet::KeyPart& k(key_set.next());
+        CertIndexNG* const     index(k.shared() ? stream->shared
+                                                : stream->exclusive);
+
+        if (0 == index->find(k)) index->insert(k);
+    }
+}
+
+
+void
+galera::Certification::stream_unlock(TrxHandle* const     trx,
+                                     StreamList::iterator stream)
+{
+    assert(stream != stream_locks_.end());
+
+    log_debug << "Stream " << stream->source_id << ":" << stream->trx_id
+              << (trx->flags() & TrxHandle::F_ROLLBACK ? " rolled back at "
+                                                       : " committed at ")
+              << trx->global_seqno() << ", locked keys: "
+              << stream->shared->size() + stream->exclusive->size();
+
+    delete stream->shared;
+    delete stream->exclusive;
+    stream_locks_.erase(stream);
+}
+
+
+void
+galera::Certification::stream_clear()
+{
+    if (!stream_locks_.empty())
+    {
+        log_info << "Dropping " << stream_locks_.size()
+                 << " streamed transaction locks";
+    }
+
+    for (StreamList::iterator s(stream_locks_.begin());
+         s != stream_locks_.end(); ++s)
+    {
+        delete s->shared;
+        delete s->exclusive;
+    }
+
+    stream_locks_.clear();
+}
+
+
+void
+galera::Certification::stream_drop(const wsrep_view_info_t& view)
+{
+    StreamList::iterator s(stream_locks_.begin());
+
+    while (s != stream_locks_.end())
+    {
+        if (view_member(view, s->source_id))
+        {
+            ++s;
+        }
+        else
+        {
+            log_info << "Dropping locks of streamed trx " << s->trx_id
+                     << " of departed member " << s->source_id;
+            delete s->shared;
+            delete s->exclusive;
+            s = stream_locks_.erase(s);
+        }
+    }
+}
+
+
 galera::Certification::TestResult
 galera::Certification::do_test(TrxHandle* trx, bool store_keys)
 {
-    assert(trx->source_id() != WSREP_UUID_UNDEFINED);
+    assert(trx->source_id() != WSREP_UUID_UNDEFINED || trx->preordered());
 
     if (trx->version() != version_)
     {
@@ -697,8 +1075,13 @@ galera::Certification::do_test(TrxHandle* trx, bool store_keys)
         return TEST_FAILED;
     }
 
-    if (gu_unlikely(trx->last_seen_seqno() < initial_position_ ||
-                    trx->global_seqno() - trx->last_seen_seqno() > max_length_))
+    /* End of non-blocking TOI has no keys and only releases operation
+     * locks, it must not fail if a configuration change came between its
+     * replication and certification, or the locks would stay. */
+    if (gu_unlikely(!trx->nbo_end() &&
+                    (trx->last_seen_seqno() < initial_position_ ||
+                     trx->global_seqno() - trx->last_seen_seqno() >
+                     max_length_)))
     {
         if (trx->last_seen_seqno() < initial_position_)
         {
@@ -758,7 +1141,7 @@ galera::Certification::do_test(TrxHandle* trx, bool store_keys)
         ++n_certified_;
         deps_dist_ += (trx->global_seqno() - trx->depends_seqno());
         cert_interval_ += (trx->global_seqno() - trx->last_seen_seqno() - 1);
-        index_size_ = (cert_index_.size() + cert_index_ng_.size());
+        index_size_ = index_mem_usage();
     }
 
     byte_count_ += trx->size();
@@ -796,9 +1179,43 @@ galera::Certification::do_test_preordered(TrxHandle* trx)
         assert(0);
     }
 
-    trx->set_depends_seqno(last_preordered_seqno_ -
-                           trx->write_set_in().pa_range() + 1);
-    // +1 compensates for subtracting from a previous seqno, rather than own.
+    bool keyed(preordered_keys_ && trx->version() == version_ &&
+               trx->write_set_in().keyset().count() > 0);
+
+    if (keyed)
+    {
+        /* Writeset carries keys: certify it like a native one. Preordered
+         * writeset has seen everything ordered before it (last_seen_seqno
+         * is set to the previous seqno in TrxHandle::set_received()), so it
+         * never fails on key conflicts (it was committed at the source
+         * already), while its keys go to the index and fail local writesets
+         * which did not see it. It still can't go ahead of preordered
+         * writesets without keys. */
+        assert(trx->last_seen_seqno() == trx->global_seqno() - 1);
+
+        if (gu_likely(TEST_OK == do_test(trx, true)))
+        {
+            trx->set_depends_seqno(std::max(trx->depends_seqno(),
+                                            last_preordered_unkeyed_));
+        }
+        else
+        {
+            /* deterministic on all nodes, nothing was added to the index */
+            log_warn << "Preordered writeset " << trx->global_seqno()
+                     << " failed certification by keys, ordering it "
+                     << "without them";
+            keyed = false;
+        }
+    }
+
+    if (!keyed)
+    {
+        trx->set_depends_seqno(last_preordered_seqno_ -
+                               trx->write_set_in().pa_range() + 1);
+        // +1 compensates for subtracting from a previous seqno, rather than
+        // own.
+        last_preordered_unkeyed_ = trx->global_seqno();
+    }
 
     last_preordered_seqno_ = trx->global_seqno();
     last_preordered_id_    = trx->trx_id();
@@ -813,6 +1230,8 @@ galera::Certification::Certification(gu::Config& conf, ServiceThd& thd, gcache::
     trx_map_               (),
     cert_index_            (),
     cert_index_ng_         (),
+    nbo_locks_             (),
+    stream_locks_          (),
     deps_set_              (),
     service_thd_           (thd),
     gcache_                (gcache),
@@ -828,6 +1247,8 @@ galera::Certification::Certification(gu::Config& conf, ServiceThd& thd, gcache::
     last_pa_unsafe_        (-1),
     last_preordered_seqno_ (position_),
     last_preordered_id_    (0),
+    last_preordered_unkeyed_(position_),
+    preordered_keys_       (false),
 #ifdef HAVE_PSI_INTERFACE
     stats_mutex_           (WSREP_PFS_INSTR_TAG_STATS_MUTEX),
 #else
@@ -837,6 +1258,8 @@ galera::Certification::Certification(gu::Config& conf, ServiceThd& thd, gcache::
     deps_dist_             (0),
     cert_interval_         (0),
     index_size_            (0),
+    hot_conflicts_         (hot_keys_capacity(conf.get(PARAM_HOT_KEYS))),
+    hot_deps_              (hot_conflicts_.capacity()),
     key_count_             (0),
     byte_count_            (0),
     trx_count_             (0),
@@ -864,6 +1287,8 @@ galera::Certification::~Certification()
     gu::Lock lock(mutex_);
 
     for_each(trx_map_.begin(), trx_map_.end(), PurgeAndDiscard(*this));
+    nbo_clear();
+    stream_clear();
     service_thd_.release_seqno(position_);
     service_thd_.flush();
 }
@@ -900,8 +1325,6 @@ void galera::Certification::assign_initial_position(wsrep_seqno_t seqno,
                  << seqno;
         std::for_each(cert_index_.begin(), cert_index_.end(),
                       gu::DeleteObject());
-        std::for_each(cert_index_ng_.begin(), cert_index_ng_.end(),
-                      gu::DeleteObject());
         std::for_each(trx_map_.begin(), trx_map_.end(),
                       Unref2nd<TrxMap::value_type>());
         cert_index_.clear();
@@ -910,6 +1333,9 @@ void galera::Certification::assign_initial_position(wsrep_seqno_t seqno,
 
     trx_map_.clear();
 
+    /* locks of non-blocking TOIs and streamed transactions are handled
+     * separately, see drop_locks() */
+
     log_info << "Assign initial position for certification: " << seqno
              << ", protocol version: " << version;
 
@@ -919,6 +1345,7 @@ void galera::Certification::assign_initial_position(wsrep_seqno_t seqno,
     last_pa_unsafe_        = seqno;
     last_preordered_seqno_ = position_;
     last_preordered_id_    = 0;
+    last_preordered_unkeyed_ = position_;
     version_               = version;
 }
 
@@ -1119,3 +1546,39 @@ galera::Certification::set_log_conflicts(const std::string& str)
     }
 }
 
+
+void
+galera::Certification::set_hot_keys(const std::string& str)
+{
+    size_t const capacity(hot_keys_capacity(str));
+
+    gu::Lock lock(mutex_);
+    hot_conflicts_.reset(capacity);
+    hot_deps_.reset(capacity);
+}
+
+
+void
+galera::Certification::hot_keys_get(std::string& conflicts,
+                                    std::string& deps) const
+{
+    std::ostringstream osc, osd;
+
+    {
+        gu::Lock lock(mutex_);
+        hot_conflicts_.print(osc, CERT_HOT_KEYS_REPORT);
+        hot_deps_.print(osd, CERT_HOT_KEYS_REPORT);
+    }
+
+    conflicts = osc.str();
+    deps      = osd.str();
+}
+
+
+/* called from certification, under mutex_ */
+void
+galera::Certification::record_hot_key(CertHotKeys&           hk,
+                                      const KeySet::KeyPart& key)
+{
+    hk.record(key);
+}
@@ -6,7 +6,8 @@
 #define GALERA_CERTIFICATION_HPP
 
 #include "trx_handle.hpp"
-#include "key_entry_ng.hpp"
+#include "cert_index_ng.hpp"
+#include "cert_hot_keys.hpp"
 #include "galera_service_thd.hpp"
 
 #include "gu_unordered.hpp"
@@ -24,22 +25,42 @@ namespace galera
     public:
 
         static std::string const PARAM_LOG_CONFLICTS;
+        static std::string const PARAM_HOT_KEYS;
 
         static void register_params(gu::Config&);
 
         typedef gu::UnorderedSet<KeyEntryOS*,
                                  KeyEntryPtrHash, KeyEntryPtrEqual> CertIndex;
 
-        typedef gu::UnorderedSet<KeyEntryNG*,
-                                 KeyEntryPtrHashNG, KeyEntryPtrEqualNG>
-        CertIndexNG;
-
     private:
 
         typedef std::multiset<wsrep_seqno_t>        DepsSet;
 
         typedef std::map<wsrep_seqno_t, TrxHandle*> TrxMap;
 
+        /* keys locked by non-blocking TOI which has begun but not ended */
+        struct NBOLock
+        {
+            wsrep_uuid_t    source_id;
+            wsrep_conn_id_t conn_id;
+            wsrep_seqno_t   seqno;
+            CertIndexNG*    keys;
+        };
+
+        typedef std::list<NBOLock> NBOList;
+
+        /* keys of streamed transaction certified in fragments so far */
+        struct StreamLock
+        {
+            wsrep_uuid_t    source_id;
+            wsrep_trx_id_t  trx_id;
+            wsrep_seqno_t   last_seqno; // seqno of the last fragment
+            CertIndexNG*    shared;
+            CertIndexNG*    exclusive;
+        };
+
+        typedef std::list<StreamLock> StreamList;
+
     public:
 
         typedef enum
@@ -56,6 +77,41 @@ namespace galera
         TestResult test(TrxHandle*, bool = true);
         wsrep_seqno_t position() const { return position_; }
 
+        /*! number of non-blocking TOI operations in progress */
+        size_t nbo_count() const
+        {
+            gu::Lock lock(mutex_);
+            return nbo_locks_.size();
+        }
+
+        /*! true if trx touches keys locked by non-blocking TOI */
+        bool nbo_locked(TrxHandle* trx) const
+        {
+            gu::Lock lock(mutex_);
+            return (!nbo_locks_.empty() && nbo_conflict(trx));
+        }
+
+        /*! Locks of non-blocking TOIs and streamed transactions survive
+         *  position reassignment at configuration change, since nodes which
+         *  stay in the primary component have certified all events up to
+         *  it. Drops the locks whose source is not a member of view, or all
+         *  of them if view is NULL (state transfer, new members). */
+        void drop_locks(const wsrep_view_info_t* view);
+
+        /*! number of streamed transactions in progress */
+        size_t stream_count() const
+        {
+            gu::Lock lock(mutex_);
+            return stream_locks_.size();
+        }
+
+        /*! true if trx touches keys locked by other streamed transaction */
+        bool stream_locked(TrxHandle* trx) const
+        {
+            gu::Lock lock(mutex_);
+            return (!stream_locks_.empty() && stream_conflict(trx));
+        }
+
         wsrep_seqno_t
         get_safe_to_discard_seqno() const
         {
@@ -98,6 +154,12 @@ namespace galera
 
         void stats_reset()
         {
+            {
+                gu::Lock lock(mutex_);
+                hot_conflicts_.clear();
+                hot_deps_.clear();
+            }
+
             gu::Lock lock(stats_mutex_);
             cert_interval_ = 0;
             deps_dist_ = 0;
@@ -111,7 +173,28 @@ namespace galera
                 cert_index_ng_.bucket_count();
         }
 
+        // approximate memory used by certification index in bytes
+        size_t index_mem_usage()
+        {
+            return cert_index_.size() * sizeof(KeyEntryOS) +
+                cert_index_.bucket_count() * sizeof(void*) +
+                cert_index_ng_.mem_usage();
+        }
+
+        // most frequent keys which caused certification conflicts and
+        // which determined trx dependencies, see CertHotKeys::print()
+        void hot_keys_get(std::string& conflicts, std::string& deps) const;
+
+        /*! certify preordered writesets by their keys, if they carry any,
+         *  must be the same on all nodes */
+        void set_preordered_keys(bool const val)
+        {
+            gu::Lock lock(mutex_);
+            preordered_keys_ = val;
+        }
+
         void set_log_conflicts(const std::string& str);
+        void set_hot_keys(const std::string& str);
 
     private:
 
@@ -122,6 +205,18 @@ namespace galera
         void purge_for_trx(TrxHandle*);
         void purge_for_trx_v1to2(TrxHandle*);
         void purge_for_trx_v3(TrxHandle*);
+        void record_hot_key(CertHotKeys&, const KeySet::KeyPart&);
+        bool nbo_conflict(TrxHandle*) const;
+        void nbo_lock(TrxHandle*);
+        void nbo_unlock(TrxHandle*);
+        void nbo_clear();
+        void nbo_drop(const wsrep_view_info_t& view);
+        bool stream_conflict(TrxHandle*) const;
+        StreamList::iterator stream_find(TrxHandle*);
+        void stream_lock(TrxHandle*, StreamList::iterator);
+        void stream_unlock(TrxHandle*, StreamList::iterator);
+        void stream_clear();
+        void stream_drop(const wsrep_view_info_t& view);
 
         // unprotected variants for internal use
         wsrep_seqno_t get_safe_to_discard_seqno_() const;
@@ -187,6 +282,8 @@ namespace galera
         TrxMap        trx_map_;
         CertIndex     cert_index_;
         CertIndexNG   cert_index_ng_;
+        NBOList       nbo_locks_;
+        StreamList    stream_locks_;
         DepsSet       deps_set_;
         ServiceThd&   service_thd_;
         gcache::GCache& gcache_;
@@ -203,6 +300,8 @@ namespace galera
         wsrep_seqno_t last_pa_unsafe_;
         wsrep_seqno_t last_preordered_seqno_;
         wsrep_trx_id_t last_preordered_id_;
+        wsrep_seqno_t last_preordered_unkeyed_;
+        bool          preordered_keys_;
 #ifdef HAVE_PSI_INTERFACE
         gu::MutexWithPFS
                       stats_mutex_;
@@ -213,6 +312,8 @@ namespace galera
         wsrep_seqno_t deps_dist_;
         wsrep_seqno_t cert_interval_;
         size_t        index_size_;
+        CertHotKeys   hot_conflicts_; // recorded during certification,
+        CertHotKeys   hot_deps_;      // so protected by mutex_
 
         size_t        key_count_;
         size_t        byte_count_;
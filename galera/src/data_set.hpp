@@ -85,14 +85,16 @@ namespace galera
         DataSetOut (gu::byte_t*             reserved,
                     size_t                  reserved_size,
                     const BaseName&         base_name,
-                    DataSet::Version        version)
+                    DataSet::Version        version,
+                    gu::Allocator::Arena*   arena = NULL)
             :
             gu::RecordSetOut<DataSet::RecordOut> (
                 reserved,
                 reserved_size,
                 base_name,
                 check_type      (version),
-                ds_to_rs_version(version)
+                ds_to_rs_version(version),
+                arena
                 ),
             version_(version)
         {}
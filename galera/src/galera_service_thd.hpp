@@ -9,6 +9,7 @@
 #include <GCache.hpp>
 
 #include <gu_lock.hpp> // gu::Mutex and gu::Cond
+#include <gu_thread.hpp>
 
 namespace galera
 {
@@ -26,6 +27,12 @@ namespace galera
         /*! reset to initial state before gcs (re)connect */
         void reset();
 
+        /*! pin service thread to given CPUs */
+        void set_affinity(const gu::ThreadAffinity& affinity)
+        {
+            gu::thread_set_affinity(thd_, affinity);
+        }
+
         /* !!!
          * The following methods must be invoked only within a monitor,
          * so that monitors drain during CC ensures that no outdated
@@ -4,10 +4,12 @@
 
 #include "ist.hpp"
 #include "ist_proto.hpp"
+#include "uuid.hpp"
 
 #include "gu_logger.hpp"
 #include "gu_uri.hpp"
 #include "gu_debug_sync.hpp"
+#include "gu_thread.hpp"
 
 #include "GCache.hpp"
 #include "galera_common.hpp"
@@ -15,10 +17,18 @@
 #include <fstream>
 #include <algorithm>
 
+#include <poll.h>
+
 namespace
 {
     static std::string const CONF_KEEP_KEYS     ("ist.keep_keys");
     static bool        const CONF_KEEP_KEYS_DEFAULT (true);
+    // compression level for sent stream, 0 - no compression
+    static std::string const CONF_COMPRESS      ("ist.compress");
+    static int         const CONF_COMPRESS_DEFAULT (0);
+    // how long to wait for broken IST connection to be re-established
+    static std::string const CONF_RESUME_TIMEOUT("ist.resume_timeout");
+    static std::string const CONF_RESUME_TIMEOUT_DEFAULT("PT30S");
 }
 
 
@@ -81,9 +91,12 @@ galera::ist::register_params(gu::Config& conf)
     conf.add(Receiver::RECV_ADDR);
     conf.add(Receiver::RECV_BIND);
     conf.add(CONF_KEEP_KEYS);
+    conf.add(CONF_COMPRESS);
+    conf.add(CONF_RESUME_TIMEOUT);
 }
 
 galera::ist::Receiver::Receiver(gu::Config&           conf,
+                                gcache::GCache&       gc,
                                 TrxHandle::SlavePool& sp,
                                 const char*           addr)
     :
@@ -104,6 +117,7 @@ galera::ist::Receiver::Receiver(gu::Config&           conf,
     first_seqno_  (-1),
     last_seqno_   (-1),
     conf_         (conf),
+    gcache_       (gc),
     trx_pool_     (sp),
     thread_       (),
     error_code_   (0),
@@ -147,6 +161,20 @@ galera::ist::Receiver::~Receiver()
 { }
 
 
+/* pins calling thread to the CPUs configured for ist role, if any */
+static void set_ist_thread_affinity(const gu::Config& conf)
+{
+    try
+    {
+        gu::thread_set_affinity(pthread_self(),
+                                gu::thread_affinity(conf, "ist"));
+    }
+    catch (gu::Exception& e)
+    {
+        log_warn << "Failed to set IST thread CPU affinity: " << e.what();
+    }
+}
+
 extern "C" void* run_receiver_thread(void* arg)
 {
 #ifdef HAVE_PSI_INTERFACE
@@ -376,9 +404,61 @@ galera::ist::Receiver::prepare(wsrep_seqno_t first_seqno,
 
 
 void galera::ist::Receiver::run()
+{
+    set_ist_thread_affinity(conf_);
+
+    // resuming is possible only with protocol where receiver reports
+    // seqno to resume from in handshake
+    gu::datetime::Period const resume_timeout(
+        version_ >= Trx::BATCH_VERSION ?
+        conf_.get(CONF_RESUME_TIMEOUT, CONF_RESUME_TIMEOUT_DEFAULT) : "PT0S");
+
+    bool resume;
+    int  ec;
+
+    while ((ec = recv_stream(resume)) != 0 && resume == true)
+    {
+        log_info << "IST connection broken at " << current_seqno_ - 1
+                 << ", waiting " << resume_timeout
+                 << " for sender to resume";
+
+        if (wait_resume(resume_timeout) == false)
+        {
+            log_warn << "IST sender did not resume in " << resume_timeout;
+            break;
+        }
+    }
+
+    acceptor_.close();
+
+    gu::Lock lock(mutex_);
+
+    running_ = false;
+    if (ec != EINTR && current_seqno_ - 1 < last_seqno_)
+    {
+        log_error << "IST didn't contain all write sets, expected last: "
+                  << last_seqno_ << " last received: " << current_seqno_ - 1;
+        ec = EPROTO;
+    }
+    if (ec != EINTR)
+    {
+        error_code_ = ec;
+    }
+    while (consumers_.empty() == false)
+    {
+        consumers_.top()->cond().signal();
+        consumers_.pop();
+    }
+}
+
+
+int galera::ist::Receiver::recv_stream(bool& resume)
 {
     asio::ip::tcp::socket socket(io_service_);
     asio::ssl::stream<asio::ip::tcp::socket> ssl_stream(io_service_, ssl_ctx_);
+
+    resume = false;
+
     try
     {
         if (use_ssl_ == true)
@@ -400,8 +480,8 @@ void galera::ist::Receiver::run()
                                          << e.what() << "': "
                                          << gu::extra_error_info(e.code());
     }
-    acceptor_.close();
     int ec(0);
+    bool streaming(false);
     try
     {
         Proto p(trx_pool_, version_,
@@ -409,26 +489,27 @@ void galera::ist::Receiver::run()
 
         if (use_ssl_ == true)
         {
-            p.send_handshake(ssl_stream);
+            p.send_handshake(ssl_stream, current_seqno_);
             p.recv_handshake_response(ssl_stream);
             p.send_ctrl(ssl_stream, Ctrl::C_OK);
         }
         else
         {
-            p.send_handshake(socket);
+            p.send_handshake(socket, current_seqno_);
             p.recv_handshake_response(socket);
             p.send_ctrl(socket, Ctrl::C_OK);
         }
+        streaming = true;
         while (true)
         {
             TrxHandle* trx;
             if (use_ssl_ == true)
             {
-                trx = p.recv_trx(ssl_stream);
+                trx = p.recv_trx(ssl_stream, gcache_);
             }
             else
             {
-                trx = p.recv_trx(socket);
+                trx = p.recv_trx(socket, gcache_);
             }
             if (trx != 0)
             {
@@ -437,6 +518,7 @@ void galera::ist::Receiver::run()
                     log_error << "unexpected trx seqno: " << trx->global_seqno()
                               << " expected: " << current_seqno_;
                     ec = EINVAL;
+                    discard_trx(trx);
                     goto err;
                 }
                 ++current_seqno_;
@@ -447,9 +529,17 @@ void galera::ist::Receiver::run()
                 lock.wait(cond_);
                 if (interrupted_)
                 {
+                    if (trx != 0) discard_trx(trx);
                     goto Intrrupted;
                 }
             }
+            if (trx != 0)
+            {
+                // ready() is called after GCache history was reset,
+                // write sets received before can be assigned only now
+                gcache_.seqno_assign(trx->action(), trx->global_seqno(),
+                                     trx->depends_seqno());
+            }
             Consumer* cons(consumers_.top());
             consumers_.pop();
             cons->trx(trx);
@@ -460,11 +550,34 @@ void galera::ist::Receiver::run()
                 break;
             }
         }
+
+        // since BATCH_VERSION sender resumes the stream unless it gets
+        // end of stream confirmed
+        if (version_ >= Trx::BATCH_VERSION)
+        {
+            try
+            {
+                if (use_ssl_ == true)
+                {
+                    p.send_ctrl(ssl_stream, Ctrl::C_EOF);
+                }
+                else
+                {
+                    p.send_ctrl(socket, Ctrl::C_EOF);
+                }
+            }
+            catch (asio::system_error& e)
+            {
+                log_debug << "failed to confirm eof: " << e.code();
+            }
+        }
     }
     catch (asio::system_error& e)
     {
         log_error << "got error while reading ist stream: " << e.code();
         ec = e.code().value();
+        // connection was lost in the middle of the stream
+        resume = streaming && ec != 0;
     }
     catch (gu::Exception& e)
     {
@@ -477,7 +590,6 @@ void galera::ist::Receiver::run()
 
 Intrrupted:
 err:
-    gu::Lock lock(mutex_);
     if (use_ssl_ == true)
     {
         ssl_stream.lowest_layer().close();
@@ -488,22 +600,29 @@ err:
         socket.close();
     }
 
-    running_ = false;
-    if (ec != EINTR && current_seqno_ - 1 < last_seqno_)
-    {
-        log_error << "IST didn't contain all write sets, expected last: "
-                  << last_seqno_ << " last received: " << current_seqno_ - 1;
-        ec = EPROTO;
-    }
-    if (ec != EINTR)
-    {
-        error_code_ = ec;
-    }
-    while (consumers_.empty() == false)
-    {
-        consumers_.top()->cond().signal();
-        consumers_.pop();
-    }
+    return ec;
+}
+
+
+bool galera::ist::Receiver::wait_resume(const gu::datetime::Period& timeout)
+{
+    if (timeout.get_nsecs() <= 0) return false;
+
+    struct pollfd pfd;
+    pfd.fd      = acceptor_.native();
+    pfd.events  = POLLIN;
+    pfd.revents = 0;
+
+    int const ret(poll(&pfd, 1, timeout.get_nsecs() / gu::datetime::MSec));
+
+    return (ret > 0);
+}
+
+
+void galera::ist::Receiver::discard_trx(TrxHandle* const trx)
+{
+    gcache_.free(const_cast<void*>(trx->action()));
+    trx->unref();
 }
 
 
@@ -651,10 +770,37 @@ galera::ist::Sender::Sender(const gu::Config&  conf,
     ssl_stream_(0),
     conf_      (conf),
     gcache_    (gcache),
+    peer_      (peer),
     version_   (version),
-    use_ssl_   (false)
+    use_ssl_   (false),
+    cancelled_ (0)
 {
     gu::URI uri(peer);
+    if (uri.get_scheme() == "ssl")
+    {
+        use_ssl_ = true;
+    }
+    if (use_ssl_ == true)
+    {
+        log_info << "IST sender using ssl";
+        try
+        {
+            ssl_prepare_context(conf, ssl_ctx_);
+        }
+        catch (asio::system_error& e)
+        {
+            gu_throw_error(e.code().value()) << "IST sender, failed to "
+                                             << "prepare ssl context: "
+                                             << e.what();
+        }
+    }
+    connect();
+}
+
+
+void galera::ist::Sender::connect()
+{
+    gu::URI uri(peer_);
     try
     {
         asio::ip::tcp::resolver resolver(io_service_);
@@ -663,14 +809,13 @@ galera::ist::Sender::Sender(const gu::Config&  conf,
                   uri.get_port(),
                   asio::ip::tcp::resolver::query::flags(0));
         asio::ip::tcp::resolver::iterator i(resolver.resolve(query));
-        if (uri.get_scheme() == "ssl")
-        {
-            use_ssl_ = true;
-        }
         if (use_ssl_ == true)
         {
-            log_info << "IST sender using ssl";
-            ssl_prepare_context(conf, ssl_ctx_);
+            if (ssl_stream_ != 0)
+            {
+                ssl_stream_->lowest_layer().close();
+                delete ssl_stream_;
+            }
             // ssl_stream must be created after ssl_ctx_ is prepared...
             ssl_stream_ = new asio::ssl::stream<asio::ip::tcp::socket>(
                 io_service_, ssl_ctx_);
@@ -680,6 +825,7 @@ galera::ist::Sender::Sender(const gu::Config&  conf,
         }
         else
         {
+            socket_.close();
             socket_.connect(*i);
             gu::set_fd_options(socket_);
         }
@@ -687,7 +833,7 @@ galera::ist::Sender::Sender(const gu::Config&  conf,
     catch (asio::system_error& e)
     {
         gu_throw_error(e.code().value()) << "IST sender, failed to connect '"
-                                         << peer.c_str() << "': " << e.what();
+                                         << peer_.c_str() << "': " << e.what();
     }
 }
 
@@ -713,102 +859,203 @@ void galera::ist::Sender::send(wsrep_seqno_t first, wsrep_seqno_t last)
         gu_throw_error(EINVAL) << "sender send first greater than last: "
                                << first << " > " << last ;
     }
-    try
+
+    // receiver reports seqno to resume from only since BATCH_VERSION
+    gu::datetime::Period const resume_timeout(
+        version_ >= Trx::BATCH_VERSION ?
+        conf_.get(CONF_RESUME_TIMEOUT, CONF_RESUME_TIMEOUT_DEFAULT) : "PT0S");
+
+    while (true)
     {
-        TrxHandle::SlavePool unused(1, 0, "");
-        Proto p(unused, version_,
-                conf_.get(CONF_KEEP_KEYS, CONF_KEEP_KEYS_DEFAULT));
-        int32_t ctrl;
+        try
+        {
+            send_stream(first, last);
+            return;
+        }
+        catch (asio::system_error& e)
+        {
+            if (cancelled_() || resume_timeout.get_nsecs() <= 0)
+            {
+                gu_throw_error(e.code().value()) << "ist send failed: "
+                                                 << e.code()
+                                                 << "', asio error '"
+                                                 << e.what() << "'";
+            }
 
-        if (use_ssl_ == true)
+            log_warn << "IST connection to " << peer_ << " broken: "
+                     << e.what() << ", trying to resume";
+        }
+
+        gu::datetime::Date const until(gu::datetime::Date::monotonic()
+                                       + resume_timeout);
+        while (true)
         {
-            p.recv_handshake(*ssl_stream_);
-            p.send_handshake_response(*ssl_stream_);
-            ctrl = p.recv_ctrl(*ssl_stream_);
+            usleep(100000);
+
+            try
+            {
+                connect();
+                break;
+            }
+            catch (gu::Exception& e)
+            {
+                if (cancelled_() || until < gu::datetime::Date::monotonic())
+                {
+                    throw;
+                }
+            }
         }
-        else
+    }
+}
+
+
+void galera::ist::Sender::send_stream(wsrep_seqno_t first, wsrep_seqno_t last)
+{
+    TrxHandle::SlavePool unused(1, 0, "");
+    Proto p(unused, version_,
+            conf_.get(CONF_KEEP_KEYS, CONF_KEEP_KEYS_DEFAULT),
+            conf_.get(CONF_COMPRESS, CONF_COMPRESS_DEFAULT));
+    int32_t ctrl;
+
+    if (use_ssl_ == true)
+    {
+        Message const hs(p.recv_handshake(*ssl_stream_));
+        p.send_handshake_response(*ssl_stream_, hs);
+        ctrl = p.recv_ctrl(*ssl_stream_);
+        first = resume_seqno(hs, first, last);
+    }
+    else
+    {
+        Message const hs(p.recv_handshake(socket_));
+        p.send_handshake_response(socket_, hs);
+        ctrl = p.recv_ctrl(socket_);
+        first = resume_seqno(hs, first, last);
+    }
+    if (ctrl < 0)
+    {
+        gu_throw_error(EPROTO)
+            << "ist send failed, peer reported error: " << ctrl;
+    }
+
+    if (first > last)
+    {
+        // receiver has everything already
+        if (use_ssl_ == true)
         {
-            p.recv_handshake(socket_);
-            p.send_handshake_response(socket_);
-            ctrl = p.recv_ctrl(socket_);
+            p.send_ctrl(*ssl_stream_, Ctrl::C_EOF);
         }
-        if (ctrl < 0)
+        else
         {
-            gu_throw_error(EPROTO)
-                << "ist send failed, peer reported error: " << ctrl;
+            p.send_ctrl(socket_, Ctrl::C_EOF);
         }
+        return;
+    }
 
-        std::vector<gcache::GCache::Buffer> buf_vec(
-            std::min(static_cast<size_t>(last - first + 1),
-                     static_cast<size_t>(1024)));
-        ssize_t n_read;
-        while ((n_read = gcache_.seqno_get_buffers(buf_vec, first)) > 0)
+    std::vector<gcache::GCache::Buffer> buf_vec(
+        std::min(static_cast<size_t>(last - first + 1),
+                 static_cast<size_t>(1024)));
+    ssize_t n_read;
+    while ((n_read = gcache_.seqno_get_buffers(buf_vec, first)) > 0)
+    {
+        GU_DBUG_SYNC_WAIT("ist_sender_send_after_get_buffers")
+        //log_info << "read " << first << " + " << n_read << " from gcache";
+        for (wsrep_seqno_t i(0); i < n_read; ++i)
         {
-            GU_DBUG_SYNC_WAIT("ist_sender_send_after_get_buffers")
-            //log_info << "read " << first << " + " << n_read << " from gcache";
-            for (wsrep_seqno_t i(0); i < n_read; ++i)
+            // log_info << "sending " << buf_vec[i].seqno_g();
+            if (use_ssl_ == true)
+            {
+                p.send_trx(*ssl_stream_, buf_vec[i]);
+            }
+            else
+            {
+                p.send_trx(socket_, buf_vec[i]);
+            }
+
+            if (buf_vec[i].seqno_g() == last)
             {
-                // log_info << "sending " << buf_vec[i].seqno_g();
                 if (use_ssl_ == true)
                 {
-                    p.send_trx(*ssl_stream_, buf_vec[i]);
+                    p.send_ctrl(*ssl_stream_, Ctrl::C_EOF);
                 }
                 else
                 {
-                    p.send_trx(socket_, buf_vec[i]);
+                    p.send_ctrl(socket_, Ctrl::C_EOF);
+                }
+
+                if (version_ >= Trx::BATCH_VERSION)
+                {
+                    // receiver confirms end of stream, connection broken
+                    // before that throws and the stream is resumed
+                    ctrl = (use_ssl_ == true ? p.recv_ctrl(*ssl_stream_) :
+                            p.recv_ctrl(socket_));
+                    if (ctrl != Ctrl::C_EOF)
+                    {
+                        gu_throw_error(EPROTO)
+                            << "unexpected ctrl code at end of stream: "
+                            << ctrl;
+                    }
+                    return;
                 }
 
-                if (buf_vec[i].seqno_g() == last)
+                // wait until receiver closes the connection
+                try
                 {
+                    gu::byte_t b;
+                    size_t n;
                     if (use_ssl_ == true)
                     {
-                        p.send_ctrl(*ssl_stream_, Ctrl::C_EOF);
+                        n = asio::read(*ssl_stream_, asio::buffer(&b, 1));
                     }
                     else
                     {
-                        p.send_ctrl(socket_, Ctrl::C_EOF);
+                        n = asio::read(socket_, asio::buffer(&b, 1));
                     }
-                    // wait until receiver closes the connection
-                    try
+                    if (n > 0)
                     {
-                        gu::byte_t b;
-                        size_t n;
-                        if (use_ssl_ == true)
-                        {
-                            n = asio::read(*ssl_stream_, asio::buffer(&b, 1));
-                        }
-                        else
-                        {
-                            n = asio::read(socket_, asio::buffer(&b, 1));
-                        }
-                        if (n > 0)
-                        {
-                            log_warn << "received " << n
-                                     << " bytes, expected none";
-                        }
+                        log_warn << "received " << n
+                                 << " bytes, expected none";
                     }
-                    catch (asio::system_error& e)
-                    { }
-                    return;
                 }
+                catch (asio::system_error& e)
+                { }
+                return;
             }
-            first += n_read;
-            // resize buf_vec to avoid scanning gcache past last
-            size_t next_size(std::min(static_cast<size_t>(last - first + 1),
-                                      static_cast<size_t>(1024)));
+        }
+        first += n_read;
+        // resize buf_vec to avoid scanning gcache past last
+        size_t next_size(std::min(static_cast<size_t>(last - first + 1),
+                                  static_cast<size_t>(1024)));
 
-            if (buf_vec.size() != next_size)
-            {
-                buf_vec.resize(next_size);
-            }
+        if (buf_vec.size() != next_size)
+        {
+            buf_vec.resize(next_size);
         }
     }
-    catch (asio::system_error& e)
+}
+
+
+wsrep_seqno_t galera::ist::Sender::resume_seqno(const Message& hs,
+                                                wsrep_seqno_t  first,
+                                                wsrep_seqno_t  last)
+{
+    if (version_ < Trx::BATCH_VERSION || hs.len() == 0) return first;
+
+    wsrep_seqno_t const next(hs.len());
+
+    if (next < first || next > last + 1)
     {
-        gu_throw_error(e.code().value()) << "ist send failed: " << e.code()
-                                         << "', asio error '" << e.what()
-                                         << "'";
+        gu_throw_error(EPROTO) << "receiver requested IST from " << next
+                               << ", outside of range " << first << '-'
+                               << last;
     }
+
+    if (next > first)
+    {
+        log_info << "IST receiver has write sets up to " << next - 1
+                 << ", resuming from there";
+    }
+
+    return next;
 }
 
 
@@ -826,6 +1073,8 @@ void* run_async_sender(void* arg)
                        NULL, NULL, NULL);
 #endif /* HAVE_PSI_INTERFACE */
 
+    set_ist_thread_affinity(as->conf());
+
     log_info << "async IST sender starting to serve " << as->peer().c_str()
              << " sending " << as->first() << "-" << as->last();
     wsrep_seqno_t join_seqno;
@@ -918,3 +1167,20 @@ void galera::ist::AsyncSenderMap::cancel()
     }
 
 }
+
+
+std::ostream& galera::operator<<(std::ostream& os, const IST_request& istr)
+{
+    return (os
+            << istr.uuid_         << ":"
+            << istr.last_applied_ << "-"
+            << istr.group_seqno_  << "|"
+            << istr.peer_);
+}
+
+std::istream& galera::operator>>(std::istream& is, IST_request& istr)
+{
+    char c;
+    return (is >> istr.uuid_ >> c >> istr.last_applied_
+            >> c >> istr.group_seqno_ >> c >> istr.peer_);
+}
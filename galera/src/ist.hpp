@@ -15,6 +15,8 @@
 #include "gu_lock.hpp"
 #include "gu_monitor.hpp"
 #include "gu_asio.hpp"
+#include "gu_datetime.hpp"
+#include "gu_atomic.hpp"
 
 #include <stack>
 #include <set>
@@ -30,6 +32,8 @@ namespace galera
 
     namespace ist
     {
+        class Message;
+
         void register_params(gu::Config& conf);
 
         class Receiver
@@ -38,7 +42,8 @@ namespace galera
             static std::string const RECV_ADDR;
             static std::string const RECV_BIND;
 
-            Receiver(gu::Config& conf, TrxHandle::SlavePool&, const char* addr);
+            Receiver(gu::Config& conf, gcache::GCache&, TrxHandle::SlavePool&,
+                     const char* addr);
             ~Receiver();
 
             std::string   prepare(wsrep_seqno_t, wsrep_seqno_t, int);
@@ -56,6 +61,21 @@ namespace galera
 
             void interrupt();
 
+            /*!
+             * Accepts connection and receives IST stream from it.
+             *
+             * @param resume set to true if connection was lost after
+             *        the stream had started
+             * @return error code
+             */
+            int  recv_stream(bool& resume);
+
+            /*! waits for sender to reconnect, @return true if it did */
+            bool wait_resume(const gu::datetime::Period& timeout);
+
+            /* drops received trx which was not passed to consumers */
+            void discard_trx(TrxHandle* trx);
+
             std::string                                   recv_addr_;
             std::string                                   recv_bind_;
             asio::io_service                              io_service_;
@@ -111,6 +131,7 @@ namespace galera
             wsrep_seqno_t         first_seqno_;
             wsrep_seqno_t         last_seqno_;
             gu::Config&           conf_;
+            gcache::GCache&       gcache_;
             TrxHandle::SlavePool& trx_pool_;
             pthread_t             thread_;
             int                   error_code_;
@@ -135,10 +156,17 @@ namespace galera
                    int version);
             virtual ~Sender();
 
+            /*!
+             * Sends write sets first - last. Since Trx::BATCH_VERSION
+             * skips write sets the receiver already has and, if
+             * connection is lost, reconnects and resumes within
+             * ist.resume_timeout.
+             */
             void send(wsrep_seqno_t first, wsrep_seqno_t last);
 
             void cancel()
             {
+                cancelled_ = 1;
                 if (use_ssl_ == true)
                 {
                     ssl_stream_->lowest_layer().close();
@@ -151,14 +179,24 @@ namespace galera
 
         private:
 
+            void connect();
+            void send_stream(wsrep_seqno_t first, wsrep_seqno_t last);
+
+            /*! @return seqno to start from as requested by receiver */
+            wsrep_seqno_t resume_seqno(const Message& hs,
+                                       wsrep_seqno_t  first,
+                                       wsrep_seqno_t  last);
+
             asio::io_service                          io_service_;
             asio::ip::tcp::socket                     socket_;
             asio::ssl::context                        ssl_ctx_;
             asio::ssl::stream<asio::ip::tcp::socket>* ssl_stream_;
             const gu::Config&                         conf_;
             gcache::GCache&                           gcache_;
+            std::string const                         peer_;
             int                                       version_;
             bool                                      use_ssl_;
+            gu::Atomic<int>                           cancelled_;
 
             Sender(const Sender&);
             void operator=(const Sender&);
@@ -169,7 +207,7 @@ namespace galera
         class AsyncSenderMap
         {
         public:
-            AsyncSenderMap(GCS_IMPL& gcs, gcache::GCache& gcache)
+            AsyncSenderMap(gcache::GCache& gcache)
                 :
                 senders_(),
 #ifdef HAVE_PSI_INTERFACE
@@ -196,6 +234,38 @@ namespace galera
 
 
     } // namespace ist
+
+    /*! IST part of the state transfer request:
+     *  "<uuid>:<last applied>-<group seqno>|<receiver address>" */
+    class IST_request
+    {
+    public:
+        IST_request() : peer_(), uuid_(), last_applied_(), group_seqno_() { }
+        IST_request(const std::string& peer,
+                    const wsrep_uuid_t& uuid,
+                    wsrep_seqno_t last_applied,
+                    wsrep_seqno_t group_seqno)
+            :
+            peer_(peer),
+            uuid_(uuid),
+            last_applied_(last_applied),
+            group_seqno_(group_seqno)
+        { }
+        const std::string&  peer()  const { return peer_ ; }
+        const wsrep_uuid_t& uuid()  const { return uuid_ ; }
+        wsrep_seqno_t       last_applied() const { return last_applied_; }
+        wsrep_seqno_t       group_seqno()  const { return group_seqno_; }
+    private:
+        friend std::ostream& operator<<(std::ostream&, const IST_request&);
+        friend std::istream& operator>>(std::istream&, IST_request&);
+        std::string peer_;
+        wsrep_uuid_t uuid_;
+        wsrep_seqno_t last_applied_;
+        wsrep_seqno_t group_seqno_;
+    };
+
+    std::ostream& operator<<(std::ostream& os, const IST_request& istr);
+    std::istream& operator>>(std::istream& is, IST_request& istr);
 } // namespace galera
 
 #endif // GALERA_IST_HPP
@@ -12,6 +12,7 @@
 #include "gu_logger.hpp"
 #include "gu_serialize.hpp"
 #include "gu_vector.hpp"
+#include "gu_compress.hpp"
 
 //
 // Message class must have non-virtual destructor until
@@ -43,6 +44,20 @@
 // order. Therefore it is not necessary to negotiate version at IST level,
 // it should be enough to check that message version numbers match.
 //
+// Since version 8 seqno_g and seqno_d are a part of trx message header and
+// message len is the size of write set payload only. Sender batches small
+// trx messages into larger writes and receiver parses trx messages out of
+// a large read buffer, so after the first recv_trx() call all reads from
+// the socket must go through recv_trx().
+//
+// Also since version 8 receiver handshake carries the seqno receiver expects
+// next in len field, so that sender can resume interrupted IST from there,
+// and F_COMPRESSED flag if receiver accepts compressed stream. If sender
+// sets F_COMPRESSED in handshake response, the rest of the stream from the
+// sender is sent as T_BLOCK messages, each carrying a (compressed) batch.
+// Receiver confirms EOF with send_ctrl(EOF) before close(), sender which
+// loses connection before the confirmation reconnects and resumes.
+//
 
 
 namespace galera
@@ -58,9 +73,15 @@ namespace galera
                 T_HANDSHAKE = 1,
                 T_HANDSHAKE_RESPONSE = 2,
                 T_CTRL = 3,
-                T_TRX = 4
+                T_TRX = 4,
+                T_BLOCK = 5
             } Type;
 
+            enum
+            {
+                F_COMPRESSED = 0x1
+            };
+
             Message(int       version = -1,
                     Type      type    = T_NONE,
                     uint8_t   flags   = 0,
@@ -194,18 +215,18 @@ namespace galera
         class Handshake : public Message
         {
         public:
-            Handshake(int version = -1)
+            Handshake(int version = -1, uint8_t flags = 0, uint64_t len = 0)
                 :
-                Message(version, Message::T_HANDSHAKE, 0, 0, 0)
+                Message(version, Message::T_HANDSHAKE, flags, 0, len)
             { }
         };
 
         class HandshakeResponse : public Message
         {
         public:
-            HandshakeResponse(int version = -1)
+            HandshakeResponse(int version = -1, uint8_t flags = 0)
                 :
-                Message(version, Message::T_HANDSHAKE_RESPONSE, 0, 0, 0)
+                Message(version, Message::T_HANDSHAKE_RESPONSE, flags, 0, 0)
             { }
         };
 
@@ -227,10 +248,60 @@ namespace galera
         class Trx : public Message
         {
         public:
-            Trx(int version = -1, uint64_t len = 0)
+            static int const BATCH_VERSION = 8;
+
+            Trx(int           version = -1,
+                uint64_t      len     = 0,
+                wsrep_seqno_t seqno_g = WSREP_SEQNO_UNDEFINED,
+                wsrep_seqno_t seqno_d = WSREP_SEQNO_UNDEFINED)
                 :
-                Message(version, Message::T_TRX, 0, 0, len)
+                Message (version, Message::T_TRX, 0, 0, len),
+                seqno_g_(seqno_g),
+                seqno_d_(seqno_d)
             { }
+
+            wsrep_seqno_t seqno_g() const { return seqno_g_; }
+            wsrep_seqno_t seqno_d() const { return seqno_d_; }
+
+            /* seqnos are serialized with header only since BATCH_VERSION */
+            static size_t meta_size(int version)
+            {
+                return (version >= BATCH_VERSION ? 8 + 8 : 0);
+            }
+
+            size_t serial_size() const
+            {
+                return Message::serial_size() + meta_size(version());
+            }
+
+            size_t serialize(gu::byte_t* buf, size_t buflen, size_t offset)
+                const
+            {
+                offset = Message::serialize(buf, buflen, offset);
+
+                if (version() >= BATCH_VERSION)
+                {
+                    offset = gu::serialize8(seqno_g_, buf, buflen, offset);
+                    offset = gu::serialize8(seqno_d_, buf, buflen, offset);
+                }
+
+                return offset;
+            }
+
+            /* unserializes header part following the Message one */
+            size_t unserialize_meta(const gu::byte_t* buf, size_t buflen,
+                                    size_t offset)
+            {
+                assert(version() >= BATCH_VERSION);
+                offset = gu::unserialize8(buf, buflen, offset, seqno_g_);
+                offset = gu::unserialize8(buf, buflen, offset, seqno_d_);
+                return offset;
+            }
+
+        private:
+
+            wsrep_seqno_t seqno_g_;
+            wsrep_seqno_t seqno_d_;
         };
 
 
@@ -238,13 +309,34 @@ namespace galera
         {
         public:
 
-            Proto(TrxHandle::SlavePool& sp, int version, bool keep_keys)
+            /* trx messages are batched up to this size on send */
+            static size_t const SEND_BATCH_SIZE = 1 << 16;
+            /* read buffer size for batched trx messages */
+            static size_t const RECV_BUF_SIZE   = 1 << 20;
+            /* largest T_BLOCK payload: batch ending with largest write set */
+            static uint64_t const MAX_BLOCK_SIZE =
+                uint64_t(WriteSetNG::MAX_SIZE) + SEND_BATCH_SIZE;
+
+            /*
+             * @param compress compression level for sent stream, 0 - off.
+             *        Takes effect only if peer accepts compressed stream.
+             */
+            Proto(TrxHandle::SlavePool& sp, int version, bool keep_keys,
+                  int compress = 0)
                 :
-                trx_pool_ (sp),
-                raw_sent_ (0),
-                real_sent_(0),
-                version_  (version),
-                keep_keys_(keep_keys)
+                trx_pool_       (sp),
+                raw_sent_       (0),
+                real_sent_      (0),
+                version_        (version),
+                keep_keys_      (keep_keys),
+                compress_       (compress),
+                send_compressed_(false),
+                recv_compressed_(false),
+                send_buf_       (),
+                block_buf_      (),
+                recv_buf_       (),
+                recv_begin_     (0),
+                recv_end_       (0)
             { }
 
             ~Proto()
@@ -261,10 +353,20 @@ namespace galera
                 }
             }
 
+            /*!
+             * @param next_seqno seqno receiver expects next, sender resumes
+             *        from it since BATCH_VERSION
+             */
             template <class ST>
-            void send_handshake(ST& socket)
+            void send_handshake(ST& socket,
+                                wsrep_seqno_t next_seqno =
+                                WSREP_SEQNO_UNDEFINED)
             {
-                Handshake  hs(version_);
+                bool const batched(version_ >= Trx::BATCH_VERSION);
+                uint8_t const flags(batched && gu::compress_supported() ?
+                                    Message::F_COMPRESSED : 0);
+                Handshake  hs(version_, flags,
+                              batched && next_seqno > 0 ? next_seqno : 0);
                 gu::Buffer buf(hs.serial_size());
                 size_t offset(hs.serialize(&buf[0], buf.size(), 0));
                 size_t n(asio::write(socket, asio::buffer(&buf[0],
@@ -275,8 +377,9 @@ namespace galera
                 }
             }
 
+            /*! @return received handshake message */
             template <class ST>
-            void recv_handshake(ST& socket)
+            Message recv_handshake(ST& socket)
             {
                 Message    msg(version_);
                 gu::Buffer buf(msg.serial_size());
@@ -318,12 +421,20 @@ namespace galera
                                            << version_;
                 }
                 // TODO: Figure out protocol versions to use
+
+                return msg;
             }
 
+            /*! @param hs handshake received from peer */
             template <class ST>
-            void send_handshake_response(ST& socket)
+            void send_handshake_response(ST& socket, const Message& hs)
             {
-                HandshakeResponse hsr(version_);
+                send_compressed_ = (version_ >= Trx::BATCH_VERSION &&
+                                    compress_ > 0 &&
+                                    (hs.flags() & Message::F_COMPRESSED));
+
+                HandshakeResponse hsr(version_, send_compressed_ ?
+                                      Message::F_COMPRESSED : 0);
                 gu::Buffer buf(hsr.serial_size());
                 size_t offset(hsr.serialize(&buf[0], buf.size(), 0));
                 size_t n(asio::write(socket, asio::buffer(&buf[0], buf.size())));
@@ -355,6 +466,8 @@ namespace galera
                 switch (msg.type())
                 {
                 case Message::T_HANDSHAKE_RESPONSE:
+                    recv_compressed_ = (version_ >= Trx::BATCH_VERSION &&
+                                        (msg.flags() & Message::F_COMPRESSED));
                     break;
                 case Message::T_CTRL:
                     switch (msg.ctrl())
@@ -375,6 +488,19 @@ namespace galera
             void send_ctrl(ST& socket, int8_t code)
             {
                 Ctrl       ctrl(version_, code);
+
+                if (send_compressed_)
+                {
+                    size_t const offset(send_buf_.size());
+                    send_buf_.resize(offset + ctrl.serial_size());
+                    (void)ctrl.serialize(&send_buf_[0], send_buf_.size(),
+                                         offset);
+                    flush(socket);
+                    return;
+                }
+
+                flush(socket);
+
                 gu::Buffer buf(ctrl.serial_size());
                 size_t offset(ctrl.serialize(&buf[0], buf.size(), 0));
                 size_t n(asio::write(socket, asio::buffer(&buf[0],buf.size())));
@@ -413,6 +539,140 @@ namespace galera
             }
 
 
+            /*! writes out pending batched trx messages */
+            template <class ST>
+            void flush(ST& socket)
+            {
+                if (send_buf_.empty()) return;
+
+                size_t sent;
+
+                if (send_compressed_)
+                {
+                    sent = send_block(socket);
+                }
+                else
+                {
+                    sent = asio::write(socket, asio::buffer(&send_buf_[0],
+                                                            send_buf_.size()));
+                }
+
+                log_debug << "sent batch of " << sent << " bytes";
+                raw_sent_ += send_buf_.size();
+                real_sent_ += sent;
+                send_buf_.clear();
+            }
+
+            /*!
+             * Sends send_buf_ contents as T_BLOCK message. Compressed block
+             * payload is prefixed by the original size.
+             */
+            template <class ST>
+            size_t send_block(ST& socket)
+            {
+                size_t const hdr_size(Message(version_).serial_size() + 8);
+
+                block_buf_.resize(hdr_size);
+
+                bool const compressed(gu::compress(&send_buf_[0],
+                                                   send_buf_.size(),
+                                                   block_buf_, compress_));
+
+                boost::array<asio::const_buffer, 2> cbs;
+                size_t offset;
+
+                if (compressed)
+                {
+                    Message const block(version_, Message::T_BLOCK,
+                                        Message::F_COMPRESSED, 0,
+                                        block_buf_.size() - hdr_size);
+                    offset = block.serialize(&block_buf_[0], hdr_size, 0);
+                    offset = gu::serialize8(uint64_t(send_buf_.size()),
+                                            &block_buf_[0], hdr_size, offset);
+                    cbs[0] = asio::const_buffer(&block_buf_[0],
+                                                block_buf_.size());
+                    cbs[1] = asio::const_buffer(&block_buf_[0], 0);
+                }
+                else
+                {
+                    Message const block(version_, Message::T_BLOCK, 0, 0,
+                                        send_buf_.size());
+                    offset = block.serialize(&block_buf_[0], hdr_size, 0);
+                    cbs[0] = asio::const_buffer(&block_buf_[0], offset);
+                    cbs[1] = asio::const_buffer(&send_buf_[0],
+                                                send_buf_.size());
+                }
+
+                return asio::write(socket, cbs);
+            }
+
+            /*!
+             * Receives next T_BLOCK message and appends its (decompressed)
+             * payload to recv_buf_.
+             */
+            template <class ST>
+            void recv_block(ST& socket)
+            {
+                Message    block(version_);
+                gu::byte_t hdr[32];
+                size_t const hdr_size(block.serial_size());
+
+                assert(hdr_size + 8 <= sizeof(hdr));
+
+                (void)asio::read(socket, asio::buffer(hdr, hdr_size));
+                (void)block.unserialize(hdr, hdr_size, 0);
+
+                if (block.type() != Message::T_BLOCK)
+                {
+                    gu_throw_error(EPROTO) << "unexpected message type: "
+                                           << block.type()
+                                           << ", expected block";
+                }
+
+                uint64_t size(block.len());
+
+                if (size > MAX_BLOCK_SIZE)
+                {
+                    gu_throw_error(EPROTO) << "block length " << size
+                                           << " exceeds " << MAX_BLOCK_SIZE;
+                }
+
+                if (block.flags() & Message::F_COMPRESSED)
+                {
+                    (void)asio::read(socket, asio::buffer(hdr, 8));
+                    (void)gu::unserialize8(hdr, 8, 0, size);
+
+                    if (size > MAX_BLOCK_SIZE)
+                    {
+                        gu_throw_error(EPROTO) << "uncompressed block size "
+                                               << size << " exceeds "
+                                               << MAX_BLOCK_SIZE;
+                    }
+
+                    block_buf_.resize(block.len());
+                    (void)asio::read(socket, asio::buffer(&block_buf_[0],
+                                                          block_buf_.size()));
+                }
+
+                if (recv_buf_.size() < recv_end_ + size)
+                {
+                    recv_buf_.resize(recv_end_ + size);
+                }
+
+                if (block.flags() & Message::F_COMPRESSED)
+                {
+                    gu::decompress(&block_buf_[0], block_buf_.size(),
+                                   &recv_buf_[recv_end_], size);
+                }
+                else
+                {
+                    (void)asio::read(socket, asio::buffer(&recv_buf_[recv_end_],
+                                                          size));
+                }
+
+                recv_end_ += size;
+            }
+
             template <class ST>
             void send_trx(ST&                           socket,
                           const gcache::GCache::Buffer& buffer)
@@ -450,6 +710,12 @@ namespace galera
                     }
                 }
 
+                if (version_ >= Trx::BATCH_VERSION)
+                {
+                    send_batched(socket, buffer, cbs, payload_size);
+                    return;
+                }
+
                 size_t const trx_meta_size(
                     8 /* serial_size(buffer.seqno_g()) */ +
                     8 /* serial_size(buffer.seqno_d()) */
@@ -479,20 +745,159 @@ namespace galera
             }
 
 
+            /*!
+             * Appends trx message to send_buf_. Payloads which don't fit
+             * into batch are written together with pending batch from
+             * their original location.
+             */
+            template <class ST>
+            void send_batched(ST&                           socket,
+                              const gcache::GCache::Buffer& buffer,
+                              boost::array<asio::const_buffer, 3>& cbs,
+                              size_t const                  payload_size)
+            {
+                Trx const trx_msg(version_, payload_size,
+                                  buffer.seqno_g(), buffer.seqno_d());
+                size_t const hdr_size(trx_msg.serial_size());
+                /* compressed stream is sent in blocks only */
+                bool   const fits(send_compressed_ ||
+                                  hdr_size + payload_size <= SEND_BATCH_SIZE);
+
+                if (fits && send_buf_.size() + hdr_size + payload_size >
+                    SEND_BATCH_SIZE)
+                {
+                    flush(socket);
+                }
+
+                size_t offset(send_buf_.size());
+                send_buf_.resize(offset + hdr_size);
+                offset = trx_msg.serialize(&send_buf_[0], send_buf_.size(),
+                                           offset);
+                assert(offset == send_buf_.size());
+
+                if (fits)
+                {
+                    for (size_t i(1); i < cbs.size(); ++i)
+                    {
+                        const gu::byte_t* const ptr(
+                            asio::buffer_cast<const gu::byte_t*>(cbs[i]));
+                        send_buf_.insert(send_buf_.end(), ptr,
+                                         ptr + asio::buffer_size(cbs[i]));
+                    }
+
+                    if (send_buf_.size() >= SEND_BATCH_SIZE) flush(socket);
+                }
+                else
+                {
+                    cbs[0] = asio::const_buffer(&send_buf_[0],
+                                                send_buf_.size());
+                    size_t const sent(asio::write(socket, cbs));
+                    log_debug << "sent " << sent << " bytes";
+                    send_buf_.clear();
+                }
+            }
+
+            /*!
+             * Returns pointer to the next n bytes received from socket.
+             * The pointer is valid until the next call.
+             */
+            template <class ST>
+            const gu::byte_t* recv_buffered(ST& socket, size_t const n)
+            {
+                size_t const avail(recv_end_ - recv_begin_);
+
+                if (avail < n)
+                {
+                    if (recv_buf_.empty()) recv_buf_.resize(RECV_BUF_SIZE);
+
+                    if (recv_begin_ > 0)
+                    {
+                        ::memmove(&recv_buf_[0], &recv_buf_[recv_begin_],
+                                  avail);
+                        recv_begin_ = 0;
+                        recv_end_   = avail;
+                    }
+
+                    if (recv_compressed_)
+                    {
+                        while (recv_end_ - recv_begin_ < n) recv_block(socket);
+                    }
+                    else
+                    {
+                        if (recv_buf_.size() < n) recv_buf_.resize(n);
+
+                        recv_end_ += asio::read(
+                            socket,
+                            asio::buffer(&recv_buf_[recv_end_],
+                                         recv_buf_.size() - recv_end_),
+                            asio::transfer_at_least(n - avail));
+                    }
+                }
+
+                const gu::byte_t* const ret(&recv_buf_[recv_begin_]);
+                recv_begin_ += n;
+                return ret;
+            }
+
+            /*! receives n bytes to buf, through read buffer if it is small */
+            template <class ST>
+            void recv_buffered(ST& socket, gu::byte_t* buf, size_t n)
+            {
+                size_t const avail(std::min(recv_end_ - recv_begin_, n));
+
+                if (avail > 0)
+                {
+                    ::memcpy(buf, &recv_buf_[recv_begin_], avail);
+                    recv_begin_ += avail;
+                    buf += avail;
+                    n   -= avail;
+                }
+
+                if (n == 0) return;
+
+                if (n < RECV_BUF_SIZE / 2 || recv_compressed_)
+                {
+                    ::memcpy(buf, recv_buffered(socket, n), n);
+                }
+                else if (asio::read(socket, asio::buffer(buf, n)) != n)
+                {
+                    gu_throw_error(EPROTO) << "error reading write set data";
+                }
+            }
+
+            /*!
+             * Receives write set directly into a GCache buffer, which becomes
+             * trx->action(). Assigning seqno to the buffer is left to the
+             * caller, as it must not happen before the cache is reset
+             * for the new history.
+             */
             template <class ST>
             galera::TrxHandle*
-            recv_trx(ST& socket)
+            recv_trx(ST& socket, gcache::GCache& gcache)
             {
+                bool const batched(version_ >= Trx::BATCH_VERSION);
                 Message    msg(version_);
-                gu::Buffer buf(msg.serial_size());
-                size_t n(asio::read(socket, asio::buffer(&buf[0], buf.size())));
+                gu::Buffer buf;
+                const gu::byte_t* hdr;
+                size_t n(msg.serial_size());
 
-                if (n != buf.size())
+                if (batched)
                 {
-                    gu_throw_error(EPROTO) << "error receiving trx header";
+                    hdr = recv_buffered(socket, n);
                 }
+                else
+                {
+                    buf.resize(n);
+                    n = asio::read(socket, asio::buffer(&buf[0], buf.size()));
 
-                (void)msg.unserialize(&buf[0], buf.size(), 0);
+                    if (n != buf.size())
+                    {
+                        gu_throw_error(EPROTO) << "error receiving trx header";
+                    }
+                    hdr = &buf[0];
+                }
+
+                (void)msg.unserialize(hdr, n, 0);
 
                 log_debug << "received header: " << n << " bytes, type "
                           << msg.type() << " len " << msg.len();
@@ -501,63 +906,96 @@ namespace galera
                 {
                 case Message::T_TRX:
                 {
-                    // TODO: ideally we want to make seqno_g and cert verdict
-                    // be a part of msg object above, so that we can skip this
-                    // read. The overhead is tiny given that vast majority of
-                    // messages will be trx writesets.
                     wsrep_seqno_t seqno_g, seqno_d;
+                    size_t        wsize;
 
-                    buf.resize(sizeof(seqno_g) + sizeof(seqno_d));
-
-                    n = asio::read(socket, asio::buffer(&buf[0], buf.size()));
-                    if (n != buf.size())
+                    if (batched)
                     {
-                        gu_throw_error(EPROTO) << "error reading trx meta data";
+                        size_t const meta_size(Trx::meta_size(version_));
+                        Trx trx_msg(version_, msg.len());
+                        (void)trx_msg.unserialize_meta(
+                            recv_buffered(socket, meta_size), meta_size, 0);
+                        seqno_g = trx_msg.seqno_g();
+                        seqno_d = trx_msg.seqno_d();
+                        wsize   = msg.len();
                     }
+                    else
+                    {
+                        buf.resize(sizeof(seqno_g) + sizeof(seqno_d));
 
-                    size_t offset(gu::unserialize8(&buf[0], buf.size(), 0,
-                                                   seqno_g));
-                    offset = gu::unserialize8(&buf[0], buf.size(), offset,
-                                              seqno_d);
+                        n = asio::read(socket, asio::buffer(&buf[0],
+                                                            buf.size()));
+                        if (n != buf.size())
+                        {
+                            gu_throw_error(EPROTO)
+                                << "error reading trx meta data";
+                        }
 
-                    galera::TrxHandle* trx(galera::TrxHandle::New(trx_pool_));
+                        size_t offset(gu::unserialize8(&buf[0], buf.size(), 0,
+                                                       seqno_g));
+                        offset = gu::unserialize8(&buf[0], buf.size(), offset,
+                                                  seqno_d);
+                        wsize  = msg.len() - offset;
+                    }
 
-                    if (seqno_d == WSREP_SEQNO_UNDEFINED)
+                    if (seqno_d == WSREP_SEQNO_UNDEFINED && wsize != 0)
                     {
-                        if (offset != msg.len())
-                        {
-                            gu_throw_error(EINVAL)
-                                << "message size " << msg.len()
-                                << " does not match expected size " << offset;
-                        }
+                        gu_throw_error(EINVAL)
+                            << "message size " << msg.len()
+                            << " does not match expected size "
+                            << msg.len() - wsize;
                     }
-                    else
+
+                    /* skipped write set comes without payload, but still
+                     * takes a (minimal) buffer to keep cached history
+                     * continuous */
+                    gu::byte_t* const wbuf(static_cast<gu::byte_t*>(
+                        gcache.malloc(std::max<size_t>(wsize, 1))));
+
+                    if (gu_unlikely(0 == wbuf))
                     {
-                        MappedBuffer& wbuf(trx->write_set_collection());
-                        size_t const wsize(msg.len() - offset);
-                        wbuf.resize(wsize);
+                        gu_throw_error(ENOMEM)
+                            << "failed to allocate " << wsize
+                            << " bytes in cache for write set " << seqno_g;
+                    }
 
-                        n = asio::read(socket,
-                                       asio::buffer(&wbuf[0], wbuf.size()));
+                    galera::TrxHandle* trx(galera::TrxHandle::New(trx_pool_));
 
-                        if (gu_unlikely(n != wbuf.size()))
+                    try
+                    {
+                        if (wsize > 0)
                         {
-                            gu_throw_error(EPROTO)
-                                << "error reading write set data";
+                            if (batched)
+                            {
+                                recv_buffered(socket, wbuf, wsize);
+                            }
+                            else if (asio::read(socket,
+                                                asio::buffer(wbuf, wsize))
+                                     != wsize)
+                            {
+                                gu_throw_error(EPROTO)
+                                    << "error reading write set data";
+                            }
+
+                            trx->unserialize(wbuf, wsize, 0);
                         }
-
-                        trx->unserialize(&wbuf[0], wbuf.size(), 0);
+                    }
+                    catch (...)
+                    {
+                        trx->unref();
+                        gcache.free(wbuf);
+                        throw;
                     }
 
                     if (seqno_d == WSREP_SEQNO_UNDEFINED ||
                         trx->version() < 3)
                     {
-                        trx->set_received(0, -1, seqno_g);
+                        trx->set_received(wbuf, -1, seqno_g);
                         trx->set_depends_seqno(seqno_d);
                     }
                     else
                     {
-                        trx->set_received_from_ws();
+                        trx->set_received_from_ws(wbuf);
                         assert(trx->global_seqno() == seqno_g);
                         assert(trx->depends_seqno() >= seqno_d);
                     }
@@ -599,6 +1037,15 @@ namespace galera
             uint64_t real_sent_;
             int      version_;
             bool     keep_keys_;
+            int      compress_;
+            bool     send_compressed_; // stream to peer is compressed
+            bool     recv_compressed_; // stream from peer is compressed
+
+            std::vector<gu::byte_t> send_buf_;   // pending batched messages
+            std::vector<gu::byte_t> block_buf_;  // compressed block
+            std::vector<gu::byte_t> recv_buf_;
+            size_t                  recv_begin_; // first unparsed byte
+            size_t                  recv_end_;   // end of received data
         };
     }
 }
@@ -1,5 +1,5 @@
 //
-// Copyright (C) 2013 Codership Oy <info@codership.com>
+// Copyright (C) 2013-2015 Codership Oy <info@codership.com>
 //
 
 #ifndef GALERA_KEY_ENTRY_NG_HPP
@@ -10,36 +10,25 @@
 namespace galera
 {
     class TrxHandle;
-
+    class CertIndexNG;
+
+    /*!
+     * Certification index entry. Entries live inline in CertIndexNG table
+     * slots and carry the key hash instead of a pointer to the key in
+     * some writeset buffer, so that index lookups never leave the table.
+     *
+     * Entry is a POD: zero-filled memory is an empty slot.
+     */
     class KeyEntryNG
     {
     public:
-        KeyEntryNG(const KeySet::KeyPart& key)
-            : refs_(), key_(key)
-        {
-            std::fill(&refs_[0],
-                      &refs_[KeySet::Key::P_LAST],
-                      reinterpret_cast<TrxHandle*>(NULL));
-        }
-
-        KeyEntryNG(const KeyEntryNG& other)
-        : refs_(), key_(other.key_)
-        {
-            std::copy(&other.refs_[0],
-                      &other.refs_[KeySet::Key::P_LAST],
-                      &refs_[0]);
-        }
 
-        const KeySet::KeyPart& key() const { return key_; }
-
-        void ref(KeySet::Key::Prefix p, const KeySet::KeyPart& k,
-                 TrxHandle* trx)
+        void ref(KeySet::Key::Prefix p, TrxHandle* trx)
         {
             assert(0 == refs_[p] ||
                    refs_[p]->global_seqno() <= trx->global_seqno());
 
             refs_[p] = trx;
-            key_ = k;
         }
 
         void unref(KeySet::Key::Prefix p, TrxHandle* trx)
@@ -74,82 +63,17 @@ namespace galera
             return refs_[p];
         }
 
-        size_t size() const
-        {
-            return sizeof(*this);
-        }
-
-        void swap(KeyEntryNG& other) throw()
-        {
-            using std::swap;
-            gu::swap_array(refs_, other.refs_);
-            swap(key_,  other.key_);
-        }
-
-        KeyEntryNG& operator=(KeyEntryNG ke)
-        {
-            swap(ke);
-            return *this;
-        }
-
-        ~KeyEntryNG()
-        {
-            assert(!referenced());
-        }
-
     private:
 
-        TrxHandle*      refs_[KeySet::Key::P_LAST + 1];
-        KeySet::KeyPart key_;
-
-#ifndef NDEBUG
-        void assert_ref(KeySet::Key::Prefix, TrxHandle*) const;
-        void assert_unref(KeySet::Key::Prefix, TrxHandle*) const;
-#endif /* NDEBUG */
-    };
-
-    inline void swap(KeyEntryNG& a, KeyEntryNG& b) { a.swap(b); }
+        friend class CertIndexNG;
 
-    class KeyEntryHashNG
-    {
-    public:
-        size_t operator()(const KeyEntryNG& ke) const
-        {
-            return ke.key().hash();
-        }
-    };
-
-    class KeyEntryPtrHashNG
-    {
-    public:
-        size_t operator()(const KeyEntryNG* const ke) const
-        {
-            return ke->key().hash();
-        }
-    };
-
-    class KeyEntryEqualNG
-    {
-    public:
-        bool operator()(const KeyEntryNG& left,
-                        const KeyEntryNG& right)
-            const
-        {
-            return left.key().matches(right.key());
-        }
-    };
-
-    class KeyEntryPtrEqualNG
-    {
-    public:
-        bool operator()(const KeyEntryNG* const left,
-                        const KeyEntryNG* const right)
-            const
-        {
-            return left->key().matches(right->key());
-        }
+        /* h0_ layout: key hash bits (header cleared) shifted left by 2,
+         * bit 1 - slot occupied, bit 0 - 16-byte hash if occupied,
+         * tombstone otherwise. */
+        uint64_t        h0_;
+        uint64_t        h1_;
+        TrxHandle*      refs_[KeySet::Key::P_LAST + 1];
     };
 }
 
-#endif // GALERA_KEY_ENTRY_HPP
-
+#endif // GALERA_KEY_ENTRY_NG_HPP
@@ -153,6 +153,35 @@ KeySet::KeyPart::print (std::ostream& os) const
     }
 }
 
+size_t
+KeySet::KeyPart::copy_to (gu::byte_t* const buf, size_t const size) const
+{
+    Version const ver(version());
+    size_t  const base(base_size(ver, data_, size));
+    size_t  const full(serial_size());
+
+    if (full <= size)
+    {
+        ::memcpy(buf, data_, full);
+        return full;
+    }
+
+    if (gu_unlikely(base > size)) throw_buffer_too_short(base, size);
+
+    ::memcpy(buf, data_, base);
+
+    if (annotated(ver))
+    {
+        /* annotated versions directly follow their plain counterparts */
+        Version const plain(static_cast<Version>(ver - 1));
+
+        buf[0] &= ~(VERSION_MASK << PREFIX_BITS);
+        buf[0] |= (plain & VERSION_MASK) << PREFIX_BITS;
+    }
+
+    return base;
+}
+
 KeySetOut::KeyPart::KeyPart (KeyParts&      added,
                              KeySetOut&     store,
                              const KeyPart* parent,
@@ -200,6 +200,25 @@ public:
             return ret; // (ret ^ (ret << HEADER_BITS)) to cover 0 bits
         }
 
+        /* for hash tables which store key hash inline: h0 is the first
+         * hash word with header bits cleared, h1 the second hash word or 0
+         * for 8-byte hash versions. Returns true if hash is 16 bytes. */
+        bool
+        hash_words (uint64_t& h0, uint64_t& h1) const
+        {
+            const uint64_t* const w(reinterpret_cast<const uint64_t*>(data_));
+            Version const ver(version());
+
+            if (gu_unlikely(EMPTY == ver)) throw_match_empty_key(ver, ver);
+
+            h0 = gtoh64(w[0]) >> HEADER_BITS;
+
+            bool const wide(FLAT16 == ver || FLAT16A == ver);
+            h1 = wide ? gtoh64(w[1]) : 0;
+
+            return wide;
+        }
+
         static size_t
         serial_size (const gu::byte_t* const buf, size_t const size)
         {
@@ -214,6 +233,11 @@ public:
         void
         print (std::ostream& os) const;
 
+        /* copies serialized key part to buf, annotation is dropped if it
+         * does not fit. Returns the number of bytes copied. */
+        size_t
+        copy_to (gu::byte_t* buf, size_t size) const;
+
         void
         swap (KeyPart& other)
         {
@@ -489,7 +513,24 @@ public:
             return end();
         }
 
-        size_t size() const { return (first_size_ + second_->size()); }
+        size_t size() const
+        {
+            return (first_size_ + (second_ ? second_->size() : 0));
+        }
+
+        /* makes room for n key parts in total in one go, so that a large
+         * batch of keys does not rehash the heap-based set on its way */
+        void rehash(size_t const n)
+        {
+            if (n <= FIRST_SIZE) return;
+
+            if (!second_) second_ = new KeyPartSet();
+
+            size_t const want(n - std::min<size_t>(n, first_size_));
+            size_t const have(second_->bucket_count());
+
+            if (want > have) second_->rehash(std::max(want, 2 * have));
+        }
 
     private:
 
@@ -621,14 +662,16 @@ public:
     KeySetOut (gu::byte_t*             reserved,
                size_t                  reserved_size,
                const BaseName&         base_name,
-               KeySet::Version const   version)
+               KeySet::Version const   version,
+               gu::Allocator::Arena*   arena = NULL)
         :
         gu::RecordSetOut<KeySet::KeyPart> (
             reserved,
             reserved_size,
             base_name,
             check_type      (version),
-            ks_to_rs_version(version)
+            ks_to_rs_version(version),
+            arena
             ),
         added_(),
         prev_ (),
@@ -645,6 +688,10 @@ public:
     size_t
     append (const KeyData& kd);
 
+    /* hint that about n more key parts are going to be appended */
+    void
+    reserve (size_t const n) { added_.rehash(added_.size() + n); }
+
     KeySet::Version
     version () { return count() ? version_ : KeySet::EMPTY; }
 
@@ -0,0 +1,151 @@
+//
+// Copyright (C) 2015 Codership Oy <info@codership.com>
+//
+
+#ifndef GALERA_NBO_HPP
+#define GALERA_NBO_HPP
+
+#include "trx_copy.hpp"
+#include "uuid.hpp"
+
+#include "gu_lock.hpp"
+
+#include <list>
+
+namespace galera
+{
+    /*!
+     * Non-blocking TOI operations being applied by slave threads.
+     *
+     * Begin event of a non-blocking TOI releases monitors before the
+     * operation is executed, end event of the same connection must not be
+     * applied before the operation completes on this node. Operations are
+     * registered in total order and found by the end event even if it
+     * reaches apply before the begin event does. The operation is executed
+     * from a copy of the begin event, so the event itself is committed and
+     * released like any other writeset.
+     */
+    class NBOMap
+    {
+    public:
+
+        NBOMap(gcache::GCache& gcache, TrxHandle::SlavePool& pool)
+            : mutex_(), cond_(), gcache_(gcache), pool_(pool), ops_()
+        { }
+
+        ~NBOMap()
+        {
+            for (OpList::iterator i(ops_.begin()); i != ops_.end(); ++i)
+            {
+                trx_copy_free(gcache_, i->ws);
+            }
+        }
+
+        /*! registers operation started by trx and returns the copy of trx
+         *  to apply. Must be called in total order (at certification), so
+         *  that the operation is known before any following event can
+         *  wait() for it. Calling it again for the same trx returns the
+         *  same copy. */
+        TrxHandle* begin(const TrxHandle& trx)
+        {
+            gu::Lock lock(mutex_);
+
+            for (OpList::iterator i(ops_.begin()); i != ops_.end(); ++i)
+            {
+                if (i->seqno == trx.global_seqno()) return i->ws;
+            }
+
+            TrxHandle* const copy(trx_copy(gcache_, pool_, trx));
+
+            Op const op = { trx.source_id(), trx.conn_id(),
+                            trx.global_seqno(), copy };
+            ops_.push_back(op);
+
+            return copy;
+        }
+
+        /*! operation started by trx has been applied */
+        void end(const TrxHandle& trx)
+        {
+            TrxHandle* ws(0);
+            {
+                gu::Lock lock(mutex_);
+
+                OpList::iterator i(ops_.begin());
+                while (i != ops_.end() && i->seqno != trx.global_seqno()) ++i;
+                assert(i != ops_.end());
+
+                if (i != ops_.end())
+                {
+                    ws = i->ws;
+                    ops_.erase(i);
+                    cond_.broadcast();
+                }
+            }
+
+            if (ws) trx_copy_free(gcache_, ws);
+        }
+
+        /*! waits until the operation ended by trx is applied, returns
+         *  immediately if it is not being applied (e.g. it was executed
+         *  before the node joined the cluster) */
+        void wait(const TrxHandle& trx)
+        {
+            gu::Lock lock(mutex_);
+
+            OpList::iterator i;
+            while ((i = find(trx)) != ops_.end())
+            {
+                log_info << "Waiting for non-blocking TOI " << i->seqno
+                         << " to complete before applying "
+                         << trx.global_seqno();
+                lock.wait(cond_);
+            }
+        }
+
+        size_t size() const
+        {
+            gu::Lock lock(mutex_);
+            return ops_.size();
+        }
+
+    private:
+
+        struct Op
+        {
+            wsrep_uuid_t    source_id;
+            wsrep_conn_id_t conn_id;
+            wsrep_seqno_t   seqno;
+            TrxHandle*      ws;      // copy of the begin event
+        };
+
+        typedef std::list<Op> OpList;
+
+        /* operation of the same connection ordered before trx, later
+         * operations may be registered already */
+        OpList::iterator find(const TrxHandle& trx)
+        {
+            OpList::iterator i(ops_.begin());
+
+            for (; i != ops_.end(); ++i)
+            {
+                if (i->source_id == trx.source_id() &&
+                    i->conn_id   == trx.conn_id()   &&
+                    i->seqno     <  trx.global_seqno()) break;
+            }
+
+            return i;
+        }
+
+        NBOMap(const NBOMap&);
+        NBOMap& operator=(const NBOMap&);
+
+        gu::Mutex             mutex_;
+        gu::Cond              cond_;
+        gcache::GCache&       gcache_;
+        TrxHandle::SlavePool& pool_;
+        OpList                ops_;
+    };
+}
+
+#endif // GALERA_NBO_HPP
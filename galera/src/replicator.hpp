@@ -84,6 +84,12 @@ namespace galera
                                                   const struct wsrep_buf* data,
                                                   size_t                  count,
                                                   bool                copy) = 0;
+        virtual wsrep_status_t preordered_append_key(
+            wsrep_po_handle_t& handle,
+            const wsrep_key_t* keys,
+            size_t             count,
+            wsrep_key_type_t   type,
+            bool               copy) = 0;
         virtual wsrep_status_t preordered_commit(wsrep_po_handle_t&  handle,
                                                  const wsrep_uuid_t& source,
                                                  uint64_t            flags,
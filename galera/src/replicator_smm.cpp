@@ -10,18 +10,22 @@
 #include "galera_info.hpp"
 
 #include <gu_debug_sync.hpp>
+#include <gu_thread.hpp>
 #include <gu_abort.h>
 
 #include <sstream>
 #include <iostream>
 
 
+/* fragments of streamed trx, if any, are applied in the same transaction
+ * before the final writeset */
 static void
-apply_trx_ws(void*                    recv_ctx,
-             wsrep_apply_cb_t         apply_cb,
-             wsrep_commit_cb_t        commit_cb,
-             const galera::TrxHandle& trx,
-             const wsrep_trx_meta_t&  meta)
+apply_trx_ws(void*                               recv_ctx,
+             wsrep_apply_cb_t                    apply_cb,
+             wsrep_commit_cb_t                   commit_cb,
+             const galera::TrxHandle&            trx,
+             const wsrep_trx_meta_t&             meta,
+             const galera::StreamMap::Fragments& fragments)
 {
     using galera::TrxHandle;
     static const size_t max_apply_attempts(4);
@@ -36,6 +40,11 @@ apply_trx_ws(void*                    recv_ctx,
                 log_debug << "Executing TO isolated action: " << trx;
             }
 
+            for (size_t i(0); i < fragments.size(); ++i)
+            {
+                gu_trace(fragments[i]->apply(recv_ctx, apply_cb, meta));
+            }
+
             gu_trace(trx.apply(recv_ctx, apply_cb, meta));
 
             if (trx.is_toi())
@@ -183,9 +192,9 @@ galera::ReplicatorSMM::ReplicatorSMM(const struct wsrep_init_args* args)
     slave_pool_         (sizeof(TrxHandle), 1024, "SlaveTrxHandle"),
     as_                 (0),
     gcs_as_             (slave_pool_, gcs_, *this, gcache_),
-    ist_receiver_       (config_, slave_pool_, args->node_address),
+    ist_receiver_       (config_, gcache_, slave_pool_, args->node_address),
     ist_prepared_       (false),
-    ist_senders_        (gcs_, gcache_),
+    ist_senders_        (gcache_),
     wsdb_               (),
     cert_               (config_, service_thd_, gcache_),
 #ifdef HAVE_PSI_INTERFACE
@@ -201,6 +210,12 @@ galera::ReplicatorSMM::ReplicatorSMM(const struct wsrep_init_args* args)
     commit_monitor_     (),
 #endif /* HAVE_PSI_INTERFACE */
     causal_read_timeout_(config_.get(Param::causal_read_timeout)),
+    nbo_map_            (gcache_, slave_pool_),
+    toi_nonblocking_    (config_.get<bool>(Param::toi_nonblocking)),
+    prim_members_       (),
+    stream_map_         (gcache_, slave_pool_),
+    fragment_size_      (config_.get<long>(Param::fragment_size)),
+    fragment_rows_      (fragment_unit_rows(config_.get(Param::fragment_unit))),
     receivers_          (),
     replicated_         (),
     replicated_bytes_   (),
@@ -267,6 +282,8 @@ galera::ReplicatorSMM::ReplicatorSMM(const struct wsrep_init_args* args)
 
     local_monitor_.set_initial_position(0);
 
+    service_thd_.set_affinity(gu::thread_affinity(config_, "service"));
+
     wsrep_uuid_t  uuid;
     wsrep_seqno_t seqno;
 
@@ -301,6 +318,8 @@ galera::ReplicatorSMM::ReplicatorSMM(const struct wsrep_init_args* args)
         commit_monitor_.set_initial_position(seqno);
     cert_.assign_initial_position(seqno, trx_proto_ver());
 
+    TrxTrace::enable(config_.get<bool>(Param::trx_trace));
+
     build_stats_vars(wsrep_stats_);
 }
 
@@ -394,6 +413,55 @@ wsrep_status_t galera::ReplicatorSMM::close()
 }
 
 
+namespace
+{
+/* applier threads belong to application, so their original placement
+ * is restored when they leave the provider */
+class ThreadAffinityScope
+{
+public:
+
+    explicit ThreadAffinityScope(const gu::ThreadAffinity& affinity)
+        :
+        orig_()
+    {
+        if (affinity.any()) return;
+
+        try
+        {
+            orig_ = gu::thread_get_affinity(pthread_self());
+            gu::thread_set_affinity(pthread_self(), affinity);
+        }
+        catch (gu::Exception& e)
+        {
+            log_warn << "Failed to set applier thread CPU affinity to "
+                     << affinity << ": " << e.what();
+            orig_ = gu::ThreadAffinity();
+        }
+    }
+
+    ~ThreadAffinityScope()
+    {
+        try
+        {
+            gu::thread_set_affinity(pthread_self(), orig_);
+        }
+        catch (gu::Exception& e)
+        {
+            log_warn << "Failed to restore applier thread CPU affinity: "
+                     << e.what();
+        }
+    }
+
+private:
+
+    ThreadAffinityScope(const ThreadAffinityScope&);
+    ThreadAffinityScope& operator=(const ThreadAffinityScope&);
+
+    gu::ThreadAffinity orig_;
+};
+}
+
 wsrep_status_t galera::ReplicatorSMM::async_recv(void* recv_ctx)
 {
     assert(recv_ctx != 0);
@@ -404,6 +472,9 @@ wsrep_status_t galera::ReplicatorSMM::async_recv(void* recv_ctx)
         return WSREP_FATAL;
     }
 
+    ThreadAffinityScope const affinity(gu::thread_affinity(config_,
+                                                            "applier"));
+
     ++receivers_;
     as_ = &gcs_as_;
 
@@ -483,28 +554,92 @@ void galera::ReplicatorSMM::apply_trx(void* recv_ctx, TrxHandle* trx)
     assert(trx->global_seqno() > STATE_SEQNO());
     assert(trx->is_local() == false);
 
+    if (gu_unlikely(trx->fragment() || stream_rolled_back(*trx)))
+    {
+        trx->set_state(TrxHandle::S_APPLYING);
+        apply_stream_event(trx);
+        trx->set_state(TrxHandle::S_COMMITTING);
+        trx->set_state(TrxHandle::S_COMMITTED);
+        return;
+    }
+
+    StreamMap::Fragments fragments;
+
+    if (gu_unlikely(trx->streamed()) && !stream_map_.find(*trx, fragments))
+    {
+        /* Fragments preceded the state this node received by state
+         * transfer. The trx was committed by the rest of the cluster, it
+         * can't be skipped: callers mark the state corrupt and abort, so
+         * that full state transfer is done on restart. */
+        gu_throw_fatal << "Fragments of streamed trx " << *trx
+                       << " are missing, can't apply it. Full state transfer "
+                       << "is required.";
+    }
+
     ApplyOrder ao(*trx);
     CommitOrder co(*trx, co_mode_);
 
+    /* end of non-blocking TOI must not be applied before the operation */
+    if (gu_unlikely(trx->nbo_end())) nbo_map_.wait(*trx);
+
     gu_trace(apply_monitor_.enter(ao));
+    trx->trace_point(TrxTrace::P_APPLY_MONITOR);
     trx->set_state(TrxHandle::S_APPLYING);
 
     wsrep_trx_meta_t meta = {{state_uuid_, trx->global_seqno() },
                              trx->depends_seqno()};
 
-    gu_trace(apply_trx_ws(recv_ctx, apply_cb_, commit_cb_, *trx, meta));
+    bool const nbo_begin(trx->nbo_begin());
+    TrxHandle* ws(trx); // writeset to apply
+
+    if (gu_unlikely(nbo_begin))
+    {
+        /* Non-blocking TOI: only the start of the operation is ordered.
+         * The begin event passes monitors and is reported committed before
+         * the operation is executed, so that following writesets keep being
+         * applied and purged. Certification keeps the operation keys locked
+         * until its end event. The operation is executed from a copy of the
+         * writeset, which is kept until it completes. The operation was
+         * registered at certification, except when received by IST. */
+        ws = nbo_map_.begin(*trx);
+
+        if (co_mode_ != CommitOrder::BYPASS)
+        {
+            gu_trace(commit_monitor_.enter(co));
+            trx->trace_point(TrxTrace::P_COMMIT_MONITOR);
+            commit_monitor_.leave(co);
+        }
+
+        trx->unordered(recv_ctx, unordered_cb_);
+
+        if (trx->local_seqno() != -1)
+        {
+            report_last_committed(cert_.set_trx_committed(trx));
+        }
+
+        apply_monitor_.leave(ao);
+    }
+
+    gu_trace(apply_trx_ws(recv_ctx, apply_cb_, commit_cb_, *ws, meta,
+                          fragments));
     /* at this point any exception in apply_trx_ws() is fatal, not
      * catching anything. */
 
     TrxHandle* commit_trx_handle = trx;
-    if (gu_likely(co_mode_ != CommitOrder::BYPASS) && trx->is_toi())
+    if (gu_likely(co_mode_ != CommitOrder::BYPASS) && trx->is_toi() &&
+        !nbo_begin)
     {
         /* TOI action are fully serialized so it is make sense to
         enforce commit ordering at this stage. For non-TOI action
         commit ordering is delayed to take advantage of full parallelism. */
         gu_trace(commit_monitor_.enter(co));
+        trx->trace_point(TrxTrace::P_COMMIT_MONITOR);
         commit_trx_handle = NULL;
     }
+    else if (gu_unlikely(nbo_begin))
+    {
+        commit_trx_handle = NULL; // commit order was passed at the start
+    }
     trx->set_state(TrxHandle::S_COMMITTING);
 
     wsrep_bool_t exit_loop(false);
@@ -520,18 +655,28 @@ void galera::ReplicatorSMM::apply_trx(void* recv_ctx, TrxHandle* trx)
     if (gu_unlikely (rcode != WSREP_CB_SUCCESS))
         gu_throw_fatal << "Commit failed. Trx: " << trx;
 
-    if (gu_likely(co_mode_ != CommitOrder::BYPASS) && trx->is_toi())
+    if (gu_likely(co_mode_ != CommitOrder::BYPASS) && trx->is_toi() &&
+        !nbo_begin)
     {
         gu_trace(commit_monitor_.leave(co));
     }
     trx->set_state(TrxHandle::S_COMMITTED);
 
+    if (gu_unlikely(nbo_begin))
+    {
+        nbo_map_.end(*trx);
+        trx->set_exit_loop(exit_loop);
+        return;
+    }
+
     if (trx->local_seqno() != -1)
     {
         // trx with local seqno -1 originates from IST (or other source not gcs)
         report_last_committed(cert_.set_trx_committed(trx));
     }
 
+    if (gu_unlikely(trx->streamed())) stream_map_.erase(*trx);
+
     /* For now need to keep it inside apply monitor to ensure all processing
      * ends by the time monitors are drained because of potential gcache
      * cleanup (and loss of the writeset buffer). Perhaps unordered monitor
@@ -544,11 +689,48 @@ void galera::ReplicatorSMM::apply_trx(void* recv_ctx, TrxHandle* trx)
 }
 
 
+void galera::ReplicatorSMM::apply_stream_event(TrxHandle* trx)
+{
+    assert(trx->fragment() || stream_rolled_back(*trx));
+
+    ApplyOrder  ao(*trx);
+    CommitOrder co(*trx, co_mode_);
+
+    if (trx->fragment())
+    {
+        /* nothing to wait for, the final writeset of the transaction depends
+         * on the last fragment and so finds all fragments stored */
+        stream_map_.append(*trx);
+        apply_monitor_.self_cancel(ao);
+    }
+    else
+    {
+        /* rollback event depends on the last fragment too */
+        gu_trace(apply_monitor_.enter(ao));
+        trx->trace_point(TrxTrace::P_APPLY_MONITOR);
+        stream_map_.erase(*trx);
+        apply_monitor_.leave(ao);
+    }
+
+    if (co_mode_ != CommitOrder::BYPASS) commit_monitor_.self_cancel(co);
+
+    if (trx->local_seqno() != -1)
+    {
+        report_last_committed(cert_.set_trx_committed(trx));
+    }
+}
+
+
 wsrep_status_t galera::ReplicatorSMM::replicate(TrxHandle* trx,
                                                 wsrep_trx_meta_t* meta)
 {
     if (state_() < S_JOINED) return WSREP_TRX_FAIL;
 
+    /* stream can't be continued after the cluster fell back to a protocol
+     * without streaming: older nodes would take it for a whole trx */
+    if (gu_unlikely(trx->streamed()) &&
+        protocol_version_ < STREAMING_PROTO_VER) return WSREP_TRX_FAIL;
+
     assert(trx->state() == TrxHandle::S_EXECUTING ||
            trx->state() == TrxHandle::S_MUST_ABORT);
     assert(trx->local_seqno() == WSREP_SEQNO_UNDEFINED &&
@@ -728,6 +910,15 @@ galera::ReplicatorSMM::abort_trx(TrxHandle* trx)
     case TrxHandle::S_MUST_ABORT:
     case TrxHandle::S_ABORTING: // guess this is here because we can have a race
         return;
+    case TrxHandle::S_MUST_REPLAY_AM:
+    case TrxHandle::S_COMMITTED:
+    case TrxHandle::S_ROLLED_BACK:
+        if (trx->fragment() || stream_rolled_back(*trx))
+        {
+            // stream event is done with, the rest of trx is in a new handle
+            return;
+        }
+        gu_throw_fatal << "invalid state " << trx->state();
     case TrxHandle::S_EXECUTING:
         trx->set_state(TrxHandle::S_MUST_ABORT);
         break;
@@ -843,6 +1034,7 @@ wsrep_status_t galera::ReplicatorSMM::pre_commit(TrxHandle*        trx,
     try
     {
         gu_trace(apply_monitor_.enter(ao));
+        trx->trace_point(TrxTrace::P_APPLY_MONITOR);
     }
     catch (gu::Exception& e)
     {
@@ -865,6 +1057,7 @@ wsrep_status_t galera::ReplicatorSMM::pre_commit(TrxHandle*        trx,
             try
             {
                 gu_trace(commit_monitor_.enter(co));
+                trx->trace_point(TrxTrace::P_COMMIT_MONITOR);
             }
             catch (gu::Exception& e)
             {
@@ -929,6 +1122,7 @@ wsrep_status_t galera::ReplicatorSMM::replay_trx(TrxHandle* trx, void* trx_ctx)
         trx->set_depends_seqno(trx->global_seqno() - 1);
         ApplyOrder ao(*trx);
         gu_trace(apply_monitor_.enter(ao));
+        trx->trace_point(TrxTrace::P_APPLY_MONITOR);
         trx->set_state(TrxHandle::S_MUST_REPLAY_CM);
         // fall through
     }
@@ -937,6 +1131,7 @@ wsrep_status_t galera::ReplicatorSMM::replay_trx(TrxHandle* trx, void* trx_ctx)
         {
             CommitOrder co(*trx, co_mode_);
             gu_trace(commit_monitor_.enter(co));
+            trx->trace_point(TrxTrace::P_COMMIT_MONITOR);
         }
         trx->set_state(TrxHandle::S_MUST_REPLAY);
         // fall through
@@ -949,7 +1144,16 @@ wsrep_status_t galera::ReplicatorSMM::replay_trx(TrxHandle* trx, void* trx_ctx)
             wsrep_trx_meta_t meta = {{state_uuid_, trx->global_seqno() },
                                      trx->depends_seqno()};
 
-            gu_trace(apply_trx_ws(trx_ctx, apply_cb_, commit_cb_, *trx, meta));
+            StreamMap::Fragments fragments;
+
+            if (trx->streamed() && !stream_map_.find(*trx, fragments))
+            {
+                gu_throw_fatal << "Fragments of streamed trx " << *trx
+                               << " are missing, can't replay it";
+            }
+
+            gu_trace(apply_trx_ws(trx_ctx, apply_cb_, commit_cb_, *trx, meta,
+                                  fragments));
 
             wsrep_bool_t unused(false);
             wsrep_cb_status_t rcode(
@@ -1045,6 +1249,8 @@ wsrep_status_t galera::ReplicatorSMM::post_commit(TrxHandle* trx)
     }
     trx->mark_interim_committed(false);
 
+    if (gu_unlikely(trx->streamed())) stream_map_.erase(*trx);
+
     ApplyOrder ao(*trx);
     report_last_committed(cert_.set_trx_committed(trx));
     apply_monitor_.leave(ao);
@@ -1078,6 +1284,77 @@ wsrep_status_t galera::ReplicatorSMM::post_rollback(TrxHandle* trx)
 }
 
 
+/* Fragments and rollback events of streamed trx change certification state
+ * on all nodes once ordered, so here they are certified even if trx was BF
+ * aborted meanwhile - there is nothing to replay. Certified event leaves
+ * trx in S_COMMITTED state, or in S_MUST_REPLAY_AM if it was aborted, any
+ * other outcome in S_ROLLED_BACK. */
+wsrep_status_t galera::ReplicatorSMM::replicate_stream_event(TrxHandle* trx)
+{
+    wsrep_status_t retval(replicate(trx, 0));
+
+    if (WSREP_OK == retval) retval = cert_and_catch(trx);
+
+    while (WSREP_BF_ABORT == retval &&
+           TrxHandle::S_MUST_CERT_AND_REPLAY == trx->state())
+    {
+        retval = cert_and_catch(trx);
+    }
+
+    switch (retval)
+    {
+    case WSREP_OK:
+        trx->set_state(TrxHandle::S_APPLYING);
+        apply_stream_event(trx);
+        trx->set_state(TrxHandle::S_COMMITTING);
+        trx->set_state(TrxHandle::S_COMMITTED);
+        break;
+    case WSREP_BF_ABORT:
+        assert(TrxHandle::S_MUST_REPLAY_AM == trx->state());
+        apply_stream_event(trx);
+        retval = WSREP_TRX_FAIL;
+        break;
+    default:
+        if (trx->state() == TrxHandle::S_MUST_ABORT)
+        {
+            trx->set_state(TrxHandle::S_ABORTING);
+        }
+        trx->set_state(TrxHandle::S_ROLLED_BACK);
+        retval = WSREP_TRX_FAIL;
+    }
+
+    return retval;
+}
+
+
+wsrep_status_t galera::ReplicatorSMM::stream_fragment(TrxHandle* trx)
+{
+    assert(trx->new_version());
+    assert(trx->trx_id() != wsrep_trx_id_t(-1));
+
+    trx->set_flags(trx->flags() | TrxHandle::F_FRAGMENT);
+
+    wsrep_status_t const retval(replicate_stream_event(trx));
+
+    log_debug << "Replicated fragment " << trx->global_seqno() << " of trx "
+              << trx->trx_id() << ": " << retval;
+
+    return retval;
+}
+
+
+wsrep_status_t galera::ReplicatorSMM::stream_rollback(TrxHandle* trx)
+{
+    assert(trx->new_version());
+    assert(trx->state() == TrxHandle::S_EXECUTING);
+
+    // no keys: rollback event must not conflict with anything
+    trx->set_flags(TrxHandle::F_ROLLBACK | TrxHandle::F_STREAMED);
+
+    return replicate_stream_event(trx);
+}
+
+
 wsrep_status_t galera::ReplicatorSMM::causal_read(wsrep_gtid_t* gtid)
 {
     wsrep_seqno_t cseq(static_cast<wsrep_seqno_t>(gcs_.caused()));
@@ -1148,11 +1425,13 @@ wsrep_status_t galera::ReplicatorSMM::to_isolation_begin(TrxHandle*        trx,
         CommitOrder co(*trx, co_mode_);
 
         gu_trace(apply_monitor_.enter(ao));
+        trx->trace_point(TrxTrace::P_APPLY_MONITOR);
 
         if (co_mode_ != CommitOrder::BYPASS)
             try
             {
                 commit_monitor_.enter(co);
+                trx->trace_point(TrxTrace::P_COMMIT_MONITOR);
             }
             catch (...)
             {
@@ -1162,6 +1441,15 @@ wsrep_status_t galera::ReplicatorSMM::to_isolation_begin(TrxHandle*        trx,
         trx->set_state(TrxHandle::S_APPLYING);
         log_debug << "Executing TO isolated action: " << *trx;
         st_.mark_unsafe();
+
+        if (trx->nbo_begin())
+        {
+            /* non-blocking TOI: only the start of the operation is ordered,
+             * the end will be ordered by a separate event */
+            if (co_mode_ != CommitOrder::BYPASS) commit_monitor_.leave(co);
+            report_last_committed(cert_.set_trx_committed(trx));
+            apply_monitor_.leave(ao);
+        }
         break;
     }
     case WSREP_TRX_FAIL:
@@ -1187,11 +1475,14 @@ wsrep_status_t galera::ReplicatorSMM::to_isolation_end(TrxHandle* trx)
 
     log_debug << "Done executing TO isolated action: " << *trx;
 
-    CommitOrder co(*trx, co_mode_);
-    if (co_mode_ != CommitOrder::BYPASS) commit_monitor_.leave(co);
-    ApplyOrder ao(*trx);
-    report_last_committed(cert_.set_trx_committed(trx));
-    apply_monitor_.leave(ao);
+    if (!trx->nbo_begin()) // monitors released in to_isolation_begin()
+    {
+        CommitOrder co(*trx, co_mode_);
+        if (co_mode_ != CommitOrder::BYPASS) commit_monitor_.leave(co);
+        ApplyOrder ao(*trx);
+        report_last_committed(cert_.set_trx_committed(trx));
+        apply_monitor_.leave(ao);
+    }
 
     st_.mark_safe();
 
@@ -1214,7 +1505,8 @@ writeset_from_handle (wsrep_po_handle_t& handle,
             ret = new WriteSetOut(
 //                gu::String<256>(trx_params.working_dir_) << '/' << &handle,
                 trx_params.working_dir_, wsrep_trx_id_t(&handle),
-                /* key format is not essential since we're not adding keys */
+                /* keys are optional here, but when added they are certified
+                 * like those of a regular writeset */
                 KeySet::version(trx_params.key_format_), NULL, 0,
                 0, WriteSetNG::MAX_VERSION, DataSet::MAX_VERSION, DataSet::MAX_VERSION,
                 trx_params.max_write_set_size_);
@@ -1252,6 +1544,24 @@ galera::ReplicatorSMM::preordered_collect(wsrep_po_handle_t&            handle,
 }
 
 
+wsrep_status_t
+galera::ReplicatorSMM::preordered_append_key(wsrep_po_handle_t&       handle,
+                                             const wsrep_key_t* const keys,
+                                             size_t             const count,
+                                             wsrep_key_type_t   const type,
+                                             bool               const copy)
+{
+    if (gu_unlikely(trx_params_.version_ < WS_NG_VERSION))
+        return WSREP_NOT_IMPLEMENTED;
+
+    WriteSetOut* const ws(writeset_from_handle(handle, trx_params_));
+
+    ws->append_keys(trx_params_.version_, keys, count, type, copy);
+
+    return WSREP_OK;
+}
+
+
 wsrep_status_t
 galera::ReplicatorSMM::preordered_commit(wsrep_po_handle_t&            handle,
                                          const wsrep_uuid_t&           source,
@@ -1436,6 +1746,17 @@ void galera::ReplicatorSMM::establish_protocol_versions (int proto_ver)
         trx_params_.version_ = 3;
         str_proto_ver_ = 2;
         break;
+    case 8:
+        // Batched IST trx message framing, no effect to TRX or STR protocols.
+        trx_params_.version_ = 3;
+        str_proto_ver_ = 2;
+        break;
+    case 9:
+        // Non-blocking TOI and streaming writeset flags, which older
+        // versions ignore, certification of preordered writesets by keys.
+        trx_params_.version_ = 3;
+        str_proto_ver_ = 2;
+        break;
     default:
         log_fatal << "Configuration change resulted in an unsupported protocol "
             "version: " << proto_ver << ". Can't continue.";
@@ -1447,6 +1768,43 @@ void galera::ReplicatorSMM::establish_protocol_versions (int proto_ver)
               << trx_params_.version_ << ", " << str_proto_ver_ << ")";
 }
 
+void
+galera::ReplicatorSMM::update_cert_locks(const wsrep_view_info_t& view,
+                                         bool const               st_required)
+{
+    /* Locks are kept only if every member continues from the previous
+     * primary view: a new member (or one which was in non-primary) can't
+     * have them, so all nodes drop them. Otherwise only the locks of members
+     * which left are dropped, their ordering events won't come. */
+    bool keep(!st_required && protocol_version_ >= NBO_PROTO_VER &&
+              protocol_version_ >= STREAMING_PROTO_VER);
+
+    for (int i(0); keep && i < view.memb_num; ++i)
+    {
+        keep = false;
+
+        for (size_t j(0); !keep && j < prim_members_.size(); ++j)
+        {
+            keep = (prim_members_[j] == view.members[i].id);
+        }
+    }
+
+    cert_.drop_locks(keep ? &view : 0);
+
+    // streams are dropped together with their certification locks
+    if (keep)
+        stream_map_.retain(view);
+    else
+        stream_map_.clear();
+
+    prim_members_.clear();
+
+    for (int i(0); i < view.memb_num; ++i)
+    {
+        prim_members_.push_back(view.members[i].id);
+    }
+}
+
 static bool
 app_wants_state_transfer (const void* const req, ssize_t const req_len)
 {
@@ -1574,6 +1932,9 @@ galera::ReplicatorSMM::process_conf_change(void*                    recv_ctx,
         // cert index yet (see #197).
         // Also this must be done before releasing GCache buffers.
         cert_.assign_initial_position(group_seqno, trx_params_.version_);
+        cert_.set_preordered_keys(protocol_version_ >=
+                                  PREORDERED_KEYS_PROTO_VER);
+        update_cert_locks(view_info, st_required);
 
         if (STATE_SEQNO() > 0) service_thd_.release_seqno(STATE_SEQNO());
         // make sure all gcache buffers are released
@@ -1678,6 +2039,8 @@ galera::ReplicatorSMM::process_conf_change(void*                    recv_ctx,
     else
     {
         // Non-primary configuration
+        prim_members_.clear();
+
         if (state_uuid_ != WSREP_UUID_UNDEFINED)
         {
             st_.set (state_uuid_, STATE_SEQNO(), safe_to_bootstrap_);
@@ -1871,6 +2234,7 @@ wsrep_status_t galera::ReplicatorSMM::cert(TrxHandle* trx)
     try
     {
         gu_trace(local_monitor_.enter(lo));
+        trx->trace_point(TrxTrace::P_LOCAL_MONITOR);
     }
     catch (gu::Exception& e)
     {
@@ -1891,6 +2255,13 @@ wsrep_status_t galera::ReplicatorSMM::cert(TrxHandle* trx)
                 if (trx->state() == TrxHandle::S_CERTIFYING)
                 {
                     retval = WSREP_OK;
+
+                    if (gu_unlikely(trx->nbo_begin()) && !trx->is_local())
+                    {
+                        // end event applied by another slave thread must
+                        // find the operation, register it in total order
+                        nbo_map_.begin(*trx);
+                    }
                 }
                 else
                 {
@@ -1909,7 +2280,11 @@ wsrep_status_t galera::ReplicatorSMM::cert(TrxHandle* trx)
             }
             break;
         case Certification::TEST_FAILED:
-            if (gu_unlikely(trx->is_toi() && applicable)) // small sanity check
+            // small sanity check, TOI may fail only on keys locked by
+            // non-blocking TOI or streamed trx in progress
+            if (gu_unlikely(trx->is_toi() && applicable &&
+                            !cert_.nbo_locked(trx) &&
+                            !cert_.stream_locked(trx)))
             {
                 // In some rare scenarios (e.g., when we have multiple
                 // transactions awaiting certification, and the last
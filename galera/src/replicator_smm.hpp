@@ -18,6 +18,8 @@
 #include "monitor.hpp"
 #include "wsdb.hpp"
 #include "certification.hpp"
+#include "nbo.hpp"
+#include "stream_map.hpp"
 #include "trx_handle.hpp"
 #include "write_set.hpp"
 #include "galera_service_thd.hpp"
@@ -30,6 +32,7 @@
 
 
 #include <map>
+#include <vector>
 
 namespace galera
 {
@@ -53,6 +56,12 @@ namespace galera
         ~ReplicatorSMM();
 
         int trx_proto_ver() const { return trx_params_.version_; }
+
+        /*! TOI actions replicate separate begin and end events */
+        bool toi_nonblocking() const
+        {
+            return (toi_nonblocking_ && protocol_version_ >= NBO_PROTO_VER);
+        }
         int repl_proto_ver() const{ return protocol_version_; }
 
         wsrep_status_t connect(const std::string& cluster_name,
@@ -105,6 +114,27 @@ namespace galera
         wsrep_status_t post_commit(TrxHandle* trx);
         wsrep_status_t post_rollback(TrxHandle* trx);
 
+        /*! true if trx has collected enough to be replicated as a fragment */
+        bool fragment_due(TrxHandle* trx) const
+        {
+            if (gu_likely(0 == fragment_size_) || !trx->new_version() ||
+                trx->trx_id() == wsrep_trx_id_t(-1) ||
+                protocol_version_ < STREAMING_PROTO_VER) return false;
+
+            const WriteSetOut& ws(trx->write_set_out());
+
+            return ((fragment_rows_ ? ws.appended_keys() :
+                     long(ws.payload_size())) >= fragment_size_);
+        }
+
+        /*! replicates and certifies collected part of trx as a fragment,
+         *  the rest of the transaction must be collected in a new handle */
+        wsrep_status_t stream_fragment(TrxHandle* trx);
+
+        /*! replicates rollback event for streamed trx, which releases
+         *  its fragments and their keys on all nodes */
+        wsrep_status_t stream_rollback(TrxHandle* trx);
+
         wsrep_status_t applier_pre_commit(void* trx_handle)
         {
             TrxHandle* trx = reinterpret_cast<TrxHandle*>(trx_handle);
@@ -141,6 +171,11 @@ namespace galera
                                           const struct wsrep_buf* data,
                                           size_t                  count,
                                           bool                    copy);
+        wsrep_status_t preordered_append_key(wsrep_po_handle_t& handle,
+                                             const wsrep_key_t* keys,
+                                             size_t             count,
+                                             wsrep_key_type_t   type,
+                                             bool               copy);
         wsrep_status_t preordered_commit(wsrep_po_handle_t&      handle,
                                          const wsrep_uuid_t&     source,
                                          uint64_t                flags,
@@ -207,6 +242,11 @@ namespace galera
             static const std::string commit_order;
             static const std::string causal_read_timeout;
             static const std::string max_write_set_size;
+            static const std::string trx_trace;
+            static const std::string trx_trace_dump;
+            static const std::string toi_nonblocking;
+            static const std::string fragment_size;
+            static const std::string fragment_unit;
         };
 
         typedef std::pair<std::string, std::string> Default;
@@ -220,6 +260,9 @@ namespace galera
         static const Defaults defaults;
         // both a list of parameters and a list of default values
 
+        /*! true if fragment size is given in rows rather than bytes */
+        static bool fragment_unit_rows(const std::string& unit);
+
         wsrep_seqno_t last_committed()
         {
             return co_mode_ != CommitOrder::BYPASS ?
@@ -238,6 +281,16 @@ namespace galera
         wsrep_status_t cert_and_catch(TrxHandle* trx);
         wsrep_status_t cert_for_aborted(TrxHandle* trx);
 
+        /*! rollback event of streamed trx */
+        static bool stream_rolled_back(const TrxHandle& trx)
+        {
+            return (trx.streamed() && (trx.flags() & TrxHandle::F_ROLLBACK));
+        }
+
+        /*! stores certified fragment or releases rolled back stream */
+        void apply_stream_event(TrxHandle* trx);
+        wsrep_status_t replicate_stream_event(TrxHandle* trx);
+
         void update_state_uuid (const wsrep_uuid_t& u,
                                 const wsrep_seqno_t seqno);
         void update_incoming_list (const wsrep_view_info_t& v);
@@ -502,6 +555,11 @@ namespace galera
 
         void establish_protocol_versions (int version);
 
+        /*! keeps or drops certification locks of ordering events in
+         *  progress on primary configuration change */
+        void update_cert_locks(const wsrep_view_info_t& view,
+                               bool                     st_required);
+
         bool state_transfer_required(const wsrep_view_info_t& view_info);
 
         void prepare_for_IST (void*& req, ssize_t& req_len,
@@ -555,6 +613,12 @@ namespace galera
         } init_ssl_; // initialize global SSL parameters
 
         static int const       MAX_PROTO_VER;
+        // writesets may carry F_NBO_BEGIN/F_NBO_END flags
+        static int const       NBO_PROTO_VER;
+        // writesets may carry F_FRAGMENT/F_STREAMED flags
+        static int const       STREAMING_PROTO_VER;
+        // keys of preordered writesets are certified
+        static int const       PREORDERED_KEYS_PROTO_VER;
         /*
          * |------------------------------------------------------
          * | protocol_version_ |  trx  version  | str_proto_ver_ |
@@ -566,6 +630,8 @@ namespace galera
          * |                 5 |              3 |              1 |
          * |                 6 |              3 |              2 |
          * |                 7 |              3 |              2 |
+         * |                 8 |              3 |              2 |
+         * |                 9 |              3 |              2 |
          * -------------------------------------------------------
          */
 
@@ -642,6 +708,14 @@ namespace galera
         Monitor<ApplyOrder>  apply_monitor_;
         Monitor<CommitOrder> commit_monitor_;
         gu::datetime::Period causal_read_timeout_;
+        NBOMap               nbo_map_; // non-blocking TOIs being applied
+        bool                 toi_nonblocking_;
+        // members of the last primary view this node was in, empty if it
+        // has been in non-primary since
+        std::vector<wsrep_uuid_t> prim_members_;
+        StreamMap            stream_map_; // fragments of streamed trxs
+        long                 fragment_size_; // 0 - streaming disabled
+        bool                 fragment_rows_;
 
         // counters
         gu::Atomic<size_t>    receivers_;
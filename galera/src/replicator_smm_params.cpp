@@ -7,6 +7,7 @@
 #include "gu_uri.hpp"
 #include "write_set_ng.hpp"
 #include "gu_throw.hpp"
+#include "gu_thread.hpp"
 
 const std::string galera::ReplicatorSMM::Param::base_host = "base_host";
 const std::string galera::ReplicatorSMM::Param::base_port = "base_port";
@@ -24,8 +25,21 @@ const std::string galera::ReplicatorSMM::Param::key_format =
     common_prefix + "key_format";
 const std::string galera::ReplicatorSMM::Param::max_write_set_size =
     common_prefix + "max_ws_size";
-
-int const galera::ReplicatorSMM::MAX_PROTO_VER(7);
+const std::string galera::ReplicatorSMM::Param::trx_trace =
+    common_prefix + "trx_trace";
+const std::string galera::ReplicatorSMM::Param::trx_trace_dump =
+    common_prefix + "trx_trace_dump";
+const std::string galera::ReplicatorSMM::Param::toi_nonblocking =
+    common_prefix + "toi_nonblocking";
+const std::string galera::ReplicatorSMM::Param::fragment_size =
+    common_prefix + "fragment_size";
+const std::string galera::ReplicatorSMM::Param::fragment_unit =
+    common_prefix + "fragment_unit";
+
+int const galera::ReplicatorSMM::MAX_PROTO_VER(9);
+int const galera::ReplicatorSMM::NBO_PROTO_VER(9);
+int const galera::ReplicatorSMM::STREAMING_PROTO_VER(9);
+int const galera::ReplicatorSMM::PREORDERED_KEYS_PROTO_VER(9);
 
 galera::ReplicatorSMM::Defaults::Defaults() : map_()
 {
@@ -38,16 +52,34 @@ galera::ReplicatorSMM::Defaults::Defaults() : map_()
     const int max_write_set_size(galera::WriteSetNG::MAX_SIZE);
     map_.insert(Default(Param::max_write_set_size,
                         gu::to_string(max_write_set_size)));
+    map_.insert(Default(Param::trx_trace, "no"));
+    map_.insert(Default(Param::trx_trace_dump, ""));
+    map_.insert(Default(Param::toi_nonblocking, "no"));
+    map_.insert(Default(Param::fragment_size, "0"));
+    map_.insert(Default(Param::fragment_unit, "bytes"));
 }
 
 const galera::ReplicatorSMM::Defaults galera::ReplicatorSMM::defaults;
 
 
+bool
+galera::ReplicatorSMM::fragment_unit_rows(const std::string& unit)
+{
+    if (unit == "rows")  return true;
+    if (unit == "bytes") return false;
+
+    gu_throw_error(EINVAL) << "Bad value for '" << Param::fragment_unit
+                           << "': '" << unit << "', expected 'bytes' or "
+                           << "'rows'";
+}
+
+
 galera::ReplicatorSMM::InitConfig::InitConfig(gu::Config&       conf,
                                               const char* const node_address,
                                               const char* const base_dir)
 {
     gu::ssl_register_params(conf);
+    gu::thread_register_params(conf);
     Replicator::register_params(conf);
 
     std::map<std::string, std::string>::const_iterator i;
@@ -186,6 +218,34 @@ galera::ReplicatorSMM::set_param (const std::string& key,
     {
         trx_params_.max_write_set_size_ = gu::from_string<int>(value);
     }
+    else if (key == Param::trx_trace)
+    {
+        TrxTrace::enable(gu::Config::from_config<bool>(value));
+    }
+    else if (key == Param::trx_trace_dump)
+    {
+        TrxTrace::dump(value);
+    }
+    else if (key == Param::toi_nonblocking)
+    {
+        toi_nonblocking_ = gu::Config::from_config<bool>(value);
+    }
+    else if (key == Param::fragment_size)
+    {
+        long const size(gu::Config::from_config<long>(value));
+
+        if (size < 0)
+        {
+            gu_throw_error(EINVAL) << "Bad value for '" << key << "': "
+                                   << value;
+        }
+
+        fragment_size_ = size;
+    }
+    else if (key == Param::fragment_unit)
+    {
+        fragment_rows_ = fragment_unit_rows(value);
+    }
     else
     {
         log_warn << "parameter '" << key << "' not found";
@@ -198,6 +258,14 @@ void
 galera::ReplicatorSMM::param_set (const std::string& key,
                                   const std::string& value)
 {
+    if (key == Param::trx_trace_dump)
+    {
+        /* an action rather than a setting: value is not stored, so that
+         * the trace can be dumped to the same file again */
+        set_param (key, value);
+        return;
+    }
+
     try
     {
         if (config_.get(key) == value) return;
@@ -221,6 +289,18 @@ galera::ReplicatorSMM::param_set (const std::string& key,
         cert_.set_log_conflicts(value);
         return;
     }
+    else if (key == Certification::PARAM_HOT_KEYS)
+    {
+        cert_.set_hot_keys(value);
+        return;
+    }
+    else if (key == gu::conf::thread_affinity)
+    {
+        /* other threads pick the new value up when (re)started */
+        service_thd_.set_affinity(gu::thread_affinity(value, "service"));
+        config_.set(key, value);
+        return;
+    }
     // this key might be for another module
     else if (0 != key.find(common_prefix))
     {
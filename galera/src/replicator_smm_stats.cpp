@@ -117,12 +117,19 @@ typedef enum status_vars
     STATS_CERT_INDEX_SIZE,
     STATS_CERT_BUCKET_COUNT,
     STATS_GCACHE_POOL_SIZE,
+    STATS_GCACHE_PAGES_CREATED,
+    STATS_GCACHE_PAGES_CREATED_SYNC,
+    STATS_GCACHE_PAGES_RECYCLED,
+    STATS_GCACHE_PAGE_CREATE_AVG_NS,
+    STATS_GCACHE_PAGE_CREATE_MAX_NS,
     STATS_CAUSAL_READS,
     STATS_CERT_INTERVAL,
     STATS_IST_RECEIVE_STATUS,
     STATS_IST_RECEIVE_SEQNO_START,
     STATS_IST_RECEIVE_SEQNO_CURRENT,
     STATS_IST_RECEIVE_SEQNO_END,
+    STATS_CERT_HOT_CONFLICT_KEYS,
+    STATS_CERT_HOT_DEPENDENCY_KEYS,
     STATS_INCOMING_LIST,
     STATS_MAX
 } StatusVars;
@@ -172,12 +179,19 @@ static const struct wsrep_stats_var wsrep_stats[STATS_MAX + 1] =
     { "cert_index_size",          WSREP_VAR_INT64,  { 0 }  },
     { "cert_bucket_count",        WSREP_VAR_INT64,  { 0 }  },
     { "gcache_pool_size",         WSREP_VAR_INT64,  { 0 }  },
+    { "gcache_pages_created",     WSREP_VAR_INT64,  { 0 }  },
+    { "gcache_pages_created_sync",WSREP_VAR_INT64,  { 0 }  },
+    { "gcache_pages_recycled",    WSREP_VAR_INT64,  { 0 }  },
+    { "gcache_page_create_avg_ns",WSREP_VAR_INT64,  { 0 }  },
+    { "gcache_page_create_max_ns",WSREP_VAR_INT64,  { 0 }  },
     { "causal_reads",             WSREP_VAR_INT64,  { 0 }  },
     { "cert_interval",            WSREP_VAR_DOUBLE, { 0 }  },
     { "ist_receive_status",       WSREP_VAR_STRING, { 0 }  },
     { "ist_receive_seqno_start",  WSREP_VAR_INT64,  { 0 }  },
     { "ist_receive_seqno_current",WSREP_VAR_INT64,  { 0 }  },
     { "ist_receive_seqno_end",    WSREP_VAR_INT64,  { 0 }  },
+    { "cert_hot_conflict_keys",   WSREP_VAR_STRING, { 0 }  },
+    { "cert_hot_dependency_keys", WSREP_VAR_STRING, { 0 }  },
     { "incoming_addresses",       WSREP_VAR_STRING, { 0 }  },
     { 0,                          WSREP_VAR_STRING, { 0 }  }
 };
@@ -256,8 +270,21 @@ galera::ReplicatorSMM::stats_get()
     sv[STATS_CERT_INDEX_SIZE     ].value._int64 = index_size;
     sv[STATS_CERT_BUCKET_COUNT   ].value._int64 = cert_.bucket_count();
 
+    std::string hot_conflict_keys;
+    std::string hot_dependency_keys;
+    cert_.hot_keys_get(hot_conflict_keys, hot_dependency_keys);
+
     sv[STATS_GCACHE_POOL_SIZE    ].value._int64 = gcache_.allocated_pool_size();
 
+    gcache::PageStore::Stats const ps(gcache_.page_stats());
+
+    sv[STATS_GCACHE_PAGES_CREATED     ].value._int64 = ps.created;
+    sv[STATS_GCACHE_PAGES_CREATED_SYNC].value._int64 = ps.sync_created;
+    sv[STATS_GCACHE_PAGES_RECYCLED    ].value._int64 = ps.recycled;
+    sv[STATS_GCACHE_PAGE_CREATE_AVG_NS].value._int64 =
+        ps.created ? ps.create_ns / ps.created : 0;
+    sv[STATS_GCACHE_PAGE_CREATE_MAX_NS].value._int64 = ps.create_ns_max;
+
     double oooe;
     double oool;
     double win;
@@ -327,6 +354,9 @@ galera::ReplicatorSMM::stats_get()
         tail_size += i->first.size() + 1 + i->second.size() + 1;
     }
 
+    tail_size += hot_conflict_keys.size() + 1;
+    tail_size += hot_dependency_keys.size() + 1;
+
     gu::Lock lock_inc(incoming_mutex_);
     tail_size += incoming_list_.size() + 1;
 
@@ -353,6 +383,17 @@ galera::ReplicatorSMM::stats_get()
         sv[STATS_INCOMING_LIST].value._string = tail_buf;
         tail_buf += incoming_list_.size() + 1;
 
+        // Assign hot key lists
+        strncpy(tail_buf, hot_conflict_keys.c_str(),
+                hot_conflict_keys.size() + 1);
+        sv[STATS_CERT_HOT_CONFLICT_KEYS].value._string = tail_buf;
+        tail_buf += hot_conflict_keys.size() + 1;
+
+        strncpy(tail_buf, hot_dependency_keys.c_str(),
+                hot_dependency_keys.size() + 1);
+        sv[STATS_CERT_HOT_DEPENDENCY_KEYS].value._string = tail_buf;
+        tail_buf += hot_dependency_keys.size() + 1;
+
         // Iterate over dynamical status variables and assing strings
         size_t sv_pos(STATS_INCOMING_LIST + 1);
         for (gu::Status::const_iterator i(status.begin());
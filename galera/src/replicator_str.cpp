@@ -267,49 +267,6 @@ read_state_request (const void* const req, size_t const req_len)
 }
 
 
-class IST_request
-{
-public:
-    IST_request() : peer_(), uuid_(), last_applied_(), group_seqno_() { }
-    IST_request(const std::string& peer,
-                const wsrep_uuid_t& uuid,
-                wsrep_seqno_t last_applied,
-                wsrep_seqno_t group_seqno)
-        :
-        peer_(peer),
-        uuid_(uuid),
-        last_applied_(last_applied),
-        group_seqno_(group_seqno)
-    { }
-    const std::string&  peer()  const { return peer_ ; }
-    const wsrep_uuid_t& uuid()  const { return uuid_ ; }
-    wsrep_seqno_t       last_applied() const { return last_applied_; }
-    wsrep_seqno_t       group_seqno()  const { return group_seqno_; }
-private:
-    friend std::ostream& operator<<(std::ostream&, const IST_request&);
-    friend std::istream& operator>>(std::istream&, IST_request&);
-    std::string peer_;
-    wsrep_uuid_t uuid_;
-    wsrep_seqno_t last_applied_;
-    wsrep_seqno_t group_seqno_;
-};
-
-std::ostream& operator<<(std::ostream& os, const IST_request& istr)
-{
-    return (os
-            << istr.uuid_         << ":"
-            << istr.last_applied_ << "-"
-            << istr.group_seqno_  << "|"
-            << istr.peer_);
-}
-
-std::istream& operator>>(std::istream& is, IST_request& istr)
-{
-    char c;
-    return (is >> istr.uuid_ >> c >> istr.last_applied_
-            >> c >> istr.group_seqno_ >> c >> istr.peer_);
-}
-
 static void
 get_ist_request(const ReplicatorSMM::StateRequest* str, IST_request* istr)
 {
@@ -1046,6 +1003,10 @@ void ReplicatorSMM::recv_IST(void* recv_ctx)
                     apply_trx(recv_ctx, trx);
                     GU_DBUG_SYNC_WAIT("recv_IST_after_apply_trx");
                 }
+                // IST write sets were received into GCache and stay in
+                // its history, release the buffer as soon as it is applied
+                // so that it does not pin cache space
+                gcache_.free(const_cast<void*>(trx->action()));
             }
             else
             {
@@ -0,0 +1,182 @@
+//
+// Copyright (C) 2015 Codership Oy <info@codership.com>
+//
+
+#ifndef GALERA_STREAM_MAP_HPP
+#define GALERA_STREAM_MAP_HPP
+
+#include "trx_copy.hpp"
+#include "uuid.hpp"
+
+#include "gu_lock.hpp"
+
+#include <map>
+#include <vector>
+#include <cstring>
+
+namespace galera
+{
+    /*!
+     * Fragments of streamed transactions certified so far.
+     *
+     * Fragments are not applied on arrival: the applier can't keep a
+     * transaction open between writesets, so they are applied in order
+     * together with the final writeset of the transaction. Since writeset
+     * buffers are released from gcache as soon as certification index is
+     * purged past them, fragments are copied, see trx_copy().
+     */
+    class StreamMap
+    {
+    public:
+
+        typedef std::vector<TrxHandle*> Fragments;
+
+        StreamMap(gcache::GCache& gcache, TrxHandle::SlavePool& pool)
+            :
+            mutex_ (),
+            gcache_(gcache),
+            pool_  (pool),
+            map_   ()
+        { }
+
+        ~StreamMap() { clear(); }
+
+        /*! stores a copy of certified fragment */
+        void append(const TrxHandle& trx)
+        {
+            assert(trx.fragment());
+
+            TrxHandle* const copy(trx_copy(gcache_, pool_, trx));
+
+            gu::Lock lock(mutex_);
+
+            Fragments& frags(map_[Key(trx)]);
+
+            /* fragments may be stored by different appliers out of order */
+            Fragments::iterator i(frags.end());
+
+            while (i != frags.begin() &&
+                   (*(i - 1))->global_seqno() > copy->global_seqno()) --i;
+
+            frags.insert(i, copy);
+        }
+
+        /*! fills out with fragments stored for the transaction of trx,
+         *  returns false if there are none */
+        bool find(const TrxHandle& trx, Fragments& out) const
+        {
+            gu::Lock lock(mutex_);
+
+            Map::const_iterator const i(map_.find(Key(trx)));
+
+            if (i == map_.end()) return false;
+
+            out = i->second;
+
+            return true;
+        }
+
+        /*! releases fragments of the transaction of trx */
+        void erase(const TrxHandle& trx)
+        {
+            gu::Lock lock(mutex_);
+
+            Map::iterator const i(map_.find(Key(trx)));
+
+            if (i != map_.end())
+            {
+                release(i->second);
+                map_.erase(i);
+            }
+        }
+
+        /*! releases all fragments, e.g. when certification index is reset */
+        void clear()
+        {
+            gu::Lock lock(mutex_);
+
+            for (Map::iterator i(map_.begin()); i != map_.end(); ++i)
+            {
+                release(i->second);
+            }
+
+            map_.clear();
+        }
+
+        /*! releases fragments of transactions whose source is not a member
+         *  of view */
+        void retain(const wsrep_view_info_t& view)
+        {
+            gu::Lock lock(mutex_);
+
+            Map::iterator i(map_.begin());
+
+            while (i != map_.end())
+            {
+                int m(0);
+
+                while (m < view.memb_num &&
+                       view.members[m].id != i->first.source_id) ++m;
+
+                if (m < view.memb_num)
+                {
+                    ++i;
+                }
+                else
+                {
+                    release(i->second);
+                    map_.erase(i++);
+                }
+            }
+        }
+
+        /*! number of streamed transactions in progress */
+        size_t size() const
+        {
+            gu::Lock lock(mutex_);
+            return map_.size();
+        }
+
+    private:
+
+        struct Key
+        {
+            explicit Key(const TrxHandle& trx)
+                : source_id(trx.source_id()), trx_id(trx.trx_id())
+            { }
+
+            bool operator<(const Key& other) const
+            {
+                int const cmp(::memcmp(&source_id, &other.source_id,
+                                       sizeof(source_id)));
+
+                return (cmp < 0 || (0 == cmp && trx_id < other.trx_id));
+            }
+
+            wsrep_uuid_t   source_id;
+            wsrep_trx_id_t trx_id;
+        };
+
+        typedef std::map<Key, Fragments> Map;
+
+        void release(Fragments& frags)
+        {
+            for (Fragments::iterator i(frags.begin()); i != frags.end(); ++i)
+            {
+                trx_copy_free(gcache_, *i);
+            }
+
+            frags.clear();
+        }
+
+        StreamMap(const StreamMap&);
+        StreamMap& operator=(const StreamMap&);
+
+        gu::Mutex             mutex_;
+        gcache::GCache&       gcache_;
+        TrxHandle::SlavePool& pool_;
+        Map                   map_;
+    };
+}
+
+#endif // GALERA_STREAM_MAP_HPP
@@ -0,0 +1,66 @@
+//
+// Copyright (C) 2015 Codership Oy <info@codership.com>
+//
+
+#ifndef GALERA_TRX_COPY_HPP
+#define GALERA_TRX_COPY_HPP
+
+#include "trx_handle.hpp"
+
+#include "GCache.hpp"
+
+#include "gu_throw.hpp"
+
+#include <cstring>
+
+namespace galera
+{
+    /*!
+     * Makes a private copy of received writeset in unordered gcache buffer.
+     * Writeset buffers are released from gcache as soon as certification
+     * index is purged past them, copies stay until freed explicitly.
+     */
+    inline TrxHandle*
+    trx_copy(gcache::GCache& gcache, TrxHandle::SlavePool& pool,
+             const TrxHandle& trx)
+    {
+        ssize_t const size(trx.write_set_in().size());
+        void* const   buf(gcache.malloc(size));
+
+        if (0 == buf)
+        {
+            gu_throw_error(ENOMEM) << "Failed to allocate " << size
+                                   << " bytes for copy of " << trx;
+        }
+
+        ::memcpy(buf, trx.action(), size);
+
+        TrxHandle* const copy(TrxHandle::New(pool));
+
+        try
+        {
+            copy->unserialize(static_cast<const gu::byte_t*>(buf), size, 0);
+            copy->set_received(buf, -1, trx.global_seqno());
+            copy->verify_checksum();
+        }
+        catch (...)
+        {
+            copy->unref();
+            gcache.free(buf);
+            throw;
+        }
+
+        return copy;
+    }
+
+    /*! releases copy made by trx_copy() */
+    inline void
+    trx_copy_free(gcache::GCache& gcache, TrxHandle* const copy)
+    {
+        const void* const buf(copy->action());
+        copy->unref();
+        gcache.free(const_cast<void*>(buf));
+    }
+}
+
+#endif // GALERA_TRX_COPY_HPP
@@ -48,6 +48,35 @@ std::ostream& galera::operator<<(std::ostream& os, TrxHandle::State s)
 }
 
 
+void
+galera::TrxHandle::trace(int const point)
+{
+    int64_t const now(gu_time_monotonic());
+
+    if (gu_unlikely(point == trace_last_))
+    {
+        /* slave trx entering S_REPLICATING: trace starts here */
+        trace_tstamp_ = now;
+        return;
+    }
+
+    TrxTrace::Record const r =
+    {
+        now,
+        trace_tstamp_ ? now - trace_tstamp_ : -1,
+        global_seqno_,
+        trx_id_,
+        uint8_t(trace_last_),
+        uint8_t(point)
+    };
+
+    TrxTrace::record(r);
+
+    trace_tstamp_ = now;
+    trace_last_   = point;
+}
+
+
 std::ostream&
 galera::operator<<(std::ostream& os, const TrxHandle& th)
 {
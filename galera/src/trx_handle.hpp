@@ -12,6 +12,7 @@
 #include "key_data.hpp" // for append_key()
 #include "key_entry_os.hpp"
 #include "write_set_ng.hpp"
+#include "trx_trace.hpp"
 
 #include "wsrep_api.h"
 #include "gu_mutex.hpp"
@@ -67,7 +68,11 @@ namespace galera
             F_ANNOTATION  = 1 << 5,
             F_ISOLATION   = 1 << 6,
             F_PA_UNSAFE   = 1 << 7,
-            F_PREORDERED  = 1 << 8
+            F_PREORDERED  = 1 << 8,
+            F_NBO_BEGIN   = 1 << 9,  // start of non-blocking TOI
+            F_NBO_END     = 1 << 10, // end of non-blocking TOI
+            F_FRAGMENT    = 1 << 11, // non-final fragment of streamed trx
+            F_STREAMED    = 1 << 12  // continues previously streamed fragments
         };
 
         static inline uint32_t wsrep_flags_to_trx_flags (uint32_t flags)
@@ -111,6 +116,10 @@ namespace galera
 
             if (flags & WriteSetNG::F_TOI)       ret |= F_ISOLATION;
             if (flags & WriteSetNG::F_PA_UNSAFE) ret |= F_PA_UNSAFE;
+            if (flags & WriteSetNG::F_NBO_BEGIN) ret |= F_NBO_BEGIN;
+            if (flags & WriteSetNG::F_NBO_END)   ret |= F_NBO_END;
+            if (flags & WriteSetNG::F_FRAGMENT)  ret |= F_FRAGMENT;
+            if (flags & WriteSetNG::F_STREAMED)  ret |= F_STREAMED;
 
             return ret;
         }
@@ -140,6 +149,26 @@ namespace galera
             return ((write_set_flags_ & F_PREORDERED) != 0);
         }
 
+        bool nbo_begin() const
+        {
+            return ((write_set_flags_ & F_NBO_BEGIN) != 0);
+        }
+
+        bool nbo_end() const
+        {
+            return ((write_set_flags_ & F_NBO_END) != 0);
+        }
+
+        bool fragment() const
+        {
+            return ((write_set_flags_ & F_FRAGMENT) != 0);
+        }
+
+        bool streamed() const
+        {
+            return ((write_set_flags_ & F_STREAMED) != 0);
+        }
+
         typedef enum
         {
             S_EXECUTING,
@@ -223,7 +252,8 @@ namespace galera
                               const Params&       params,
                               const wsrep_uuid_t& source_id,
                               wsrep_conn_id_t     conn_id,
-                              wsrep_trx_id_t      trx_id)
+                              wsrep_trx_id_t      trx_id,
+                              gu::Allocator::Arena* arena = NULL)
         {
             size_t const buf_size(pool.buf_size());
 
@@ -234,7 +264,7 @@ namespace galera
             return new(buf)
                 TrxHandle(pool, params, source_id, conn_id, trx_id,
                           static_cast<gu::byte_t*>(buf) + sizeof(TrxHandle),
-                          buf_size - sizeof(TrxHandle));
+                          buf_size - sizeof(TrxHandle), arena);
         }
 
         void lock()   const { mutex_.lock();   }
@@ -299,10 +329,10 @@ namespace galera
         }
 
         /* obtain global and depends seqno from the writeset (IST) */
-        void set_received_from_ws()
+        void set_received_from_ws(const void* action)
         {
             wsrep_seqno_t const seqno_g(write_set_in_.seqno());
-            set_received(0, -1, seqno_g);
+            set_received(action, -1, seqno_g);
             wsrep_seqno_t const seqno_d
                 (std::max<wsrep_seqno_t>
                     (global_seqno_ - write_set_in_.pa_range(),
@@ -325,7 +355,17 @@ namespace galera
         }
 
         State state() const { return state_(); }
-        void set_state(State state) { state_.shift_to(state); }
+        void set_state(State state)
+        {
+            if (gu_unlikely(TrxTrace::enabled())) trace(state);
+            state_.shift_to(state);
+        }
+
+        /* marks trace point which is not a state transition */
+        void trace_point(TrxTrace::Point point)
+        {
+            if (gu_unlikely(TrxTrace::enabled())) trace(point);
+        }
 
         long gcs_handle() const { return gcs_handle_; }
         void set_gcs_handle(long gcs_handle) { gcs_handle_ = gcs_handle; }
@@ -351,6 +391,10 @@ namespace galera
                 uint16_t ws_flags(flags & COMMON_FLAGS_MASK);
                 if (flags & F_ISOLATION) ws_flags |= WriteSetNG::F_TOI;
                 if (flags & F_PA_UNSAFE) ws_flags |= WriteSetNG::F_PA_UNSAFE;
+                if (flags & F_NBO_BEGIN) ws_flags |= WriteSetNG::F_NBO_BEGIN;
+                if (flags & F_NBO_END)   ws_flags |= WriteSetNG::F_NBO_END;
+                if (flags & F_FRAGMENT)  ws_flags |= WriteSetNG::F_FRAGMENT;
+                if (flags & F_STREAMED)  ws_flags |= WriteSetNG::F_STREAMED;
                 write_set_out().set_flags(ws_flags);
             }
         }
@@ -375,6 +419,27 @@ namespace galera
             }
         }
 
+        /* appends an array of keys of the same type, checks done once */
+        void append_keys(int                const proto_ver,
+                         const wsrep_key_t* const keys,
+                         size_t             const count,
+                         wsrep_key_type_t   const type,
+                         bool               const copy)
+        {
+            if (new_version() && proto_ver == version_)
+            {
+                write_set_out().append_keys(proto_ver, keys, count, type,
+                                            copy);
+                return;
+            }
+
+            for (size_t i(0); i < count; ++i)
+            {
+                append_key(KeyData(proto_ver, keys[i].key_parts,
+                                   keys[i].key_parts_num, type, copy));
+            }
+        }
+
         void append_data(const void* data, const size_t data_len,
                          wsrep_data_type_t type, bool store)
         {
@@ -672,7 +737,9 @@ namespace galera
             interim_committed_ (false),
             exit_loop_         (false),
             wso_               (false),
-            mac_               ()
+            mac_               (),
+            trace_tstamp_      (TrxTrace::enabled() ? gu_time_monotonic() : 0),
+            trace_last_        (S_REPLICATING) // slave trx is not executed
         {}
 
         /* local trx ctor */
@@ -682,7 +749,8 @@ namespace galera
                   wsrep_conn_id_t     conn_id,
                   wsrep_trx_id_t      trx_id,
                   gu::byte_t*         reserved,
-                  size_t              reserved_size)
+                  size_t              reserved_size,
+                  gu::Allocator::Arena* arena)
             :
             source_id_         (source_id),
             conn_id_           (conn_id),
@@ -716,9 +784,11 @@ namespace galera
             interim_committed_ (false),
             exit_loop_         (false),
             wso_               (new_version()),
-            mac_               ()
+            mac_               (),
+            trace_tstamp_      (TrxTrace::enabled() ? gu_time_monotonic() : 0),
+            trace_last_        (S_EXECUTING)
         {
-            init_write_set_out(params, reserved, reserved_size);
+            init_write_set_out(params, reserved, reserved_size, arena);
         }
 
         ~TrxHandle() { if (wso_) release_write_set_out(); }
@@ -726,7 +796,8 @@ namespace galera
         void
         init_write_set_out(const Params& params,
                            gu::byte_t*   store,
-                           size_t        store_size)
+                           size_t        store_size,
+                           gu::Allocator::Arena* arena)
         {
             if (wso_)
             {
@@ -744,7 +815,8 @@ namespace galera
                                        WriteSetNG::MAX_VERSION,
                                        DataSet::MAX_VERSION,
                                        DataSet::MAX_VERSION,
-                                       params.max_write_set_size_);
+                                       params.max_write_set_size_,
+                                       arena);
             }
         }
 
@@ -787,6 +859,10 @@ namespace galera
         bool                   exit_loop_;
         bool                   wso_;
         Mac                    mac_;
+        int64_t                trace_tstamp_; // time of last trace point
+        int                    trace_last_;   // last trace point
+
+        void trace(int point);
 
         friend class Wsdb;
         friend class Certification;
@@ -0,0 +1,334 @@
+//
+// Copyright (C) 2015 Codership Oy <info@codership.com>
+//
+
+#include "trx_trace.hpp"
+#include "trx_handle.hpp"
+
+#include "gu_histogram.hpp"
+#include "gu_serialize.hpp"
+#include "gu_lock.hpp"
+#include "gu_logger.hpp"
+#include "gu_throw.hpp"
+
+#include <pthread.h>
+#include <string.h>
+#include <errno.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <map>
+
+gu::Atomic<int> galera::TrxTrace::enabled_(0);
+
+namespace
+{
+    class Ring
+    {
+    public:
+
+        Ring() : head_(0), tail_(0) {}
+
+        /* only the owner thread writes */
+        void push(const galera::TrxTrace::Record& r)
+        {
+            long long const h(head_());
+            slots_[h % galera::TrxTrace::RING_SIZE] = r;
+            head_ = h + 1;
+        }
+
+        /* must be called under registry lock */
+        void copy(std::vector<galera::TrxTrace::Record>& out) const
+        {
+            /* slot of the oldest record is the one being written next,
+             * so only size - 1 records can be read consistently */
+            long long const size(galera::TrxTrace::RING_SIZE);
+            long long const h1(head_());
+            long long const b1(std::max(tail_, h1 - size + 1));
+            size_t    const pos(out.size());
+
+            for (long long i(b1); i < h1; ++i)
+            {
+                out.push_back(slots_[i % size]);
+            }
+
+            /* records before h2 - size + 1 could have been overwritten
+             * while copying */
+            long long const h2(head_());
+            long long const b2(h2 - size + 1);
+
+            if (b2 > b1)
+            {
+                out.erase(out.begin() + pos,
+                          out.begin() + pos + std::min(b2, h1) - b1);
+            }
+        }
+
+        void clear() { tail_ = head_(); }
+
+    private:
+
+        galera::TrxTrace::Record slots_[galera::TrxTrace::RING_SIZE];
+        gu::Atomic<long long>    head_;
+        long long                tail_;
+    };
+
+    /* Rings are kept for the lifetime of the process: rings of exited
+     * threads are still dumped and are handed to new threads. */
+    gu::Mutex          registry_mtx;
+    std::vector<Ring*> registry_all;
+    std::vector<Ring*> registry_free;
+
+    pthread_key_t      ring_key;
+    pthread_once_t     ring_key_once = PTHREAD_ONCE_INIT;
+    int                ring_key_err  = 0;
+
+    extern "C" void ring_release(void* const ptr)
+    {
+        gu::Lock lock(registry_mtx);
+        registry_free.push_back(static_cast<Ring*>(ptr));
+    }
+
+    extern "C" void ring_key_create()
+    {
+        ring_key_err = pthread_key_create(&ring_key, ring_release);
+    }
+
+    Ring* thread_ring()
+    {
+        void* ptr(pthread_getspecific(ring_key));
+
+        if (gu_unlikely(0 == ptr))
+        {
+            Ring* ring;
+            {
+                gu::Lock lock(registry_mtx);
+
+                if (registry_free.empty())
+                {
+                    ring = new Ring();
+                    registry_all.push_back(ring);
+                }
+                else
+                {
+                    ring = registry_free.back();
+                    registry_free.pop_back();
+                }
+            }
+
+            pthread_setspecific(ring_key, ring);
+            ptr = ring;
+        }
+
+        return static_cast<Ring*>(ptr);
+    }
+
+    bool tstamp_less(const galera::TrxTrace::Record& a,
+                     const galera::TrxTrace::Record& b)
+    {
+        return a.tstamp < b.tstamp;
+    }
+
+    std::string const HISTOGRAM_BINS(
+        "0.0,0.0001,0.00031623,0.001,0.0031623,0.01,0.031623,0.1,0.31623,"
+        "1.,3.1623,10.,31.623");
+
+    struct Phase
+    {
+        Phase() : hist(HISTOGRAM_BINS), count(0), total(0) {}
+
+        gu::Histogram hist;
+        long long     count;
+        long long     total; // ns
+    };
+
+    char const BINARY_MAGIC[] = { 'G', 'T', 'T', '\1' };
+    size_t const BINARY_RECORD_SIZE = 4 * 8 + 2;
+}
+
+
+void
+galera::TrxTrace::enable(bool const val)
+{
+    if (val)
+    {
+        pthread_once(&ring_key_once, ring_key_create);
+
+        if (ring_key_err)
+        {
+            gu_throw_error(ring_key_err) << "Failed to create trx trace key";
+        }
+    }
+
+    enabled_ = val;
+}
+
+
+void
+galera::TrxTrace::record(const Record& r)
+{
+    thread_ring()->push(r);
+}
+
+
+void
+galera::TrxTrace::snapshot(std::vector<Record>& out)
+{
+    gu::Lock lock(registry_mtx);
+
+    for (size_t i(0); i < registry_all.size(); ++i)
+    {
+        registry_all[i]->copy(out);
+    }
+}
+
+
+void
+galera::TrxTrace::clear()
+{
+    gu::Lock lock(registry_mtx);
+
+    for (size_t i(0); i < registry_all.size(); ++i)
+    {
+        registry_all[i]->clear();
+    }
+}
+
+
+std::string
+galera::TrxTrace::point_name(int const point)
+{
+    switch (point)
+    {
+    case P_LOCAL_MONITOR:  return "LOCAL_MONITOR";
+    case P_APPLY_MONITOR:  return "APPLY_MONITOR";
+    case P_COMMIT_MONITOR: return "COMMIT_MONITOR";
+    }
+
+    if (point >= TrxHandle::S_EXECUTING && point <= TrxHandle::S_ROLLED_BACK)
+    {
+        std::ostringstream os;
+        os << TrxHandle::State(point);
+        return os.str();
+    }
+
+    std::ostringstream os;
+    os << "UNKNOWN(" << point << ')';
+    return os.str();
+}
+
+
+void
+galera::TrxTrace::dump_json(std::ostream& os)
+{
+    std::vector<Record> recs;
+    snapshot(recs);
+    std::stable_sort(recs.begin(), recs.end(), tstamp_less);
+
+    std::map<std::string, Phase> phases;
+
+    os << "{\n\"records\": [";
+
+    for (size_t i(0); i < recs.size(); ++i)
+    {
+        const Record& r(recs[i]);
+        std::string const from(point_name(r.from));
+        std::string const to  (point_name(r.to));
+
+        os << (i ? ",\n" : "\n")
+           << "{\"tstamp\": "   << r.tstamp
+           << ", \"trx_id\": "  << int64_t(r.trx_id)
+           << ", \"seqno\": "   << r.seqno
+           << ", \"from\": \""  << from
+           << "\", \"to\": \""  << to
+           << "\", \"elapsed\": " << r.elapsed << '}';
+
+        if (r.elapsed >= 0)
+        {
+            Phase& p(phases[from + "->" + to]);
+            p.hist.insert(double(r.elapsed) / 1.0e9);
+            p.count += 1;
+            p.total += r.elapsed;
+        }
+    }
+
+    os << "\n],\n\"phases\": {";
+
+    for (std::map<std::string, Phase>::const_iterator i(phases.begin());
+         i != phases.end(); ++i)
+    {
+        os << (i == phases.begin() ? "\n" : ",\n")
+           << '"' << i->first << "\": {\"count\": " << i->second.count
+           << ", \"avg\": "
+           << double(i->second.total) / i->second.count / 1.0e9
+           << ", \"hist\": \"" << i->second.hist << "\"}";
+    }
+
+    os << "\n}\n}\n";
+}
+
+
+void
+galera::TrxTrace::dump_binary(std::ostream& os)
+{
+    std::vector<Record> recs;
+    snapshot(recs);
+    std::stable_sort(recs.begin(), recs.end(), tstamp_less);
+
+    std::vector<gu::byte_t> buf(sizeof(BINARY_MAGIC) + 4 +
+                                recs.size() * BINARY_RECORD_SIZE);
+
+    ::memcpy(&buf[0], BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    size_t off(sizeof(BINARY_MAGIC));
+    off = gu::serialize4(uint32_t(recs.size()), &buf[0], buf.size(), off);
+
+    for (size_t i(0); i < recs.size(); ++i)
+    {
+        const Record& r(recs[i]);
+        off = gu::serialize8(r.tstamp,  &buf[0], buf.size(), off);
+        off = gu::serialize8(r.elapsed, &buf[0], buf.size(), off);
+        off = gu::serialize8(r.seqno,   &buf[0], buf.size(), off);
+        off = gu::serialize8(r.trx_id,  &buf[0], buf.size(), off);
+        off = gu::serialize1(r.from,    &buf[0], buf.size(), off);
+        off = gu::serialize1(r.to,      &buf[0], buf.size(), off);
+    }
+
+    assert(off == buf.size());
+
+    os.write(reinterpret_cast<const char*>(&buf[0]), off);
+}
+
+
+void
+galera::TrxTrace::dump(const std::string& file_name)
+{
+    static std::string const bin_suffix(".bin");
+
+    bool const binary(file_name.size() > bin_suffix.size() &&
+                      0 == file_name.compare(file_name.size()
+                                             - bin_suffix.size(),
+                                             bin_suffix.size(), bin_suffix));
+
+    std::ofstream ofs(file_name.c_str(), binary ?
+                      std::ios_base::out | std::ios_base::binary :
+                      std::ios_base::out);
+
+    if (!ofs.good())
+    {
+        gu_throw_error(errno) << "Failed to open trx trace dump file '"
+                              << file_name << '\'';
+    }
+
+    if (binary) dump_binary(ofs); else dump_json(ofs);
+
+    ofs.close();
+
+    if (ofs.fail())
+    {
+        gu_throw_error(EIO) << "Failed to write trx trace dump file '"
+                            << file_name << '\'';
+    }
+
+    log_info << "Dumped trx trace to '" << file_name << '\'';
+}
@@ -0,0 +1,82 @@
+//
+// Copyright (C) 2015 Codership Oy <info@codership.com>
+//
+
+#ifndef GALERA_TRX_TRACE_HPP
+#define GALERA_TRX_TRACE_HPP
+
+#include "gu_atomic.hpp"
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <stdint.h>
+
+namespace galera
+{
+    /*!
+     * Optional tracing of transaction processing phases.
+     *
+     * Each trace point of a transaction (TrxHandle state transition or
+     * monitor entry) is written together with the time elapsed since the
+     * previous trace point of the same transaction into the ring buffer of
+     * the calling thread. Rings have a single writer and are not locked on
+     * the write path, readers detect overwritten records by re-reading the
+     * write position after copying.
+     */
+    class TrxTrace
+    {
+    public:
+
+        /* trace points which are not TrxHandle states */
+        enum Point
+        {
+            P_LOCAL_MONITOR = 32, // entered local monitor
+            P_APPLY_MONITOR,      // entered apply monitor
+            P_COMMIT_MONITOR      // entered commit monitor
+        };
+
+        struct Record
+        {
+            int64_t  tstamp;  // gu_time_monotonic(), ns
+            int64_t  elapsed; // since previous point, ns, -1 if unknown
+            int64_t  seqno;   // global seqno, -1 if not assigned yet
+            uint64_t trx_id;
+            uint8_t  from;    // previous point
+            uint8_t  to;      // this point
+        };
+
+        /* ring slots per thread, the last RING_SIZE - 1 records are kept */
+        static size_t const RING_SIZE = 1 << 12;
+
+        static bool enabled() { return enabled_() != 0; }
+        static void enable(bool val);
+
+        /*! writes record to the ring of the calling thread */
+        static void record(const Record& r);
+
+        /*! appends records currently held by all rings to out */
+        static void snapshot(std::vector<Record>& out);
+
+        /*! forgets all recorded points */
+        static void clear();
+
+        /*! name of trace point */
+        static std::string point_name(int point);
+
+        /*! records and per-phase latency histograms as a JSON object */
+        static void dump_json(std::ostream& os);
+
+        /*! records in fixed size little-endian binary form */
+        static void dump_binary(std::ostream& os);
+
+        /*! dumps to file, binary if name ends with ".bin", JSON otherwise */
+        static void dump(const std::string& file_name);
+
+    private:
+
+        static gu::Atomic<int> enabled_;
+    };
+}
+
+#endif // GALERA_TRX_TRACE_HPP
@@ -102,7 +102,11 @@ namespace galera
             F_TOI         = 1 << 2,
             F_PA_UNSAFE   = 1 << 3,
             F_COMMUTATIVE = 1 << 4,
-            F_NATIVE      = 1 << 5
+            F_NATIVE      = 1 << 5,
+            F_NBO_BEGIN   = 1 << 6, /* start of non-blocking TOI */
+            F_NBO_END     = 1 << 7, /* end of non-blocking TOI */
+            F_FRAGMENT    = 1 << 8, /* non-final fragment of a transaction */
+            F_STREAMED    = 1 << 9  /* continues previous fragments */
         };
 
         /* this takes care of converting wsrep API flags to on-the-wire flags */
@@ -494,7 +498,8 @@ namespace galera
                      WriteSetNG::Version     ver      = WriteSetNG::MAX_VERSION,
                      DataSet::Version        dver     = DataSet::MAX_VERSION,
                      DataSet::Version        uver     = DataSet::MAX_VERSION,
-                     size_t                  max_size = WriteSetNG::MAX_SIZE)
+                     size_t                  max_size = WriteSetNG::MAX_SIZE,
+                     gu::Allocator::Arena*   arena    = NULL)
             :
             header_(ver),
             base_name_(dir_name, id),
@@ -502,19 +507,23 @@ namespace galera
             kbn_   (base_name_),
             keys_  (reserved,
                     (reserved_size >>= 6, reserved_size <<= 3, reserved_size),
-                    kbn_, kver),
+                    kbn_, kver, arena),
             /* 5/8 of reserved goes to data set  */
             dbn_   (base_name_),
-            data_  (reserved + reserved_size, reserved_size*5, dbn_, dver),
+            data_  (reserved + reserved_size, reserved_size*5, dbn_, dver,
+                    arena),
             /* 2/8 of reserved goes to unordered set  */
             ubn_   (base_name_),
-            unrd_  (reserved + reserved_size*6, reserved_size*2, ubn_, uver),
+            unrd_  (reserved + reserved_size*6, reserved_size*2, ubn_, uver,
+                    arena),
             /* annotation set is not allocated unless requested */
             abn_   (base_name_),
             annt_  (NULL),
+            arena_ (arena),
             left_  (max_size - keys_.size() - data_.size() - unrd_.size()
                     - header_.size()),
-            flags_ (flags)
+            flags_ (flags),
+            appended_keys_(0)
         {}
 
         ~WriteSetOut() { delete annt_; }
@@ -522,6 +531,27 @@ namespace galera
         void append_key(const KeyData& k)
         {
             left_ -= keys_.append(k);
+            ++appended_keys_;
+        }
+
+        /* appends an array of keys of the same type */
+        void append_keys(int                const proto_ver,
+                         const wsrep_key_t* const keys,
+                         size_t             const count,
+                         wsrep_key_type_t   const type,
+                         bool               const copy)
+        {
+            /* all but leaf parts are usually shared by consecutive keys */
+            if (count > 1) keys_.reserve(count);
+
+            for (size_t i(0); i < count; ++i)
+            {
+                KeyData const k(proto_ver, keys[i].key_parts,
+                                keys[i].key_parts_num, type, copy);
+                left_ -= keys_.append(k);
+            }
+
+            appended_keys_ += count;
         }
 
         void append_data(const void* data, size_t data_len, bool store)
@@ -538,7 +568,8 @@ namespace galera
         {
             if (NULL == annt_)
             {
-                annt_ = new DataSetOut(NULL, 0, abn_, DataSet::MAX_VERSION);
+                annt_ = new DataSetOut(NULL, 0, abn_, DataSet::MAX_VERSION,
+                                       arena_);
                 left_ -= annt_->size();
             }
 
@@ -556,6 +587,15 @@ namespace galera
                      (annt_ ? annt_->count() : 0)) == 0);
         }
 
+        /*! size of keys and data collected so far */
+        size_t payload_size() const
+        {
+            return (keys_.size() + data_.size() + unrd_.size());
+        }
+
+        /*! number of append_key() calls, roughly rows modified */
+        long appended_keys() const { return appended_keys_; }
+
 
         /* !!! This returns header without checksum! *
          *     Use set_last_seen() to finalize it.   */
@@ -653,8 +693,10 @@ namespace galera
         DataSetOut          unrd_;
         BaseNameImpl<annt_suffix> abn_;
         DataSetOut*         annt_;
+        gu::Allocator::Arena* const arena_; // heap page cache, may be NULL
         ssize_t             left_;
         uint16_t            flags_;
+        long                appended_keys_;
 
         void check_size()
         {
@@ -8,6 +8,7 @@
 
 #include "gu_lock.hpp"
 #include "gu_throw.hpp"
+#include "gu_time.h"
 
 
 void galera::Wsdb::print(std::ostream& os) const
@@ -35,6 +36,9 @@ galera::Wsdb::Wsdb()
     trx_pool_  (TrxHandle::LOCAL_STORAGE_SIZE(), 512, "LocalTrxHandle"),
     trx_map_     (),
     conn_trx_map_(),
+    arena_map_   (),
+    trx_thread_map_(),
+    arena_purge_time_(0),
 #ifdef HAVE_PSI_INTERFACE
     trx_mutex_   (WSREP_PFS_INSTR_TAG_WSDB_TRX_MUTEX),
 #else
@@ -65,6 +69,11 @@ galera::Wsdb::~Wsdb()
              conn_trx_map_.end(),
              Unref2nd<ConnTrxMap::value_type>());
 #endif // !NDEBUG
+
+    for (ArenaMap::iterator i(arena_map_.begin()); i != arena_map_.end(); ++i)
+    {
+        i->second.arena_->unref();
+    }
 }
 
 
@@ -95,15 +104,107 @@ galera::Wsdb::find_trx(wsrep_trx_id_t const trx_id)
 }
 
 
+inline galera::Wsdb::ThreadArena&
+galera::Wsdb::thread_arena(pthread_t const id)
+{
+    ThreadArena& ta(arena_map_.insert(std::make_pair(id, ThreadArena()))
+                    .first->second);
+
+    if (0 == ta.arena_)
+    {
+        ta.arena_ = new gu::Allocator::Arena(trx_mem_limit_);
+    }
+
+    return ta;
+}
+
+
+inline void
+galera::Wsdb::release_thread_arena(pthread_t const id)
+{
+    ArenaMap::iterator const i(arena_map_.find(id));
+
+    assert(i != arena_map_.end());
+    if (gu_unlikely(arena_map_.end() == i)) return;
+
+    assert(i->second.trxs_ > 0);
+
+    if (--i->second.trxs_ == 0)
+    {
+        if (gu_unlikely(arena_map_.size() > arena_map_max_))
+        {
+            /* writesets still being replicated hold their own references */
+            i->second.arena_->unref();
+            arena_map_.erase(i);
+        }
+        else
+        {
+            long long const now(gu_time_monotonic());
+            i->second.idle_since_ = now;
+            purge_idle_arenas(now);
+        }
+    }
+}
+
+
+void
+galera::Wsdb::purge_idle_arenas(long long const now)
+{
+    /* scan at most once per idle period, arenas of exited threads
+     * are therefore released after 1-2 periods */
+    if (gu_likely(now < arena_purge_time_)) return;
+
+    arena_purge_time_ = now + arena_idle_period_;
+
+    ArenaMap::iterator i(arena_map_.begin());
+    while (i != arena_map_.end())
+    {
+        ThreadArena& ta(i->second);
+
+        if (0 == ta.trxs_ && now - ta.idle_since_ >= arena_idle_period_)
+        {
+            ta.arena_->unref();
+            i = arena_map_.erase(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+
+size_t
+galera::Wsdb::arena_cache_size()
+{
+    gu::Lock lock(trx_mutex_);
+
+    size_t ret(0);
+
+    for (ArenaMap::const_iterator i(arena_map_.begin());
+         i != arena_map_.end(); ++i)
+    {
+        ret += i->second.arena_->size();
+    }
+
+    return ret;
+}
+
+
 inline galera::TrxHandle*
 galera::Wsdb::create_trx(const TrxHandle::Params& params,
                          const wsrep_uuid_t&  source_id,
                          wsrep_trx_id_t const trx_id)
 {
-    TrxHandle* trx(TrxHandle::New(trx_pool_, params, source_id, -1, trx_id));
+    pthread_t const self(pthread_self());
 
     gu::Lock lock(trx_mutex_);
 
+    ThreadArena& ta(thread_arena(self));
+
+    TrxHandle* trx(TrxHandle::New(trx_pool_, params, source_id, -1, trx_id,
+                                  ta.arena_));
+
     galera::TrxHandle* trx_ref;
     if (trx_id != wsrep_trx_id_t(-1))
     {
@@ -113,17 +214,20 @@ galera::Wsdb::create_trx(const TrxHandle::Params& params,
             (trx_map_.insert(std::make_pair(trx_id, trx)));
         if (gu_unlikely(i.second == false)) gu_throw_fatal;
         trx_ref = i.first->second;
+        trx_thread_map_.insert_unique(std::make_pair(trx_id, self));
     }
     else
     {
         /* trx_id is default so add trx object to connection map
         that is maintained based on pthread_id (alias for connection_id). */
          std::pair<ConnTrxMap::iterator, bool> i
-             (conn_trx_map_.insert(std::make_pair(pthread_self(), trx)));
+             (conn_trx_map_.insert(std::make_pair(self, trx)));
         if (gu_unlikely(i.second == false)) gu_throw_fatal;
         trx_ref = i.first->second;
     }
 
+    ++ta.trxs_;
+
     return (trx_ref);
 }
 
@@ -183,7 +287,8 @@ galera::Wsdb::get_conn_query(const TrxHandle::Params& params,
     if (conn->get_trx() == 0 && create == true)
     {
         TrxHandle* trx
-            (TrxHandle::New(trx_pool_, params, source_id, conn_id, -1));
+            (TrxHandle::New(trx_pool_, params, source_id, conn_id, -1,
+                            conn->arena()));
         conn->assign_trx(trx);
     }
 
@@ -201,6 +306,14 @@ void galera::Wsdb::discard_trx(wsrep_trx_id_t trx_id)
         {
             i->second->unref();
             trx_map_.erase(i);
+
+            TrxThreadMap::iterator const t(trx_thread_map_.find(trx_id));
+            assert(t != trx_thread_map_.end());
+            if (gu_likely(t != trx_thread_map_.end()))
+            {
+                release_thread_arena(t->second);
+                trx_thread_map_.erase(t);
+            }
         }
     }
     else
@@ -211,6 +324,7 @@ void galera::Wsdb::discard_trx(wsrep_trx_id_t trx_id)
         {
             i->second->unref();
             conn_trx_map_.erase(i);
+            release_thread_arena(id);
         }
     }
 }
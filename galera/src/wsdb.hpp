@@ -19,16 +19,24 @@ namespace galera
             Conn(wsrep_conn_id_t conn_id)
                 :
                 conn_id_(conn_id),
-                trx_(0)
+                trx_(0),
+                arena_(new gu::Allocator::Arena(trx_mem_limit_))
             { }
 
             Conn(const Conn& other)
                 :
                 conn_id_(other.conn_id_),
-                trx_(other.trx_)
-            { }
+                trx_(other.trx_),
+                arena_(other.arena_)
+            {
+                arena_->ref();
+            }
 
-            ~Conn() { if (trx_ != 0) trx_->unref(); }
+            ~Conn()
+            {
+                if (trx_ != 0) trx_->unref();
+                arena_->unref();
+            }
 
             void assign_trx(TrxHandle* trx)
             {
@@ -41,10 +49,16 @@ namespace galera
                 return trx_;
             }
 
+            gu::Allocator::Arena* arena()
+            {
+                return arena_;
+            }
+
         private:
             void operator=(const Conn&);
             wsrep_conn_id_t conn_id_;
             TrxHandle* trx_;
+            gu::Allocator::Arena* arena_; // write set pages of conn queries
         };
 
 
@@ -73,6 +87,28 @@ namespace galera
 
         typedef gu::UnorderedMap<pthread_t, TrxHandle*, ConnTrxHash> ConnTrxMap;
 
+        /* Transactions are not bound to Conn objects, so write set pages
+        are recycled through per-thread arenas, with the same pthread_id
+        alias for connection_id as above. An arena outlives the trxs of its
+        thread and is released only after it has stayed idle for
+        arena_idle_period_, so that thread churn does not accumulate arenas.
+        Past arena_map_max_ arenas, an arena is released as soon as it
+        becomes idle. */
+        class ThreadArena
+        {
+        public:
+            ThreadArena() : arena_(0), trxs_(0), idle_since_(0) {}
+            gu::Allocator::Arena* arena_;
+            size_t                trxs_;   // live trxs created by the thread
+            long long             idle_since_; // when trxs_ dropped to 0
+        };
+
+        typedef gu::UnorderedMap<pthread_t, ThreadArena, ConnTrxHash> ArenaMap;
+
+        /* creator threads of trxs in TrxMap, to find their ThreadArena */
+        typedef gu::UnorderedMap<wsrep_trx_id_t, pthread_t, TrxHash>
+        TrxThreadMap;
+
         class ConnHash
         {
         public:
@@ -102,6 +138,9 @@ namespace galera
 
         void print(std::ostream& os) const;
 
+        // Total size of write set pages cached in per-thread arenas
+        size_t arena_cache_size();
+
     private:
         // Find existing trx handle in the map
         TrxHandle* find_trx(wsrep_trx_id_t trx_id);
@@ -113,12 +152,26 @@ namespace galera
 
         Conn*      get_conn(wsrep_conn_id_t conn_id, bool create);
 
-        static const size_t trx_mem_limit_ = 1 << 20;
+        // Arena of the thread, must be called under trx_mutex_
+        ThreadArena& thread_arena(pthread_t id);
+
+        // Drop a trx from thread arena, must be called under trx_mutex_
+        void release_thread_arena(pthread_t id);
+
+        // Release arenas idle for too long, must be called under trx_mutex_
+        void purge_idle_arenas(long long now);
+
+        static const size_t    trx_mem_limit_     = 1 << 20;
+        static const size_t    arena_map_max_     = 256;
+        static const long long arena_idle_period_ = 60 * 1000000000LL; // 60s
 
         TrxHandle::LocalPool trx_pool_;
 
         TrxMap       trx_map_;
         ConnTrxMap   conn_trx_map_;
+        ArenaMap     arena_map_;
+        TrxThreadMap trx_thread_map_;
+        long long    arena_purge_time_;
 #ifdef HAVE_PSI_INTERFACE
         gu::MutexWithPFS
                      trx_mutex_;
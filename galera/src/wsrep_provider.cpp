@@ -457,6 +457,87 @@ wsrep_status_t galera_post_commit (wsrep_t*            gh,
 }
 
 
+/* releases fragments and keys of rolled back streamed trx on all nodes */
+static void
+stream_rollback(REPL_CLASS* const repl, wsrep_ws_handle_t* const ws_handle)
+{
+    TrxHandle* const trx(get_local_trx(repl, ws_handle, true));
+    assert(trx != 0);
+
+    wsrep_status_t retval;
+
+    try
+    {
+        TrxHandleLock lock(*trx);
+        retval = repl->stream_rollback(trx);
+    }
+    catch (std::exception& e)
+    {
+        log_error << e.what();
+        retval = WSREP_NODE_FAIL;
+    }
+
+    discard_local_trx(repl, ws_handle, trx);
+
+    if (retval != WSREP_OK)
+    {
+        log_warn << "Failed to replicate rollback of streamed trx "
+                 << ws_handle->trx_id << ": " << retval
+                 << ", its keys stay locked until this node leaves "
+                 << "primary component";
+    }
+}
+
+
+/* Replicates what trx has collected so far as a fragment. Fragment handle is
+ * discarded and the rest of the transaction is collected in a new one. */
+static wsrep_status_t
+stream_fragment(REPL_CLASS*        const repl,
+                wsrep_ws_handle_t* const ws_handle,
+                TrxHandle*         const trx)
+{
+    wsrep_status_t retval;
+    bool           streamed(false);
+
+    try
+    {
+        TrxHandleLock lock(*trx);
+        streamed = trx->streamed();
+        retval   = repl->stream_fragment(trx);
+        // fragment which was not rolled back is certified on all nodes
+        streamed = (streamed || trx->state() != TrxHandle::S_ROLLED_BACK);
+    }
+    catch (gu::Exception& e)
+    {
+        log_error << e.what();
+
+        if (e.get_errno() == EMSGSIZE)
+            retval = WSREP_SIZE_EXCEEDED;
+        else
+            retval = WSREP_NODE_FAIL;
+    }
+    catch (std::exception& e)
+    {
+        log_error << e.what();
+        retval = WSREP_NODE_FAIL;
+    }
+
+    discard_local_trx(repl, ws_handle, trx);
+
+    TrxHandle* const next(get_local_trx(repl, ws_handle, true));
+
+    if (streamed)
+    {
+        TrxHandleLock lock(*next);
+        next->set_flags(TrxHandle::F_STREAMED);
+    }
+
+    repl->unref_local_trx(next);
+
+    return retval;
+}
+
+
 extern "C"
 wsrep_status_t galera_post_rollback(wsrep_t*            gh,
                                     wsrep_ws_handle_t*  ws_handle)
@@ -474,10 +555,12 @@ wsrep_status_t galera_post_rollback(wsrep_t*            gh,
     }
 
     wsrep_status_t retval;
+    bool           streamed(false);
 
     try
     {
         TrxHandleLock lock(*trx);
+        streamed = trx->streamed();
         retval = repl->post_rollback(trx);
     }
     catch (std::exception& e)
@@ -493,6 +576,8 @@ wsrep_status_t galera_post_rollback(wsrep_t*            gh,
 
     discard_local_trx(repl, ws_handle, trx);
 
+    if (streamed) stream_rollback(repl, ws_handle);
+
     return retval;
 }
 
@@ -543,7 +628,9 @@ wsrep_status_t galera_replicate(wsrep_t*           const gh,
     {
         TrxHandleLock lock(*trx);
         trx->set_conn_id(conn_id);
-        trx->set_flags(TrxHandle::wsrep_flags_to_trx_flags(flags));
+        // continuation of streamed trx stays such
+        trx->set_flags(TrxHandle::wsrep_flags_to_trx_flags(flags) |
+                       (trx->flags() & TrxHandle::F_STREAMED));
 
         retval = repl->replicate(trx, meta);
 
@@ -665,7 +752,9 @@ wsrep_status_t galera_replicate_pre_commit(wsrep_t*           const gh,
         trx->set_conn_id(conn_id);
 //        /* rbr_data should clearly persist over pre_commit() call */
 //        append_data_array (trx, rbr_data, rbr_data_len, false, false);
-        trx->set_flags(TrxHandle::wsrep_flags_to_trx_flags(flags));
+        // continuation of streamed trx stays such
+        trx->set_flags(TrxHandle::wsrep_flags_to_trx_flags(flags) |
+                       (trx->flags() & TrxHandle::F_STREAMED));
 
         retval = repl->replicate(trx, meta);
 
@@ -756,19 +845,14 @@ wsrep_status_t galera_append_key(wsrep_t*           const gh,
     assert(trx != 0);
 
     wsrep_status_t retval;
+    bool           fragment_due(false);
 
     try
     {
         TrxHandleLock lock(*trx);
-        for (size_t i(0); i < keys_num; ++i)
-        {
-            galera::KeyData k (repl->trx_proto_ver(),
-                               keys[i].key_parts,
-                               keys[i].key_parts_num,
-                               key_type,
-                               copy);
-            trx->append_key(k);
-        }
+        trx->append_keys(repl->trx_proto_ver(), keys, keys_num, key_type,
+                         copy);
+        fragment_due = repl->fragment_due(trx);
         retval = WSREP_OK;
     }
     catch (std::exception& e)
@@ -781,6 +865,9 @@ wsrep_status_t galera_append_key(wsrep_t*           const gh,
         log_fatal << "non-standard exception";
         retval = WSREP_FATAL;
     }
+
+    if (fragment_due) return stream_fragment(repl, trx_handle, trx);
+
     repl->unref_local_trx(trx);
 
     return retval;
@@ -810,12 +897,14 @@ wsrep_status_t galera_append_data(wsrep_t*                const wsrep,
     assert(trx != 0);
 
     wsrep_status_t retval;
+    bool           fragment_due(false);
 
     try
     {
         TrxHandleLock lock(*trx);
         if (WSREP_DATA_ORDERED == type)
             append_data_array(trx, data, count, type, copy);
+        fragment_due = repl->fragment_due(trx);
         retval = WSREP_OK;
     }
     catch (std::exception& e)
@@ -829,6 +918,8 @@ wsrep_status_t galera_append_data(wsrep_t*                const wsrep,
         retval = WSREP_FATAL;
     }
 
+    if (fragment_due) return stream_fragment(repl, trx_handle, trx);
+
     repl->unref_local_trx(trx);
 
     return retval;
@@ -921,10 +1012,14 @@ wsrep_status_t galera_to_execute_start(wsrep_t*                const gh,
 
         append_data_array(trx, data, count, WSREP_DATA_ORDERED, false);
 
-        trx->set_flags(TrxHandle::wsrep_flags_to_trx_flags(
+        uint32_t flags(TrxHandle::wsrep_flags_to_trx_flags(
                            WSREP_FLAG_COMMIT |
                            WSREP_FLAG_ISOLATION));
 
+        if (repl->toi_nonblocking()) flags |= TrxHandle::F_NBO_BEGIN;
+
+        trx->set_flags(flags);
+
         retval = repl->replicate(trx, meta);
 
         assert((retval == WSREP_OK && trx->global_seqno() > 0) ||
@@ -960,6 +1055,45 @@ wsrep_status_t galera_to_execute_start(wsrep_t*                const gh,
 }
 
 
+/* replicates end event of non-blocking TOI started by connection */
+static wsrep_status_t
+to_execute_nbo_end(REPL_CLASS* const repl, wsrep_conn_id_t const conn_id)
+{
+    TrxHandle* trx(repl->local_conn_trx(conn_id, true));
+    assert(trx != 0);
+
+    wsrep_status_t retval;
+
+    {
+        TrxHandleLock lock(*trx);
+
+        // no keys: end event must not conflict with anything
+        trx->set_flags(TrxHandle::wsrep_flags_to_trx_flags(
+                           WSREP_FLAG_COMMIT |
+                           WSREP_FLAG_ISOLATION) | TrxHandle::F_NBO_END);
+
+        retval = repl->replicate(trx, 0);
+
+        if (retval == WSREP_OK) retval = repl->to_isolation_begin(trx, 0);
+        if (retval == WSREP_OK) retval = repl->to_isolation_end(trx);
+    }
+
+    repl->discard_local_conn_trx(conn_id);
+
+    if (trx->global_seqno() < 0) trx->unref();
+
+    if (retval != WSREP_OK)
+    {
+        log_warn << "Failed to replicate end of non-blocking TOI for "
+                 << "connection " << conn_id << ": " << retval
+                 << ", its keys stay locked until this node leaves "
+                 << "primary component";
+    }
+
+    return retval;
+}
+
+
 extern "C"
 wsrep_status_t galera_to_execute_end(wsrep_t*        const gh,
                                      wsrep_conn_id_t const conn_id)
@@ -974,11 +1108,16 @@ wsrep_status_t galera_to_execute_end(wsrep_t*        const gh,
 
     try
     {
-        TrxHandleLock lock(*trx);
-        repl->to_isolation_end(trx);
-        repl->discard_local_conn_trx(conn_id);
-        return WSREP_OK;
-        // trx will be unreferenced (destructed) during purge
+        bool nbo_begin;
+        {
+            TrxHandleLock lock(*trx);
+            nbo_begin = trx->nbo_begin();
+            repl->to_isolation_end(trx);
+            repl->discard_local_conn_trx(conn_id);
+            // trx will be unreferenced (destructed) during purge
+        }
+
+        return (nbo_begin ? to_execute_nbo_end(repl, conn_id) : WSREP_OK);
     }
     catch (std::exception& e)
     {
@@ -1027,6 +1166,54 @@ galera_preordered_collect (wsrep_t* const gh,
 }
 
 
+/*!
+ * Galera extension to the preordered API: adds certification keys to the
+ * writeset being collected in handle. Writesets with keys are certified
+ * against each other and against local traffic and applied in parallel
+ * according to their keys, those without keys fall back to pa_range.
+ *
+ * It is not a member of wsrep_t (that would break the interface), so event
+ * feeders look it up by name in the provider library they loaded:
+ *
+ * typedef wsrep_status_t (*preordered_append_key_t)(wsrep_t*,
+ *     wsrep_po_handle_t*, const wsrep_key_t*, size_t, wsrep_key_type_t,
+ *     wsrep_bool_t);
+ *
+ * preordered_append_key_t const append_key(
+ *     (preordered_append_key_t)dlsym(dlh, "galera_preordered_append_key"));
+ */
+extern "C" wsrep_status_t
+galera_preordered_append_key (wsrep_t*           const gh,
+                              wsrep_po_handle_t* const handle,
+                              const wsrep_key_t* const keys,
+                              size_t             const count,
+                              wsrep_key_type_t   const type,
+                              wsrep_bool_t       const copy)
+{
+    assert(gh != 0);
+    assert(gh->ctx != 0);
+    assert(handle != 0);
+    assert(keys != 0 || 0 == count);
+
+    REPL_CLASS * repl(reinterpret_cast< REPL_CLASS * >(gh->ctx));
+
+    try
+    {
+        return repl->preordered_append_key(*handle, keys, count, type, copy);
+    }
+    catch (std::exception& e)
+    {
+        log_warn << e.what();
+        return WSREP_TRX_FAIL;
+    }
+    catch (...)
+    {
+        log_fatal << "non-standard exception";
+        return WSREP_FATAL;
+    }
+}
+
+
 extern "C" wsrep_status_t
 galera_preordered_commit (wsrep_t* const gh,
                           wsrep_po_handle_t*      const handle,
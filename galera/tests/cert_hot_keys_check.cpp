@@ -0,0 +1,146 @@
+/* Copyright (C) 2015 Codership Oy <info@codership.com>
+ */
+
+#undef NDEBUG
+
+#include "../src/cert_hot_keys.hpp"
+
+#include "gu_logger.hpp"
+
+#include <check.h>
+
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+using namespace galera;
+
+namespace
+{
+    // serialized annotated key parts "db/tN"
+    class TestKeys
+    {
+    public:
+
+        TestKeys(size_t n, size_t name_len = 12)
+            : bufs_(n)
+        {
+            for (size_t i(0); i < n; ++i)
+            {
+                std::ostringstream os;
+                os << 't' << i;
+                std::string name(os.str());
+                name.resize(std::max(name.size(), name_len), '_');
+
+                wsrep_buf_t const parts[2] =
+                    { { "db", 2 }, { name.data(), name.size() } };
+
+                KeySet::KeyPart::HashData hd;
+                ::memset(hd.buf, 0, sizeof(hd.buf));
+                ::memcpy(hd.buf + 1, &i, sizeof(i));
+
+                KeySet::KeyPart kp(tmp_, hd, KeySet::FLAT8A, true, parts, 1);
+
+                bufs_[i].assign(kp.ptr(), kp.ptr() + kp.serial_size());
+            }
+        }
+
+        KeySet::KeyPart operator[] (size_t i) const
+        {
+            return KeySet::KeyPart(&bufs_[i][0], bufs_[i].size());
+        }
+
+    private:
+
+        KeySet::KeyPart::TmpStore            tmp_;
+        std::vector<std::vector<gu::byte_t> > bufs_;
+    };
+}
+
+START_TEST(test_cert_hot_keys_basic)
+{
+    size_t const cap(64);
+    CertHotKeys  hk(cap);
+    TestKeys     keys(1000);
+
+    // keys 0, 1, 2 are hot, the rest is a long uniform tail
+    unsigned int seed(1);
+    size_t       n(0);
+    for (size_t round(0); round < 20; ++round)
+    {
+        for (size_t i(0); i < 1000; ++i)
+        {
+            size_t const k(rand_r(&seed) % 1000);
+            hk.record(keys[k]);      ++n;
+            if (i % 5  == 0) { hk.record(keys[0]); ++n; }
+            if (i % 10 == 0) { hk.record(keys[1]); ++n; }
+            if (i % 20 == 0) { hk.record(keys[2]); ++n; }
+        }
+    }
+
+    fail_if(hk.size() != cap, "size %zu", hk.size());
+    fail_if(hk.total() != n);
+
+    // true counts are at least the deterministic part
+    uint64_t const expected[3] = { 4000, 2000, 1000 };
+    for (size_t i(0); i < 3; ++i)
+    {
+        uint64_t err;
+        uint64_t const cnt(hk.count(keys[i], &err));
+        fail_if(cnt < expected[i], "key %zu count %llu < %llu",
+                i, (unsigned long long)cnt, (unsigned long long)expected[i]);
+        fail_if(cnt - err > expected[i] + 100, "key %zu count %llu err %llu",
+                i, (unsigned long long)cnt, (unsigned long long)err);
+        // max overestimation is bounded by total/capacity
+        fail_if(err > n / cap);
+    }
+
+    std::ostringstream os;
+    hk.print(os, 3);
+    std::string const out(os.str());
+    log_info << "hot keys: " << out;
+
+    size_t const p0(out.find("t.0._"));
+    size_t const p1(out.find("t.1._"));
+    size_t const p2(out.find("t.2._"));
+    fail_if(p0 == std::string::npos || p1 == std::string::npos ||
+            p2 == std::string::npos, "'%s'", out.c_str());
+    fail_if(!(p0 < p1 && p1 < p2), "wrong order: '%s'", out.c_str());
+
+    hk.reset(0);
+    hk.record(keys[0]);
+    fail_if(hk.size() != 0);
+    fail_if(hk.total() != 0);
+}
+END_TEST
+
+START_TEST(test_cert_hot_keys_long_annotation)
+{
+    CertHotKeys hk(4);
+    TestKeys    keys(2, 200);
+
+    hk.record(keys[1]);
+    fail_if(hk.count(keys[1]) != 1);
+
+    // annotation does not fit and is dropped, hash is preserved
+    std::ostringstream os;
+    hk.print(os, 4);
+    fail_if(os.str().find("t.1._") != std::string::npos, "'%s'",
+            os.str().c_str());
+    fail_if(os.str().find("FLAT8)") == std::string::npos, "'%s'",
+            os.str().c_str());
+}
+END_TEST
+
+Suite* cert_hot_keys_suite()
+{
+    Suite* s = suite_create ("cert_hot_keys");
+    TCase* tc;
+
+    tc = tcase_create ("cert_hot_keys");
+    tcase_add_test  (tc, test_cert_hot_keys_basic);
+    tcase_add_test  (tc, test_cert_hot_keys_long_annotation);
+    suite_add_tcase (s, tc);
+
+    return s;
+}
@@ -0,0 +1,157 @@
+/* Copyright (C) 2015 Codership Oy <info@codership.com>
+ */
+
+#undef NDEBUG
+
+#include "../src/cert_index_ng.hpp"
+
+#include "gu_logger.hpp"
+
+#include <check.h>
+
+#include <cstdlib>
+#include <vector>
+
+using namespace galera;
+
+namespace
+{
+    // serialized key parts for test keys, KeyPart only points to them
+    class TestKeys
+    {
+    public:
+
+        TestKeys(size_t n, KeySet::Version ver, unsigned int seed)
+            : bufs_(n)
+        {
+            for (size_t i(0); i < n; ++i)
+            {
+                KeySet::KeyPart::HashData hd;
+                for (size_t j(0); j < sizeof(hd.buf); ++j)
+                {
+                    hd.buf[j] = rand_r(&seed);
+                }
+                KeySet::KeyPart kp(tmp_, hd, ver, i % 2, 0, 0);
+                std::copy(tmp_.buf, tmp_.buf + sizeof(bufs_[i].buf),
+                          bufs_[i].buf);
+            }
+        }
+
+        KeySet::KeyPart operator[] (size_t i) const
+        {
+            return KeySet::KeyPart(bufs_[i].buf, sizeof(bufs_[i].buf));
+        }
+
+        size_t size() const { return bufs_.size(); }
+
+    private:
+
+        struct Buf { gu::byte_t buf[KeySet::KeyPart::MAX_HASH_SIZE]; };
+
+        KeySet::KeyPart::TmpStore tmp_;
+        std::vector<Buf>          bufs_;
+    };
+}
+
+START_TEST(test_cert_index_ng_basic)
+{
+    CertIndexNG ci;
+    TestKeys    keys(100000, KeySet::FLAT16, 1);
+    TrxHandle*  const trx(reinterpret_cast<TrxHandle*>(&ci));
+
+    fail_if(ci.size() != 0);
+    fail_if(ci.mem_usage() != 0);
+
+    for (size_t i(0); i < keys.size(); ++i)
+    {
+        fail_if(ci.find(keys[i]) != 0, "key %zu found before insert", i);
+        ci.insert(keys[i])->ref(keys[i].prefix(), trx);
+    }
+
+    fail_if(ci.size() != keys.size());
+    fail_if(ci.mem_usage() < keys.size() * sizeof(KeyEntryNG));
+
+    for (size_t i(0); i < keys.size(); ++i)
+    {
+        KeyEntryNG* const ke(ci.find(keys[i]));
+        fail_if(ke == 0, "key %zu not found", i);
+        fail_if(ke->ref_trx(keys[i].prefix()) != trx);
+    }
+
+    // erase every other key, interleaved with inserts of new ones
+    TestKeys more(keys.size()/2, KeySet::FLAT16, 2);
+    for (size_t i(0); i < keys.size(); i += 2)
+    {
+        KeyEntryNG* const ke(ci.find(keys[i]));
+        fail_if(ke == 0, "key %zu not found", i);
+        ke->unref(keys[i].prefix(), trx);
+        ci.erase(ke);
+        ci.insert(more[i/2]);
+    }
+
+    fail_if(ci.size() != keys.size());
+
+    for (size_t i(0); i < keys.size(); ++i)
+    {
+        fail_if((ci.find(keys[i]) == 0) != (i % 2 == 0),
+                "key %zu lookup mismatch", i);
+    }
+    for (size_t i(0); i < more.size(); ++i)
+    {
+        fail_if(ci.find(more[i]) == 0, "new key %zu not found", i);
+    }
+
+    size_t const peak_mem(ci.mem_usage());
+
+    for (size_t i(1); i < keys.size(); i += 2)
+    {
+        KeyEntryNG* const ke(ci.find(keys[i]));
+        ke->unref(keys[i].prefix(), trx);
+        ci.erase(ke);
+    }
+    for (size_t i(0); i < more.size(); ++i)
+    {
+        ci.erase(ci.find(more[i]));
+    }
+
+    fail_if(ci.size() != 0);
+    fail_if(ci.mem_usage() >= peak_mem, "index did not shrink: %zu",
+            ci.mem_usage());
+
+    ci.clear();
+    fail_if(ci.mem_usage() != 0);
+}
+END_TEST
+
+START_TEST(test_cert_index_ng_mixed_width)
+{
+    CertIndexNG ci;
+    TestKeys    wide(1, KeySet::FLAT16, 3);
+    TestKeys    narrow(1, KeySet::FLAT8, 3);
+
+    // same first hash word: must match as KeyPart::matches() does
+    fail_if(!wide[0].matches(narrow[0]));
+
+    KeyEntryNG* const ke(ci.insert(wide[0]));
+    fail_if(ci.find(narrow[0]) != ke);
+
+    ci.erase(ke);
+    ci.insert(narrow[0]);
+    fail_if(ci.find(wide[0]) == 0);
+    fail_if(ci.size() != 1);
+}
+END_TEST
+
+Suite* cert_index_ng_suite()
+{
+    Suite* s = suite_create ("cert_index_ng");
+    TCase* tc;
+
+    tc = tcase_create ("cert_index_ng");
+    tcase_add_test  (tc, test_cert_index_ng_basic);
+    tcase_add_test  (tc, test_cert_index_ng_mixed_width);
+    tcase_set_timeout(tc, 60);
+    suite_add_tcase (s, tc);
+
+    return s;
+}
@@ -11,8 +11,14 @@
 #include "GCache.hpp"
 #include "gu_arch.h"
 #include "replicator_smm.hpp"
+#include "gu_uri.hpp"
 #include <check.h>
 
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+
 using namespace galera;
 
 // Message tests
@@ -59,6 +65,24 @@ START_TEST(test_ist_message)
     fail_unless(mu4.flags()   == 0x2);
     fail_unless(mu4.ctrl()    == 3);
     fail_unless(mu4.len()     == 1001);
+
+    Trx m8(8, 1001, 5, 3);
+    fail_unless(m8.serial_size() == 28);
+
+    buf.clear();
+    buf.resize(m8.serial_size());
+    fail_unless(m8.serialize(&buf[0], buf.size(), 0) == buf.size());
+
+    Message mu8(8);
+    size_t const offset(mu8.unserialize(&buf[0], buf.size(), 0));
+    fail_unless(mu8.type()    == Message::T_TRX);
+    fail_unless(mu8.len()     == 1001);
+
+    Trx tu8(mu8.version(), mu8.len());
+    fail_unless(tu8.unserialize_meta(&buf[0], buf.size(), offset) ==
+                buf.size());
+    fail_unless(tu8.seqno_g() == 5);
+    fail_unless(tu8.seqno_d() == 3);
 }
 END_TEST
 
@@ -92,16 +116,18 @@ struct sender_args
     wsrep_seqno_t first_;
     wsrep_seqno_t last_;
     int version_;
+    int compress_;
     sender_args(gcache::GCache& gcache,
                 const std::string& peer,
                 wsrep_seqno_t first, wsrep_seqno_t last,
-                int version)
+                int version, int compress)
         :
         gcache_(gcache),
         peer_  (peer),
         first_ (first),
         last_  (last),
-        version_(version)
+        version_(version),
+        compress_(compress)
     { }
 };
 
@@ -113,17 +139,20 @@ struct receiver_args
     wsrep_seqno_t last_;
     size_t        n_receivers_;
     TrxHandle::SlavePool& trx_pool_;
+    gcache::GCache& gcache_;
     int           version_;
 
     receiver_args(const std::string listen_addr,
                   wsrep_seqno_t first, wsrep_seqno_t last,
-                  size_t n_receivers, TrxHandle::SlavePool& sp, int version)
+                  size_t n_receivers, TrxHandle::SlavePool& sp,
+                  gcache::GCache& gcache, int version)
         :
         listen_addr_(listen_addr),
         first_      (first),
         last_       (last),
         n_receivers_(n_receivers),
         trx_pool_   (sp),
+        gcache_     (gcache),
         version_    (version)
     { }
 };
@@ -131,10 +160,12 @@ struct receiver_args
 struct trx_thread_args
 {
     galera::ist::Receiver& receiver_;
+    gcache::GCache& gcache_;
     galera::Monitor<TestOrder> monitor_;
-    trx_thread_args(galera::ist::Receiver& receiver)
+    trx_thread_args(galera::ist::Receiver& receiver, gcache::GCache& gcache)
         :
         receiver_(receiver),
+        gcache_  (gcache),
 #ifdef HAVE_PSI_INTERFACE
         monitor_(WSREP_PFS_INSTR_TAG_IST_RECEIVER_MONITOR_MUTEX,
                  WSREP_PFS_INSTR_TAG_IST_RECEIVER_MONITOR_CONDVAR)
@@ -152,6 +183,7 @@ extern "C" void* sender_thd(void* arg)
 
     gu::Config conf;
     galera::ReplicatorSMM::InitConfig(conf, NULL, NULL);
+    conf.set("ist.compress", sargs->compress_);
     pthread_barrier_wait(&start_barrier);
     galera::ist::Sender sender(conf, sargs->gcache_, sargs->peer_,
                                sargs->version_);
@@ -178,6 +210,8 @@ extern "C" void* trx_thread(void* arg)
         }
         TestOrder to(*trx);
         targs->monitor_.enter(to);
+        // release applied write set buffer in order, like recv_IST() does
+        targs->gcache_.free(const_cast<void*>(trx->action()));
         targs->monitor_.leave(to);
         trx->unref();
     }
@@ -196,14 +230,14 @@ extern "C" void* receiver_thd(void* arg)
     mark_point();
 
     conf.set(galera::ist::Receiver::RECV_ADDR, rargs->listen_addr_);
-    galera::ist::Receiver receiver(conf, rargs->trx_pool_, 0);
+    galera::ist::Receiver receiver(conf, rargs->gcache_, rargs->trx_pool_, 0);
     rargs->listen_addr_ = receiver.prepare(rargs->first_, rargs->last_,
                                            rargs->version_);
 
     mark_point();
 
     std::vector<pthread_t> threads(rargs->n_receivers_);
-    trx_thread_args trx_thd_args(receiver);
+    trx_thread_args trx_thd_args(receiver, rargs->gcache_);
     for (size_t i(0); i < threads.size(); ++i)
     {
         log_info << "starting trx thread " << i;
@@ -225,6 +259,144 @@ extern "C" void* receiver_thd(void* arg)
 }
 
 
+// TCP proxy between sender and receiver which breaks the first connection
+// after cut_ bytes from sender, the following one is forwarded as is
+struct proxy_args
+{
+    int                fd_;     // listening socket
+    const std::string& target_; // receiver address
+    size_t             cut_;
+    int                conns_;  // accepted connections
+    proxy_args(int fd, const std::string& target, size_t cut)
+        :
+        fd_    (fd),
+        target_(target),
+        cut_   (cut),
+        conns_ (0)
+    { }
+};
+
+static int proxy_listen(std::string& addr)
+{
+    int const fd(socket(AF_INET, SOCK_STREAM, 0));
+    fail_if(fd < 0);
+
+    struct sockaddr_in sa;
+    socklen_t sa_len(sizeof(sa));
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family      = AF_INET;
+    sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    sa.sin_port        = 0;
+    fail_if(bind(fd, reinterpret_cast<struct sockaddr*>(&sa), sa_len));
+    fail_if(listen(fd, 4));
+    fail_if(getsockname(fd, reinterpret_cast<struct sockaddr*>(&sa),
+                        &sa_len));
+
+    addr = "tcp://127.0.0.1:" + gu::to_string(ntohs(sa.sin_port));
+    return fd;
+}
+
+static int proxy_connect(const std::string& addr)
+{
+    gu::URI const uri(addr);
+    int const fd(socket(AF_INET, SOCK_STREAM, 0));
+    if (fd < 0) return fd;
+
+    struct sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port   = htons(gu::from_string<unsigned short>(uri.get_port()));
+    inet_pton(AF_INET, uri.get_host().c_str(), &sa.sin_addr);
+
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&sa), sizeof(sa)))
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static bool proxy_write(int const fd, const char* buf, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t const n(send(fd, buf, len, MSG_NOSIGNAL));
+        if (n <= 0) return false;
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+// forwards data until either side closes or limit bytes from sender
+// were forwarded, 0 - no limit
+static void proxy_forward(int const sender, int const receiver,
+                          size_t const limit)
+{
+    struct pollfd pfd[2];
+    pfd[0].fd     = sender;
+    pfd[0].events = POLLIN;
+    pfd[1].fd     = receiver;
+    pfd[1].events = POLLIN;
+
+    char   buf[4096];
+    size_t forwarded(0);
+
+    while (limit == 0 || forwarded < limit)
+    {
+        if (poll(pfd, 2, -1) <= 0) break;
+
+        if (pfd[0].revents)
+        {
+            size_t const len(limit == 0 ? sizeof(buf) :
+                             std::min(sizeof(buf), limit - forwarded));
+            ssize_t const n(read(sender, buf, len));
+            if (n <= 0 || !proxy_write(receiver, buf, n)) break;
+            forwarded += n;
+        }
+
+        if (pfd[1].revents)
+        {
+            ssize_t const n(read(receiver, buf, sizeof(buf)));
+            if (n <= 0 || !proxy_write(sender, buf, n)) break;
+        }
+    }
+
+    log_info << "proxy forwarded " << forwarded << " bytes from sender";
+    close(sender);
+    close(receiver);
+}
+
+extern "C" void* proxy_thd(void* arg)
+{
+    proxy_args* pargs(reinterpret_cast<proxy_args*>(arg));
+
+    pthread_barrier_wait(&start_barrier);
+
+    for (size_t cut(pargs->cut_); ; cut = 0)
+    {
+        int const s(accept(pargs->fd_, 0, 0));
+        if (s < 0) break;
+        ++pargs->conns_;
+
+        int const r(proxy_connect(pargs->target_));
+        if (r < 0)
+        {
+            close(s);
+            break;
+        }
+
+        proxy_forward(s, r, cut);
+
+        if (0 == cut) break;
+    }
+
+    close(pargs->fd_);
+    return 0;
+}
+
+
 static int select_trx_version(int protocol_version)
 {
     // see protocol version table in replicator_smm.hpp
@@ -237,6 +409,9 @@ static int select_trx_version(int protocol_version)
     case 4:
         return 2;
     case 5:
+    case 6:
+    case 7:
+    case 8:
         return 3;
     }
     fail("unknown protocol version %i", protocol_version);
@@ -244,7 +419,11 @@ static int select_trx_version(int protocol_version)
 }
 
 
-static void test_ist_common(int const version)
+// recv_first > 1 makes receiver to report that it has write sets before it,
+// cut > 0 breaks connection after that many bytes from sender
+static void test_ist_common(int const version, int const compress = 0,
+                            wsrep_seqno_t const recv_first = 1,
+                            size_t const cut = 0)
 {
     using galera::KeyData;
     using galera::TrxHandle;
@@ -327,13 +506,24 @@ static void test_ist_common(int const version)
 
     mark_point();
 
-    receiver_args rargs(receiver_addr, 1, 10, 1, sp, version);
-    sender_args sargs(*gcache, rargs.listen_addr_, 1, 10, version);
+    std::string joiner_gcache_file("ist_check_joiner.cache");
+    conf.set("gcache.name", joiner_gcache_file);
+    gcache::GCache* joiner_gcache = new gcache::GCache(conf, dir);
+
+    receiver_args rargs(receiver_addr, recv_first, 10, 1, sp, *joiner_gcache,
+                        version);
+    std::string proxy_addr;
+    proxy_args pargs(cut > 0 ? proxy_listen(proxy_addr) : -1,
+                     rargs.listen_addr_, cut);
+    sender_args sargs(*gcache, cut > 0 ? proxy_addr : rargs.listen_addr_,
+                      1, 10, version, compress);
 
-    pthread_barrier_init(&start_barrier, 0, 1 + 1 + rargs.n_receivers_);
+    pthread_barrier_init(&start_barrier, 0,
+                         1 + 1 + rargs.n_receivers_ + (cut > 0));
 
-    pthread_t sender_thread, receiver_thread;
+    pthread_t sender_thread, receiver_thread, proxy_thread;
 
+    if (cut > 0) pthread_create(&proxy_thread, 0, &proxy_thd, &pargs);
     pthread_create(&sender_thread, 0, &sender_thd, &sargs);
     mark_point();
     usleep(100000);
@@ -342,13 +532,51 @@ static void test_ist_common(int const version)
 
     pthread_join(sender_thread, 0);
     pthread_join(receiver_thread, 0);
+    if (cut > 0)
+    {
+        pthread_join(proxy_thread, 0);
+        fail_if(pargs.conns_ != 2, "sender connected %d times",
+                pargs.conns_);
+    }
 
     mark_point();
 
+    // received write sets must be in joiner cache, same as in donor's
+    fail_if(joiner_gcache->seqno_min() != recv_first,
+            "joiner cache seqno_min: %lld",
+            (long long)joiner_gcache->seqno_min());
+
+    for (wsrep_seqno_t i(recv_first); i <= 10; ++i)
+    {
+        int64_t seqno_d, donor_seqno_d;
+        ssize_t size, donor_size;
+        const void* const ptr(joiner_gcache->seqno_get_ptr(i, seqno_d, size));
+        const void* const donor_ptr(gcache->seqno_get_ptr(i, donor_seqno_d,
+                                                          donor_size));
+        fail_if(0 == ptr);
+        fail_if(seqno_d != donor_seqno_d, "seqno %lld: seqno_d %lld != %lld",
+                (long long)i, (long long)seqno_d, (long long)donor_seqno_d);
+        fail_if(trx_version < 3 &&
+                (size != donor_size || memcmp(ptr, donor_ptr, size)),
+                "seqno %lld: joiner copy differs from donor's", (long long)i);
+    }
+
+    joiner_gcache->seqno_unlock();
+    gcache->seqno_unlock();
+
+    // applied write sets must not pin joiner cache: all received buffers
+    // are released and history can be discarded
+    gu::UUID const gid(0, 0);
+    joiner_gcache->seqno_reset(gid, 10);
+    fail_if(joiner_gcache->seqno_min() != -1, "joiner cache seqno_min: %lld",
+            (long long)joiner_gcache->seqno_min());
+
+    delete joiner_gcache;
     delete gcache;
 
     mark_point();
     unlink(gcache_file.c_str());
+    unlink(joiner_gcache_file.c_str());
 }
 
 
@@ -385,6 +613,30 @@ START_TEST(test_ist_v5)
 }
 END_TEST
 
+START_TEST(test_ist_v8)
+{
+    test_ist_common(8);
+}
+END_TEST
+
+START_TEST(test_ist_v8_compress)
+{
+    test_ist_common(8, 1);
+}
+END_TEST
+
+START_TEST(test_ist_v8_resume)
+{
+    test_ist_common(8, 0, 4);
+}
+END_TEST
+
+START_TEST(test_ist_v8_broken)
+{
+    test_ist_common(8, 0, 1, 256);
+}
+END_TEST
+
 Suite* ist_suite()
 {
     Suite* s  = suite_create("ist");
@@ -419,5 +671,25 @@ Suite* ist_suite()
     tcase_add_test(tc, test_ist_v5);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("test_ist_v8");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_v8);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_ist_v8_compress");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_v8_compress);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_ist_v8_resume");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_v8_resume);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_ist_v8_broken");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_v8_broken);
+    suite_add_tcase(s, tc);
+
     return s;
 }
@@ -0,0 +1,899 @@
+//
+// Copyright (C) 2015 Codership Oy <info@codership.com>
+//
+
+//
+// In-process multi-node replication benchmark.
+//
+// Loads wsrep provider library and starts a cluster of N provider instances
+// on loopback in a single process. Each node runs a number of synthetic
+// client threads which generate writesets with configurable key count,
+// conflict probability and payload size, and a number of applier threads
+// which receive and "apply" replicated writesets. At the end of the run
+// throughput, commit latency percentiles, certification failures and
+// flow control statistics are reported.
+//
+// With one or more -A options the benchmark is repeated for each given
+// thread placement (a value of thread.affinity provider option) and
+// throughput of the placements is compared at the end. "-A topology"
+// stands for a set of placements derived from NUMA topology of the host.
+//
+// Example:
+//   replication_bench -p ./libgalera_smm.so -n 3 -c 8 -t 10 -k 4 -x 0.01
+//   replication_bench -n 2 -c 8 -A topology -A "gcomm:0 gcs_recv:0"
+//
+
+#include "wsrep_api.h"
+
+#include "gu_atomic.hpp"
+#include "gu_lock.hpp"
+#include "gu_logger.hpp"
+#include "gu_throw.hpp"
+#include "gu_time.h"
+#include "gu_datetime.hpp"
+#include "gu_thread.hpp"
+#include "gu_utils.hpp"
+
+#include <dlfcn.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    typedef int (*wsrep_loader_fun)(wsrep_t*);
+
+    // Thread placement to benchmark, affinity is a value of
+    // thread.affinity provider option, empty for no pinning
+    struct Placement
+    {
+        Placement(const std::string& n, const std::string& a)
+            : name(n), affinity(a)
+        { }
+
+        std::string name;
+        std::string affinity;
+    };
+
+    struct BenchConf
+    {
+        BenchConf()
+            :
+            provider  ("./libgalera_smm.so"),
+            dir       ("/tmp/replication_bench"),
+            options   (),
+            nodes     (3),
+            clients   (4),
+            appliers  (4),
+            duration  (10),
+            keys      (4),
+            hot_keys  (16),
+            conflict  (0.0),
+            payload   (256),
+            apply_usec(0),
+            port      (14567),
+            verbose   (false),
+            placements()
+        { }
+
+        std::string provider;
+        std::string dir;
+        std::string options;
+        int         nodes;
+        int         clients;     // client threads per node
+        int         appliers;    // applier threads per node
+        int         duration;    // seconds
+        int         keys;        // keys per writeset
+        int         hot_keys;    // size of the contended key set
+        double      conflict;    // probability of a key to be a hot one
+        int         payload;     // writeset payload bytes
+        int         apply_usec;  // simulated apply cost
+        int         port;        // base port, each node uses port + 10*idx
+        bool        verbose;
+        std::vector<Placement> placements;
+    };
+
+    BenchConf conf;
+
+    bool verbose_log(false);
+
+    void logger_cb(wsrep_log_level_t level, const char* msg)
+    {
+        if (level <= WSREP_LOG_WARN || verbose_log)
+        {
+            std::cerr << msg << std::endl;
+        }
+    }
+
+    class Node;
+
+    // Context passed to provider as recv_ctx for both appliers and
+    // client replays
+    struct Ctx
+    {
+        Ctx(Node& n) : node(n) { }
+        Node& node;
+    };
+
+    class Node
+    {
+    public:
+
+        Node(int idx, wsrep_loader_fun loader)
+            :
+            idx_       (idx),
+            wsrep_     (),
+            mutex_     (),
+            cond_      (),
+            synced_    (false),
+            stopping_  (false),
+            appliers_  (),
+            applied_   (0),
+            app_ctx_   (*this)
+        {
+            memset(&wsrep_, 0, sizeof(wsrep_));
+            int const err(loader(&wsrep_));
+            if (err != 0)
+            {
+                gu_throw_error(err) << "Failed to load wsrep provider";
+            }
+        }
+
+        ~Node()
+        {
+            if (wsrep_.free) wsrep_.free(&wsrep_);
+        }
+
+        wsrep_t* wsrep() { return &wsrep_; }
+        int      idx() const { return idx_; }
+
+        void start(const std::string& base_dir, int base_port,
+                   const std::string& affinity)
+        {
+            std::string const dir(base_dir + "/node" + gu::to_string(idx_));
+            if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST)
+            {
+                gu_throw_error(errno) << "Failed to create " << dir;
+            }
+
+            int const port(base_port + 10*idx_);
+            std::ostringstream opts;
+            opts << "base_dir=" << dir
+                 << "; gmcast.listen_addr=tcp://127.0.0.1:" << port
+                 << "; ist.recv_addr=127.0.0.1:" << port + 1
+                 << "; pc.recovery=false";
+            if (affinity.empty() == false)
+            {
+                opts << "; " << gu::conf::thread_affinity << '=' << affinity;
+            }
+            if (conf.options.empty() == false)
+            {
+                opts << "; " << conf.options;
+            }
+            std::string const options(opts.str());
+            std::string const name("bench" + gu::to_string(idx_));
+
+            wsrep_gtid_t const state_id = { WSREP_UUID_UNDEFINED,
+                                            WSREP_SEQNO_UNDEFINED };
+
+            struct wsrep_init_args args;
+            memset(&args, 0, sizeof(args));
+            args.app_ctx         = &app_ctx_;
+            args.node_name       = name.c_str();
+            args.node_address    = "127.0.0.1";
+            args.node_incoming   = "";
+            args.data_dir        = dir.c_str();
+            args.options         = options.c_str();
+            args.proto_ver       = 127;
+            args.state_id        = &state_id;
+            args.state           = 0;
+            args.state_len       = 0;
+            args.logger_cb       = logger_cb;
+            args.view_handler_cb = view_cb;
+            args.apply_cb        = apply_cb;
+            args.commit_cb       = commit_cb;
+            args.unordered_cb    = unordered_cb;
+            args.sst_donate_cb   = sst_donate_cb;
+            args.synced_cb       = synced_cb;
+
+            if (wsrep_.init(&wsrep_, &args) != WSREP_OK)
+            {
+                gu_throw_fatal << "Failed to init node " << idx_;
+            }
+
+            std::string const url(idx_ == 0 ? "gcomm://" :
+                                  "gcomm://127.0.0.1:" +
+                                  gu::to_string(base_port));
+            if (wsrep_.connect(&wsrep_, "replication_bench", url.c_str(), "",
+                               idx_ == 0) != WSREP_OK)
+            {
+                gu_throw_fatal << "Failed to connect node " << idx_;
+            }
+
+            for (int i(0); i < conf.appliers; ++i)
+            {
+                pthread_t t;
+                int const err(pthread_create(&t, 0, applier_thd, this));
+                if (err != 0)
+                {
+                    gu_throw_error(err) << "Failed to start applier";
+                }
+                appliers_.push_back(t);
+            }
+        }
+
+        void wait_synced()
+        {
+            gu::Lock lock(mutex_);
+            while (synced_ == false) lock.wait(cond_);
+        }
+
+        void stop()
+        {
+            stopping_ = true;
+            wsrep_.disconnect(&wsrep_);
+            for (size_t i(0); i < appliers_.size(); ++i)
+            {
+                pthread_join(appliers_[i], 0);
+            }
+            appliers_.clear();
+        }
+
+        long long applied() const { return applied_(); }
+
+        // Returns integer stats variable value or -1 if not found
+        long long stat(const char* name)
+        {
+            long long ret(-1);
+            struct wsrep_stats_var* const vars(wsrep_.stats_get(&wsrep_));
+            for (struct wsrep_stats_var* v(vars); v && v->name; ++v)
+            {
+                if (strcmp(v->name, name) == 0 && v->type == WSREP_VAR_INT64)
+                {
+                    ret = v->value._int64;
+                    break;
+                }
+            }
+            wsrep_.stats_free(&wsrep_, vars);
+            return ret;
+        }
+
+        // Returns string stats variable value or empty string if not found
+        std::string str_stat(const char* name)
+        {
+            std::string ret;
+            struct wsrep_stats_var* const vars(wsrep_.stats_get(&wsrep_));
+            for (struct wsrep_stats_var* v(vars); v && v->name; ++v)
+            {
+                if (strcmp(v->name, name) == 0 &&
+                    v->type == WSREP_VAR_STRING && v->value._string)
+                {
+                    ret = v->value._string;
+                    break;
+                }
+            }
+            wsrep_.stats_free(&wsrep_, vars);
+            return ret;
+        }
+
+    private:
+
+        Node(const Node&);
+        Node& operator=(const Node&);
+
+        static Node& node(void* ctx)
+        {
+            return static_cast<Ctx*>(ctx)->node;
+        }
+
+        static void* applier_thd(void* arg)
+        {
+            Node& n(*static_cast<Node*>(arg));
+            Ctx ctx(n);
+            wsrep_status_t const ret(n.wsrep_.recv(&n.wsrep_, &ctx));
+            if (ret != WSREP_OK && n.stopping_ == false)
+            {
+                log_warn << "node " << n.idx_ << " applier exited: " << ret;
+            }
+            return 0;
+        }
+
+        static wsrep_cb_status_t
+        view_cb(void* app_ctx, void* recv_ctx, const wsrep_view_info_t* view,
+                const char* state, size_t state_len,
+                void** sst_req, size_t* sst_req_len)
+        {
+            if (view->state_gap && view->status == WSREP_VIEW_PRIMARY)
+            {
+                // state is empty, nothing to transfer
+                *sst_req     = strdup(WSREP_STATE_TRANSFER_TRIVIAL);
+                *sst_req_len = strlen(WSREP_STATE_TRANSFER_TRIVIAL) + 1;
+            }
+            return WSREP_CB_SUCCESS;
+        }
+
+        static wsrep_cb_status_t
+        apply_cb(void* recv_ctx, const void* data, size_t size,
+                 uint32_t flags, const wsrep_trx_meta_t* meta)
+        {
+            if (conf.apply_usec > 0) usleep(conf.apply_usec);
+            return WSREP_CB_SUCCESS;
+        }
+
+        static wsrep_cb_status_t
+        commit_cb(void* recv_ctx, const void* trx_handle, uint32_t flags,
+                  const wsrep_trx_meta_t* meta, wsrep_bool_t* exit,
+                  wsrep_bool_t commit)
+        {
+            Node& n(node(recv_ctx));
+            if (commit && trx_handle != 0)
+            {
+                void* const th(const_cast<void*>(trx_handle));
+                n.wsrep_.applier_pre_commit(&n.wsrep_, th);
+                n.wsrep_.applier_post_commit(&n.wsrep_, th);
+            }
+            if (commit) ++n.applied_;
+            return WSREP_CB_SUCCESS;
+        }
+
+        static wsrep_cb_status_t
+        unordered_cb(void* recv_ctx, const void* data, size_t size)
+        {
+            return WSREP_CB_SUCCESS;
+        }
+
+        static wsrep_cb_status_t
+        sst_donate_cb(void* app_ctx, void* recv_ctx, const void* msg,
+                      size_t msg_len, const wsrep_gtid_t* state_id,
+                      const char* state, size_t state_len, wsrep_bool_t bypass)
+        {
+            Node& n(node(app_ctx));
+            n.wsrep_.sst_sent(&n.wsrep_, state_id, 0);
+            return WSREP_CB_SUCCESS;
+        }
+
+        static void synced_cb(void* app_ctx)
+        {
+            Node& n(node(app_ctx));
+            gu::Lock lock(n.mutex_);
+            n.synced_ = true;
+            n.cond_.broadcast();
+        }
+
+        int                    idx_;
+        wsrep_t                wsrep_;
+        gu::Mutex              mutex_;
+        gu::Cond               cond_;
+        bool                   synced_;
+        bool volatile          stopping_;
+        std::vector<pthread_t> appliers_;
+        gu::Atomic<long long>  applied_;
+        Ctx                    app_ctx_;
+    };
+
+    gu::Atomic<int> running(0);
+
+    class Client
+    {
+    public:
+
+        Client(Node& node, int id)
+            :
+            node_       (node),
+            id_         (id),
+            thd_        (),
+            joined_     (true),
+            seed_       (id + 1),
+            payload_    (conf.payload, static_cast<char>(id)),
+            committed_  (0),
+            cert_fails_ (0),
+            replays_    (0),
+            errors_     (0),
+            latencies_  ()
+        { }
+
+        void start()
+        {
+            int const err(pthread_create(&thd_, 0, run_thd, this));
+            if (err != 0)
+            {
+                gu_throw_error(err) << "Failed to start client";
+            }
+            joined_ = false;
+        }
+
+        void join()
+        {
+            if (joined_ == false) pthread_join(thd_, 0);
+            joined_ = true;
+        }
+
+        long long committed()  const { return committed_;  }
+        long long cert_fails() const { return cert_fails_; }
+        long long replays()    const { return replays_;    }
+        long long errors()     const { return errors_;     }
+        const std::vector<long long>& latencies() const { return latencies_; }
+
+    private:
+
+        static void* run_thd(void* arg)
+        {
+            static_cast<Client*>(arg)->run();
+            return 0;
+        }
+
+        void run()
+        {
+            wsrep_t* const wsrep(node_.wsrep());
+            Ctx ctx(node_);
+            std::vector<long long> key_vals(conf.keys);
+            long long n(0);
+
+            while (running() != 0)
+            {
+                ++n;
+                wsrep_ws_handle_t wsh = {
+                    (static_cast<wsrep_trx_id_t>(id_) << 40) + n, 0 };
+                long long const start(gu_time_monotonic());
+
+                for (int k(0); k < conf.keys; ++k)
+                {
+                    double const r(double(rand_r(&seed_))/RAND_MAX);
+                    // negative values are hot keys shared by all clients,
+                    // positive ones are unique to this client
+                    key_vals[k] = (r < conf.conflict ?
+                                   -1 - rand_r(&seed_) % conf.hot_keys :
+                                   (static_cast<long long>(id_) << 40) +
+                                   n*conf.keys + k);
+                    wsrep_buf_t const part = { &key_vals[k],
+                                               sizeof(key_vals[k]) };
+                    wsrep_key_t const key = { &part, 1 };
+                    wsrep->append_key(wsrep, &wsh, &key, 1,
+                                      WSREP_KEY_EXCLUSIVE, true);
+                }
+
+                wsrep_buf_t const data = { &payload_[0], payload_.size() };
+                wsrep->append_data(wsrep, &wsh, &data, 1, WSREP_DATA_ORDERED,
+                                   true);
+
+                wsrep_trx_meta_t meta;
+                wsrep_status_t ret(wsrep->replicate_pre_commit(
+                                       wsrep, id_, &wsh, WSREP_FLAG_COMMIT,
+                                       &meta));
+                if (ret == WSREP_BF_ABORT)
+                {
+                    ++replays_;
+                    ret = wsrep->replay_trx(wsrep, &wsh, &ctx);
+                }
+
+                switch (ret)
+                {
+                case WSREP_OK:
+                    wsrep->post_commit(wsrep, &wsh);
+                    ++committed_;
+                    latencies_.push_back(
+                        gu_time_monotonic() - start);
+                    break;
+                case WSREP_TRX_FAIL:
+                    wsrep->post_rollback(wsrep, &wsh);
+                    ++cert_fails_;
+                    break;
+                default:
+                    wsrep->post_rollback(wsrep, &wsh);
+                    ++errors_;
+                    usleep(1000);
+                }
+            }
+            wsrep->free_connection(wsrep, id_);
+        }
+
+        Node&                  node_;
+        int                    id_;
+        pthread_t              thd_;
+        bool                   joined_;
+        unsigned int           seed_;
+        std::vector<char>      payload_;
+        long long              committed_;
+        long long              cert_fails_;
+        long long              replays_;
+        long long              errors_;
+        std::vector<long long> latencies_;
+    };
+
+    void usage(const char* prog)
+    {
+        std::cerr
+            << "Usage: " << prog << " [options]\n"
+            << "  -p, --provider PATH   wsrep provider library ("
+            << conf.provider << ")\n"
+            << "  -d, --dir PATH        base directory for node state ("
+            << conf.dir << ")\n"
+            << "  -o, --options STR     extra provider options\n"
+            << "  -n, --nodes N         number of nodes (" << conf.nodes
+            << ")\n"
+            << "  -c, --clients N       client threads per node ("
+            << conf.clients << ")\n"
+            << "  -a, --appliers N      applier threads per node ("
+            << conf.appliers << ")\n"
+            << "  -t, --time SEC        load duration (" << conf.duration
+            << ")\n"
+            << "  -k, --keys N          keys per writeset (" << conf.keys
+            << ")\n"
+            << "  -H, --hot-keys N      size of contended key set ("
+            << conf.hot_keys << ")\n"
+            << "  -x, --conflict P      probability of key to be contended ("
+            << conf.conflict << ")\n"
+            << "  -s, --payload BYTES   writeset payload size ("
+            << conf.payload << ")\n"
+            << "  -u, --apply-usec N    simulated apply cost ("
+            << conf.apply_usec << ")\n"
+            << "  -P, --port N          base port (" << conf.port << ")\n"
+            << "  -A, --affinity SPEC   thread placement to compare, value "
+            << "of " << gu::conf::thread_affinity << ",\n"
+            << "                        'none' or 'topology', may be given "
+            << "several times\n"
+            << "  -v, --verbose         show provider info log\n";
+    }
+
+    // Placements derived from host topology: no pinning, all threads on
+    // one NUMA node and network threads apart from the rest, either on
+    // another NUMA node or on a dedicated CPU of a single node.
+    void topology_placements()
+    {
+        std::vector<std::vector<int> > const nodes(gu::numa_node_cpus());
+        std::vector<size_t> cpu_nodes;
+
+        for (size_t i(0); i < nodes.size(); ++i)
+        {
+            if (!nodes[i].empty()) cpu_nodes.push_back(i);
+        }
+
+        conf.placements.push_back(Placement("none", ""));
+
+        if (cpu_nodes.size() > 1)
+        {
+            std::string const first("node" + gu::to_string(cpu_nodes[0]));
+            std::string const second("node" + gu::to_string(cpu_nodes[1]));
+
+            conf.placements.push_back(Placement("local", "*:" + first));
+            conf.placements.push_back(
+                Placement("split", "gcomm:" + first + " gcs_recv:" + first +
+                          " *:" + second));
+        }
+        else if (!cpu_nodes.empty())
+        {
+            const std::vector<int>& cpus(nodes[cpu_nodes[0]]);
+
+            if (cpus.size() > 1)
+            {
+                std::ostringstream net, rest;
+                net  << gu::ThreadAffinity(std::vector<int>(1, cpus[0]));
+                rest << gu::ThreadAffinity(
+                    std::vector<int>(cpus.begin() + 1, cpus.end()));
+                conf.placements.push_back(
+                    Placement("dedicated-net", "gcomm:" + net.str() +
+                              " gcs_recv:" + net.str() + " *:" + rest.str()));
+            }
+        }
+    }
+
+    void add_placements(const std::string& arg)
+    {
+        if (arg == "topology")
+        {
+            topology_placements();
+        }
+        else if (arg == "none")
+        {
+            conf.placements.push_back(Placement(arg, ""));
+        }
+        else
+        {
+            conf.placements.push_back(Placement(arg, arg));
+        }
+    }
+
+    int parse_args(int argc, char* argv[])
+    {
+        static struct option const opts[] = {
+            { "provider",   required_argument, 0, 'p' },
+            { "dir",        required_argument, 0, 'd' },
+            { "options",    required_argument, 0, 'o' },
+            { "nodes",      required_argument, 0, 'n' },
+            { "clients",    required_argument, 0, 'c' },
+            { "appliers",   required_argument, 0, 'a' },
+            { "time",       required_argument, 0, 't' },
+            { "keys",       required_argument, 0, 'k' },
+            { "hot-keys",   required_argument, 0, 'H' },
+            { "conflict",   required_argument, 0, 'x' },
+            { "payload",    required_argument, 0, 's' },
+            { "apply-usec", required_argument, 0, 'u' },
+            { "port",       required_argument, 0, 'P' },
+            { "affinity",   required_argument, 0, 'A' },
+            { "verbose",    no_argument,       0, 'v' },
+            { "help",       no_argument,       0, 'h' },
+            { 0, 0, 0, 0 }
+        };
+
+        int c;
+        while ((c = getopt_long(argc, argv, "p:d:o:n:c:a:t:k:H:x:s:u:P:A:vh",
+                                opts, 0)) != -1)
+        {
+            switch (c)
+            {
+            case 'p': conf.provider   = optarg;         break;
+            case 'd': conf.dir        = optarg;         break;
+            case 'o': conf.options    = optarg;         break;
+            case 'n': conf.nodes      = atoi(optarg);   break;
+            case 'c': conf.clients    = atoi(optarg);   break;
+            case 'a': conf.appliers   = atoi(optarg);   break;
+            case 't': conf.duration   = atoi(optarg);   break;
+            case 'k': conf.keys       = atoi(optarg);   break;
+            case 'H': conf.hot_keys   = atoi(optarg);   break;
+            case 'x': conf.conflict   = atof(optarg);   break;
+            case 's': conf.payload    = atoi(optarg);   break;
+            case 'u': conf.apply_usec = atoi(optarg);   break;
+            case 'P': conf.port       = atoi(optarg);   break;
+            case 'A': add_placements(optarg);           break;
+            case 'v': conf.verbose    = true;           break;
+            default:
+                usage(argv[0]);
+                return EINVAL;
+            }
+        }
+
+        if (conf.nodes < 1 || conf.clients < 1 || conf.appliers < 1 ||
+            conf.duration < 1 || conf.keys < 1 || conf.hot_keys < 1 ||
+            conf.payload < 1 || conf.conflict < 0 || conf.conflict > 1)
+        {
+            usage(argv[0]);
+            return EINVAL;
+        }
+
+        return 0;
+    }
+
+    double percentile(const std::vector<long long>& sorted, double p)
+    {
+        if (sorted.empty()) return 0;
+        size_t const i(std::min(sorted.size() - 1,
+                                static_cast<size_t>(p*sorted.size())));
+        return double(sorted[i])/gu::datetime::MSec;
+    }
+    struct RunResult
+    {
+        RunResult() : tps(0), p99(0), fc_paused(0) { }
+
+        double tps;
+        double p99;       // commit latency, ms
+        double fc_paused; // total flow control pause of all nodes, ms
+    };
+
+    // Runs benchmark with given thread placement. Each run uses its own
+    // ports and state directories, so that consecutive runs don't interfere
+    // through lingering sockets or saved state.
+    int run(size_t const idx, const Placement& p, wsrep_loader_fun loader,
+            RunResult& res)
+    {
+        int err(0);
+        int const port(conf.port + 10*conf.nodes*idx);
+        std::string const dir(idx > 0 ?
+                              conf.dir + "/run" + gu::to_string(idx) :
+                              conf.dir);
+
+        if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST)
+        {
+            std::cerr << "Failed to create " << dir << ": "
+                      << strerror(errno) << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        std::vector<Node*>   nodes;
+        std::vector<Client*> clients;
+
+        try
+        {
+            for (int i(0); i < conf.nodes; ++i)
+            {
+                nodes.push_back(new Node(i, loader));
+                nodes.back()->start(dir, port, p.affinity);
+                nodes.back()->wait_synced();
+                std::cerr << "node " << i << " synced" << std::endl;
+            }
+
+            std::vector<long long> fc_start;
+            for (int i(0); i < conf.nodes; ++i)
+            {
+                fc_start.push_back(nodes[i]->stat("flow_control_paused_ns"));
+            }
+
+            running = 1;
+            for (int i(0); i < conf.nodes; ++i)
+            {
+                for (int j(0); j < conf.clients; ++j)
+                {
+                    clients.push_back(new Client(*nodes[i],
+                                                 i*conf.clients + j + 1));
+                    clients.back()->start();
+                }
+            }
+
+            long long const start(gu_time_monotonic());
+            sleep(conf.duration);
+            running = 0;
+            for (size_t i(0); i < clients.size(); ++i) clients[i]->join();
+            double const elapsed(
+                double(gu_time_monotonic() - start)/
+                gu::datetime::Sec);
+
+            long long committed(0), cert_fails(0), replays(0), errors(0);
+            std::vector<long long> lat;
+            for (size_t i(0); i < clients.size(); ++i)
+            {
+                const Client& c(*clients[i]);
+                committed  += c.committed();
+                cert_fails += c.cert_fails();
+                replays    += c.replays();
+                errors     += c.errors();
+                lat.insert(lat.end(), c.latencies().begin(),
+                           c.latencies().end());
+            }
+            std::sort(lat.begin(), lat.end());
+
+            std::cout << std::fixed << std::setprecision(3)
+                      << "nodes: " << conf.nodes
+                      << ", clients/node: " << conf.clients
+                      << ", appliers/node: " << conf.appliers
+                      << ", keys: " << conf.keys
+                      << ", conflict: " << conf.conflict
+                      << ", payload: " << conf.payload << "\n"
+                      << "duration:       " << elapsed << " s\n"
+                      << "committed:      " << committed << "\n"
+                      << "tps:            " << committed/elapsed << "\n"
+                      << "cert failures:  " << cert_fails << " ("
+                      << (committed + cert_fails > 0 ?
+                          100.0*cert_fails/(committed + cert_fails) : 0.0)
+                      << "%)\n"
+                      << "replays:        " << replays << "\n"
+                      << "errors:         " << errors << "\n"
+                      << "latency ms:     p50 " << percentile(lat, 0.50)
+                      << " p90 " << percentile(lat, 0.90)
+                      << " p99 " << percentile(lat, 0.99)
+                      << " p99.9 " << percentile(lat, 0.999)
+                      << " max " << percentile(lat, 1.0) << "\n";
+
+            for (size_t i(0); i < nodes.size(); ++i)
+            {
+                Node& n(*nodes[i]);
+                long long const paused(n.stat("flow_control_paused_ns") -
+                                       fc_start[i]);
+                double const paused_ms(double(paused)/gu::datetime::MSec);
+                res.fc_paused += paused_ms;
+                std::cout << "node " << i
+                          << ": applied " << n.applied()
+                          << ", fc sent " << n.stat("flow_control_sent")
+                          << ", fc recv " << n.stat("flow_control_recv")
+                          << ", fc paused " << paused_ms << " ms\n";
+            }
+
+            std::cout << "hot conflict keys:   "
+                      << nodes[0]->str_stat("cert_hot_conflict_keys")
+                      << "\nhot dependency keys: "
+                      << nodes[0]->str_stat("cert_hot_dependency_keys")
+                      << "\n";
+            std::cout << std::flush;
+
+            res.tps = committed/elapsed;
+            res.p99 = percentile(lat, 0.99);
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "Benchmark failed: " << e.what() << std::endl;
+            err = EXIT_FAILURE;
+        }
+
+        running = 0;
+        for (size_t i(0); i < clients.size(); ++i)
+        {
+            clients[i]->join();
+            delete clients[i];
+        }
+
+        for (size_t i(nodes.size()); i > 0; --i)
+        {
+            nodes[i - 1]->stop();
+            delete nodes[i - 1];
+        }
+
+        return err;
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    int err(parse_args(argc, argv));
+    if (err != 0) return err;
+
+    verbose_log = conf.verbose;
+
+    void* const dlh(dlopen(conf.provider.c_str(), RTLD_NOW | RTLD_LOCAL));
+    if (dlh == 0)
+    {
+        std::cerr << "Failed to load " << conf.provider << ": " << dlerror()
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    wsrep_loader_fun const loader(
+        reinterpret_cast<wsrep_loader_fun>(dlsym(dlh, "wsrep_loader")));
+    if (loader == 0)
+    {
+        std::cerr << "No wsrep_loader() in " << conf.provider << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (mkdir(conf.dir.c_str(), 0700) != 0 && errno != EEXIST)
+    {
+        std::cerr << "Failed to create " << conf.dir << ": "
+                  << strerror(errno) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (conf.placements.empty())
+    {
+        RunResult res;
+        return run(0, Placement("none", ""), loader, res);
+    }
+
+    std::vector<RunResult> results(conf.placements.size());
+
+    for (size_t i(0); i < conf.placements.size(); ++i)
+    {
+        const Placement& p(conf.placements[i]);
+
+        std::cout << "placement " << p.name << ": "
+                  << (p.affinity.empty() ? "none" : p.affinity) << "\n";
+
+        err = run(i, p, loader, results[i]);
+        if (err != 0) return err;
+
+        std::cout << std::endl;
+    }
+
+    size_t width(std::string("placement").size());
+    for (size_t i(0); i < conf.placements.size(); ++i)
+    {
+        width = std::max(width, conf.placements[i].name.size());
+    }
+    width += 2;
+
+    std::cout << std::left << std::setw(width) << "placement"
+              << std::right << std::setw(12) << "tps"
+              << std::setw(12) << "p99 ms"
+              << std::setw(12) << "fc ms" << "\n";
+
+    for (size_t i(0); i < conf.placements.size(); ++i)
+    {
+        std::cout << std::fixed << std::setprecision(3)
+                  << std::left << std::setw(width) << conf.placements[i].name
+                  << std::right << std::setw(12) << results[i].tps
+                  << std::setw(12) << results[i].p99
+                  << std::setw(12) << results[i].fc_paused << "\n";
+    }
+    std::cout << std::flush;
+
+    return 0;
+}
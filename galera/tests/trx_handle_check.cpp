@@ -7,6 +7,8 @@
 
 #include <check.h>
 
+#include <sstream>
+
 using namespace std;
 using namespace galera;
 
@@ -190,6 +192,108 @@ START_TEST(test_serialization)
 }
 END_TEST
 
+START_TEST(test_trace)
+{
+    TrxHandle::LocalPool tp(TrxHandle::LOCAL_STORAGE_SIZE(), 16, "test_trace");
+    wsrep_uuid_t uuid = {{1, }};
+    wsrep_trx_id_t const trx_id(4242);
+
+    TrxTrace::enable(true);
+    TrxTrace::clear();
+
+    TrxHandle* trx(TrxHandle::New(tp, TrxHandle::Defaults, uuid, -1, trx_id));
+    trx->set_state(TrxHandle::S_REPLICATING);
+    trx->set_state(TrxHandle::S_CERTIFYING);
+    trx->trace_point(TrxTrace::P_LOCAL_MONITOR);
+    trx->set_state(TrxHandle::S_APPLYING);
+    trx->trace_point(TrxTrace::P_APPLY_MONITOR);
+    trx->set_state(TrxHandle::S_COMMITTING);
+    trx->trace_point(TrxTrace::P_COMMIT_MONITOR);
+    trx->set_state(TrxHandle::S_COMMITTED);
+    trx->unref();
+
+    TrxTrace::enable(false);
+
+    /* not traced */
+    trx = TrxHandle::New(tp, TrxHandle::Defaults, uuid, -1, trx_id);
+    trx->set_state(TrxHandle::S_REPLICATING);
+    trx->unref();
+
+    int const points[] =
+    {
+        TrxHandle::S_EXECUTING,
+        TrxHandle::S_REPLICATING,
+        TrxHandle::S_CERTIFYING,
+        TrxTrace::P_LOCAL_MONITOR,
+        TrxHandle::S_APPLYING,
+        TrxTrace::P_APPLY_MONITOR,
+        TrxHandle::S_COMMITTING,
+        TrxTrace::P_COMMIT_MONITOR,
+        TrxHandle::S_COMMITTED
+    };
+    size_t const n_recs(sizeof(points)/sizeof(points[0]) - 1);
+
+    std::vector<TrxTrace::Record> recs;
+    TrxTrace::snapshot(recs);
+    fail_unless(recs.size() == n_recs, "expected %zu records, got %zu",
+                n_recs, recs.size());
+
+    for (size_t i(0); i < recs.size(); ++i)
+    {
+        fail_unless(recs[i].trx_id == trx_id);
+        fail_unless(recs[i].from == points[i], "record %zu: from %d, "
+                    "expected %d", i, int(recs[i].from), points[i]);
+        fail_unless(recs[i].to == points[i + 1], "record %zu: to %d, "
+                    "expected %d", i, int(recs[i].to), points[i + 1]);
+        fail_unless(recs[i].elapsed >= 0);
+        fail_if(i > 0 && recs[i].tstamp < recs[i - 1].tstamp);
+    }
+
+    std::ostringstream json;
+    TrxTrace::dump_json(json);
+    fail_if(json.str().find("\"CERTIFYING->LOCAL_MONITOR\": {\"count\": 1")
+            == std::string::npos, "no phase in JSON dump: %s",
+            json.str().c_str());
+
+    std::ostringstream bin;
+    TrxTrace::dump_binary(bin);
+    fail_unless(bin.str().size() == 8 + n_recs * 34);
+
+    /* slave trx trace starts at S_REPLICATING */
+    TrxHandle::SlavePool sp(sizeof(TrxHandle), 4, "test_trace_sp");
+    TrxTrace::enable(true);
+    TrxTrace::clear();
+    trx = TrxHandle::New(sp);
+    trx->set_state(TrxHandle::S_REPLICATING);
+    trx->set_state(TrxHandle::S_CERTIFYING);
+    trx->unref();
+    TrxTrace::enable(false);
+
+    recs.clear();
+    TrxTrace::snapshot(recs);
+    fail_unless(recs.size() == 1, "expected 1 slave record, got %zu",
+                recs.size());
+    fail_unless(recs[0].from == TrxHandle::S_REPLICATING);
+    fail_unless(recs[0].to   == TrxHandle::S_CERTIFYING);
+
+    /* ring keeps only the last RING_SIZE - 1 records */
+    TrxTrace::clear();
+    for (size_t i(0); i < TrxTrace::RING_SIZE + 10; ++i)
+    {
+        TrxTrace::Record const r = { int64_t(i), 0, -1, i, 0, 1 };
+        TrxTrace::record(r);
+    }
+
+    recs.clear();
+    TrxTrace::snapshot(recs);
+    fail_unless(recs.size() == TrxTrace::RING_SIZE - 1);
+    fail_unless(recs.front().trx_id == 11);
+    fail_unless(recs.back().trx_id == TrxTrace::RING_SIZE + 9);
+
+    TrxTrace::clear();
+}
+END_TEST
+
 Suite* trx_handle_suite()
 {
     Suite* s = suite_create("trx_handle");
@@ -204,5 +308,9 @@ Suite* trx_handle_suite()
     tcase_add_test(tc, test_serialization);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("test_trace");
+    tcase_add_test(tc, test_trace);
+    suite_add_tcase(s, tc);
+
     return s;
 }
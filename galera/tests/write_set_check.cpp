@@ -12,6 +12,7 @@
 #include "galera_service_thd.hpp"
 
 #include <cstdlib>
+#include <cstring>
 #include <check.h>
 
 namespace
@@ -644,6 +645,519 @@ START_TEST(test_trac_726)
 END_TEST
 
 
+/* replicates v3 trx with a single key (if any) and returns it certified,
+ * by default trx has seen all the preceding writesets */
+static Certification::TestResult
+cert_ws_v3(Certification& cert, std::list<gu::Buffer>& bufs,
+           const wsrep_uuid_t& uuid, wsrep_conn_id_t const conn_id,
+           const wsrep_buf_t* const key, size_t const key_len,
+           int const flags, wsrep_seqno_t const seqno,
+           wsrep_trx_id_t const trx_id = wsrep_trx_id_t(-1),
+           wsrep_seqno_t const last_seen = WSREP_SEQNO_UNDEFINED)
+{
+    const int version(3);
+    galera::TrxHandle::Params const trx_params("", version,
+                                               KeySet::MAX_VERSION);
+    TrxHandle* trx(TrxHandle::New(lp, trx_params, uuid, conn_id, trx_id));
+
+    if (key_len > 0)
+    {
+        trx->append_key(KeyData(version, key, key_len, WSREP_KEY_EXCLUSIVE,
+                                true));
+    }
+    // fragments and rollback events do not commit
+    if (flags & (TrxHandle::F_FRAGMENT | TrxHandle::F_ROLLBACK))
+        trx->set_flags(flags);
+    else
+        trx->set_flags(TrxHandle::F_COMMIT | flags);
+
+    WriteSetNG::GatherVector out;
+    size_t const size(trx->write_set_out().gather(trx->source_id(),
+                                                  trx->conn_id(),
+                                                  trx->trx_id(), out));
+    trx->set_last_seen_seqno(last_seen < 0 ? seqno - 1 : last_seen);
+
+    bufs.push_back(gu::Buffer(size));
+    gu::byte_t* p(&bufs.back()[0]);
+    for (size_t i(0); i < out->size(); ++i)
+    {
+        ::memcpy(p, out[i].ptr, out[i].size); p += out[i].size;
+    }
+    trx->unref();
+
+    trx = TrxHandle::New(sp);
+    trx->unserialize(&bufs.back()[0], size, 0);
+    trx->set_received(0, seqno, seqno);
+
+    Certification::TestResult const result(cert.append_trx(trx));
+    cert.set_trx_committed(trx);
+    trx->unref();
+
+    return result;
+}
+
+START_TEST(test_cert_nbo)
+{
+    log_info << "test_cert_nbo";
+
+    std::list<gu::Buffer> bufs; // must outlive cert
+    TestEnv env;
+    galera::Certification cert(env.conf(), env.thd(), env.gcache());
+    cert.assign_initial_position(0, 3);
+
+    wsrep_uuid_t const uuid1 = {{1, }};
+    wsrep_uuid_t const uuid2 = {{2, }};
+
+    wsrep_buf_t const t1[3] = {
+        {void_cast("db"), 2}, {void_cast("t1"), 2}, {void_cast("pk"), 2}
+    };
+    wsrep_buf_t const t2[3] = {
+        {void_cast("db"), 2}, {void_cast("t2"), 2}, {void_cast("pk"), 2}
+    };
+
+    int const toi(TrxHandle::F_ISOLATION);
+
+    // 1: begin of operation on db.t1 locks the table
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid1, 1, t1, 2,
+                           toi | TrxHandle::F_NBO_BEGIN, 1));
+    fail_unless(1 == cert.nbo_count());
+
+    // 2: row of db.t1 conflicts
+    fail_unless(Certification::TEST_FAILED ==
+                cert_ws_v3(cert, bufs, uuid2, 2, t1, 3, 0, 2));
+
+    // 3: row of db.t2 does not
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid2, 2, t2, 3, 0, 3));
+
+    // 4: neither does plain TOI on db.t2, but TOI on db.t1 does
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid2, 2, t2, 2, toi, 4));
+    fail_unless(Certification::TEST_FAILED ==
+                cert_ws_v3(cert, bufs, uuid2, 2, t1, 2, toi, 5));
+
+    // 6: end event from another connection does not unlock
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid1, 2, 0, 0,
+                           toi | TrxHandle::F_NBO_END, 6));
+    fail_unless(1 == cert.nbo_count());
+
+    // 7: end event of the operation unlocks db.t1
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid1, 1, 0, 0,
+                           toi | TrxHandle::F_NBO_END, 7));
+    fail_unless(0 == cert.nbo_count());
+
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid2, 2, t1, 3, 0, 8));
+
+    // 9: locks survive position reassignment at configuration change
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid1, 1, t1, 2,
+                           toi | TrxHandle::F_NBO_BEGIN, 9));
+    fail_unless(1 == cert.nbo_count());
+    cert.assign_initial_position(9, 3);
+    fail_unless(1 == cert.nbo_count());
+    fail_unless(Certification::TEST_FAILED ==
+                cert_ws_v3(cert, bufs, uuid2, 2, t1, 3, 0, 10));
+
+    // and are dropped only when their source leaves
+    wsrep_view_info_t view;
+    ::memset(&view, 0, sizeof(view));
+    view.memb_num = 1;
+    view.members[0].id = uuid1;
+    cert.drop_locks(&view);
+    fail_unless(1 == cert.nbo_count());
+    view.members[0].id = uuid2;
+    cert.drop_locks(&view);
+    fail_unless(0 == cert.nbo_count());
+
+    // or on state transfer
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid2, 2, t1, 2,
+                           toi | TrxHandle::F_NBO_BEGIN, 11));
+    fail_unless(1 == cert.nbo_count());
+    cert.drop_locks(0);
+    fail_unless(0 == cert.nbo_count());
+
+    // 13: end event replicated before configuration change at 12 still
+    // unlocks, even though it has not seen the new initial position
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid1, 1, t1, 2,
+                           toi | TrxHandle::F_NBO_BEGIN, 12));
+    cert.assign_initial_position(12, 3);
+    fail_unless(1 == cert.nbo_count());
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid1, 1, 0, 0,
+                           toi | TrxHandle::F_NBO_END, 13, -1, 11));
+    fail_unless(0 == cert.nbo_count());
+    // while other writesets which have not seen it fail
+    fail_unless(Certification::TEST_FAILED ==
+                cert_ws_v3(cert, bufs, uuid2, 2, t2, 3, 0, 14, -1, 11));
+}
+END_TEST
+
+/* slave v3 trx without keys as received with seqno */
+static TrxHandle*
+slave_ws_v3(std::list<gu::Buffer>& bufs, const wsrep_uuid_t& uuid,
+            wsrep_conn_id_t const conn_id, int const flags,
+            wsrep_seqno_t const seqno)
+{
+    galera::TrxHandle::Params const trx_params("", 3, KeySet::MAX_VERSION);
+    TrxHandle* trx(TrxHandle::New(lp, trx_params, uuid, conn_id, -1));
+    trx->set_flags(TrxHandle::F_COMMIT | flags);
+
+    WriteSetNG::GatherVector out;
+    size_t const size(trx->write_set_out().gather(trx->source_id(),
+                                                  trx->conn_id(),
+                                                  trx->trx_id(), out));
+    trx->set_last_seen_seqno(seqno - 1);
+
+    bufs.push_back(gu::Buffer(size));
+    gu::byte_t* p(&bufs.back()[0]);
+    for (size_t i(0); i < out->size(); ++i)
+    {
+        ::memcpy(p, out[i].ptr, out[i].size); p += out[i].size;
+    }
+    trx->unref();
+
+    trx = TrxHandle::New(sp);
+    trx->unserialize(&bufs.back()[0], size, 0);
+    trx->set_received(&bufs.back()[0], seqno, seqno);
+
+    return trx;
+}
+
+struct nbo_wait_args
+{
+    nbo_wait_args(galera::NBOMap& m, const TrxHandle& t)
+        : map(m), trx(t), done(0)
+    { }
+
+    galera::NBOMap&  map;
+    const TrxHandle& trx;
+    gu::Atomic<int>  done;
+};
+
+extern "C" void* nbo_wait_thd(void* arg)
+{
+    nbo_wait_args* const args(static_cast<nbo_wait_args*>(arg));
+    args->map.wait(args->trx);
+    args->done = 1;
+    return 0;
+}
+
+START_TEST(test_nbo_map)
+{
+    log_info << "test_nbo_map";
+
+    std::list<gu::Buffer> bufs;
+    TestEnv env;
+    galera::NBOMap map(env.gcache(), sp);
+
+    wsrep_uuid_t const uuid1 = {{1, }};
+    int const toi(TrxHandle::F_ISOLATION);
+
+    TrxHandle* const end1(slave_ws_v3(bufs, uuid1, 1,
+                                      toi | TrxHandle::F_NBO_END, 2));
+    TrxHandle* const begin2(slave_ws_v3(bufs, uuid1, 1,
+                                        toi | TrxHandle::F_NBO_BEGIN, 3));
+    TrxHandle* const end2(slave_ws_v3(bufs, uuid1, 1,
+                                      toi | TrxHandle::F_NBO_END, 4));
+
+    // begin registered at certification, apply gets the same copy
+    TrxHandle* const ws(map.begin(*begin2));
+    fail_unless(ws == map.begin(*begin2));
+    fail_unless(1 == map.size());
+    fail_unless(ws->global_seqno() == 3);
+
+    // end of the previous operation of the connection doesn't wait for it
+    map.wait(*end1);
+
+    // end of the operation waits even if begin has not been applied yet
+    nbo_wait_args args(map, *end2);
+    pthread_t thd;
+    pthread_create(&thd, 0, nbo_wait_thd, &args);
+    usleep(100000);
+    fail_unless(0 == args.done());
+
+    map.end(*begin2);
+    pthread_join(thd, 0);
+    fail_unless(1 == args.done());
+    fail_unless(0 == map.size());
+
+    end1->unref();
+    begin2->unref();
+    end2->unref();
+}
+END_TEST
+
+START_TEST(test_cert_stream)
+{
+    log_info << "test_cert_stream";
+
+    std::list<gu::Buffer> bufs; // must outlive cert
+    TestEnv env;
+    galera::Certification cert(env.conf(), env.thd(), env.gcache());
+    cert.assign_initial_position(0, 3);
+
+    wsrep_uuid_t const uuid1 = {{1, }};
+    wsrep_uuid_t const uuid2 = {{2, }};
+
+    wsrep_buf_t const t1[3] = {
+        {void_cast("db"), 2}, {void_cast("t1"), 2}, {void_cast("pk"), 2}
+    };
+    wsrep_buf_t const t2[3] = {
+        {void_cast("db"), 2}, {void_cast("t2"), 2}, {void_cast("pk"), 2}
+    };
+
+    int const frag(TrxHandle::F_FRAGMENT);
+    int const strm(TrxHandle::F_STREAMED);
+    int const toi (TrxHandle::F_ISOLATION);
+
+    // 1: first fragment of trx 10 locks row of db.t1
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid1, 1, t1, 3, frag, 1, 10));
+    fail_unless(1 == cert.stream_count());
+
+    // 2: other trx which has seen the fragment still conflicts with it
+    fail_unless(Certification::TEST_FAILED ==
+                cert_ws_v3(cert, bufs, uuid2, 2, t1, 3, 0, 2, 20));
+
+    // 3: row of db.t2 does not
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid2, 2, t2, 3, 0, 3, 20));
+
+    // 4: next fragment adds row of db.t2, after that TOI on db.t2 conflicts
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid1, 1, t2, 3, frag | strm, 4, 10));
+    fail_unless(Certification::TEST_FAILED ==
+                cert_ws_v3(cert, bufs, uuid2, 2, t2, 2, toi, 5));
+    fail_unless(1 == cert.stream_count());
+
+    // 6: final writeset of trx 10 unlocks
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid1, 1, t1, 3, strm, 6, 10));
+    fail_unless(0 == cert.stream_count());
+
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid2, 2, t1, 3, 0, 7, 20));
+
+    // 8: continuation of unknown stream fails
+    fail_unless(Certification::TEST_FAILED ==
+                cert_ws_v3(cert, bufs, uuid2, 2, t1, 3, frag | strm, 8, 30));
+
+    // 9: rollback event releases stream
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid2, 2, t1, 3, frag, 9, 30));
+    fail_unless(1 == cert.stream_count());
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid2, 2, 0, 0,
+                           TrxHandle::F_ROLLBACK | strm, 10, 30));
+    fail_unless(0 == cert.stream_count());
+
+    // 11: streams survive position reassignment at configuration change
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid1, 1, t1, 3, frag, 11, 40));
+    fail_unless(1 == cert.stream_count());
+    cert.assign_initial_position(11, 3);
+    fail_unless(1 == cert.stream_count());
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid1, 1, t2, 3, frag | strm, 12, 40));
+
+    // and are dropped only when their source leaves
+    wsrep_view_info_t view;
+    ::memset(&view, 0, sizeof(view));
+    view.memb_num = 1;
+    view.members[0].id = uuid1;
+    cert.drop_locks(&view);
+    fail_unless(1 == cert.stream_count());
+    view.members[0].id = uuid2;
+    cert.drop_locks(&view);
+    fail_unless(0 == cert.stream_count());
+
+    // 13: after that the rest of the stream fails
+    fail_unless(Certification::TEST_FAILED ==
+                cert_ws_v3(cert, bufs, uuid1, 1, t1, 3, strm, 13, 40));
+}
+END_TEST
+
+/* replicates preordered writeset like ReplicatorSMM::preordered_commit() does
+ * and returns its depends_seqno after certification */
+static wsrep_seqno_t
+cert_po_ws_v3(Certification& cert, std::list<gu::Buffer>& bufs,
+              const wsrep_buf_t* const key, size_t const key_len,
+              int const pa_range, wsrep_seqno_t const seqno,
+              wsrep_trx_id_t const trx_id)
+{
+    WriteSetOut ws("", trx_id, KeySet::MAX_VERSION, NULL, 0, 0,
+                   WriteSetNG::MAX_VERSION, DataSet::MAX_VERSION,
+                   DataSet::MAX_VERSION);
+
+    if (key_len > 0)
+    {
+        ws.append_key(KeyData(3, key, key_len, WSREP_KEY_EXCLUSIVE, true));
+    }
+    ws.append_data("event", 5, true);
+    ws.set_flags(WriteSetNG::F_COMMIT);
+
+    WriteSetNG::GatherVector out;
+    size_t const size(ws.gather(WSREP_UUID_UNDEFINED, 0, trx_id, out));
+    ws.set_preordered(pa_range);
+
+    bufs.push_back(gu::Buffer(size));
+    gu::byte_t* p(&bufs.back()[0]);
+    for (size_t i(0); i < out->size(); ++i)
+    {
+        ::memcpy(p, out[i].ptr, out[i].size); p += out[i].size;
+    }
+
+    TrxHandle* const trx(TrxHandle::New(sp));
+    trx->unserialize(&bufs.back()[0], size, 0);
+    trx->set_received(0, seqno, seqno);
+    fail_unless(trx->preordered());
+    // keyed certification relies on preordered writeset seeing everything
+    fail_unless(trx->last_seen_seqno() == seqno - 1,
+                "last seen %lld", (long long)trx->last_seen_seqno());
+
+    fail_unless(Certification::TEST_OK == cert.append_trx(trx));
+    wsrep_seqno_t const ret(trx->depends_seqno());
+    cert.set_trx_committed(trx);
+    trx->unref();
+
+    return ret;
+}
+
+START_TEST(test_cert_preordered)
+{
+    log_info << "test_cert_preordered";
+
+    std::list<gu::Buffer> bufs; // must outlive cert
+    TestEnv env;
+    galera::Certification cert(env.conf(), env.thd(), env.gcache());
+    cert.assign_initial_position(0, 3);
+    cert.set_preordered_keys(true);
+
+    wsrep_uuid_t const uuid1 = {{1, }};
+
+    wsrep_buf_t const r1[3] = {
+        {void_cast("db"), 2}, {void_cast("t1"), 2}, {void_cast("r1"), 2}
+    };
+    wsrep_buf_t const r2[3] = {
+        {void_cast("db"), 2}, {void_cast("t1"), 2}, {void_cast("r2"), 2}
+    };
+
+    // 1-2: without keys pa_range determines dependency
+    fail_unless(cert_po_ws_v3(cert, bufs, 0, 0, 0, 1, 1) < 1);
+    fail_unless(cert_po_ws_v3(cert, bufs, 0, 0, 0, 2, 2) < 2);
+
+    // 3: with keys nothing to depend on but the last writeset without keys
+    fail_unless(2 == cert_po_ws_v3(cert, bufs, r1, 3, 0, 3, 3));
+
+    // 4-5: different row applies in parallel with 3, same row waits for it
+    fail_unless(2 == cert_po_ws_v3(cert, bufs, r2, 3, 0, 4, 4));
+    fail_unless(3 == cert_po_ws_v3(cert, bufs, r1, 3, 0, 5, 5));
+
+    // 6: local trx which has not seen 5 conflicts on its key
+    fail_unless(Certification::TEST_FAILED ==
+                cert_ws_v3(cert, bufs, uuid1, 1, r1, 3, 0, 6, 10, 4));
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid1, 1, r1, 3, 0, 7));
+
+    // 8: with older protocol keys are ignored and don't fail local trxs
+    cert.set_preordered_keys(false);
+    fail_unless(cert_po_ws_v3(cert, bufs, r2, 3, 0, 8, 6) < 8);
+    fail_unless(Certification::TEST_OK ==
+                cert_ws_v3(cert, bufs, uuid1, 1, r2, 3, 0, 9, 11, 7));
+}
+END_TEST
+
+START_TEST(test_cert_hot_keys_param)
+{
+    TestEnv env;
+
+    env.conf().set(Certification::PARAM_HOT_KEYS, "1000000");
+
+    try
+    {
+        galera::Certification cert(env.conf(), env.thd(), env.gcache());
+        fail("Certification with unbounded %s",
+             Certification::PARAM_HOT_KEYS.c_str());
+    }
+    catch (gu::Exception& e)
+    {
+        fail_if(EINVAL != e.get_errno());
+    }
+
+    env.conf().set(Certification::PARAM_HOT_KEYS, "16");
+    galera::Certification cert(env.conf(), env.thd(), env.gcache());
+
+    const char* const bad[] = { "-1", "1025", "abc" };
+    for (size_t i(0); i < sizeof(bad)/sizeof(bad[0]); ++i)
+    {
+        try
+        {
+            cert.set_hot_keys(bad[i]);
+            fail("%s accepted value %s", Certification::PARAM_HOT_KEYS.c_str(),
+                 bad[i]);
+        }
+        catch (gu::Exception& e) {}
+    }
+
+    cert.set_hot_keys("0");
+    cert.set_hot_keys("1024");
+}
+END_TEST
+
+
+START_TEST(test_wsdb_arena_reuse)
+{
+    galera::Wsdb wsdb;
+    galera::TrxHandle::Params const trx_params("", 3, KeySet::MAX_VERSION);
+    std::vector<char> const data(1 << 14, 'x');
+    size_t cached(0);
+
+    // consecutive trxs of a thread must recycle the same write set pages
+    for (wsrep_trx_id_t id(1); id <= 3; ++id)
+    {
+        TrxHandle* const trx(wsdb.get_trx(trx_params, WSREP_UUID_UNDEFINED,
+                                          id, true));
+        fail_if(0 == trx);
+
+        for (int i(0); i < 16; ++i)
+        {
+            trx->append_data(&data[0], data.size(), WSREP_DATA_ORDERED, true);
+        }
+
+        if (id > 1)
+        {
+            fail_if(wsdb.arena_cache_size() >= cached,
+                    "trx %lld did not take pages from arena: %zu >= %zu",
+                    static_cast<long long>(id), wsdb.arena_cache_size(),
+                    cached);
+        }
+
+        trx->unref();
+        wsdb.discard_trx(id);
+
+        if (1 == id)
+        {
+            cached = wsdb.arena_cache_size();
+            fail_if(0 == cached, "arena released after trx discard");
+        }
+        else
+        {
+            fail_if(wsdb.arena_cache_size() != cached,
+                    "trx %lld: arena cache %zu, expected %zu",
+                    static_cast<long long>(id), wsdb.arena_cache_size(),
+                    cached);
+        }
+    }
+}
+END_TEST
+
+
 Suite* write_set_suite()
 {
     Suite* s = suite_create("write_set");
@@ -684,5 +1198,31 @@ Suite* write_set_suite()
     tcase_set_timeout(tc, 20);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("test_cert_nbo");
+    tcase_add_test(tc, test_cert_nbo);
+    tcase_set_timeout(tc, 20);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_nbo_map");
+    tcase_add_test(tc, test_nbo_map);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_cert_stream");
+    tcase_add_test(tc, test_cert_stream);
+    tcase_set_timeout(tc, 20);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_cert_preordered");
+    tcase_add_test(tc, test_cert_preordered);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_cert_hot_keys_param");
+    tcase_add_test(tc, test_cert_hot_keys_param);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_wsdb_arena_reuse");
+    tcase_add_test(tc, test_wsdb_arena_reuse);
+    suite_add_tcase(s, tc);
+
     return s;
 }
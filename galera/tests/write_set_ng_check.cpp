@@ -340,11 +340,89 @@ START_TEST (ver3_annotation)
 }
 END_TEST
 
+static void
+bulk_keys_gather (WriteSetOut& wso, std::vector<gu::byte_t>& in)
+{
+    wsrep_uuid_t const source = {{ 1, }};
+    WriteSetNG::GatherVector out;
+    size_t const out_size(wso.gather(source, 1, 1, out));
+    wso.set_last_seen(1);
+
+    in.reserve(out_size);
+    for (size_t i(0); i < out->size(); ++i)
+    {
+        const gu::byte_t* ptr(static_cast<const gu::byte_t*>(out[i].ptr));
+        in.insert (in.end(), ptr, ptr + out[i].size);
+    }
+}
+
+START_TEST (ver3_bulk_keys)
+{
+    /* enough keys to overflow preallocated key part buckets */
+    int const nkeys(300);
+    std::vector<int> rows(nkeys);
+    std::vector<wsrep_buf_t> parts(3 * nkeys);
+    std::vector<wsrep_key_t> keys(nkeys);
+
+    for (int i(0); i < nkeys; ++i)
+    {
+        rows[i] = i - i % 3; // every row thrice in a row
+        parts[3*i    ].ptr = "db";     parts[3*i    ].len = 2;
+        parts[3*i + 1].ptr = "t1";     parts[3*i + 1].len = 2;
+        parts[3*i + 2].ptr = &rows[i]; parts[3*i + 2].len = sizeof(rows[i]);
+        keys[i].key_parts     = &parts[3*i];
+        keys[i].key_parts_num = 3;
+    }
+
+    std::string const dir(".");
+    WriteSetOut one (dir, 1, KeySet::FLAT8A, 0, 0, 0, WriteSetNG::VER3);
+    WriteSetOut bulk(dir, 2, KeySet::FLAT8A, 0, 0, 0, WriteSetNG::VER3);
+
+    for (int i(0); i < nkeys; ++i)
+    {
+        one.append_key(KeyData(3, keys[i].key_parts, keys[i].key_parts_num,
+                               WSREP_KEY_EXCLUSIVE, true));
+    }
+
+    bulk.append_keys(3, &keys[0], nkeys / 2, WSREP_KEY_EXCLUSIVE, true);
+    bulk.append_keys(3, &keys[nkeys / 2], nkeys - nkeys / 2,
+                     WSREP_KEY_EXCLUSIVE, true);
+
+    fail_if (one.appended_keys() != bulk.appended_keys());
+
+    std::vector<gu::byte_t> one_buf;
+    std::vector<gu::byte_t> bulk_buf;
+    bulk_keys_gather(one,  one_buf);
+    bulk_keys_gather(bulk, bulk_buf);
+
+    gu::Buf const one_in  = { one_buf.data(),
+                              static_cast<ssize_t>(one_buf.size()) };
+    gu::Buf const bulk_in = { bulk_buf.data(),
+                              static_cast<ssize_t>(bulk_buf.size()) };
+
+    WriteSetIn one_wsi (one_in);
+    WriteSetIn bulk_wsi(bulk_in);
+
+    bulk_wsi.verify_checksum();
+
+    /* 2 branch parts + every third leaf is a duplicate */
+    int const expected(2 + nkeys / 3);
+    fail_if (one_wsi.keyset().count() != expected,
+             "Key parts: %d, expected: %d",
+             one_wsi.keyset().count(), expected);
+    fail_if (bulk_wsi.keyset().count() != one_wsi.keyset().count(),
+             "Key parts: %d, expected: %d",
+             bulk_wsi.keyset().count(), one_wsi.keyset().count());
+    fail_if (bulk_wsi.keyset().size() != one_wsi.keyset().size());
+}
+END_TEST
+
 Suite* write_set_ng_suite ()
 {
     TCase* t = tcase_create ("WriteSet");
     tcase_add_test (t, ver3_basic);
     tcase_add_test (t, ver3_annotation);
+    tcase_add_test (t, ver3_bulk_keys);
     tcase_set_timeout(t, 60);
 
     Suite* s = suite_create ("WriteSet");
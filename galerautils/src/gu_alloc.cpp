@@ -9,15 +9,84 @@
 #include "gu_throw.hpp"
 #include "gu_assert.hpp"
 #include "gu_limits.h"
+#include "gu_lock.hpp"
 
 #include <sstream>
 #include <iomanip> // for std::setfill() and std::setw()
 
 
-gu::Allocator::HeapPage::HeapPage (page_size_type const size) :
-    Page (static_cast<byte_t*>(::malloc(size)), size)
+gu::Allocator::Arena::Arena (size_t const max_size)
+    :
+    mtx_     (),
+    pages_   (),
+    max_size_(max_size),
+    size_    (0),
+    refcnt_  (1)
+{}
+
+
+gu::Allocator::Arena::~Arena ()
+{
+    for (size_t i(0); i < pages_.size(); ++i) free (pages_[i].first);
+}
+
+
+gu::byte_t*
+gu::Allocator::Arena::get (page_size_type& size)
 {
+    {
+        Lock lock(mtx_);
+
+        for (size_t i(pages_.size()); i > 0; --i)
+        {
+            CachedPage const cp(pages_[i - 1]);
+
+            if (cp.second >= size)
+            {
+                pages_.erase(pages_.begin() + (i - 1));
+                size_ -= cp.second;
+                size   = cp.second;
+                return cp.first;
+            }
+        }
+    }
+
+    return static_cast<byte_t*>(::malloc(size));
+}
+
+
+void
+gu::Allocator::Arena::put (byte_t* const ptr, page_size_type const size)
+{
+    {
+        Lock lock(mtx_);
+
+        if (size_ + size <= max_size_)
+        {
+            pages_.push_back(CachedPage(ptr, size));
+            size_ += size;
+            return;
+        }
+    }
+
+    free (ptr);
+}
+
+
+gu::Allocator::HeapPage::HeapPage (page_size_type const size,
+                                   Arena* const         arena) :
+    Page   (0, 0),
+    arena_ (arena),
+    size_  (size)
+{
+    /* cached page may be bigger than requested, then use all of it */
+    base_ptr_ = arena_ ? arena_->get(size_)
+                       : static_cast<byte_t*>(::malloc(size_));
+
     if (0 == base_ptr_) gu_throw_error (ENOMEM);
+
+    ptr_  = base_ptr_;
+    left_ = size_;
 }
 
 
@@ -32,11 +101,12 @@ gu::Allocator::HeapStore::my_new_page (page_size_type const size)
         page_size_type const page_size
             (std::min(std::max(size, PAGE_SIZE), left_));
 
-        Page* ret = new HeapPage (page_size);
+        HeapPage* ret = new HeapPage (page_size, arena_);
 
         assert (ret != 0);
 
-        left_ -= page_size;
+        /* account for the whole page actually taken from the arena */
+        left_ -= std::min(ret->capacity(), left_);
 
         return ret;
     }
@@ -174,11 +244,12 @@ gu::Allocator::Allocator (const BaseName&         base_name,
                           byte_t*                 reserved,
                           page_size_type          reserved_size,
                           heap_size_type          max_ram,
-                          page_size_type          disk_page_size)
+                          page_size_type          disk_page_size,
+                          Arena*                  arena)
         :
     first_page_   (reserved, reserved_size),
     current_page_ (&first_page_),
-    heap_store_   (max_ram),
+    heap_store_   (max_ram, arena),
     file_store_   (base_name, disk_page_size),
     current_store_(&heap_store_),
     pages_        (),
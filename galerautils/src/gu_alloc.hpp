@@ -13,6 +13,8 @@
 #include "gu_mmap.hpp"
 #include "gu_buf.hpp"
 #include "gu_vector.hpp"
+#include "gu_mutex.hpp"
+#include "gu_atomic.hpp"
 
 #include "gu_macros.h" // gu_likely()
 
@@ -39,12 +41,54 @@ public:
     typedef unsigned int   page_size_type; // max page size
     typedef page_size_type heap_size_type; // max heap store size
 
+    /*! Cache of heap pages released by Allocators, to be reused by the next
+     *  ones, e.g. those of consecutive transactions on one connection.
+     *  Retains pages up to max_size bytes, so that once it has grown to the
+     *  high-water mark of the workload, heap pages don't go to malloc().
+     *  Reference counted since Allocators may outlive the arena owner. */
+    class Arena
+    {
+    public:
+
+        explicit
+        Arena (size_t max_size);
+
+        void ref()   { refcnt_.add_and_fetch(1); }
+        void unref() { if (0 == refcnt_.sub_and_fetch(1)) delete this; }
+
+        /*! @param size - requested page size, on return - actual size
+         *  @return cached page or a newly allocated one or NULL */
+        byte_t* get (page_size_type& size);
+
+        /*! returns page to cache or frees it if cache is full */
+        void    put (byte_t* ptr, page_size_type size);
+
+        /*! total size of cached pages */
+        size_t  size() const { return size_; }
+
+    private:
+
+        ~Arena ();
+
+        typedef std::pair<byte_t*, page_size_type> CachedPage;
+
+        Mutex                   mtx_;
+        std::vector<CachedPage> pages_;
+        size_t const            max_size_;
+        size_t                  size_;
+        Atomic<int>             refcnt_;
+
+        Arena (const Arena&);
+        Arena& operator= (const Arena&);
+    };
+
     explicit
     Allocator (const BaseName&     base_name      = BASE_NAME_DEFAULT,
                byte_t*             reserved       = NULL,
                page_size_type      reserved_size  = 0,
                heap_size_type      max_heap       = (1U << 22),   /* 4M  */
-               page_size_type      disk_page_size = (1U << 26));  /* 64M */
+               page_size_type      disk_page_size = (1U << 26),   /* 64M */
+               Arena*              arena          = NULL);
 
     ~Allocator ();
 
@@ -113,9 +157,23 @@ private:
     {
     public:
 
-        HeapPage (page_size_type max_size);
+        HeapPage (page_size_type max_size, Arena* arena);
+
+        ~HeapPage ()
+        {
+            if (arena_) arena_->put (base_ptr_, size_); else free (base_ptr_);
+        }
+
+        /* may exceed requested size if the page came from arena */
+        page_size_type capacity() const { return size_; }
 
-        ~HeapPage () { free (base_ptr_); }
+    private:
+
+        Arena* const   arena_;
+        page_size_type size_;
+
+        HeapPage (const HeapPage&);
+        HeapPage& operator= (const HeapPage&);
     };
 
     class FilePage : public Page
@@ -151,13 +209,21 @@ private:
     {
     public:
 
-        HeapStore (heap_size_type max) : PageStore(), left_(max) {}
+        HeapStore (heap_size_type max, Arena* arena)
+            : PageStore(), left_(max), arena_(arena)
+        {
+            if (arena_) arena_->ref();
+        }
 
-        ~HeapStore () {}
+        ~HeapStore () { if (arena_) arena_->unref(); }
 
     private:
 
         heap_size_type left_;
+        Arena* const   arena_;
+
+        HeapStore (const HeapStore&);
+        HeapStore& operator= (const HeapStore&);
 
         Page* my_new_page (page_size_type const size);
     };
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2015 Codership Oy <info@codership.com>
+ */
+
+#include "gu_compress.hpp"
+#include "gu_throw.hpp"
+
+#ifdef HAVE_ZLIB_H
+#include <zlib.h>
+#endif /* HAVE_ZLIB_H */
+
+#include <cerrno>
+
+bool gu::compress_supported()
+{
+#ifdef HAVE_ZLIB_H
+    return true;
+#else
+    return false;
+#endif /* HAVE_ZLIB_H */
+}
+
+bool gu::compress(const void* const buf, size_t const len,
+                  std::vector<byte_t>& out, int const level)
+{
+#ifdef HAVE_ZLIB_H
+    size_t const old_size(out.size());
+    uLongf       out_len(compressBound(len));
+
+    out.resize(old_size + out_len);
+
+    int const err(compress2(&out[0] + old_size, &out_len,
+                            static_cast<const Bytef*>(buf), len, level));
+
+    if (err != Z_OK || out_len >= len)
+    {
+        out.resize(old_size);
+        return false;
+    }
+
+    out.resize(old_size + out_len);
+    return true;
+#else
+    return false;
+#endif /* HAVE_ZLIB_H */
+}
+
+void gu::decompress(const void* const buf, size_t const len,
+                    void* const out, size_t const out_len)
+{
+#ifdef HAVE_ZLIB_H
+    uLongf    dlen(out_len);
+    int const err(uncompress(static_cast<Bytef*>(out), &dlen,
+                             static_cast<const Bytef*>(buf), len));
+
+    if (err != Z_OK || dlen != out_len)
+    {
+        gu_throw_error(EBADMSG) << "failed to decompress " << len
+                                << " bytes: " << err << ", got " << dlen
+                                << " bytes, expected " << out_len;
+    }
+#else
+    gu_throw_error(ENOTSUP) << "compression support not compiled in";
+#endif /* HAVE_ZLIB_H */
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2015 Codership Oy <info@codership.com>
+ */
+
+/*!
+ * @file Block compression helpers.
+ *
+ * Compression support is optional and depends on zlib being available
+ * at build time (HAVE_ZLIB_H). If it is not, compress() never compresses
+ * and decompress() throws.
+ */
+
+#ifndef _gu_compress_hpp_
+#define _gu_compress_hpp_
+
+#include "gu_types.hpp"
+
+#include <vector>
+#include <cstddef>
+
+namespace gu
+{
+    /*! @return true if compression support was compiled in */
+    bool compress_supported();
+
+    /*!
+     * Compress len bytes starting at buf, appending result to out.
+     *
+     * @param level compression level, 1 (fastest) - 9 (best)
+     * @return true if data was compressed into smaller size than the
+     *         original, false otherwise. In the latter case out is left
+     *         unchanged.
+     */
+    bool compress(const void* buf, size_t len,
+                  std::vector<byte_t>& out, int level);
+
+    /*!
+     * Decompress len bytes starting at buf into out which must be
+     * exactly out_len bytes, the length of the original data.
+     *
+     * @throw gu::Exception if data cannot be decompressed or the
+     *        decompressed length does not match out_len
+     */
+    void decompress(const void* buf, size_t len,
+                    void* out, size_t out_len);
+}
+
+#endif // _gu_compress_hpp_
@@ -34,7 +34,7 @@ void
 gu_lock_step_destroy (gu_lock_step_t* ls)
 {
     // this is not really fool-proof, but that's not for fools to use
-    while (gu_lock_step_cont(ls, 10)) {};
+    while (gu_lock_step_cont(ls, 10) > 0) {}; // -1 if not enabled
     gu_cond_destroy  (&ls->cond);
     gu_mutex_destroy (&ls->mtx);
     assert (0 == ls->wait);
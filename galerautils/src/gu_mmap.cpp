@@ -20,6 +20,10 @@
 #include <unistd.h>
 #include "gu_limits.h"
 
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
 #if defined(__FreeBSD__) && defined(MAP_NORESERVE)
 /* FreeBSD has never implemented this flags and will deprecate it. */
 #undef MAP_NORESERVE
@@ -74,6 +78,81 @@ namespace gu
         log_debug << "Memory mapped: " << ptr << " (" << size << " bytes)";
     }
 
+    MMap::MMap (size_t const sz)
+        :
+        size   (sz),
+        ptr    (mmap (NULL, size, PROT_READ|PROT_WRITE,
+                      MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0)),
+        mapped (ptr != GU_MAP_FAILED)
+    {
+        if (!mapped)
+        {
+            gu_throw_error(errno) << "Anonymous mmap() of " << size
+                                  << " bytes failed";
+        }
+
+#if defined(MADV_DONTFORK)
+        if (posix_madvise (ptr, size, MADV_DONTFORK))
+        {
+            int const err(errno);
+            log_warn << "Failed to set MADV_DONTFORK on anonymous mapping: "
+                     << err << " (" << strerror(err) << ")";
+        }
+#endif
+
+        log_debug << "Memory mapped: " << ptr << " (" << size << " bytes)";
+    }
+
+    bool
+    MMap::huge_pages() const
+    {
+#if defined(MADV_HUGEPAGE)
+        if (madvise(ptr, size, MADV_HUGEPAGE))
+        {
+            int const err(errno);
+            log_warn << "Failed to set MADV_HUGEPAGE on " << ptr << ": "
+                     << err << " (" << strerror(err) << ')';
+            return false;
+        }
+        return true;
+#else
+        log_warn << "MADV_HUGEPAGE is not supported on this platform";
+        return false;
+#endif
+    }
+
+    bool
+    MMap::bind_node(int const node) const
+    {
+#if defined(__linux__) && defined(SYS_mbind)
+        static int      const MPOL_BIND_    (2);
+        static unsigned const MPOL_MF_MOVE_ (1 << 1);
+        static int      const BITS(sizeof(unsigned long) * 8);
+
+        if (node < 0 || node >= 1024)
+        {
+            log_warn << "Invalid NUMA node: " << node;
+            return false;
+        }
+
+        unsigned long mask[1024 / BITS] = { 0, };
+        mask[node / BITS] = 1UL << (node % BITS);
+
+        if (syscall(SYS_mbind, ptr, size, MPOL_BIND_, mask,
+                    static_cast<unsigned long>(node + 2), MPOL_MF_MOVE_))
+        {
+            int const err(errno);
+            log_warn << "Failed to bind " << ptr << " to NUMA node " << node
+                     << ": " << err << " (" << strerror(err) << ')';
+            return false;
+        }
+        return true;
+#else
+        log_warn << "NUMA binding is not supported on this platform";
+        return false;
+#endif
+    }
+
     void
     MMap::dont_need() const
     {
@@ -22,9 +22,20 @@ public:
 
     MMap (const FileDescriptor& fd, bool sequential = false);
 
+    /* anonymous private mapping */
+    explicit MMap (size_t size);
+
     ~MMap ();
 
     void dont_need() const;
+
+    /* ask kernel to back the mapping with transparent huge pages,
+     * returns false if it is not supported */
+    bool huge_pages() const;
+
+    /* bind the mapping memory to NUMA node,
+     * returns false if it is not supported */
+    bool bind_node(int node) const;
     void sync(void *addr, size_t length) const;
     void sync() const;
     void unmap();
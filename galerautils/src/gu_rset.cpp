@@ -230,7 +230,8 @@ RecordSetOutBase::RecordSetOutBase (byte_t*                 reserved,
                                     size_t                  reserved_size,
                                     const BaseName&         base_name,
                                     CheckType const         ct,
-                                    Version const           version
+                                    Version const           version,
+                                    Allocator::Arena* const arena
 #ifdef GU_RSET_CHECK_SIZE
                                     ,ssize_t const          max_size
 #endif
@@ -240,7 +241,8 @@ RecordSetOutBase::RecordSetOutBase (byte_t*                 reserved,
 #ifdef GU_RSET_CHECK_SIZE
     max_size_   (max_size),
 #endif
-    alloc_      (base_name, reserved, reserved_size),
+    alloc_      (base_name, reserved, reserved_size,
+                 1U << 22 /* 4M */, 1U << 26 /* 64M */, arena),
     check_      (),
     bufs_       (),
     prev_stored_(true)
@@ -103,7 +103,8 @@ protected:
                       const BaseName&   base_name,     /* basename for on-disk
                                                         * allocator */
                       CheckType         ct,
-                      Version           version  = MAX_VERSION
+                      Version           version  = MAX_VERSION,
+                      Allocator::Arena* arena    = NULL
 #ifdef GU_RSET_CHECK_SIZE
                       ,ssize_t          max_size = 0x7fffffff
 #endif
@@ -226,12 +227,14 @@ public:
                   size_t              reserved_size,
                   const BaseName&     base_name,
                   CheckType           ct,
-                  Version             version  = MAX_VERSION
+                  Version             version  = MAX_VERSION,
+                  Allocator::Arena*   arena    = NULL
 #ifdef GU_RSET_CHECK_SIZE
                   ,ssize_t            max_size = 0x7fffffff
 #endif
         )
-        : RecordSetOutBase (reserved, reserved_size, base_name, ct, version
+        : RecordSetOutBase (reserved, reserved_size, base_name, ct, version,
+                            arena
 #ifdef GU_RSET_CHECK_SIZE
                             ,max_size
 #endif
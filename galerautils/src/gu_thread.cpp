@@ -6,11 +6,26 @@
 
 #include "gu_utils.hpp"
 #include "gu_string_utils.hpp"
+#include "gu_config.hpp"
+#include "gu_logger.hpp"
 #include "gu_throw.hpp"
 
+#include <sched.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <map>
 #include <vector>
 
+#ifndef CPU_SETSIZE
+#define CPU_SETSIZE 1024
+#endif
+
 static std::string const SCHED_OTHER_STR  ("other");
 static std::string const SCHED_FIFO_STR   ("fifo");
 static std::string const SCHED_RR_STR     ("rr");
@@ -91,3 +106,317 @@ void gu::thread_set_schedparam(pthread_t thd, const gu::ThreadSchedparam& sp)
         gu_throw_error(err) << "Failed to set thread schedparams " << sp;
     }
 }
+
+/* strict non-negative integer conversion, returns -1 on failure */
+static int parse_cpu_number(const std::string& str)
+{
+    if (str.empty() || str.find_first_not_of("0123456789") !=
+        std::string::npos) return -1;
+
+    long const ret(strtol(str.c_str(), 0, 10));
+
+    return (ret < CPU_SETSIZE ? ret : -1);
+}
+
+/* appends CPUs from a list of ranges like "0-3,8", as used both in sysfs
+ * and in ThreadAffinity representation, node<N> entries are allowed only
+ * if nodes is not null */
+static void parse_cpu_list(const std::string&                    list,
+                           const std::vector<std::vector<int> >* nodes,
+                           std::vector<int>&                     cpus)
+{
+    std::vector<std::string> items(gu::strsplit(list, ','));
+
+    for (size_t i(0); i < items.size(); ++i)
+    {
+        std::string& item(items[i]);
+        gu::trim(item);
+
+        if (item.empty()) continue;
+
+        if (nodes && item.compare(0, 4, "node") == 0)
+        {
+            int const n(parse_cpu_number(item.substr(4)));
+
+            if (n < 0 || size_t(n) >= nodes->size() || (*nodes)[n].empty())
+            {
+                gu_throw_error(EINVAL) << "No NUMA node with CPUs: '"
+                                       << item << "'";
+            }
+
+            cpus.insert(cpus.end(), (*nodes)[n].begin(), (*nodes)[n].end());
+            continue;
+        }
+
+        size_t const dash(item.find('-'));
+        int const first(parse_cpu_number(item.substr(0, dash)));
+        int const last (dash == std::string::npos ? first :
+                        parse_cpu_number(item.substr(dash + 1)));
+
+        if (first < 0 || last < first)
+        {
+            gu_throw_error(EINVAL) << "Invalid CPU range: '" << item << "'";
+        }
+
+        for (int c(first); c <= last; ++c) cpus.push_back(c);
+    }
+}
+
+/* reads the first line of sysfs file, returns false if it can't be read */
+static bool read_sysfs(const std::string& path, std::string& line)
+{
+    std::ifstream ifs(path.c_str());
+    return (std::getline(ifs, line).fail() == false);
+}
+
+std::vector<std::vector<int> > gu::numa_node_cpus()
+{
+    static std::string const node_dir("/sys/devices/system/node");
+
+    std::map<int, std::vector<int> > nodes;
+
+    DIR* const dir(opendir(node_dir.c_str()));
+
+    if (dir)
+    {
+        struct dirent* ent;
+
+        while ((ent = readdir(dir)) != 0)
+        {
+            std::string const name(ent->d_name);
+
+            if (name.compare(0, 4, "node") != 0) continue;
+
+            int const n(parse_cpu_number(name.substr(4)));
+            std::string cpulist;
+
+            if (n < 0 ||
+                !read_sysfs(node_dir + '/' + name + "/cpulist", cpulist))
+                continue;
+
+            try
+            {
+                parse_cpu_list(cpulist, 0, nodes[n]);
+            }
+            catch (gu::Exception& e)
+            {
+                log_warn << "Failed to parse CPU list of NUMA node " << n
+                         << ": " << e.what();
+                nodes.erase(n);
+            }
+        }
+
+        closedir(dir);
+    }
+
+    std::vector<std::vector<int> > ret;
+
+    if (nodes.empty())
+    {
+        std::vector<int> cpus;
+        std::string      online;
+
+        if (read_sysfs("/sys/devices/system/cpu/online", online))
+        {
+            try { parse_cpu_list(online, 0, cpus); }
+            catch (gu::Exception&) { cpus.clear(); }
+        }
+
+        if (cpus.empty())
+        {
+            long const n(sysconf(_SC_NPROCESSORS_ONLN));
+            for (long c(0); c < n && c < CPU_SETSIZE; ++c) cpus.push_back(c);
+        }
+
+        ret.push_back(cpus);
+    }
+    else
+    {
+        /* node numbers may be sparse, missing nodes have no CPUs */
+        ret.resize(nodes.rbegin()->first + 1);
+
+        for (std::map<int, std::vector<int> >::iterator i(nodes.begin());
+             i != nodes.end(); ++i)
+        {
+            ret[i->first].swap(i->second);
+        }
+    }
+
+    return ret;
+}
+
+static std::string const THREAD_AFFINITY_ANY("any");
+
+static void normalize_cpus(std::vector<int>& cpus)
+{
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+}
+
+gu::ThreadAffinity::ThreadAffinity(const std::string& cpus)
+    :
+    cpus_()
+{
+    std::string str(cpus);
+    gu::trim(str);
+
+    if (str.empty() || str == THREAD_AFFINITY_ANY) return;
+
+    std::vector<std::vector<int> > nodes;
+
+    if (str.find("node") != std::string::npos) nodes = numa_node_cpus();
+
+    parse_cpu_list(str, &nodes, cpus_);
+    normalize_cpus(cpus_);
+
+    if (cpus_.empty())
+    {
+        gu_throw_error(EINVAL) << "Invalid CPU list: '" << cpus << "'";
+    }
+}
+
+gu::ThreadAffinity::ThreadAffinity(const std::vector<int>& cpus)
+    :
+    cpus_(cpus)
+{
+    normalize_cpus(cpus_);
+}
+
+void gu::ThreadAffinity::print(std::ostream& os) const
+{
+    if (any())
+    {
+        os << THREAD_AFFINITY_ANY;
+        return;
+    }
+
+    for (size_t i(0); i < cpus_.size(); ++i)
+    {
+        size_t j(i);
+        while (j + 1 < cpus_.size() && cpus_[j + 1] == cpus_[j] + 1) ++j;
+
+        if (i > 0) os << ',';
+        os << cpus_[i];
+        if (j > i) os << '-' << cpus_[j];
+
+        i = j;
+    }
+}
+
+gu::ThreadAffinity gu::thread_get_affinity(pthread_t thd)
+{
+    std::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+
+    int const err(pthread_getaffinity_np(thd, sizeof(set), &set));
+    if (err != 0)
+    {
+        gu_throw_error(err) << "Failed to read thread affinity";
+    }
+
+    for (int c(0); c < CPU_SETSIZE; ++c)
+    {
+        if (CPU_ISSET(c, &set)) cpus.push_back(c);
+    }
+#endif /* __linux__ */
+    return ThreadAffinity(cpus);
+}
+
+void gu::thread_set_affinity(pthread_t thd, const gu::ThreadAffinity& ta)
+{
+    if (ta.any()) return;
+
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+
+    for (size_t i(0); i < ta.cpus().size(); ++i)
+    {
+        CPU_SET(ta.cpus()[i], &set);
+    }
+
+    int const err(pthread_setaffinity_np(thd, sizeof(set), &set));
+    if (err != 0)
+    {
+        gu_throw_error(err) << "Failed to set thread affinity " << ta;
+    }
+#else
+    gu_throw_error(ENOSYS) << "Setting thread affinity is not supported "
+                           << "on this platform";
+#endif /* __linux__ */
+}
+
+static const char* const THREAD_ROLES[] =
+{
+    "gcomm", "gcs_recv", "applier", "service", "ist", "*", 0
+};
+
+gu::ThreadAffinity gu::thread_affinity(const std::string& spec,
+                                       const std::string& role)
+{
+    ThreadAffinity ret;
+    ThreadAffinity dflt;
+    bool           found(false);
+
+    std::istringstream iss(spec);
+    std::string        item;
+
+    while (iss >> item)
+    {
+        size_t const colon(item.find(':'));
+
+        if (colon == std::string::npos)
+        {
+            gu_throw_error(EINVAL) << "Invalid thread affinity '" << item
+                                   << "', expected <role>:<cpus>";
+        }
+
+        std::string const name(item.substr(0, colon));
+
+        int r(0);
+        while (THREAD_ROLES[r] && name != THREAD_ROLES[r]) ++r;
+
+        if (!THREAD_ROLES[r])
+        {
+            gu_throw_error(EINVAL) << "Unknown thread role '" << name
+                                   << "' in '" << spec << "'";
+        }
+
+        /* parse all entries to report malformed ones */
+        ThreadAffinity const ta(item.substr(colon + 1));
+
+        if (name == role)
+        {
+            ret   = ta;
+            found = true;
+        }
+        else if (name == "*")
+        {
+            dflt = ta;
+        }
+    }
+
+    return (found ? ret : dflt);
+}
+
+gu::ThreadAffinity gu::thread_affinity(const gu::Config&  cnf,
+                                       const std::string& role)
+{
+    try
+    {
+        if (cnf.is_set(conf::thread_affinity))
+        {
+            return thread_affinity(cnf.get(conf::thread_affinity), role);
+        }
+    }
+    catch (gu::NotFound&) {}
+
+    return ThreadAffinity();
+}
+
+void gu::thread_register_params(gu::Config& cnf)
+{
+    cnf.add(conf::thread_affinity);
+}
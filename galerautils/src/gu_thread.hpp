@@ -12,9 +12,26 @@
 #include <pthread.h>
 
 #include <string>
+#include <vector>
 
 namespace gu
 {
+    class Config;
+
+    namespace conf
+    {
+        //
+        // CPU affinity of provider threads, a whitespace separated list
+        // of <role>:<cpus> pairs, e.g. "gcomm:0 applier:node0 ist:node1".
+        // Roles are "gcomm" (group communication network thread),
+        // "gcs_recv" (GCS receive thread), "applier", "service" (writeset
+        // service thread), "ist" (IST sender and receiver threads) and
+        // "*" (all roles not listed explicitly). See ThreadAffinity for
+        // the format of <cpus>.
+        //
+        const std::string thread_affinity("thread.affinity");
+    }
+
     //
     // Wrapper class for thread scheduling parameters. For details,
     // about values see sched_setscheduler() and pthread_setschedparams()
@@ -103,6 +120,106 @@ namespace gu
     {
         sp.print(os); return os;
     }
+
+    //
+    // Set of CPUs a thread is allowed to run on. Empty set means that
+    // thread placement is left to the operating system.
+    //
+    class ThreadAffinity
+    {
+    public:
+        //
+        // Default constructor. Initializes to empty set.
+        //
+        ThreadAffinity() : cpus_() { }
+
+        //
+        // Construct ThreadAffinity from given string representation,
+        // which is a comma separated list of
+        //
+        //  <cpu> | <first cpu>-<last cpu> | node<N>
+        //
+        // where node<N> stands for all CPUs of NUMA node N as reported
+        // by numa_node_cpus(). Empty string or "any" give empty set.
+        //
+        ThreadAffinity(const std::string& cpus);
+
+        //
+        // Construct ThreadAffinity from given list of CPUs.
+        //
+        explicit ThreadAffinity(const std::vector<int>& cpus);
+
+        // Return sorted list of CPUs
+        const std::vector<int>& cpus() const { return cpus_; }
+
+        // Return true if placement is left to the operating system
+        bool any() const { return cpus_.empty(); }
+
+        bool operator==(const ThreadAffinity& other) const
+        {
+            return (cpus_ == other.cpus_);
+        }
+
+        bool operator!=(const ThreadAffinity& other) const
+        {
+            return !(*this == other);
+        }
+
+        // Print as a list of CPU ranges, e.g. "0-3,8"
+        void print(std::ostream& os) const;
+
+    private:
+
+        std::vector<int> cpus_;
+    };
+
+    //
+    // Return CPUs of each NUMA node as discovered from
+    // /sys/devices/system/node. If NUMA topology is not available, a single
+    // node with all online CPUs is returned.
+    //
+    std::vector<std::vector<int> > numa_node_cpus();
+
+    //
+    // Return current CPU affinity of given thread.
+    //
+    ThreadAffinity thread_get_affinity(pthread_t thread);
+
+    //
+    // Set CPU affinity of given thread, does nothing if affinity.any().
+    //
+    // Throws gu::Exception if setting affinity fails.
+    //
+    void thread_set_affinity(pthread_t thread, const ThreadAffinity&);
+
+    //
+    // Return affinity of thread role from conf::thread_affinity
+    // specification. Throws gu::Exception with EINVAL if specification
+    // is malformed.
+    //
+    ThreadAffinity thread_affinity(const std::string& spec,
+                                   const std::string& role);
+
+    //
+    // Return affinity of thread role from configuration, empty set if
+    // conf::thread_affinity is not registered or not set.
+    //
+    ThreadAffinity thread_affinity(const Config& cnf,
+                                   const std::string& role);
+
+    //
+    // Register thread parameters to config.
+    //
+    void thread_register_params(Config& cnf);
+
+    //
+    // Insertion operator for ThreadAffinity
+    //
+    inline std::ostream& operator<<(std::ostream& os,
+                                    const gu::ThreadAffinity& ta)
+    {
+        ta.print(os); return os;
+    }
 }
 
 
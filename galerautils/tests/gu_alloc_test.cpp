@@ -82,10 +82,54 @@ START_TEST (basic)
 }
 END_TEST
 
+START_TEST (arena)
+{
+    TestBaseName test_name("gu_alloc_arena_test");
+    gu::Allocator::Arena* const arena(new gu::Allocator::Arena(1 << 16));
+    size_t const r(1 << 10);
+    bool   n;
+    void*  p;
+
+    {
+        gu::Allocator a(test_name, NULL, 0, 1 << 16, 1 << 16, arena);
+        p = a.alloc(r, n);
+        fail_if (0 == p);
+        fail_if (!n);
+    }
+
+    fail_if (0 == arena->size(), "released page was not cached");
+
+    {
+        gu::Allocator a(test_name, NULL, 0, 1 << 16, 1 << 16, arena);
+        void* const p1(a.alloc(r, n));
+        fail_if (!n);
+        fail_if (p1 != p, "cached page was not reused: %p != %p", p1, p);
+        fail_if (0 != arena->size());
+    }
+
+    arena->unref();
+
+    /* cache is capped */
+    gu::Allocator::Arena* const small(new gu::Allocator::Arena(1));
+
+    {
+        gu::Allocator a(test_name, NULL, 0, 1 << 16, 1 << 16, small);
+        p = a.alloc(r, n);
+        fail_if (0 == p);
+        fail_if (!n);
+    }
+
+    fail_if (0 != small->size());
+
+    small->unref();
+}
+END_TEST
+
 Suite* gu_alloc_suite ()
 {
     TCase* t = tcase_create ("Allocator");
     tcase_add_test (t, basic);
+    tcase_add_test (t, arena);
 
     Suite* s = suite_create ("gu::Allocator");
     suite_add_tcase (s, t);
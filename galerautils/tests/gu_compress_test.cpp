@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2015 Codership Oy <info@codership.com>
+ */
+
+#include "../src/gu_compress.hpp"
+#include "../src/gu_exception.hpp"
+
+#include "gu_compress_test.hpp"
+
+#include <cstring>
+
+START_TEST(test_compress)
+{
+    std::vector<gu::byte_t> src(1 << 16);
+    for (size_t i(0); i < src.size(); ++i)
+    {
+        src[i] = "compressible"[i % 12];
+    }
+
+    std::vector<gu::byte_t> out(3, 0xff); // compressed data is appended
+
+    if (gu::compress_supported() == false)
+    {
+        fail_if(gu::compress(&src[0], src.size(), out, 1));
+        fail_if(out.size() != 3);
+        return;
+    }
+
+    fail_unless(gu::compress(&src[0], src.size(), out, 1));
+    fail_unless(out.size() > 3);
+    fail_unless(out.size() < src.size());
+
+    std::vector<gu::byte_t> res(src.size());
+    gu::decompress(&out[3], out.size() - 3, &res[0], res.size());
+    fail_if(memcmp(&src[0], &res[0], src.size()) != 0);
+
+    // wrong original length must be detected
+    try
+    {
+        gu::decompress(&out[3], out.size() - 3, &res[0], res.size() - 1);
+        fail("decompress into short buffer succeeded");
+    }
+    catch (gu::Exception& e) { }
+
+    // incompressible data is not compressed
+    for (size_t i(0); i < 16; ++i) src[i] = i * 37;
+    std::vector<gu::byte_t> out2;
+    fail_if(gu::compress(&src[0], 16, out2, 9));
+    fail_if(out2.empty() == false);
+}
+END_TEST
+
+Suite* gu_compress_suite()
+{
+    TCase* t = tcase_create ("test_compress");
+    tcase_add_test (t, test_compress);
+
+    Suite* s = suite_create ("gu::compress");
+    suite_add_tcase (s, t);
+
+    return s;
+}
@@ -26,6 +26,7 @@
 #include "gu_histogram_test.hpp"
 #include "gu_stats_test.hpp"
 #include "gu_thread_test.hpp"
+#include "gu_compress_test.hpp"
 
 typedef Suite *(*suite_creator_t)(void);
 
@@ -47,6 +48,7 @@ static suite_creator_t suites[] =
     gu_histogram_suite,
     gu_stats_suite,
     gu_thread_suite,
+    gu_compress_suite,
     0
 };
 
@@ -5,6 +5,8 @@
 
 
 #include "gu_thread.hpp"
+#include "gu_config.hpp"
+#include "gu_exception.hpp"
 #include <sstream>
 
 #include "gu_thread_test.hpp"
@@ -50,6 +52,96 @@ START_TEST(check_thread_schedparam_system_default)
 }
 END_TEST
 
+START_TEST(check_thread_affinity_parse)
+{
+    gu::ThreadAffinity const any("any");
+    fail_unless(any.any());
+    fail_unless(gu::ThreadAffinity("") == any);
+
+    gu::ThreadAffinity const ta(" 8, 0-3 ,2,10-11");
+    fail_unless(ta.cpus().size() == 7, "%zu", ta.cpus().size());
+
+    std::ostringstream oss;
+    oss << ta;
+    fail_unless(oss.str() == "0-3,8,10-11", "'%s'", oss.str().c_str());
+
+    const char* const bad[] = { "x", "3-1", "-1", "1-", "1x", ",", 0 };
+    for (int i(0); bad[i]; ++i)
+    {
+        try
+        {
+            gu::ThreadAffinity const b(bad[i]);
+            fail("'%s' should have failed", bad[i]);
+        }
+        catch (gu::Exception& e)
+        {
+            fail_unless(e.get_errno() == EINVAL);
+        }
+    }
+
+    std::vector<std::vector<int> > const nodes(gu::numa_node_cpus());
+    fail_unless(nodes.size() > 0);
+
+    size_t n(0);
+    while (nodes[n].empty()) ++n;
+    gu::ThreadAffinity const node(std::string("node") + char('0' + n));
+    fail_unless(node == gu::ThreadAffinity(nodes[n]));
+}
+END_TEST
+
+START_TEST(check_thread_affinity_roles)
+{
+    std::string const spec("gcomm:0 applier:1-2\t*:3");
+
+    fail_unless(gu::thread_affinity(spec, "gcomm")   ==
+                gu::ThreadAffinity("0"));
+    fail_unless(gu::thread_affinity("applier:1-2 *:3", "applier") ==
+                gu::ThreadAffinity("1,2"));
+    fail_unless(gu::thread_affinity("applier:1-2 *:3", "ist") ==
+                gu::ThreadAffinity("3"));
+    fail_unless(gu::thread_affinity("gcomm:0", "ist").any());
+
+    const char* const bad[] = { "gcomm", "foo:1", "ist:x", 0 };
+    for (int i(0); bad[i]; ++i)
+    {
+        try
+        {
+            gu::thread_affinity(bad[i], "ist");
+            fail("'%s' should have failed", bad[i]);
+        }
+        catch (gu::Exception& e)
+        {
+            fail_unless(e.get_errno() == EINVAL);
+        }
+    }
+
+    gu::Config conf;
+    fail_unless(gu::thread_affinity(conf, "ist").any());
+    gu::thread_register_params(conf);
+    fail_unless(gu::thread_affinity(conf, "ist").any());
+    conf.set(gu::conf::thread_affinity, "ist:1");
+    fail_unless(gu::thread_affinity(conf, "ist") == gu::ThreadAffinity("1"));
+}
+END_TEST
+
+START_TEST(check_thread_affinity_set)
+{
+    gu::ThreadAffinity const orig(gu::thread_get_affinity(pthread_self()));
+    fail_unless(orig.any() == false);
+
+    gu::ThreadAffinity const first(std::vector<int>(1, orig.cpus()[0]));
+    gu::thread_set_affinity(pthread_self(), first);
+    fail_unless(gu::thread_get_affinity(pthread_self()) == first);
+
+    /* empty set leaves placement unchanged */
+    gu::thread_set_affinity(pthread_self(), gu::ThreadAffinity());
+    fail_unless(gu::thread_get_affinity(pthread_self()) == first);
+
+    gu::thread_set_affinity(pthread_self(), orig);
+    fail_unless(gu::thread_get_affinity(pthread_self()) == orig);
+}
+END_TEST
+
 Suite* gu_thread_suite()
 {
     Suite* s(suite_create("galerautils Thread"));
@@ -59,5 +151,11 @@ Suite* gu_thread_suite()
     tcase_add_test(tc, check_thread_schedparam_parse);
     tcase_add_test(tc, check_thread_schedparam_system_default);
 
+    tc = tcase_create("affinity");
+    suite_add_tcase(s, tc);
+    tcase_add_test(tc, check_thread_affinity_parse);
+    tcase_add_test(tc, check_thread_affinity_roles);
+    tcase_add_test(tc, check_thread_affinity_set);
+
     return s;
 }
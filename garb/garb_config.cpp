@@ -42,6 +42,7 @@ Config::Config (int argc, char* argv[])
       options_ (),
       log_     (),
       cfg_     (),
+      ist_donor_(false),
       exit_    (false)
 {
     po::options_description other ("Other options");
@@ -61,6 +62,7 @@ Config::Config (int argc, char* argv[])
         ("donor",    po::value<std::string>(&donor_),   "SST donor name")
         ("options,o",po::value<std::string>(&options_), "GCS/GCOMM option list")
         ("log,l",    po::value<std::string>(&log_),     "Log file")
+        ("ist-donor", "Keep write set cache in gcache.dir and serve IST")
         ;
 
     po::options_description cfg_opt;
@@ -126,6 +128,11 @@ Config::Config (int argc, char* argv[])
         daemon_ = true;
     }
 
+    if (vm.count("ist-donor"))
+    {
+        ist_donor_ = true;
+    }
+
     /* Seeing how https://svn.boost.org/trac/boost/ticket/850 is fixed long and
      * hard, it becomes clear what an undercooked piece of... cake(?) boost is.
      * - need to strip quotes manually if used in config file.
@@ -168,7 +175,8 @@ std::ostream& operator << (std::ostream& os, const Config& c)
        << "\n\tdonor:   " << c.donor()
        << "\n\toptions: " << c.options()
        << "\n\tcfg:     " << c.cfg()
-       << "\n\tlog:     " << c.log();
+       << "\n\tlog:     " << c.log()
+       << "\n\tist-donor: " << c.ist_donor();
     return os;
 }
 
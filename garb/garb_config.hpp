@@ -27,6 +27,7 @@ public:
     const std::string& options() const { return options_; }
     const std::string& cfg()     const { return cfg_    ; }
     const std::string& log()     const { return log_    ; }
+    bool               ist_donor() const { return ist_donor_; }
     bool               exit()    const { return exit_   ; }
 
 private:
@@ -40,6 +41,7 @@ private:
     std::string options_;
     std::string log_;
     std::string cfg_;
+    bool        ist_donor_;
     bool exit_; /* Exit on --help or --version */
 
 }; /* class Config */
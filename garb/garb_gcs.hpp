@@ -14,6 +14,7 @@ class Gcs
 public:
 
     Gcs (gu::Config&        conf,
+         gcache_t*          cache,
          const std::string& name,
          const std::string& address,
          const std::string& group);
@@ -0,0 +1,241 @@
+/* Copyright (C) 2015 Codership Oy <info@codership.com> */
+
+#include "garb_ist_donor.hpp"
+
+#include <uuid.hpp>
+
+#include <gu_serialize.hpp>
+#include <gu_throw.hpp>
+#include <gu_logger.hpp>
+
+#include <sstream>
+
+namespace garb
+{
+
+static std::string const GCACHE_DIR("gcache.dir");
+
+/* daemon changes working directory to "/", so the cache location must be
+ * given explicitly */
+static const std::string&
+gcache_dir (const gu::Config& conf)
+{
+    const std::string& dir(conf.get(GCACHE_DIR));
+
+    if (dir.empty())
+    {
+        gu_throw_error(EINVAL) << "IST donor mode requires '" << GCACHE_DIR
+                               << "' to be set";
+    }
+
+    return dir;
+}
+
+/* see galera::ReplicatorSMM::establish_protocol_versions() */
+static int
+trx_proto_ver (int const repl_proto_ver)
+{
+    switch (repl_proto_ver)
+    {
+    case 1:
+    case 2:  return 1;
+    case 3:
+    case 4:  return 2;
+    default: return 3;
+    }
+}
+
+void
+IstDonor::register_params (gu::Config& conf)
+{
+    gcache::GCache::register_params(conf);
+    galera::Certification::register_params(conf);
+}
+
+IstDonor::IstDonor (gu::Config& conf)
+    :
+    conf_       (conf),
+    gcache_     (conf, gcache_dir(conf)),
+    gcs_        (conf, gcache_),
+    service_thd_(gcs_, gcache_),
+    slave_pool_ (sizeof(galera::TrxHandle), 1024, "SlaveTrxHandle"),
+    cert_       (conf, service_thd_, gcache_),
+    senders_    (gcache_),
+    state_uuid_ (GU_UUID_NIL),
+    last_seqno_ (GCS_SEQNO_ILL),
+    cc_seqno_   (GCS_SEQNO_ILL),
+    proto_ver_  (-1)
+{
+    log_info << "Serving IST from " << conf.get(GCACHE_DIR);
+}
+
+IstDonor::~IstDonor ()
+{
+    senders_.cancel();
+    service_thd_.flush();
+}
+
+void
+IstDonor::process_trx (const gcs_action& act)
+{
+    assert(act.seqno_g > 0);
+    assert(act.seqno_l > 0);
+
+    galera::TrxHandle* const trx(galera::TrxHandle::New(slave_pool_));
+
+    try
+    {
+        const gu::byte_t* const buf(static_cast<const gu::byte_t*>(act.buf));
+
+        gu_trace(trx->unserialize(buf, act.size, 0));
+        trx->set_received(act.buf, act.seqno_l, act.seqno_g);
+        trx->verify_checksum();
+
+        /* depends_seqno is -1 if certification failed, this is how joiner
+         * learns that it must skip this write set */
+        (void)cert_.append_trx(trx);
+        gcache_.seqno_assign(act.buf, act.seqno_g, trx->depends_seqno());
+
+        (void)cert_.set_trx_committed(trx);
+    }
+    catch (...)
+    {
+        trx->unref();
+        throw;
+    }
+
+    trx->unref();
+    last_seqno_ = act.seqno_g;
+}
+
+void
+IstDonor::process_commit_cut (const gcs_action& act)
+{
+    gcs_seqno_t seq;
+    gu::unserialize8(static_cast<const gu::byte_t*>(act.buf), act.size, 0,
+                     seq);
+
+    /* see galera::ReplicatorSMM::process_commit_cut() */
+    if (seq >= cc_seqno_) cert_.purge_trxs_upto(seq, true);
+}
+
+void
+IstDonor::process_conf (const gcs_act_conf_t& conf)
+{
+    if (conf.conf_id < 0) return; /* non-primary */
+
+    gu_uuid_t uuid;
+    ::memcpy(&uuid, conf.uuid, sizeof(uuid));
+
+    proto_ver_ = conf.repl_proto_ver;
+
+    /* all members reset certification at primary configuration change,
+     * so do we to get the same verdicts */
+    cert_.assign_initial_position(conf.seqno, trx_proto_ver(proto_ver_));
+    service_thd_.flush();
+
+    if (state_uuid_ != uuid || last_seqno_ != conf.seqno)
+    {
+        /* missed some history, it has to be started anew */
+        log_info << "Resetting IST cache to " << uuid << ':' << conf.seqno;
+        gcache_.seqno_reset(uuid, conf.seqno);
+        state_uuid_ = uuid;
+    }
+
+    last_seqno_ = conf.seqno;
+    cc_seqno_   = conf.seqno;
+}
+
+/* State request layout (see galera::StateRequest_v1):
+ * "STRv1\0", uint32_t SST length, SST request, uint32_t IST length, IST req. */
+gcs_seqno_t
+IstDonor::process_state_req (const gcs_action& act)
+{
+    static const char   MAGIC[] = "STRv1";
+    const char* const   req(static_cast<const char*>(act.buf));
+    size_t const        len(act.size);
+    size_t              off(sizeof(MAGIC));
+
+    if (len < off + 2 * sizeof(uint32_t) || ::strcmp(req, MAGIC))
+    {
+        log_info << "Refusing state transfer: SST is not supported";
+        return -ENOSYS;
+    }
+
+    uint32_t const sst_len(gtohl(*reinterpret_cast<const uint32_t*>(req+off)));
+    off += sizeof(uint32_t) + sst_len;
+
+    if (sst_len != 0)
+    {
+        log_info << "Refusing state transfer: SST is not supported";
+        return -ENOSYS;
+    }
+
+    uint32_t const ist_len(gtohl(*reinterpret_cast<const uint32_t*>(req+off)));
+    off += sizeof(uint32_t);
+
+    if (off + ist_len != len)
+    {
+        log_error << "Malformed state transfer request: IST length "
+                  << ist_len << ", total length: " << len;
+        return -EINVAL;
+    }
+
+    galera::IST_request istr;
+    std::istringstream is(std::string(req + off, ist_len));
+    is >> istr;
+
+    if (galera::to_gu_uuid(istr.uuid()) != state_uuid_)
+    {
+        log_info << "Refusing IST request " << istr << ": local history is "
+                 << state_uuid_;
+        return -ECANCELED;
+    }
+
+    log_info << "IST request: " << istr;
+
+    try
+    {
+        gcache_.seqno_lock(istr.last_applied() + 1);
+    }
+    catch (gu::NotFound&)
+    {
+        log_info << "IST first seqno " << istr.last_applied() + 1
+                 << " not found from cache";
+        return -ENODATA;
+    }
+
+    try
+    {
+        /* sender thread unlocks gcache when done */
+        senders_.run(conf_, istr.peer(), istr.last_applied() + 1, cc_seqno_,
+                     proto_ver_);
+    }
+    catch (gu::Exception& e)
+    {
+        log_error << "IST failed: " << e.what();
+        gcache_.seqno_unlock();
+        return -e.get_errno();
+    }
+
+    return act.seqno_g;
+}
+
+void
+IstDonor::release (const gcs_action& act)
+{
+    switch (act.type)
+    {
+    case GCS_ACT_TORDERED:
+        /* referenced by certification index, released by commit cut */
+        break;
+    case GCS_ACT_STATE_REQ:
+        gcache_.free(const_cast<void*>(act.buf));
+        break;
+    default:
+        ::free(const_cast<void*>(act.buf));
+        break;
+    }
+}
+
+} /* namespace garb */
@@ -0,0 +1,71 @@
+/* Copyright (C) 2015 Codership Oy <info@codership.com> */
+
+#ifndef _GARB_IST_DONOR_HPP_
+#define _GARB_IST_DONOR_HPP_
+
+#include <GCache.hpp>
+#include <certification.hpp>
+#include <galera_service_thd.hpp>
+#include <galera_gcs.hpp>
+#include <ist.hpp>
+
+#include <gcs.hpp>
+#include <gu_config.hpp>
+
+namespace garb
+{
+
+/*!
+ * Keeps write set history in GCache and serves IST requests from it.
+ *
+ * Write sets are certified as they arrive so that the joiner receives
+ * correct certification verdicts (seqno_d) with them. Only IST-only requests
+ * can be served as arbitrator has no state to send in SST.
+ */
+class IstDonor
+{
+public:
+
+    static void register_params(gu::Config& conf);
+
+    IstDonor (gu::Config& conf);
+
+    ~IstDonor ();
+
+    /*! cache to be used by GCS for received actions */
+    gcache_t* gcache() { return reinterpret_cast<gcache_t*>(&gcache_); }
+
+    void process_trx        (const gcs_action& act);
+
+    void process_commit_cut (const gcs_action& act);
+
+    void process_conf       (const gcs_act_conf_t& conf);
+
+    /*! @return seqno to join the group with or negative error code */
+    gcs_seqno_t process_state_req (const gcs_action& act);
+
+    /*! releases action buffer according to where it was allocated */
+    void release (const gcs_action& act);
+
+private:
+
+    gu::Config&                      conf_;
+    gcache::GCache                   gcache_;
+    galera::DummyGcs                 gcs_;  // only for service_thd_
+    galera::ServiceThd               service_thd_;
+    galera::TrxHandle::SlavePool     slave_pool_;
+    galera::Certification            cert_;
+    galera::ist::AsyncSenderMap      senders_;
+    gu_uuid_t                        state_uuid_;
+    gcs_seqno_t                      last_seqno_;
+    gcs_seqno_t                      cc_seqno_;
+    int                              proto_ver_;
+
+    IstDonor (const IstDonor&);
+    IstDonor& operator= (const IstDonor&);
+
+}; /* class IstDonor */
+
+} /* namespace garb */
+
+#endif /* _GARB_IST_DONOR_HPP_ */
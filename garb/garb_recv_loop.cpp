@@ -24,7 +24,9 @@ RecvLoop::RecvLoop (const Config& config)
     gconf_ (),
     params_(gconf_),
     parse_ (gconf_, config_.options()),
-    gcs_   (gconf_, config_.name(), config_.address(), config_.group())
+    donor_ (gconf_, config_.ist_donor()),
+    gcs_   (gconf_, donor_.donor_ ? donor_.donor_->gcache() : NULL,
+            config_.name(), config_.address(), config_.group())
 {
     /* set up signal handlers */
     global_gcs = &gcs_;
@@ -53,6 +55,8 @@ RecvLoop::RecvLoop (const Config& config)
 void
 RecvLoop::loop()
 {
+    IstDonor* const donor(donor_.donor_);
+
     while (1)
     {
         gcs_action act;
@@ -62,6 +66,8 @@ RecvLoop::loop()
         switch (act.type)
         {
         case GCS_ACT_TORDERED:
+            if (donor) donor->process_trx (act);
+
             if (gu_unlikely(!(act.seqno_g & 127)))
                 /* == report_interval_ of 128 */
             {
@@ -69,15 +75,19 @@ RecvLoop::loop()
             }
             break;
         case GCS_ACT_COMMIT_CUT:
+            if (donor) donor->process_commit_cut (act);
             break;
         case GCS_ACT_STATE_REQ:
-            gcs_.join (-ENOSYS); /* we can't donate state */
+            /* without history we can't donate state */
+            gcs_.join (donor ? donor->process_state_req (act) : -ENOSYS);
             break;
         case GCS_ACT_CONF:
         {
             const gcs_act_conf_t* const cc
                 (reinterpret_cast<const gcs_act_conf_t*>(act.buf));
 
+            if (donor) donor->process_conf (*cc);
+
             if (cc->conf_id > 0) /* PC */
             {
                 if (GCS_NODE_STATE_PRIM == cc->my_state)
@@ -111,7 +121,10 @@ RecvLoop::loop()
 
         if (act.buf)
         {
-            free (const_cast<void*>(act.buf));
+            if (donor)
+                donor->release (act);
+            else
+                free (const_cast<void*>(act.buf));
         }
     }
 }
@@ -5,6 +5,7 @@
 
 #include "garb_gcs.hpp"
 #include "garb_config.hpp"
+#include "garb_ist_donor.hpp"
 
 #include <gu_throw.hpp>
 #include <gu_asio.hpp>
@@ -34,6 +35,7 @@ private:
         RegisterParams(gu::Config& cnf)
         {
             gu::ssl_register_params(cnf);
+            IstDonor::register_params(cnf);
             if (gcs_register_params(reinterpret_cast<gu_config_t*>(&cnf)))
             {
                 gu_throw_fatal << "Error initializing GCS parameters";
@@ -51,6 +53,20 @@ private:
     }
         parse_;
 
+    struct Donor
+    {
+        Donor(gu::Config& cnf, bool enabled)
+            : donor_(enabled ? new IstDonor(cnf) : 0) { }
+        ~Donor() { delete donor_; }
+
+        IstDonor* const donor_;
+
+    private:
+        Donor(const Donor&);
+        Donor& operator=(const Donor&);
+    }
+        donor_;
+
     Gcs           gcs_;
 }; /* RecvLoop */
 
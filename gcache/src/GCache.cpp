@@ -50,14 +50,16 @@ namespace gcache
         gid       (),
         mem       (params.mem_size(), seqno2ptr),
         rb        (params.rb_name(), params.rb_size(), seqno2ptr, gid,
-                   params.recover()),
+                   params.recover(), params.rb_anonymous(),
+                   params.rb_huge_pages(), params.rb_numa_node()),
         ps        (params.dir_name(),
                    params.keep_pages_size(),
                    params.page_size(),
                    /* keep last page if PS is the only storage */
                    params.keep_pages_count() ?
                    params.keep_pages_count() :
-                   !((params.mem_size() + params.rb_size()) > 0)),
+                   !((params.mem_size() + params.rb_size()) > 0),
+                   params.page_prealloc()),
         mallocs   (0),
         reallocs  (0),
         frees     (0),
@@ -104,6 +104,11 @@ namespace gcache
          */
         size_t allocated_pool_size ();
 
+        /*!
+         * Returns page store statistics (page creation latency etc.)
+         */
+        PageStore::Stats page_stats () const { return ps.stats(); }
+
 
         /*!
          * Implements the cleanup policy test.
@@ -209,12 +214,17 @@ namespace gcache
             size_t page_size()           const { return page_size_;        }
             size_t keep_pages_size()     const { return keep_pages_size_;  }
             size_t keep_pages_count()    const { return keep_pages_count_; }
+            size_t page_prealloc()       const { return page_prealloc_;    }
+            bool   rb_anonymous()        const { return rb_anonymous_;     }
+            bool   rb_huge_pages()       const { return rb_huge_pages_;    }
+            int    rb_numa_node()        const { return rb_numa_node_;     }
             bool   recover()             const { return recover_;         }
 
             void mem_size         (size_t s) { mem_size_         = s; }
             void page_size        (size_t s) { page_size_        = s; }
             void keep_pages_size  (size_t s) { keep_pages_size_  = s; }
             void keep_pages_count (size_t c) { keep_pages_count_ = c; }
+            void page_prealloc    (size_t c) { page_prealloc_    = c; }
 
         private:
 
@@ -225,6 +235,10 @@ namespace gcache
             size_t            page_size_;
             size_t            keep_pages_size_;
             size_t            keep_pages_count_;
+            size_t            page_prealloc_;
+            bool        const rb_anonymous_;
+            bool        const rb_huge_pages_;
+            int         const rb_numa_node_;
             bool        const recover_;
         }
             params;
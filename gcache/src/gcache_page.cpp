@@ -26,8 +26,9 @@ gcache::Page::reset ()
         abort();
     }
 
-    space_ = mmap_.size;
-    next_  = static_cast<uint8_t*>(mmap_.ptr);
+    space_     = mmap_.size;
+    next_      = static_cast<uint8_t*>(mmap_.ptr);
+    min_space_ = space_;
 
     BH_clear (reinterpret_cast<BufferHeader*>(next_));
 }
@@ -48,12 +49,13 @@ gcache::Page::drop_fs_cache() const
 #endif
 }
 
-gcache::Page::Page (void* ps, const std::string& name, size_t size)
+gcache::Page::Page (void* ps, const std::string& name, size_t size,
+                    bool const allocate)
     :
 #ifdef HAVE_PSI_INTERFACE
-    fd_   (name, WSREP_PFS_INSTR_TAG_GCACHE_PAGE_FILE, size, false, false),
+    fd_   (name, WSREP_PFS_INSTR_TAG_GCACHE_PAGE_FILE, size, allocate, false),
 #else
-    fd_   (name, size, false, false),
+    fd_   (name, size, allocate, false),
 #endif /* HAVE_PSI_INTERFACE */
     mmap_ (fd_),
     ps_   (ps),
@@ -21,7 +21,9 @@ namespace gcache
     {
     public:
 
-        Page (void* ps, const std::string& name, size_t size);
+        /* allocate: reserve disk space for the whole file upfront */
+        Page (void* ps, const std::string& name, size_t size,
+              bool allocate = false);
         ~Page () {}
 
         void* malloc  (size_type size);
@@ -10,6 +10,7 @@
 
 #include <gu_logger.hpp>
 #include <gu_throw.hpp>
+#include <gu_time.h>
 
 #include <cstdio>
 #include <cstring>
@@ -47,47 +48,54 @@ make_page_name (const std::string& base_name, size_t count)
     return os.str();
 }
 
-static void*
-remove_file (void* __restrict__ arg)
+static void
+remove_file (const std::string& file_name)
 {
-    char* const file_name (static_cast<char*>(arg));
-
-#ifdef HAVE_PSI_INTERFACE
-    pfs_instr_callback(WSREP_PFS_INSTR_TYPE_THREAD,
-                       WSREP_PFS_INSTR_OPS_INIT,
-                       WSREP_PFS_INSTR_TAG_GCACHE_REMOVEFILE_THREAD,
-                       NULL, NULL, NULL);
-#endif /* HAVE_PSI_INTERFACE */
-
-    if (NULL != file_name)
+    if (remove (file_name.c_str()))
     {
-        if (remove (file_name))
-        {
-            int err = errno;
+        int err = errno;
 
-            log_error << "Failed to remove page file '" << file_name << "': "
-                      << err << " (" << strerror(err) << ")";
-        }
-        else
-        {
-            log_info << "Deleted page " << file_name;
-        }
-
-        free (file_name);
+        log_error << "Failed to remove page file '" << file_name << "': "
+                  << err << " (" << strerror(err) << ")";
     }
     else
     {
-        log_error << "Null file name in " << __FUNCTION__;
+        log_info << "Deleted page " << file_name;
     }
+}
 
-#ifdef HAVE_PSI_INTERFACE
-    pfs_instr_callback(WSREP_PFS_INSTR_TYPE_THREAD,
-                       WSREP_PFS_INSTR_OPS_DESTROY,
-                       WSREP_PFS_INSTR_TAG_GCACHE_REMOVEFILE_THREAD,
-                       NULL, NULL, NULL);
-#endif /* HAVE_PSI_INTERFACE */
+void
+gcache::PageStore::remove_page (Page* const page)
+{
+    std::string const file_name(page->name());
+
+    delete page;
+
+    remove_file (file_name);
+}
+
+gcache::Page*
+gcache::PageStore::create_page (size_t const size, bool const allocate)
+{
+    std::string name;
+    {
+        gu::Lock lock(mgr_mtx_);
+        name = make_page_name (base_name_, file_count_++);
+    }
+
+    long long const start(gu_time_monotonic());
+
+    Page* const page(new Page(this, name, size, allocate));
+
+    long long const ns(gu_time_monotonic() - start);
+
+    gu::Lock lock(mgr_mtx_);
+
+    ++stats_.created;
+    stats_.create_ns += ns;
+    if (stats_.create_ns_max < ns) stats_.create_ns_max = ns;
 
-    pthread_exit(NULL);
+    return page;
 }
 
 /*
@@ -106,27 +114,14 @@ gcache::PageStore::delete_page ()
 
     pages_.pop_front();
 
-    char* const file_name(strdup(page->name().c_str()));
-
     total_size_ -= page->size();
 
     if (current_ == page) current_ = 0;
 
-    delete page;
-
-#ifdef GCACHE_DETACH_THREAD
-    pthread_t delete_thr_;
-#else
-    if (delete_thr_ != pthread_t(-1)) pthread_join (delete_thr_, NULL);
-#endif /* GCACHE_DETACH_THERAD */
-
-    int err = gu_thread_create (&delete_thr_, &delete_page_attr_, remove_file,
-                                file_name);
-    if (0 != err)
-    {
-        delete_thr_ = pthread_t(-1);
-        gu_throw_error(err) << "Failed to create page file deletion thread";
-    }
+    /* page manager will either recycle or delete it */
+    gu::Lock lock(mgr_mtx_);
+    release_.push_back (page);
+    mgr_cond_.signal();
 
     return true;
 }
@@ -176,7 +171,29 @@ gcache::PageStore::reset ()
 inline void
 gcache::PageStore::new_page (size_type size)
 {
-    Page* const page(new Page(this, make_page_name (base_name_, count_), size));
+    Page* page(0);
+
+    {
+        gu::Lock lock(mgr_mtx_);
+
+        if (!ready_.empty() && ready_.front()->size() >= size_t(size))
+        {
+            page = ready_.front();
+            ready_.pop_front();
+        }
+
+        mgr_active_ = true;
+        mgr_failed_ = false; /* retry preallocation if it failed before */
+        mgr_cond_.signal();
+    }
+
+    if (0 == page)
+    {
+        page = create_page (page_size_ > size ? page_size_ : size, false);
+
+        gu::Lock lock(mgr_mtx_);
+        ++stats_.sync_created;
+    }
 
     pages_.push_back (page);
     total_size_ += page->size();
@@ -184,10 +201,121 @@ gcache::PageStore::new_page (size_type size)
     count_++;
 }
 
+void*
+gcache::PageStore::mgr_thread (void* arg)
+{
+#ifdef HAVE_PSI_INTERFACE
+    pfs_instr_callback(WSREP_PFS_INSTR_TYPE_THREAD,
+                       WSREP_PFS_INSTR_OPS_INIT,
+                       WSREP_PFS_INSTR_TAG_GCACHE_REMOVEFILE_THREAD,
+                       NULL, NULL, NULL);
+#endif /* HAVE_PSI_INTERFACE */
+
+    static_cast<PageStore*>(arg)->mgr_run();
+
+#ifdef HAVE_PSI_INTERFACE
+    pfs_instr_callback(WSREP_PFS_INSTR_TYPE_THREAD,
+                       WSREP_PFS_INSTR_OPS_DESTROY,
+                       WSREP_PFS_INSTR_TAG_GCACHE_REMOVEFILE_THREAD,
+                       NULL, NULL, NULL);
+#endif /* HAVE_PSI_INTERFACE */
+
+    return NULL;
+}
+
+bool
+gcache::PageStore::mgr_prealloc_needed () const
+{
+    return (mgr_active_ && !mgr_failed_ && !mgr_closing_ &&
+            ready_.size() < prealloc_);
+}
+
+void
+gcache::PageStore::mgr_run ()
+{
+    for (;;)
+    {
+        Page*  remove(0);
+        size_t create(0);
+
+        {
+            gu::Lock lock(mgr_mtx_);
+
+            while (release_.empty() && !mgr_prealloc_needed() && !mgr_closing_)
+            {
+                mgr_busy_ = false;
+                mgr_idle_.broadcast();
+                lock.wait(mgr_cond_);
+            }
+
+            if (!release_.empty())
+            {
+                Page* const page(release_.front());
+                release_.pop_front();
+
+                if (mgr_prealloc_needed() && page->size() == prealloc_size_)
+                {
+                    page->reset();
+                    ready_.push_back(page);
+                    ++stats_.recycled;
+                    log_debug << "Recycled page " << page->name();
+                    continue;
+                }
+
+                remove = page;
+            }
+            else if (mgr_closing_)
+            {
+                mgr_busy_ = false;
+                mgr_idle_.broadcast();
+                return;
+            }
+            else
+            {
+                create = prealloc_size_;
+            }
+
+            mgr_busy_ = true;
+        }
+
+        if (remove)
+        {
+            remove_page (remove);
+            continue;
+        }
+
+        assert(create > 0);
+
+        try
+        {
+            Page* const page(create_page (create, true));
+
+            gu::Lock lock(mgr_mtx_);
+
+            if (mgr_prealloc_needed() && page->size() == prealloc_size_)
+            {
+                ready_.push_back(page);
+            }
+            else
+            {
+                release_.push_back(page); /* not needed anymore */
+            }
+        }
+        catch (gu::Exception& e)
+        {
+            log_warn << "Failed to preallocate cache page: " << e.what();
+
+            gu::Lock lock(mgr_mtx_);
+            mgr_failed_ = true;
+        }
+    }
+}
+
 gcache::PageStore::PageStore (const std::string& dir_name,
                               size_t             keep_size,
                               size_t             page_size,
-                              size_t             keep_page)
+                              size_t             keep_page,
+                              size_t             prealloc)
     :
     base_name_ (make_base_name(dir_name)),
     keep_size_ (keep_size),
@@ -197,29 +325,27 @@ gcache::PageStore::PageStore (const std::string& dir_name,
     pages_     (),
     current_   (0),
     total_size_(0),
-    delete_page_attr_()
-#ifndef GCACHE_DETACH_THREAD
-    , delete_thr_(pthread_t(-1))
-#endif /* GCACHE_DETACH_THREAD */
+    mgr_mtx_   (),
+    mgr_cond_  (),
+    mgr_idle_  (),
+    ready_     (),
+    release_   (),
+    prealloc_  (prealloc),
+    prealloc_size_(page_size),
+    file_count_(0),
+    stats_     (),
+    mgr_active_(false),
+    mgr_busy_  (false),
+    mgr_failed_(false),
+    mgr_closing_(false),
+    mgr_thr_   ()
 {
-    int err = pthread_attr_init (&delete_page_attr_);
-
-    if (0 != err)
-    {
-        gu_throw_error(err) << "Failed to initialize page file deletion "
-                            << "thread attributes";
-    }
+    int const err(gu_thread_create (&mgr_thr_, NULL, mgr_thread, this));
 
-#ifdef GCACHE_DETACH_THREAD
-    err = pthread_attr_setdetachstate (&delete_page_attr_,
-                                       PTHREAD_CREATE_DETACHED);
     if (0 != err)
     {
-        pthread_attr_destroy (&delete_page_attr_);
-        gu_throw_error(err) << "Failed to set DETACHED attribute to "
-                            << "page file deletion thread";
+        gu_throw_error(err) << "Failed to create page manager thread";
     }
-#endif /* GCACHE_DETACH_THREAD */
 }
 
 gcache::PageStore::~PageStore ()
@@ -227,22 +353,101 @@ gcache::PageStore::~PageStore ()
     try
     {
         while (pages_.size() && delete_page()) {};
-#ifndef GCACHE_DETACH_THREAD
-        if (delete_thr_ != pthread_t(-1)) pthread_join (delete_thr_, NULL);
-#endif /* GCACHE_DETACH_THREAD */
     }
     catch (gu::Exception& e)
     {
         log_error << e.what() << " in ~PageStore()"; // abort() ?
     }
 
+    {
+        gu::Lock lock(mgr_mtx_);
+        mgr_closing_ = true;
+        mgr_cond_.signal();
+    }
+
+    pthread_join (mgr_thr_, NULL);
+
+    assert(release_.empty());
+
+    while (!ready_.empty())
+    {
+        remove_page (ready_.front());
+        ready_.pop_front();
+    }
+
     if (pages_.size() > 0)
     {
         log_error << "Could not delete " << pages_.size()
                   << " page files: some buffers are still \"mmapped\".";
     }
+}
+
+void
+gcache::PageStore::set_page_size (size_t const size)
+{
+    page_size_ = size;
+
+    {
+        gu::Lock lock(mgr_mtx_);
+
+        prealloc_size_ = size;
+
+        /* pages of old size are of no use now */
+        for (std::deque<Page*>::iterator i(ready_.begin()); i != ready_.end();)
+        {
+            if ((*i)->size() != prealloc_size_)
+            {
+                release_.push_back(*i);
+                i = ready_.erase(i);
+            }
+            else ++i;
+        }
+
+        mgr_cond_.signal();
+    }
+
+    cleanup();
+}
+
+void
+gcache::PageStore::set_prealloc (size_t const count)
+{
+    gu::Lock lock(mgr_mtx_);
 
-    pthread_attr_destroy (&delete_page_attr_);
+    prealloc_ = count;
+
+    while (ready_.size() > prealloc_)
+    {
+        release_.push_back(ready_.back());
+        ready_.pop_back();
+    }
+
+    mgr_cond_.signal();
+}
+
+gcache::PageStore::Stats
+gcache::PageStore::stats () const
+{
+    gu::Lock lock(mgr_mtx_);
+    return stats_;
+}
+
+size_t
+gcache::PageStore::ready_pages () const
+{
+    gu::Lock lock(mgr_mtx_);
+    return ready_.size();
+}
+
+void
+gcache::PageStore::wait_idle ()
+{
+    gu::Lock lock(mgr_mtx_);
+
+    while (mgr_busy_ || !release_.empty() || mgr_prealloc_needed())
+    {
+        lock.wait(mgr_idle_);
+    }
 }
 
 inline void*
@@ -254,7 +459,7 @@ gcache::PageStore::malloc_new (size_type size)
 
     try
     {
-        new_page (page_size_ > size ? page_size_ : size);
+        new_page (size);
         ret = current_->malloc (size);
         cleanup();
     }
@@ -11,6 +11,8 @@
 #include "gcache_page.hpp"
 #include "gcache_seqno.hpp"
 
+#include <gu_lock.hpp>
+
 #include <string>
 #include <deque>
 
@@ -23,7 +25,8 @@ namespace gcache
         PageStore (const std::string& dir_name,
                    size_t             keep_size,
                    size_t             page_size,
-                   size_t             keep_page);
+                   size_t             keep_page,
+                   size_t             prealloc = 0);
 
         ~PageStore ();
 
@@ -48,14 +51,32 @@ namespace gcache
         void  reset();
 
 
-        void  set_page_size (size_t size) { page_size_ = size; cleanup();}
+        void  set_page_size (size_t size);
 
         void  set_keep_size (size_t size) { keep_size_ = size; cleanup();}
 
         void  set_keep_count (size_t count) { keep_page_ = count; cleanup();}
 
+        /* how many empty pages to keep ready for allocation */
+        void  set_prealloc (size_t count);
+
         size_t allocated_pool_size ();
 
+        struct Stats
+        {
+            long long created;      /* page files created                  */
+            long long recycled;     /* released pages reused               */
+            long long sync_created; /* pages created in allocation path    */
+            long long create_ns;    /* total page creation time            */
+            long long create_ns_max;/* longest page creation               */
+        };
+
+        Stats stats() const;
+
+        /* for unit tests: wait until background page manager is idle */
+        void   wait_idle();
+        size_t ready_pages() const;
+
         /* for unit tests */
         size_t count()       const { return count_;        }
         size_t total_pages() const { return pages_.size(); }
@@ -71,10 +92,31 @@ namespace gcache
         std::deque<Page*> pages_;
         Page*             current_;
         size_t            total_size_;
-        pthread_attr_t    delete_page_attr_;
-#ifndef GCACHE_DETACH_THREAD
-        pthread_t         delete_thr_;
-#endif /* GCACHE_DETACH_THREAD */
+
+        /* Background page manager: keeps up to prealloc_ empty pages in
+         * ready_ and disposes of pages in release_, either by recycling
+         * them into ready_ or by deleting them. Everything below is
+         * protected by mgr_mtx_. */
+        gu::Mutex         mgr_mtx_;
+        gu::Cond          mgr_cond_;
+        gu::Cond          mgr_idle_;
+        std::deque<Page*> ready_;
+        std::deque<Page*> release_;
+        size_t            prealloc_;
+        size_t            prealloc_size_; /* size of pages in ready_ */
+        size_t            file_count_;    /* for unique page file names */
+        Stats             stats_;
+        bool              mgr_active_;    /* page store has been used */
+        bool              mgr_busy_;
+        bool              mgr_failed_;    /* last prealloc attempt failed */
+        bool              mgr_closing_;
+        pthread_t         mgr_thr_;
+
+        static void* mgr_thread (void* arg);
+        void  mgr_run ();
+        bool  mgr_prealloc_needed () const;
+        Page* create_page (size_t size, bool allocate);
+        void  remove_page (Page* page);
 
         void new_page    (size_type size);
 
@@ -18,6 +18,14 @@ static const std::string GCACHE_PARAMS_KEEP_PAGES_SIZE("gcache.keep_pages_size")
 static const std::string GCACHE_PARAMS_KEEP_PAGES_COUNT("gcache.keep_pages_count");
 static const std::string GCACHE_DEFAULT_KEEP_PAGES_SIZE("0");
 static const std::string GCACHE_DEFAULT_KEEP_PAGES_COUNT("0");
+static const std::string GCACHE_PARAMS_PAGE_PREALLOC("gcache.page_prealloc");
+static const std::string GCACHE_DEFAULT_PAGE_PREALLOC("0");
+static const std::string GCACHE_PARAMS_RB_ANONYMOUS("gcache.anonymous");
+static const std::string GCACHE_DEFAULT_RB_ANONYMOUS("no");
+static const std::string GCACHE_PARAMS_RB_HUGE_PAGES("gcache.huge_pages");
+static const std::string GCACHE_DEFAULT_RB_HUGE_PAGES("no");
+static const std::string GCACHE_PARAMS_RB_NUMA_NODE("gcache.numa_node");
+static const std::string GCACHE_DEFAULT_RB_NUMA_NODE("-1");
 static const std::string GCACHE_PARAMS_RECOVER    ("gcache.recover");
 static const std::string GCACHE_DEFAULT_RECOVER   ("no");
 
@@ -31,6 +39,10 @@ gcache::GCache::Params::register_params(gu::Config& cfg)
     cfg.add(GCACHE_PARAMS_PAGE_SIZE,        GCACHE_DEFAULT_PAGE_SIZE);
     cfg.add(GCACHE_PARAMS_KEEP_PAGES_SIZE,  GCACHE_DEFAULT_KEEP_PAGES_SIZE);
     cfg.add(GCACHE_PARAMS_KEEP_PAGES_COUNT, GCACHE_DEFAULT_KEEP_PAGES_COUNT);
+    cfg.add(GCACHE_PARAMS_PAGE_PREALLOC,    GCACHE_DEFAULT_PAGE_PREALLOC);
+    cfg.add(GCACHE_PARAMS_RB_ANONYMOUS,     GCACHE_DEFAULT_RB_ANONYMOUS);
+    cfg.add(GCACHE_PARAMS_RB_HUGE_PAGES,    GCACHE_DEFAULT_RB_HUGE_PAGES);
+    cfg.add(GCACHE_PARAMS_RB_NUMA_NODE,     GCACHE_DEFAULT_RB_NUMA_NODE);
     cfg.add(GCACHE_PARAMS_RECOVER,          GCACHE_DEFAULT_RECOVER);
 }
 
@@ -68,6 +80,10 @@ gcache::GCache::Params::Params (gu::Config& cfg, const std::string& data_dir)
     page_size_(cfg.get<size_t>(GCACHE_PARAMS_PAGE_SIZE)),
     keep_pages_size_(cfg.get<size_t>(GCACHE_PARAMS_KEEP_PAGES_SIZE)),
     keep_pages_count_(cfg.get<size_t>(GCACHE_PARAMS_KEEP_PAGES_COUNT)),
+    page_prealloc_(cfg.get<size_t>(GCACHE_PARAMS_PAGE_PREALLOC)),
+    rb_anonymous_ (cfg.get<bool>(GCACHE_PARAMS_RB_ANONYMOUS)),
+    rb_huge_pages_(cfg.get<bool>(GCACHE_PARAMS_RB_HUGE_PAGES)),
+    rb_numa_node_ (cfg.get<int>(GCACHE_PARAMS_RB_NUMA_NODE)),
     recover_  (cfg.get<bool>(GCACHE_PARAMS_RECOVER))
 {}
 
@@ -144,6 +160,23 @@ gcache::GCache::param_set (const std::string& key, const std::string& val)
                           params.keep_pages_count() :
                           !((params.mem_size() + params.rb_size()) > 0));
    }
+   else if (key == GCACHE_PARAMS_PAGE_PREALLOC)
+   {
+       size_t tmp_count = gu::Config::from_config<size_t>(val);
+
+       gu::Lock lock(mtx);
+
+       config.set<size_t>(key, tmp_count);
+       params.page_prealloc(tmp_count);
+       ps.set_prealloc(params.page_prealloc());
+   }
+   else if (key == GCACHE_PARAMS_RB_ANONYMOUS  ||
+            key == GCACHE_PARAMS_RB_HUGE_PAGES ||
+            key == GCACHE_PARAMS_RB_NUMA_NODE)
+   {
+       gu_throw_error(EPERM) << "Can't change ring buffer memory placement "
+                             << "in runtime.";
+   }
    else if (key == GCACHE_PARAMS_RECOVER)
    {
        gu_throw_error(EINVAL) << "'" << key
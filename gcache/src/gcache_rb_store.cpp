@@ -20,6 +20,60 @@ namespace gcache
         return s + RingBuffer::pad_size() + sizeof(BufferHeader);
     }
 
+    static gu::FileDescriptor*
+    open_file (const std::string& name, size_t const size, bool const anon)
+    {
+        if (anon) return 0;
+
+#ifdef HAVE_PSI_INTERFACE
+        return new gu::FileDescriptor(name,
+                                      WSREP_PFS_INSTR_TAG_RINGBUFFER_FILE,
+                                      check_size(size));
+#else
+        return new gu::FileDescriptor(name, check_size(size));
+#endif /* HAVE_PSI_INTERFACE */
+    }
+
+    /* takes ownership of fd */
+    static gu::MMap*
+    map_memory (gu::FileDescriptor* const fd, size_t const size,
+                bool const huge_pages, int const numa_node)
+    {
+        gu::MMap* ret(0);
+
+        /* file pages are allocated when the file is created, binding them
+         * to NUMA node afterwards has no effect */
+        if (fd && numa_node >= 0)
+        {
+            delete fd;
+            gu_throw_error(EINVAL) << "Binding GCache ring buffer to NUMA node"
+                                   << " requires anonymous ring buffer";
+        }
+
+        try
+        {
+            ret = fd ? new gu::MMap(*fd) : new gu::MMap(check_size(size));
+        }
+        catch (...)
+        {
+            delete fd;
+            throw;
+        }
+
+        /* both must be done before the memory is touched */
+        if (numa_node >= 0 && ret->bind_node(numa_node))
+        {
+            log_info << "GCache ring buffer bound to NUMA node " << numa_node;
+        }
+
+        if (huge_pages && ret->huge_pages())
+        {
+            log_info << "GCache ring buffer uses transparent huge pages";
+        }
+
+        return ret;
+    }
+
     void
     RingBuffer::reset()
     {
@@ -45,21 +99,21 @@ namespace gcache
                             size_t             size,
                             seqno2ptr_t&       seqno2ptr,
                             gu::UUID&          gid,
-                            bool const         recover)
+                            bool const         recover,
+                            bool const         anonymous,
+                            bool const         huge_pages,
+                            int  const         numa_node)
     :
-#ifdef HAVE_PSI_INTERFACE
-        fd_        (name, WSREP_PFS_INSTR_TAG_RINGBUFFER_FILE, check_size(size)),
-#else
-        fd_        (name, check_size(size)),
-#endif /* HAVE_PSI_INTERFACE */
-        mmap_      (fd_),
-        preamble_  (static_cast<char*>(mmap_.ptr)),
+        name_      (name),
+        fd_        (open_file(name, size, anonymous)),
+        mmap_      (map_memory(fd_, size, huge_pages, numa_node)),
+        preamble_  (static_cast<char*>(mmap_->ptr)),
         header_    (reinterpret_cast<int64_t*>(preamble_ + PREAMBLE_LEN)),
         start_     (reinterpret_cast<uint8_t*>(header_   + HEADER_LEN)),
-        end_       (reinterpret_cast<uint8_t*>(preamble_ + mmap_.size)),
+        end_       (reinterpret_cast<uint8_t*>(preamble_ + mmap_->size)),
         first_     (start_),
         next_      (first_),
-        max_used_  (first_ - static_cast<uint8_t*>(mmap_.ptr) +
+        max_used_  (first_ - static_cast<uint8_t*>(mmap_->ptr) +
                     sizeof(BufferHeader)),
         seqno2ptr_ (seqno2ptr),
         gid_       (gid),
@@ -71,16 +125,33 @@ namespace gcache
 //        reallocs_  (0),
         open_      (true)
     {
-        constructor_common ();
-        open_preamble(recover);
-        BH_clear (BH_cast(next_));
+        if (anonymous && recover)
+        {
+            log_info << "Skipped GCache ring buffer recovery: "
+                     << "ring buffer is not persistent.";
+        }
+
+        try
+        {
+            constructor_common ();
+            open_preamble(recover && !anonymous);
+            BH_clear (BH_cast(next_));
+        }
+        catch (...)
+        {
+            delete mmap_;
+            delete fd_;
+            throw;
+        }
     }
 
     RingBuffer::~RingBuffer ()
     {
         close_preamble();
         open_ = false;
-        mmap_.sync();
+        if (fd_) mmap_->sync();
+        delete mmap_;
+        delete fd_;
     }
 
     static inline void
@@ -260,7 +331,7 @@ namespace gcache
         next_ = ret + size;
 
         size_t max_used=
-            next_ - static_cast<uint8_t*>(mmap_.ptr) + sizeof(BufferHeader);
+            next_ - static_cast<uint8_t*>(mmap_->ptr) + sizeof(BufferHeader);
 
         if (max_used > max_used_)
         {
@@ -598,7 +669,7 @@ namespace gcache
 
         ::memcpy(preamble_, os.str().c_str(), copy_len);
 
-        mmap_.sync(preamble_, copy_len);
+        if (fd_) mmap_->sync(preamble_, copy_len);
     }
 
     void
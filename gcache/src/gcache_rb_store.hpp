@@ -23,11 +23,20 @@ namespace gcache
     {
     public:
 
+        /*!
+         * @param anonymous  use anonymous memory instead of file mapping,
+         *                   contents are lost on restart
+         * @param huge_pages back the mapping with transparent huge pages
+         * @param numa_node  bind memory to NUMA node (-1 for no binding)
+         */
         RingBuffer (const std::string& name,
                     size_t             size,
                     seqno2ptr_t&       seqno2ptr,
                     gu::UUID&          gid,
-                    bool               recover);
+                    bool               recover,
+                    bool               anonymous  = false,
+                    bool               huge_pages = false,
+                    int                numa_node  = -1);
 
         ~RingBuffer ();
 
@@ -47,9 +56,9 @@ namespace gcache
 
         size_t size      () const { return size_cache_; }
 
-        size_t rb_size   () const { return fd_.size(); }
+        size_t rb_size   () const { return mmap_->size; }
 
-        const std::string& rb_name() const { return fd_.name(); }
+        const std::string& rb_name() const { return name_; }
 
         void  reset();
 
@@ -118,8 +127,9 @@ namespace gcache
         static size_t const PREAMBLE_LEN = 1024;
         static size_t const HEADER_LEN = 32;
 
-        gu::FileDescriptor fd_;
-        gu::MMap           mmap_;
+        std::string  const name_;
+        gu::FileDescriptor* const fd_;  // NULL if anonymous
+        gu::MMap*    const mmap_;
         char*        const preamble_; // ASCII text preamble
         int64_t*     const header_;   // cache binary header
         uint8_t*     const start_;    // start of cache area
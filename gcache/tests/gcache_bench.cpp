@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2015 Codership Oy <info@codership.com>
+ *
+ * Compares ring buffer throughput with different memory placement options:
+ *
+ *     gcache_bench [ring size MB] [buffer size] [ops] [numa node]
+ *
+ * Each configuration runs a writer pass (malloc, fill, seqno_assign, free -
+ * the way replicator uses the cache, old buffers get discarded as the ring
+ * wraps) followed by a random seqno_get_ptr() pass over the retained history.
+ */
+
+#include "GCache.hpp"
+
+#include <gu_logger.hpp>
+#include <gu_exception.hpp>
+#include <gu_time.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <unistd.h>
+
+using namespace gcache;
+
+static void
+run (const char* const name, const std::string& opts,
+     size_t const rb_size, size_t const buf_size, long const ops)
+{
+    std::ostringstream params;
+    params << "gcache.name = gcache_bench.cache; gcache.page_size = "
+           << rb_size << "; gcache.size = " << rb_size << "; " << opts;
+
+    gu::Config conf;
+    GCache::register_params(conf);
+    conf.parse(params.str());
+
+    GCache* const cache(new GCache(conf, "."));
+
+    long long const write_start(gu_time_monotonic());
+
+    for (long seqno(1); seqno <= ops; ++seqno)
+    {
+        void* const ptr(cache->malloc(buf_size));
+        ::memset(ptr, seqno, buf_size);
+        cache->seqno_assign(ptr, seqno, seqno - 1);
+        cache->free(ptr);
+    }
+
+    long long const write_time(gu_time_monotonic() - write_start);
+
+    int64_t const min(cache->seqno_min());
+    int64_t const max(ops);
+    unsigned int  seed(1);
+    long          sum(0);
+
+    long long const read_start(gu_time_monotonic());
+
+    for (long i(0); i < ops; ++i)
+    {
+        int64_t const seqno(min + rand_r(&seed) % (max - min + 1));
+        int64_t       seqno_d;
+        ssize_t       size;
+
+        const void* const ptr(cache->seqno_get_ptr(seqno, seqno_d, size));
+        sum += static_cast<const unsigned char*>(ptr)[size - 1];
+    }
+
+    long long const read_time(gu_time_monotonic() - read_start);
+
+    cache->seqno_unlock();
+    delete cache;
+    ::unlink("gcache_bench.cache");
+
+    std::cout << std::left << std::setw(24) << name << std::right
+              << std::setw(12) << (ops * 1000000000.0 / write_time)
+              << " writes/s" << std::setw(12)
+              << (ops * 1000000000.0 / read_time) << " reads/s"
+              << (sum < 0 ? " " : "") << std::endl;
+}
+
+int
+main (int argc, char* argv[])
+{
+    size_t const rb_size (argc > 1 ? atol(argv[1]) << 20 : 256 << 20);
+    size_t const buf_size(argc > 2 ? atol(argv[2])       : 1024);
+    long   const ops     (argc > 3 ? atol(argv[3])       : 2000000);
+    std::string  node;
+
+    /* NUMA binding is supported only for anonymous ring buffer */
+    if (argc > 4)
+    {
+        node = std::string("gcache.numa_node = ") + argv[4] + "; ";
+    }
+
+    struct { const char* name; const char* opts; bool anon; } const configs[] =
+    {
+        { "file",               "",                        false },
+        { "file+huge_pages",    "gcache.huge_pages = yes", false },
+        { "anonymous",          "gcache.anonymous = yes",  true  },
+        { "anonymous+huge_pages",
+          "gcache.anonymous = yes; gcache.huge_pages = yes", true }
+    };
+
+    std::cout << "ring: " << (rb_size >> 20) << "M, buffer: " << buf_size
+              << ", ops: " << ops << std::endl;
+
+    try
+    {
+        for (size_t i(0); i < sizeof(configs)/sizeof(configs[0]); ++i)
+        {
+            run(configs[i].name,
+                (configs[i].anon ? node : std::string()) + configs[i].opts,
+                rb_size, buf_size, ops);
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
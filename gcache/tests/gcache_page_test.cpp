@@ -8,6 +8,9 @@
 #include "gcache_bh.hpp"
 #include "gcache_page_test.hpp"
 
+#include <dirent.h>
+#include <cstring>
+
 using namespace gcache;
 
 void ps_free (void* ptr)
@@ -112,6 +115,72 @@ START_TEST(test3) // check that all page size is efficiently used
 }
 END_TEST
 
+static size_t
+count_page_files()
+{
+    size_t ret(0);
+    DIR* const dir(opendir("."));
+
+    fail_if (0 == dir);
+
+    for (struct dirent* e(readdir(dir)); e != 0; e = readdir(dir))
+    {
+        if (0 == strncmp(e->d_name, "gcache.page.", 12)) ++ret;
+    }
+
+    closedir(dir);
+
+    return ret;
+}
+
+START_TEST(test4) // background page preallocation and recycling
+{
+    const char* const dir_name = "";
+    ssize_t const page_size = 1 << 16;
+
+    gcache::PageStore ps (dir_name, 0, page_size, 0, 1);
+
+    ps.wait_idle();
+    fail_if (ps.ready_pages() != 0, "page preallocated before first use");
+
+    void* prev = ps.malloc (page_size);
+    fail_if (0 == prev);
+    fail_if (ps.stats().sync_created != 1);
+
+    for (int i = 0; i < 20; ++i)
+    {
+        ps.wait_idle();
+        fail_if (ps.ready_pages() != 1, "expected 1 ready page, got %zu",
+                 ps.ready_pages());
+
+        void* const buf = ps.malloc (page_size); // must use ready page
+        fail_if (0 == buf);
+        fail_if (ps.stats().sync_created != 1,
+                 "page created in allocation path");
+
+        ps_free (prev);
+        ps.discard (ptr2BH(prev));
+        prev = buf;
+    }
+
+    ps.wait_idle();
+
+    gcache::PageStore::Stats const st(ps.stats());
+
+    fail_if (ps.count() != 21, "expected count 21, got %zu", ps.count());
+    fail_if (st.created + st.recycled < 22);
+    fail_if (st.recycled == 0, "no pages recycled");
+    fail_if (st.create_ns_max <= 0);
+    fail_if (ps.total_pages() != 1);
+    fail_if (count_page_files() != ps.total_pages() + ps.ready_pages(),
+             "%zu page files for %zu pages", count_page_files(),
+             ps.total_pages() + ps.ready_pages());
+
+    ps_free (prev);
+    ps.discard (ptr2BH(prev));
+}
+END_TEST
+
 Suite* gcache_page_suite()
 {
     Suite* s = suite_create("gcache::PageStore");
@@ -121,6 +190,7 @@ Suite* gcache_page_suite()
     tcase_add_test(tc, test1);
     tcase_add_test(tc, test2);
     tcase_add_test(tc, test3);
+    tcase_add_test(tc, test4);
     suite_add_tcase(s, tc);
 
     return s;
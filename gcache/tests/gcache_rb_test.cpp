@@ -12,6 +12,8 @@
 
 #include "gu_logger.hpp"
 
+#include <sys/stat.h>
+
 using namespace gcache;
 
 static gu::UUID    const GID(NULL, 0);
@@ -400,6 +402,62 @@ START_TEST(recovery)
 }
 END_TEST
 
+START_TEST(anonymous)
+{
+    ::unlink(RB_NAME.c_str());
+
+    size_t const rb_size(ALLOC_SIZE(2) * 2);
+    struct stat  st;
+
+    {
+        seqno2ptr_t s2p;
+        gu::UUID    gid(GID);
+        RingBuffer  rb(RB_NAME, rb_size, s2p, gid, true, true, true);
+
+        fail_if (rb.size() != rb_size, "Expected %zd, got %zd", rb_size,
+                 rb.size());
+        fail_if (0 == ::stat(RB_NAME.c_str(), &st),
+                 "anonymous ring buffer created file");
+
+        void* const buf(rb.malloc (ALLOC_SIZE(1)));
+        fail_if (NULL == buf);
+        ::memset(buf, 'a', 1);
+
+        BufferHeader* const bh(ptr2BH(buf));
+        bh->seqno_g = 1;
+        s2p.insert(seqno2ptr_pair_t(1, buf));
+        BH_release(bh);
+        rb.free (bh);
+    }
+
+    /* nothing is recovered */
+    {
+        seqno2ptr_t s2p;
+        gu::UUID    gid(GID);
+        RingBuffer  rb(RB_NAME, rb_size, s2p, gid, true, true);
+
+        fail_if (!s2p.empty());
+        fail_if (NULL == rb.malloc (ALLOC_SIZE(1)));
+    }
+
+    /* file pages are allocated before they could be bound to NUMA node */
+    try
+    {
+        seqno2ptr_t s2p;
+        gu::UUID    gid(GID);
+        RingBuffer  rb(RB_NAME, rb_size, s2p, gid, false, false, false, 0);
+        fail ("NUMA node accepted for file backed ring buffer");
+    }
+    catch (gu::Exception& e)
+    {
+        fail_if (EINVAL != e.get_errno(), "Expected EINVAL, got %d",
+                 e.get_errno());
+    }
+
+    ::unlink(RB_NAME.c_str());
+}
+END_TEST
+
 
 Suite* gcache_rb_suite()
 {
@@ -416,5 +474,11 @@ Suite* gcache_rb_suite()
     tcase_add_test(tc, recovery);
     suite_add_tcase(ts, tc);
 
+    tc = tcase_create("anonymous");
+
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, anonymous);
+    suite_add_tcase(ts, tc);
+
     return ts;
 }
@@ -13,6 +13,7 @@
 #include "gcomm/conf.hpp"
 
 #include "gu_logger.hpp"
+#include "gu_thread.hpp"
 
 #include <boost/bind.hpp>
 #include <boost/shared_ptr.hpp>
@@ -34,7 +35,12 @@ gcomm::AsioProtonet::AsioProtonet(gu::Config& conf, int version)
     mtu_(1 << 15),
     checksum_(NetHeader::checksum_type(
                   conf.get<int>(gcomm::Conf::SocketChecksum,
-                                NetHeader::CS_CRC32C)))
+                                NetHeader::CS_CRC32C))),
+    io_io_service_(),
+    io_work_(0),
+    io_threads_(),
+    deliver_mutex_(),
+    deliver_q_()
 {
     conf.set(gcomm::Conf::SocketChecksum, checksum_);
 #ifdef HAVE_ASIO_SSL_HPP
@@ -55,11 +61,83 @@ gcomm::AsioProtonet::AsioProtonet(gu::Config& conf, int version)
         gu::ssl_prepare_context(conf_, ssl_context_);
     }
 #endif // HAVE_ASIO_SSL_HPP
+
+    const int io_threads(check_range(Conf::ProtonetIoThreads,
+                                     conf_.get<int>(Conf::ProtonetIoThreads),
+                                     0, 65));
+    if (io_threads > 0)
+    {
+        log_info << "starting " << io_threads << " protonet I/O threads";
+        io_work_ = new asio::io_service::work(io_io_service_);
+        io_threads_.resize(io_threads);
+        for (size_t i(0); i < io_threads_.size(); ++i)
+        {
+            int const err(gu_thread_create(&io_threads_[i], 0,
+                                           &AsioProtonet::run_io_thread,
+                                           this));
+            if (err != 0)
+            {
+                io_threads_.resize(i);
+                stop_io_threads();
+                gu_throw_error(err) << "failed to start protonet I/O thread";
+            }
+        }
+
+        gu::ThreadAffinity const affinity(gu::thread_affinity(conf_,
+                                                              "gcomm"));
+        try
+        {
+            for (size_t i(0); i < io_threads_.size(); ++i)
+            {
+                gu::thread_set_affinity(io_threads_[i], affinity);
+            }
+        }
+        catch (...)
+        {
+            stop_io_threads();
+            throw;
+        }
+    }
 }
 
 gcomm::AsioProtonet::~AsioProtonet()
 {
+    stop_io_threads();
+}
 
+void gcomm::AsioProtonet::stop_io_threads()
+{
+    delete io_work_;
+    io_work_ = 0;
+    io_io_service_.stop();
+    for (std::vector<gu_thread_t>::iterator i(io_threads_.begin());
+         i != io_threads_.end(); ++i)
+    {
+        gu_thread_join(*i, 0);
+    }
+    io_threads_.clear();
+}
+
+void* gcomm::AsioProtonet::run_io_thread(void* arg)
+{
+    AsioProtonet* net(static_cast<AsioProtonet*>(arg));
+    while (true)
+    {
+        try
+        {
+            net->io_io_service_.run();
+            break;
+        }
+        catch (gu::Exception& e)
+        {
+            log_error << "exception from protonet I/O thread: " << e.what();
+        }
+        catch (std::exception& e)
+        {
+            log_error << "exception from protonet I/O thread: " << e.what();
+        }
+    }
+    return 0;
 }
 
 void gcomm::AsioProtonet::enter()
@@ -134,6 +212,47 @@ void gcomm::AsioProtonet::dispatch(const SocketId& id,
 }
 
 
+void gcomm::AsioProtonet::deliver(const SocketPtr& socket,
+                                  const Datagram&  dg,
+                                  int              err_no)
+{
+    if (io_threads() == false)
+    {
+        dispatch(socket->id(), dg, ProtoUpMeta(err_no));
+        return;
+    }
+
+    bool post;
+    {
+        gu::Lock lock(deliver_mutex_);
+        post = deliver_q_.empty();
+        deliver_q_.push_back(DeliverItem(socket, dg, err_no));
+    }
+    if (post == true)
+    {
+        io_service_.post(boost::bind(&AsioProtonet::handle_deliver, this));
+    }
+}
+
+
+void gcomm::AsioProtonet::handle_deliver()
+{
+    Critical<AsioProtonet> crit(*this);
+
+    std::deque<DeliverItem> q;
+    {
+        gu::Lock lock(deliver_mutex_);
+        q.swap(deliver_q_);
+    }
+
+    for (std::deque<DeliverItem>::const_iterator i(q.begin()); i != q.end();
+         ++i)
+    {
+        dispatch(i->socket_->id(), i->dg_, ProtoUpMeta(i->err_no_));
+    }
+}
+
+
 void gcomm::AsioProtonet::interrupt()
 {
     io_service_.stop();
@@ -30,12 +30,17 @@ public:
     void dispatch(const SocketId&,
                   const Datagram&,
                   const ProtoUpMeta&);
+    // Dispatch socket event from socket handler. If I/O threads are
+    // in use, the event is queued and dispatched later from gcomm
+    // thread, otherwise it is dispatched immediately.
+    void deliver(const SocketPtr&, const Datagram&, int err_no);
     void interrupt();
     SocketPtr socket(const gu::URI&);
     gcomm::Acceptor* acceptor(const gu::URI&);
     void enter();
     void leave();
     size_t mtu() const { return mtu_; }
+    bool io_threads() const { return (io_threads_.empty() == false); }
 
 #ifdef HAVE_ASIO_SSL_HPP
     std::string get_ssl_password() const;
@@ -47,8 +52,30 @@ private:
     friend class AsioTcpAcceptor;
     friend class AsioUdpSocket;
     AsioProtonet(const AsioProtonet&);
+    void operator=(const AsioProtonet&);
 
     void handle_wait(const asio::error_code& ec);
+    void handle_deliver();
+    void stop_io_threads();
+    static void* run_io_thread(void* arg);
+
+    // io_service for socket operations
+    asio::io_service& socket_io_service()
+    {
+        return (io_threads() ? io_io_service_ : io_service_);
+    }
+
+    struct DeliverItem
+    {
+        DeliverItem(const SocketPtr& socket, const Datagram& dg, int err_no)
+            : socket_(socket), dg_(dg), err_no_(err_no)
+        { }
+        // Holding the socket keeps its SocketId from being reused by
+        // a new socket while the item is queued
+        SocketPtr socket_;
+        Datagram  dg_;
+        int       err_no_;
+    };
 
     gu::RecursiveMutex          mutex_;
     gu::datetime::Date          poll_until_;
@@ -60,6 +87,14 @@ private:
     size_t                      mtu_;
 
     NetHeader::checksum_t       checksum_;
+
+    // I/O thread pool, socket handlers are run in io_io_service_
+    // and received messages are passed to gcomm thread via deliver_q_
+    asio::io_service            io_io_service_;
+    asio::io_service::work*     io_work_;
+    std::vector<gu_thread_t>    io_threads_;
+    gu::Mutex                   deliver_mutex_;
+    std::deque<DeliverItem>     deliver_q_;
 };
 
 #endif // GCOMM_ASIO_PROTONET_HPP
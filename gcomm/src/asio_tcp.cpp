@@ -13,7 +13,9 @@ gcomm::AsioTcpSocket::AsioTcpSocket(AsioProtonet& net, const gu::URI& uri)
     :
     Socket       (uri),
     net_         (net),
-    socket_      (net.io_service_),
+    socket_      (net.socket_io_service()),
+    strand_      (net.socket_io_service()),
+    mutex_       (),
 #ifdef HAVE_ASIO_SSL_HPP
     ssl_socket_  (0),
 #endif /* HAVE_ASIO_SSL_HPP */
@@ -37,6 +39,36 @@ gcomm::AsioTcpSocket::~AsioTcpSocket()
 #endif /* HAVE_ASIO_SSL_HPP */
 }
 
+void gcomm::AsioTcpSocket::enter() const
+{
+    if (net_.io_threads())
+    {
+        mutex_.lock();
+    }
+    else
+    {
+        net_.enter();
+    }
+}
+
+void gcomm::AsioTcpSocket::leave() const
+{
+    if (net_.io_threads())
+    {
+        mutex_.unlock();
+    }
+    else
+    {
+        net_.leave();
+    }
+}
+
+gcomm::Socket::State gcomm::AsioTcpSocket::state() const
+{
+    Critical<const AsioTcpSocket> crit(*this);
+    return state_;
+}
+
 void gcomm::AsioTcpSocket::failed_handler(const asio::error_code& ec,
                                           const std::string& func,
                                           int line)
@@ -61,13 +93,15 @@ void gcomm::AsioTcpSocket::failed_handler(const asio::error_code& ec,
 
     if (prev_state != S_FAILED && prev_state != S_CLOSED)
     {
-        net_.dispatch(id(), Datagram(), ProtoUpMeta(ec.value()));
+        net_.deliver(shared_from_this(), Datagram(), ec.value());
     }
 }
 
 #ifdef HAVE_ASIO_SSL_HPP
 void gcomm::AsioTcpSocket::handshake_handler(const asio::error_code& ec)
 {
+    Critical<AsioTcpSocket> crit(*this);
+
     if (ec)
     {
         if (ec.category() == asio::error::get_ssl_category() &&
@@ -99,14 +133,14 @@ void gcomm::AsioTcpSocket::handshake_handler(const asio::error_code& ec)
              << " cipher: " << gu::cipher(*ssl_socket_)
              << " compression: " << gu::compression(*ssl_socket_);
     state_ = S_CONNECTED;
-    net_.dispatch(id(), Datagram(), ProtoUpMeta(ec.value()));
+    net_.deliver(shared_from_this(), Datagram(), ec.value());
     async_receive();
 }
 #endif /* HAVE_ASIO_SSL_HPP */
 
 void gcomm::AsioTcpSocket::connect_handler(const asio::error_code& ec)
 {
-    Critical<AsioProtonet> crit(net_);
+    Critical<AsioTcpSocket> crit(*this);
 
     try
     {
@@ -128,9 +162,10 @@ void gcomm::AsioTcpSocket::connect_handler(const asio::error_code& ec)
                           << local_addr();
                 ssl_socket_->async_handshake(
                     asio::ssl::stream<asio::ip::tcp::socket>::client,
-                    boost::bind(&AsioTcpSocket::handshake_handler,
-                                shared_from_this(),
-                                asio::placeholders::error)
+                    strand_.wrap(
+                        boost::bind(&AsioTcpSocket::handshake_handler,
+                                    shared_from_this(),
+                                    asio::placeholders::error))
                     );
             }
             else
@@ -140,7 +175,7 @@ void gcomm::AsioTcpSocket::connect_handler(const asio::error_code& ec)
                           << remote_addr() << " local endpoint "
                           << local_addr();
                 state_ = S_CONNECTED;
-                net_.dispatch(id(), Datagram(), ProtoUpMeta(ec.value()));
+                net_.deliver(shared_from_this(), Datagram(), ec.value());
                 async_receive();
 
 #ifdef HAVE_ASIO_SSL_HPP
@@ -158,9 +193,9 @@ void gcomm::AsioTcpSocket::connect(const gu::URI& uri)
 {
     try
     {
-        Critical<AsioProtonet> crit(net_);
+        Critical<AsioTcpSocket> crit(*this);
 
-        asio::ip::tcp::resolver resolver(net_.io_service_);
+        asio::ip::tcp::resolver resolver(net_.socket_io_service());
         // Give query flags explicitly to avoid having AI_ADDRCONFIG in
         // underlying getaddrinfo() hint flags.
         asio::ip::tcp::resolver::query
@@ -173,13 +208,14 @@ void gcomm::AsioTcpSocket::connect(const gu::URI& uri)
         if (uri.get_scheme() == gu::scheme::ssl)
         {
             ssl_socket_ = new asio::ssl::stream<asio::ip::tcp::socket>(
-                net_.io_service_, net_.ssl_context_
+                net_.socket_io_service(), net_.ssl_context_
             );
 
             ssl_socket_->lowest_layer().async_connect(
-                *i, boost::bind(&AsioTcpSocket::connect_handler,
+                *i, strand_.wrap(
+                    boost::bind(&AsioTcpSocket::connect_handler,
                                 shared_from_this(),
-                                asio::placeholders::error)
+                                asio::placeholders::error))
             );
         }
         else
@@ -194,9 +230,10 @@ void gcomm::AsioTcpSocket::connect(const gu::URI& uri)
                     0);
                 socket_.bind(ep);
             }
-            socket_.async_connect(*i, boost::bind(&AsioTcpSocket::connect_handler,
+            socket_.async_connect(*i, strand_.wrap(
+                                      boost::bind(&AsioTcpSocket::connect_handler,
                                                   shared_from_this(),
-                                                  asio::placeholders::error));
+                                                  asio::placeholders::error)));
 #ifdef HAVE_ASIO_SSL_HPP
         }
 #endif /* HAVE_ASIO_SSL_HPP */
@@ -213,7 +250,7 @@ void gcomm::AsioTcpSocket::connect(const gu::URI& uri)
 
 void gcomm::AsioTcpSocket::close()
 {
-    Critical<AsioProtonet> crit(net_);
+    Critical<AsioTcpSocket> crit(*this);
 
     if (state() == S_CLOSED || state() == S_CLOSING) return;
 
@@ -222,7 +259,17 @@ void gcomm::AsioTcpSocket::close()
 
     if (send_q_.empty() == true || state() != S_CONNECTED)
     {
-        close_socket();
+        if (net_.io_threads())
+        {
+            // socket may have operations in progress in I/O threads,
+            // close it from the strand
+            strand_.post(boost::bind(&AsioTcpSocket::close_socket,
+                                     shared_from_this()));
+        }
+        else
+        {
+            close_socket();
+        }
         state_ = S_CLOSED;
     }
     else
@@ -235,7 +282,7 @@ void gcomm::AsioTcpSocket::close()
 void gcomm::AsioTcpSocket::write_handler(const asio::error_code& ec,
                                          size_t bytes_transferred)
 {
-    Critical<AsioProtonet> crit(net_);
+    Critical<AsioTcpSocket> crit(*this);
 
     if (state() != S_CONNECTED && state() != S_CLOSING)
     {
@@ -268,14 +315,7 @@ void gcomm::AsioTcpSocket::write_handler(const asio::error_code& ec,
 
         if (send_q_.empty() == false)
         {
-            const Datagram& dg(send_q_.front());
-            boost::array<asio::const_buffer, 2> cbs;
-            cbs[0] = asio::const_buffer(dg.header()
-                                        + dg.header_offset(),
-                                        dg.header_len());
-            cbs[1] = asio::const_buffer(&dg.payload()[0],
-                                        dg.payload().size());
-            write_one(cbs);
+            write_front();
         }
         else if (state_ == S_CLOSING)
         {
@@ -323,17 +363,12 @@ namespace gcomm
         { }
         void operator()()
         {
+            Critical<AsioTcpSocket> crit(*socket_);
+
             if (socket_->state() == gcomm::Socket::S_CONNECTED &&
                 socket_->send_q_.empty() == false)
             {
-                const gcomm::Datagram& dg(socket_->send_q_.front());
-                boost::array<asio::const_buffer, 2> cbs;
-                cbs[0] = asio::const_buffer(dg.header()
-                                            + dg.header_offset(),
-                                            dg.header_len());
-                cbs[1] = asio::const_buffer(&dg.payload()[0],
-                                            dg.payload().size());
-                socket_->write_one(cbs);
+                socket_->write_front();
             }
         }
     private:
@@ -343,42 +378,52 @@ namespace gcomm
 
 int gcomm::AsioTcpSocket::send(const Datagram& dg)
 {
-    Critical<AsioProtonet> crit(net_);
+    Critical<AsioTcpSocket> crit(*this);
 
     if (state() != S_CONNECTED)
     {
         return ENOTCONN;
     }
 
-    NetHeader hdr(static_cast<uint32_t>(dg.len()), net_.version_);
+    // NetHeader is prepended in write_front() when the datagram
+    // reaches the head of the queue, so that checksum is computed
+    // in I/O thread if I/O threads are in use
+    send_q_.push_back(dg); // makes copy of dg
 
-    if (net_.checksum_ != NetHeader::CS_NONE)
+    if (send_q_.size() == 1)
     {
-        hdr.set_crc32(crc32(net_.checksum_, dg), net_.checksum_);
+        strand_.post(AsioPostForSendHandler(shared_from_this()));
     }
+    return 0;
+}
 
-    send_q_.push_back(dg); // makes copy of dg
-    Datagram& priv_dg(send_q_.back());
 
-    priv_dg.set_header_offset(priv_dg.header_offset() -
-                              NetHeader::serial_size_);
-    serialize(hdr,
-              priv_dg.header(),
-              priv_dg.header_size(),
-              priv_dg.header_offset());
+void gcomm::AsioTcpSocket::write_front()
+{
+    Datagram& dg(send_q_.front());
+
+    NetHeader hdr(static_cast<uint32_t>(dg.len()), net_.version_);
 
-    if (send_q_.size() == 1)
+    if (net_.checksum_ != NetHeader::CS_NONE)
     {
-        net_.io_service_.post(AsioPostForSendHandler(shared_from_this()));
+        hdr.set_crc32(crc32(net_.checksum_, dg), net_.checksum_);
     }
-    return 0;
+
+    dg.set_header_offset(dg.header_offset() - NetHeader::serial_size_);
+    serialize(hdr, dg.header(), dg.header_size(), dg.header_offset());
+
+    boost::array<asio::const_buffer, 2> cbs;
+    cbs[0] = asio::const_buffer(dg.header() + dg.header_offset(),
+                                dg.header_len());
+    cbs[1] = asio::const_buffer(&dg.payload()[0], dg.payload().size());
+    write_one(cbs);
 }
 
 
 void gcomm::AsioTcpSocket::read_handler(const asio::error_code& ec,
                                         const size_t bytes_transferred)
 {
-    Critical<AsioProtonet> crit(net_);
+    Critical<AsioTcpSocket> crit(*this);
 
     if (ec)
     {
@@ -445,8 +490,7 @@ void gcomm::AsioTcpSocket::read_handler(const asio::error_code& ec,
                     return;
                 }
             }
-            ProtoUpMeta um;
-            net_.dispatch(id(), dg, um);
+            net_.deliver(shared_from_this(), dg, 0);
             recv_offset_ -= NetHeader::serial_size_ + hdr.len();
 
             if (recv_offset_ > 0)
@@ -472,7 +516,7 @@ size_t gcomm::AsioTcpSocket::read_completion_condition(
     const asio::error_code& ec,
     const size_t bytes_transferred)
 {
-    Critical<AsioProtonet> crit(net_);
+    Critical<AsioTcpSocket> crit(*this);
     if (ec)
     {
 #ifdef HAVE_ASIO_SSL_HPP
@@ -520,7 +564,22 @@ size_t gcomm::AsioTcpSocket::read_completion_condition(
 
 void gcomm::AsioTcpSocket::async_receive()
 {
-    Critical<AsioProtonet> crit(net_);
+    if (net_.io_threads())
+    {
+        // initiate read from the strand to avoid racing with
+        // socket handlers running in I/O threads
+        strand_.dispatch(boost::bind(&AsioTcpSocket::start_receive,
+                                     shared_from_this()));
+    }
+    else
+    {
+        start_receive();
+    }
+}
+
+void gcomm::AsioTcpSocket::start_receive()
+{
+    Critical<AsioTcpSocket> crit(*this);
 
     gcomm_assert(state() == S_CONNECTED);
 
@@ -585,10 +644,11 @@ void gcomm::AsioTcpSocket::read_one(boost::array<asio::mutable_buffer, 1>& mbs)
                                shared_from_this(),
                                asio::placeholders::error,
                                asio::placeholders::bytes_transferred),
-                   boost::bind(&AsioTcpSocket::read_handler,
-                               shared_from_this(),
-                               asio::placeholders::error,
-                               asio::placeholders::bytes_transferred));
+                   strand_.wrap(
+                       boost::bind(&AsioTcpSocket::read_handler,
+                                   shared_from_this(),
+                                   asio::placeholders::error,
+                                   asio::placeholders::bytes_transferred)));
     }
     else
     {
@@ -598,10 +658,11 @@ void gcomm::AsioTcpSocket::read_one(boost::array<asio::mutable_buffer, 1>& mbs)
                                shared_from_this(),
                                asio::placeholders::error,
                                asio::placeholders::bytes_transferred),
-                   boost::bind(&AsioTcpSocket::read_handler,
-                               shared_from_this(),
-                               asio::placeholders::error,
-                               asio::placeholders::bytes_transferred));
+                   strand_.wrap(
+                       boost::bind(&AsioTcpSocket::read_handler,
+                                   shared_from_this(),
+                                   asio::placeholders::error,
+                                   asio::placeholders::bytes_transferred)));
 #ifdef HAVE_ASIO_SSL_HPP
     }
 #endif /* HAVE_ASIO_SSL_HPP */
@@ -615,19 +676,21 @@ void gcomm::AsioTcpSocket::write_one(
     if (ssl_socket_ != 0)
     {
         async_write(*ssl_socket_, cbs,
-                    boost::bind(&AsioTcpSocket::write_handler,
-                                shared_from_this(),
-                                asio::placeholders::error,
-                                asio::placeholders::bytes_transferred));
+                    strand_.wrap(
+                        boost::bind(&AsioTcpSocket::write_handler,
+                                    shared_from_this(),
+                                    asio::placeholders::error,
+                                    asio::placeholders::bytes_transferred)));
     }
     else
     {
 #endif /* HAVE_ASIO_SSL_HPP */
         async_write(socket_, cbs,
-                    boost::bind(&AsioTcpSocket::write_handler,
-                                shared_from_this(),
-                                asio::placeholders::error,
-                                asio::placeholders::bytes_transferred));
+                    strand_.wrap(
+                        boost::bind(&AsioTcpSocket::write_handler,
+                                    shared_from_this(),
+                                    asio::placeholders::error,
+                                    asio::placeholders::bytes_transferred)));
 #ifdef HAVE_ASIO_SSL_HPP
     }
 #endif /* HAVE_ASIO_SSL_HPP */
@@ -736,6 +799,8 @@ void gcomm::AsioTcpAcceptor::accept_handler(
         AsioTcpSocket* s(static_cast<AsioTcpSocket*>(socket.get()));
         try
         {
+            Critical<AsioTcpSocket> crit(*s);
+
             s->assign_local_addr();
             s->assign_remote_addr();
             s->set_socket_options();
@@ -748,9 +813,10 @@ void gcomm::AsioTcpAcceptor::accept_handler(
                           << s->local_addr();
                 s->ssl_socket_->async_handshake(
                     asio::ssl::stream<asio::ip::tcp::socket>::server,
-                    boost::bind(&AsioTcpSocket::handshake_handler,
-                                s->shared_from_this(),
-                                asio::placeholders::error));
+                    s->strand_.wrap(
+                        boost::bind(&AsioTcpSocket::handshake_handler,
+                                    s->shared_from_this(),
+                                    asio::placeholders::error)));
                 s->state_ = Socket::S_CONNECTING;
             }
             else
@@ -776,7 +842,7 @@ void gcomm::AsioTcpAcceptor::accept_handler(
         {
             new_socket->ssl_socket_ =
                 new asio::ssl::stream<asio::ip::tcp::socket>(
-                    net_.io_service_, net_.ssl_context_);
+                    net_.socket_io_service(), net_.ssl_context_);
             acceptor_.async_accept(new_socket->ssl_socket_->lowest_layer(),
                                    boost::bind(&AsioTcpAcceptor::accept_handler,
                                                this,
@@ -824,7 +890,7 @@ void gcomm::AsioTcpAcceptor::listen(const gu::URI& uri)
         {
             new_socket->ssl_socket_ =
                 new asio::ssl::stream<asio::ip::tcp::socket>(
-                    net_.io_service_, net_.ssl_context_);
+                    net_.socket_io_service(), net_.ssl_context_);
             acceptor_.async_accept(new_socket->ssl_socket_->lowest_layer(),
                                    boost::bind(&AsioTcpAcceptor::accept_handler,
                                                this,
@@ -61,8 +61,12 @@ public:
     size_t mtu() const;
     std::string local_addr() const;
     std::string remote_addr() const;
-    State state() const { return state_; }
+    State state() const;
     SocketId id() const { return &socket_; }
+    // Lock socket state. Protonet is locked if I/O threads are not
+    // in use, otherwise socket private mutex.
+    void enter() const;
+    void leave() const;
 private:
     friend class gcomm::AsioTcpAcceptor;
     friend class gcomm::AsioPostForSendHandler;
@@ -73,6 +77,8 @@ private:
     void set_socket_options();
     void read_one(boost::array<asio::mutable_buffer, 1>& mbs);
     void write_one(const boost::array<asio::const_buffer, 2>& cbs);
+    void write_front();
+    void start_receive();
     void close_socket();
 
     // call to assign local/remote addresses at the point where it
@@ -89,6 +95,10 @@ private:
 
     AsioProtonet&                             net_;
     asio::ip::tcp::socket                     socket_;
+    // all socket handlers are run through strand_ to serialize
+    // them when I/O threads are in use
+    asio::io_service::strand                  strand_;
+    gu::RecursiveMutex mutable                mutex_;
 #ifdef HAVE_ASIO_SSL_HPP
     asio::ssl::stream<asio::ip::tcp::socket>* ssl_socket_;
 #endif // HAVE_ASIO_SSL_HPP
@@ -13,11 +13,13 @@ namespace gcomm
     {
         static std::string const ProtonetBackend          ;
         static std::string const ProtonetVersion          ;
+        static std::string const ProtonetIoThreads        ;
         static std::string const SocketChecksum           ;
         static std::string const SocketRecvBufSize        ;
         static std::string const GMCastVersion            ;
         static std::string const GMCastTcpPort            ;
         static std::string const GMCastSegment            ;
+        static std::string const GMCastSegmentCompress    ;
         static std::string const GMCastTimeWait           ;
         static std::string const GMCastPeerTimeout        ;
         static std::string const EvsViewForgetTimeout     ;
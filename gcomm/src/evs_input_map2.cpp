@@ -90,6 +90,18 @@ std::ostream& gcomm::evs::operator<<(std::ostream& os, const InputMapMsg& m)
 }
 
 
+std::ostream& gcomm::evs::operator<<(std::ostream& os,
+                                     const InputMapMsgIndex& mi)
+{
+    for (InputMapMsgIndex::iterator i(mi.begin()); i != mi.end(); ++i)
+    {
+        os << "(" << InputMapMsgIndex::key(i) << ","
+           << InputMapMsgIndex::value(i) << ")";
+    }
+    return (os << " recovery=" << mi.n_recovery());
+}
+
+
 std::ostream& gcomm::evs::operator<<(std::ostream& os, const InputMap& im)
 {
     return (os << "evs::input_map: {"
@@ -98,14 +110,202 @@ std::ostream& gcomm::evs::operator<<(std::ostream& os, const InputMap& im)
             << "node_index="     << *im.node_index_
 #ifndef NDEBUG
             << ","
-            << "msg_index="      << *im.msg_index_      << ","
-            << "recovery_index=" << *im.recovery_index_
+            << "msg_index="      << *im.msg_index_
 #endif // !NDEBUG
             << "}");
 }
 
 
 
+//////////////////////////////////////////////////////////////////////////
+//
+// Message ring and index
+//
+//////////////////////////////////////////////////////////////////////////
+
+
+gcomm::evs::InputMapMsgRing::InputMapMsgRing(size_t capacity)
+    :
+    slots_      (),
+    empty_      (),
+    base_       (0),
+    end_        (0),
+    first_msg_  (-1),
+    n_msgs_     (0),
+    n_recovery_ (0)
+{
+    size_t cap(1);
+    while (cap < capacity) cap <<= 1;
+    slots_.resize(cap);
+}
+
+
+void gcomm::evs::InputMapMsgRing::reserve(const seqno_t seq)
+{
+    const size_t required(static_cast<size_t>(seq - base_) + 1);
+    if (required <= slots_.size()) return;
+
+    size_t cap(slots_.size());
+    while (cap < required) cap <<= 1;
+
+    std::vector<Slot> slots(cap);
+    const size_t mask(cap - 1);
+    for (seqno_t s(base_); s < end_; ++s)
+    {
+        slots[static_cast<size_t>(s) & mask] = slots_[slot(s)];
+    }
+    slots_.swap(slots);
+}
+
+
+void gcomm::evs::InputMapMsgRing::release(Slot& s)
+{
+    s.state_ = S_EMPTY;
+    s.msg_.release(empty_);
+}
+
+
+void gcomm::evs::InputMapMsgRing::insert(const seqno_t seq,
+                                         const UserMessage& msg,
+                                         const Datagram& rb)
+{
+    gcomm_assert(seq >= base_) << "seq " << seq << " < base " << base_;
+    gu_trace(reserve(seq));
+
+    Slot& s(slots_[slot(seq)]);
+    gcomm_assert(seq >= end_ || s.state_ == S_EMPTY)
+        << "slot for seq " << seq << " not empty";
+
+    s.state_ = S_MSG;
+    s.msg_.assign(msg, rb);
+
+    if (seq >= end_) end_ = seq + 1;
+    if (n_msgs_ == 0 || seq < first_msg_) first_msg_ = seq;
+    ++n_msgs_;
+}
+
+
+void gcomm::evs::InputMapMsgRing::erase(const seqno_t seq)
+{
+    gcomm_assert(state(seq) == S_MSG) << "no message for seq " << seq;
+
+    slots_[slot(seq)].state_ = S_RECOVERY;
+    --n_msgs_;
+    ++n_recovery_;
+
+    if (seq == first_msg_)
+    {
+        first_msg_ = (n_msgs_ > 0 ? next_msg(seq + 1) : -1);
+    }
+}
+
+
+void gcomm::evs::InputMapMsgRing::cleanup(const seqno_t safe_seq)
+{
+    // Undelivered message blocks advancing base, remaining recovery
+    // messages will be released once it has been erased.
+    while (base_ <= safe_seq && base_ < end_)
+    {
+        Slot& s(slots_[slot(base_)]);
+        if (s.state_ == S_MSG) break;
+        if (s.state_ == S_RECOVERY)
+        {
+            release(s);
+            --n_recovery_;
+        }
+        ++base_;
+    }
+}
+
+
+gcomm::evs::seqno_t
+gcomm::evs::InputMapMsgRing::next_msg(seqno_t seq) const
+{
+    if (n_msgs_ == 0) return -1;
+    if (seq < first_msg_) seq = first_msg_;
+    for (; seq < end_; ++seq)
+    {
+        if (slots_[slot(seq)].state_ == S_MSG) return seq;
+    }
+    return -1;
+}
+
+
+void gcomm::evs::InputMapMsgRing::clear()
+{
+    for (seqno_t s(base_); s < end_; ++s)
+    {
+        release(slots_[slot(s)]);
+    }
+    base_       = 0;
+    end_        = 0;
+    first_msg_  = -1;
+    n_msgs_     = 0;
+    n_recovery_ = 0;
+}
+
+
+void gcomm::evs::InputMapMsgIndex::reset(const size_t nodes,
+                                         const size_t capacity)
+{
+    clear();
+    rings_.resize(nodes, InputMapMsgRing(capacity));
+}
+
+
+void gcomm::evs::InputMapMsgIndex::clear()
+{
+    for (std::vector<InputMapMsgRing>::iterator i(rings_.begin());
+         i != rings_.end(); ++i)
+    {
+        i->clear();
+    }
+}
+
+
+size_t gcomm::evs::InputMapMsgIndex::n_msgs() const
+{
+    size_t ret(0);
+    for (std::vector<InputMapMsgRing>::const_iterator i(rings_.begin());
+         i != rings_.end(); ++i)
+    {
+        ret += i->n_msgs();
+    }
+    return ret;
+}
+
+
+size_t gcomm::evs::InputMapMsgIndex::n_recovery() const
+{
+    size_t ret(0);
+    for (std::vector<InputMapMsgRing>::const_iterator i(rings_.begin());
+         i != rings_.end(); ++i)
+    {
+        ret += i->n_recovery();
+    }
+    return ret;
+}
+
+
+gcomm::InputMapMsgKey
+gcomm::evs::InputMapMsgIndex::next(const InputMapMsgKey& key) const
+{
+    InputMapMsgKey ret(end_key());
+    for (size_t i(0); i < rings_.size(); ++i)
+    {
+        // Messages with the same seqno are ordered by node index
+        const seqno_t seq(rings_[i].next_msg(i > key.index() ?
+                                             key.seq() : key.seq() + 1));
+        if (seq != -1 && (ret == end_key() || seq < ret.seq()))
+        {
+            ret = InputMapMsgKey(i, seq);
+        }
+    }
+    return ret;
+}
+
+
+
 //////////////////////////////////////////////////////////////////////////
 //
 // Constructors/destructors
@@ -119,7 +319,7 @@ gcomm::evs::InputMap::InputMap() :
     aru_seq_        (-1),
     node_index_     (new InputMapNodeIndex()),
     msg_index_      (new InputMapMsgIndex()),
-    recovery_index_ (new InputMapMsgIndex())
+    empty_dg_       ()
 { }
 
 
@@ -128,7 +328,6 @@ gcomm::evs::InputMap::~InputMap()
     clear();
     delete node_index_;
     delete msg_index_;
-    delete recovery_index_;
 }
 
 
@@ -142,11 +341,11 @@ gcomm::evs::InputMap::~InputMap()
 
 void gcomm::evs::InputMap::reset(const size_t nodes, const seqno_t window)
 {
-    gcomm_assert(msg_index_->empty()                           == true &&
-                 recovery_index_->empty()                      == true);
+    gcomm_assert(msg_index_->empty() == true);
     node_index_->clear();
 
     window_ = window;
+    gu_trace(msg_index_->reset(nodes, static_cast<size_t>(window)));
     log_debug << " size " << node_index_->size();
     gu_trace(node_index_->resize(nodes, InputMapNode()));
     for (size_t i = 0; i < nodes; ++i)
@@ -213,18 +412,17 @@ void gcomm::evs::InputMap::set_safe_seq(const size_t uuid, const seqno_t seq)
 
 void gcomm::evs::InputMap::clear()
 {
-    if (msg_index_->empty() == false)
+    if (msg_index_->n_msgs() > 0)
     {
-        log_warn << "discarding " << msg_index_->size() <<
+        log_warn << "discarding " << msg_index_->n_msgs() <<
             " messages from message index";
     }
-    msg_index_->clear();
-    if (recovery_index_->empty() == false)
+    if (msg_index_->n_recovery() > 0)
     {
-        log_debug << "discarding " << recovery_index_->size()
+        log_debug << "discarding " << msg_index_->n_recovery()
                   << " messages from recovery index";
     }
-    recovery_index_->clear();
+    msg_index_->clear();
     node_index_->clear();
     aru_seq_ = -1;
     safe_seq_ = -1;
@@ -246,10 +444,11 @@ gcomm::evs::InputMap::insert(const size_t uuid,
     // messages.
     gcomm_assert(aru_seq_ < msg.seq())
         << "aru seq " << aru_seq_ << " msg seq " << msg.seq()
-        << " index size " << msg_index_->size();
+        << " index size " << msg_index_->n_msgs();
 
     gcomm_assert(uuid < node_index_->size());
     InputMapNode& node((*node_index_)[uuid]);
+    InputMapMsgRing& ring(msg_index_->ring(node.index()));
     range = node.range();
 
     // User should check LU before inserting. This check is left
@@ -262,8 +461,7 @@ gcomm::evs::InputMap::insert(const size_t uuid,
     // Check whether this message has already been seen
     if (msg.seq() < node.range().lu() ||
         (msg.seq() <= node.range().hs() &&
-         recovery_index_->find(InputMapMsgKey(node.index(), msg.seq())) !=
-         recovery_index_->end()))
+         ring.state(msg.seq()) == InputMapMsgRing::S_RECOVERY))
     {
         return node.range();
     }
@@ -272,35 +470,24 @@ gcomm::evs::InputMap::insert(const size_t uuid,
     // already found
     for (seqno_t s = msg.seq(); s <= msg.seq() + msg.seq_range(); ++s)
     {
-        InputMapMsgIndex::iterator msg_i;
-
-        if (range.hs() < s)
-        {
-            msg_i = msg_index_->end();
-        }
-        else
-        {
-            msg_i = msg_index_->find(InputMapMsgKey(node.index(), s));
-        }
-
-        if (msg_i == msg_index_->end())
+        if (range.hs() < s || ring.state(s) == InputMapMsgRing::S_EMPTY)
         {
-            Datagram ins_dg(s == msg.seq() ?
-                                Datagram(rb)   :
-                                Datagram());
-            gu_trace((void)msg_index_->insert_unique(
-                         std::make_pair(
-                             InputMapMsgKey(node.index(), s),
-                             InputMapMsg(
-                                 (s == msg.seq() ?
-                                  msg :
-                                  UserMessage(msg.version(),
-                                              msg.source(),
-                                              msg.source_view_id(),
-                                              s,
-                                              msg.aru_seq(),
-                                              0,
-                                              O_DROP)), ins_dg))));
+            if (s == msg.seq())
+            {
+                gu_trace(ring.insert(s, msg, rb));
+            }
+            else
+            {
+                gu_trace(ring.insert(s,
+                                     UserMessage(msg.version(),
+                                                 msg.source(),
+                                                 msg.source_view_id(),
+                                                 s,
+                                                 msg.aru_seq(),
+                                                 0,
+                                                 O_DROP),
+                                     empty_dg_));
+            }
         }
 
         // Update highest seen
@@ -317,12 +504,8 @@ gcomm::evs::InputMap::insert(const size_t uuid,
             {
                 ++i;
             }
-            while (
-                i <= range.hs() &&
-                (msg_index_->find(InputMapMsgKey(node.index(), i))
-                 != msg_index_->end() ||
-                 recovery_index_->find(InputMapMsgKey(node.index(), i))
-                 != recovery_index_->end()));
+            while (i <= range.hs() &&
+                   ring.state(i) != InputMapMsgRing::S_EMPTY);
             range.set_lu(i);
         }
     }
@@ -335,30 +518,40 @@ gcomm::evs::InputMap::insert(const size_t uuid,
 
 void gcomm::evs::InputMap::erase(iterator i)
 {
-    gu_trace(recovery_index_->insert_unique(*i));
-    gu_trace(msg_index_->erase(i));
+    const InputMapMsgKey& key(InputMapMsgIndex::key(i));
+    InputMapMsgRing& ring(msg_index_->ring(key.index()));
+    gu_trace(ring.erase(key.seq()));
+    if (key.seq() <= safe_seq_)
+    {
+        // Message was already safe, no need to keep it for recovery
+        ring.cleanup(safe_seq_);
+    }
 }
 
 
 gcomm::evs::InputMap::iterator
 gcomm::evs::InputMap::find(const size_t uuid, const seqno_t seq) const
 {
-    iterator ret;
     const InputMapNode& node(node_index_->at(uuid));
-    const InputMapMsgKey key(node.index(), seq);
-    gu_trace(ret = msg_index_->find(key));
-    return ret;
+    if (msg_index_->ring(node.index()).state(seq) == InputMapMsgRing::S_MSG)
+    {
+        return iterator(msg_index_, InputMapMsgKey(node.index(), seq));
+    }
+    return msg_index_->end();
 }
 
 
 gcomm::evs::InputMap::iterator
 gcomm::evs::InputMap::recover(const size_t uuid, const seqno_t seq) const
 {
-    iterator ret;
     const InputMapNode& node(node_index_->at(uuid));
     const InputMapMsgKey key(node.index(), seq);
-    gu_trace(ret = recovery_index_->find_checked(key));
-    return ret;
+    if (msg_index_->ring(node.index()).state(seq) !=
+        InputMapMsgRing::S_RECOVERY)
+    {
+        gu_throw_fatal << "element " << key << " not found";
+    }
+    return iterator(msg_index_, key);
 }
 
 
@@ -385,7 +578,8 @@ inline void gcomm::evs::InputMap::update_aru()
 void gcomm::evs::InputMap::cleanup_recovery_index()
 {
     gcomm_assert(node_index_->size() > 0);
-    InputMapMsgIndex::iterator i = recovery_index_->lower_bound(
-        InputMapMsgKey(0, safe_seq_ + 1));
-    recovery_index_->erase(recovery_index_->begin(), i);
+    for (size_t i(0); i < node_index_->size(); ++i)
+    {
+        msg_index_->ring(i).cleanup(safe_seq_);
+    }
 }
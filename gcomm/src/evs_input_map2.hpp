@@ -20,7 +20,6 @@
 #define EVS_INPUT_MAP2_HPP
 
 #include "evs_message2.hpp"
-#include "gcomm/map.hpp"
 #include "gcomm/datagram.hpp"
 
 #include <vector>
@@ -35,7 +34,9 @@ namespace gcomm
     {
         class InputMapMsg;
         std::ostream& operator<<(std::ostream&, const InputMapMsg&);
+        class InputMapMsgRing;
         class InputMapMsgIndex;
+        std::ostream& operator<<(std::ostream&, const InputMapMsgIndex&);
         class InputMapNode;
         std::ostream& operator<<(std::ostream&, const InputMapNode&);
         typedef std::vector<InputMapNode> InputMapNodeIndex;
@@ -63,9 +64,19 @@ public:
         return (seq_ < cmp.seq_ || (seq_ == cmp.seq_ && index_ < cmp.index_));
     }
 
+    bool operator==(const InputMapMsgKey& cmp) const
+    {
+        return (seq_ == cmp.seq_ && index_ == cmp.index_);
+    }
+
+    bool operator!=(const InputMapMsgKey& cmp) const
+    {
+        return !(*this == cmp);
+    }
+
 private:
-    size_t       const index_;
-    evs::seqno_t const seq_;
+    size_t       index_;
+    evs::seqno_t seq_;
 };
 
 
@@ -73,6 +84,7 @@ private:
 class gcomm::evs::InputMapMsg
 {
 public:
+    InputMapMsg() : msg_(), rb_() { }
     InputMapMsg(const UserMessage&  msg,
                 const Datagram&     rb)
         :
@@ -82,41 +94,185 @@ public:
     InputMapMsg(const InputMapMsg& m) : msg_(m.msg_), rb_ (m.rb_) { }
     ~InputMapMsg() { }
 
+    InputMapMsg& operator=(const InputMapMsg& m)
+    {
+        msg_ = m.msg_;
+        rb_  = m.rb_;
+        return *this;
+    }
+
+    void assign(const UserMessage& msg, const Datagram& rb)
+    {
+        msg_ = msg;
+        rb_  = rb;
+    }
+
+    void release(const Datagram& rb) { rb_ = rb; }
+
     const UserMessage&  msg () const { return msg_;  }
     const Datagram& rb  () const { return rb_;   }
 private:
-    void operator=(const InputMapMsg&);
+    UserMessage msg_;
+    Datagram    rb_;
+};
+
+
+/*!
+ * Per node message ring.
+ *
+ * Messages originated from a single node are stored in circular array
+ * indexed by message sequence number. Since sequence numbers of a single
+ * source are dense inside the send window, array slot for seqno is found
+ * directly and no allocation is done in steady state. Array capacity is
+ * always a power of two and it is doubled if the window outgrows it.
+ *
+ * Slots between base and end are either empty (not received yet),
+ * hold undelivered message or hold delivered message which is kept
+ * for recovery until it becomes safe.
+ */
+class gcomm::evs::InputMapMsgRing
+{
+public:
+    enum State
+    {
+        S_EMPTY,    /*!< No message          */
+        S_MSG,      /*!< Undelivered message */
+        S_RECOVERY  /*!< Delivered, not safe */
+    };
+
+    explicit InputMapMsgRing(size_t capacity = 0);
 
-    UserMessage const msg_;
-    Datagram          rb_;
+    State state(const seqno_t seq) const
+    {
+        if (seq < base_ || seq >= end_) return S_EMPTY;
+        return slots_[slot(seq)].state_;
+    }
+
+    const InputMapMsg& msg(const seqno_t seq) const
+    {
+        assert(state(seq) != S_EMPTY);
+        return slots_[slot(seq)].msg_;
+    }
+
+    /*! Store message with given seqno, slot must be empty */
+    void insert(seqno_t seq, const UserMessage& msg, const Datagram& rb);
+
+    /*! Move message from undelivered to recovery state */
+    void erase(seqno_t seq);
+
+    /*! Release all recovery messages up to and including safe_seq */
+    void cleanup(seqno_t safe_seq);
+
+    /*!
+     * Return lowest seqno of undelivered message which is equal or
+     * greater than seq or -1 if there is none.
+     */
+    seqno_t next_msg(seqno_t seq) const;
+
+    /*! Release all messages, capacity is retained */
+    void clear();
+
+    size_t n_msgs()     const { return n_msgs_;     }
+    size_t n_recovery() const { return n_recovery_; }
+    size_t capacity()   const { return slots_.size(); }
+
+private:
+    struct Slot
+    {
+        Slot() : state_(S_EMPTY), msg_() { }
+        State       state_;
+        InputMapMsg msg_;
+    };
+
+    size_t slot(const seqno_t seq) const
+    {
+        return (static_cast<size_t>(seq) & (slots_.size() - 1));
+    }
+
+    void reserve(seqno_t seq);
+    void release(Slot& s);
+
+    std::vector<Slot> slots_;
+    Datagram          empty_;      /*!< Assigned to released slots  */
+    seqno_t           base_;       /*!< Lowest seqno held in ring    */
+    seqno_t           end_;        /*!< Highest seqno held plus one  */
+    seqno_t           first_msg_;  /*!< Lowest undelivered seqno     */
+    size_t            n_msgs_;
+    size_t            n_recovery_;
 };
 
 
-#if defined(GALERA_USE_BOOST_POOL_ALLOC)
+/*!
+ * Message index over all node rings. Iteration happens in total
+ * order of (seq, index) over undelivered messages.
+ */
+class gcomm::evs::InputMapMsgIndex
+{
+public:
 
-#include <boost/pool/pool_alloc.hpp>
+    class iterator
+    {
+    public:
+        iterator() : index_(0), key_(0, -1) { }
+        iterator(const InputMapMsgIndex* index, const InputMapMsgKey& key)
+            :
+            index_(index),
+            key_  (key)
+        { }
 
-class gcomm::evs::InputMapMsgIndex :
-    public Map<InputMapMsgKey, InputMapMsg,
-               std::map<InputMapMsgKey,
-                        InputMapMsg,
-                        std::less<InputMapMsgKey>,
-                        boost::fast_pool_allocator<
-                            std::pair<const InputMapMsgKey, InputMapMsg>,
-                            boost::default_user_allocator_new_delete,
-                            boost::details::pool::null_mutex
-                            >
-                        >
-               >
-{};
+        const InputMapMsgKey& key() const { return key_; }
 
-#else /* GALERA_USE_BOOST_POOL_ALLOC */
+        const InputMapMsg& operator*() const
+        {
+            return index_->rings_[key_.index()].msg(key_.seq());
+        }
 
-class gcomm::evs::InputMapMsgIndex :
-    public Map<InputMapMsgKey, InputMapMsg>
-{};
+        const InputMapMsg* operator->() const { return &operator*(); }
 
-#endif /* GALERA_USE_BOOST_POOL_ALLOC */
+        iterator& operator++()
+        {
+            key_ = index_->next(key_);
+            return *this;
+        }
+
+        bool operator==(const iterator& cmp) const { return key_ == cmp.key_; }
+        bool operator!=(const iterator& cmp) const { return key_ != cmp.key_; }
+
+    private:
+        const InputMapMsgIndex* index_;
+        InputMapMsgKey          key_;
+    };
+
+    typedef iterator const_iterator;
+
+    InputMapMsgIndex() : rings_() { }
+
+    static const InputMapMsgKey& key  (const iterator& i) { return i.key(); }
+    static const InputMapMsg&    value(const iterator& i) { return *i;      }
+
+    iterator begin() const { return iterator(this, next(end_key())); }
+    iterator end  () const { return iterator(this, end_key());       }
+
+    void reset(size_t nodes, size_t capacity);
+    void clear();
+
+    bool   empty()      const { return (n_msgs() == 0 && n_recovery() == 0); }
+    size_t n_msgs()     const;
+    size_t n_recovery() const;
+
+    InputMapMsgRing&       ring(size_t index)       { return rings_[index]; }
+    const InputMapMsgRing& ring(size_t index) const { return rings_[index]; }
+
+private:
+    friend class iterator;
+
+    static InputMapMsgKey end_key() { return InputMapMsgKey(0, -1); }
+
+    /* Return key of the message following key in total order */
+    InputMapMsgKey next(const InputMapMsgKey& key) const;
+
+    std::vector<InputMapMsgRing> rings_;
+};
 
 /* Internal node representation */
 class gcomm::evs::InputMapNode
@@ -322,9 +478,12 @@ public:
     iterator recover(const size_t uuid, const seqno_t seq) const;
 
     /*!
+     * Reset input map for given number of nodes.
      *
+     * @param nodes  Number of nodes
+     * @param window Initial capacity of per node message rings
      */
-    void reset(const size_t, const seqno_t = 256);
+    void reset(const size_t nodes, const seqno_t window = 256);
 
     /*!
      * Clear input map state.
@@ -344,7 +503,7 @@ private:
     void update_aru();
 
     /*!
-     * Clean up recovery index. All messages up to safe_seq are removed.
+     * Clean up recovery messages. All messages up to safe_seq are removed.
      */
     void cleanup_recovery_index();
 
@@ -353,7 +512,7 @@ private:
     seqno_t            aru_seq_;        /*!< All received upto seqno */
     InputMapNodeIndex* node_index_;     /*!< Index of nodes          */
     InputMapMsgIndex*  msg_index_;      /*!< Index of messages       */
-    InputMapMsgIndex*  recovery_index_; /*!< Recovery index          */
+    Datagram const     empty_dg_;       /*!< Payload for O_DROP msgs */
 };
 
 #endif // EVS_INPUT_MAP2_HPP
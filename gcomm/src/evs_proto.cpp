@@ -58,6 +58,12 @@ gcomm::evs::Proto::Proto(gu::Config&    conf,
     hs_safe_("0.0,0.0001,0.00031623,0.001,0.0031623,0.01,0.031623,0.1,0.31623,1.,3.1623,10.,31.623"),
     hs_local_causal_("0.0,0.0001,0.00031623,0.001,0.0031623,0.01,0.031623,0.1,0.31623,1.,3.1623,10.,31.623"),
     safe_deliv_latency_(),
+    view_gather_latency_(),
+    view_commit_latency_(),
+    view_install_latency_(),
+    view_change_start_(gu::datetime::Date::now()),
+    view_install_msg_(view_change_start_),
+    view_committed_(view_change_start_),
     send_queue_s_(0),
     n_send_queue_s_(0),
     sent_msgs_(7, 0),
@@ -80,6 +86,8 @@ gcomm::evs::Proto::Proto(gu::Config&    conf,
     segment_(segment),
     known_(),
     self_i_(),
+    view_uuids_(),
+    view_nodes_(),
     view_forget_timeout_(
         check_range(Conf::EvsViewForgetTimeout,
                     param<gu::datetime::Period>(
@@ -183,10 +191,16 @@ gcomm::evs::Proto::Proto(gu::Config&    conf,
                     gu::from_string<seqno_t>(Defaults::EvsUserSendWindowMin),
                     send_window_ + 1)),
     output_(),
-    send_buf_(),
     max_output_size_(128),
     mtu_(mtu),
     use_aggregate_(param<bool>(conf, uri, Conf::EvsUseAggregate, "true")),
+    aggregate_wait_(
+        check_range(Conf::EvsAggregateWait,
+                    param<gu::datetime::Period>(conf, uri,
+                                                Conf::EvsAggregateWait,
+                                                "PT0S"),
+                    gu::datetime::Period(0), retrans_period_ + 1)),
+    aggregate_armed_(false),
     self_loopback_(false),
     state_(S_CLOSED),
     shift_to_rfcnt_(0),
@@ -213,6 +227,7 @@ gcomm::evs::Proto::Proto(gu::Config&    conf,
     conf.set(Conf::EvsSendWindow, gu::to_string(send_window_));
     conf.set(Conf::EvsUserSendWindow, gu::to_string(user_send_window_));
     conf.set(Conf::EvsUseAggregate, gu::to_string(use_aggregate_));
+    conf.set(Conf::EvsAggregateWait, gu::to_string(aggregate_wait_));
     conf.set(Conf::EvsDebugLogMask, gu::to_string(debug_mask_, std::hex));
     conf.set(Conf::EvsInfoLogMask, gu::to_string(info_mask_, std::hex));
     conf.set(Conf::EvsMaxInstallTimeouts, gu::to_string(max_install_timeouts_));
@@ -229,16 +244,13 @@ gcomm::evs::Proto::Proto(gu::Config&    conf,
     NodeMap::value(self_i_).set_index(0);
     input_map_->reset(1);
     current_view_.add_member(my_uuid_, segment_);
+    reset_view_index();
     // we don't need to store previous views, do we ?
     if (rst_view) {
         previous_view_ = *rst_view;
         previous_views_.insert(
             std::make_pair(rst_view -> id(), gu::datetime::Date::now()));
     }
-    if (mtu_ != std::numeric_limits<size_t>::max())
-    {
-        send_buf_.reserve(mtu_);
-    }
 }
 
 
@@ -386,6 +398,16 @@ gcomm::evs::Proto::set_param(const std::string& key, const std::string& val)
         conf_.set(Conf::EvsUseAggregate, gu::to_string(use_aggregate_));
         return true;
     }
+    else if (key == Conf::EvsAggregateWait)
+    {
+        aggregate_wait_ = check_range(
+            Conf::EvsAggregateWait,
+            gu::from_string<gu::datetime::Period>(val),
+            gu::datetime::Period(0), retrans_period_ + 1);
+        conf_.set(Conf::EvsAggregateWait, gu::to_string(aggregate_wait_));
+        // held messages are flushed on next aggregate timer expiration
+        return true;
+    }
     else if (key == Conf::EvsDelayMargin)
     {
         delay_margin_ = gu::from_string<gu::datetime::Period>(val);
@@ -445,6 +467,12 @@ void gcomm::evs::Proto::handle_get_status(gu::Status& status) const
 {
     status.insert("evs_state", to_string(state_));
     status.insert("evs_repl_latency", safe_deliv_latency_.to_string());
+    status.insert("evs_view_gather_latency",
+                  view_gather_latency_.to_string());
+    status.insert("evs_view_commit_latency",
+                  view_commit_latency_.to_string());
+    status.insert("evs_view_install_latency",
+                  view_install_latency_.to_string());
     std::string delayed_list_str;
     for (DelayedList::const_iterator i(delayed_list_.begin());
          i != delayed_list_.end(); ++i)
@@ -798,6 +826,32 @@ void gcomm::evs::Proto::handle_stats_timer()
 }
 
 
+void gcomm::evs::Proto::handle_aggregate_timer()
+{
+    // Flush messages held in output queue for aggregation if
+    // no message from the group has done it within aggregate_wait_
+    if (state() == S_OPERATIONAL)
+    {
+        while (output_.empty() == false)
+        {
+            int err;
+            if ((err = send_user(send_window_)) != 0)
+            {
+                break;
+            }
+        }
+    }
+}
+
+
+bool gcomm::evs::Proto::aggregate_armed()
+{
+    bool const ret(aggregate_armed_);
+    aggregate_armed_ = false;
+    return ret;
+}
+
+
 
 class TimerSelectOp
 {
@@ -844,6 +898,9 @@ gu::datetime::Date gcomm::evs::Proto::next_expiration(const Timer t) const
         }
     case T_STATS:
         return (now + stats_report_period_);
+    case T_AGGREGATE:
+        return (output_.empty() == true ?
+                gu::datetime::Date::max() : now + aggregate_wait_);
     }
     gu_throw_fatal;
 }
@@ -897,6 +954,9 @@ gu::datetime::Date gcomm::evs::Proto::handle_timers()
         case T_STATS:
             handle_stats_timer();
             break;
+        case T_AGGREGATE:
+            handle_aggregate_timer();
+            break;
         }
         if (state() == S_CLOSED)
         {
@@ -1610,8 +1670,12 @@ int gcomm::evs::Proto::send_user(const seqno_t win)
     size_t alen;
     if (use_aggregate_ == true && (alen = aggregate_len()) > 0)
     {
-        // Messages can be aggregated into single message
-        send_buf_.resize(alen);
+        // Messages can be aggregated into single message. Aggregate
+        // is gathered directly into the buffer which is handed to
+        // the outgoing datagram, so each payload is copied only once.
+        gu::SharedBuffer sb(new gu::Buffer(alen));
+        gu::byte_t* const buf(&(*sb)[0]);
+        const size_t buflen(sb->size());
         size_t offset(0);
         size_t n(0);
 
@@ -1625,21 +1689,20 @@ int gcomm::evs::Proto::send_user(const seqno_t win)
             AggregateMessage am(0, dg.len(), dm.user_type());
             gcomm_assert(alen >= dg.len() + am.serial_size());
 
-            gu_trace(offset = am.serialize(&send_buf_[0],
-                                           send_buf_.size(), offset));
+            gu_trace(offset = am.serialize(buf, buflen, offset));
             std::copy(dg.header() + dg.header_offset(),
                       dg.header() + dg.header_size(),
-                      &send_buf_[0] + offset);
+                      buf + offset);
             offset += (dg.header_len());
             std::copy(dg.payload().begin(), dg.payload().end(),
-                      &send_buf_[0] + offset);
+                      buf + offset);
             offset += dg.payload().size();
             alen -= dg.len() + am.serial_size();
             ++n;
             ++i;
         }
-        Datagram dg(gu::SharedBuffer(new gu::Buffer(send_buf_.begin(),
-                                                        send_buf_.end())));
+        assert(offset == buflen);
+        Datagram dg(sb);
         if ((ret = send_user(dg, 0xff, ord, win, -1, n)) == 0)
         {
             while (n-- > 0)
@@ -2148,7 +2211,7 @@ void gcomm::evs::Proto::recover(const UUID& gap_source,
         return;
     }
 
-    const Node& range_node(NodeMap::value(known_.find_checked(range_uuid)));
+    const Node& range_node(NodeMap::value(find_node_checked(range_uuid)));
     const Range im_range(input_map_->range(range_node.index()));
 
     evs_log_debug(D_RETRANS) << " recovering message from "
@@ -2306,7 +2369,7 @@ void gcomm::evs::Proto::handle_msg(const Message& msg,
     gcomm_assert(msg.source() != UUID::nil());
 
     // Figure out if the message is from known source
-    NodeMap::iterator ii = known_.find(msg.source());
+    NodeMap::iterator ii = find_node(msg.source());
 
     if (ii == known_.end())
     {
@@ -2615,7 +2678,20 @@ int gcomm::evs::Proto::handle_down(Datagram& wb, const ProtoDownMeta& dm)
 
     int ret = 0;
 
-    if (output_.empty() == true)
+    if (output_.empty()        == true &&
+        use_aggregate_         == true &&
+        aggregate_wait_        >  gu::datetime::Period(0) &&
+        last_sent_             >  input_map_->safe_seq())
+    {
+        // Own messages are still in flight, hold this one in output
+        // queue to be sent in aggregate with following messages.
+        // Output queue is flushed when the next message from the group
+        // is handled or at latest when aggregate timer expires.
+        output_.push_back(std::make_pair(wb, dm));
+        reset_timer(T_AGGREGATE);
+        aggregate_armed_ = true;
+    }
+    else if (output_.empty() == true)
     {
         int err;
         err = send_user(wb,
@@ -2668,6 +2744,29 @@ int gcomm::evs::Proto::send_down(Datagram& dg, const ProtoDownMeta& dm)
 // State handler
 /////////////////////////////////////////////////////////////////////////////
 
+void gcomm::evs::Proto::update_view_change_stats()
+{
+    const gu::datetime::Date now(gu::datetime::Date::now());
+    const double gather(double(view_install_msg_.get_utc()
+                               - view_change_start_.get_utc())
+                        /gu::datetime::Sec);
+    const double commit(double(view_committed_.get_utc()
+                               - view_install_msg_.get_utc())
+                        /gu::datetime::Sec);
+    const double install(double(now.get_utc() - view_committed_.get_utc())
+                         /gu::datetime::Sec);
+
+    view_gather_latency_.insert(gather);
+    view_commit_latency_.insert(commit);
+    view_install_latency_.insert(install);
+
+    log_info << self_string() << " view change to "
+             << install_message_->install_view_id() << " took "
+             << gather + commit + install << " s (gather " << gather
+             << ", commit " << commit << ", install " << install << ")";
+}
+
+
 void gcomm::evs::Proto::shift_to(const State s, const bool send_j)
 {
     if (shift_to_rfcnt_ > 0) gu_throw_fatal << *this;
@@ -2787,6 +2886,12 @@ void gcomm::evs::Proto::shift_to(const State s, const bool send_j)
         }
 
         State prev_state(state_);
+        if (prev_state == S_OPERATIONAL || prev_state == S_JOINING)
+        {
+            // Beginning of view change. Failed install attempts count
+            // towards gather phase, so the timestamp is not reset for them.
+            view_change_start_ = gu::datetime::Date::now();
+        }
         state_ = S_GATHER;
         if (send_j == true)
         {
@@ -2807,6 +2912,7 @@ void gcomm::evs::Proto::shift_to(const State s, const bool send_j)
     {
         gcomm_assert(install_message_ != 0);
         gcomm_assert(is_all_committed() == true);
+        view_committed_ = gu::datetime::Date::now();
         state_ = S_INSTALL;
         reset_timer(T_INACTIVITY);
         reset_timer(T_RETRANS);
@@ -2822,6 +2928,7 @@ void gcomm::evs::Proto::shift_to(const State s, const bool send_j)
                          *install_message_))
             << "install message not consistent with own join, state: " << *this;
         gcomm_assert(is_all_installed() == true);
+        gu_trace(update_view_change_stats());
         gu_trace(deliver());
         gu_trace(deliver_local());
         gu_trace(deliver_trans_view(*install_message_, current_view_));
@@ -2894,6 +3001,7 @@ void gcomm::evs::Proto::shift_to(const State s, const bool send_j)
         }
 
         input_map_->reset(current_view_.members().size());
+        reset_view_index();
         last_sent_ = -1;
         state_ = S_OPERATIONAL;
         deliver_reg_view(*install_message_, previous_view_);
@@ -3232,6 +3340,52 @@ gcomm::evs::seqno_t gcomm::evs::Proto::update_im_safe_seq(const size_t uuid,
 }
 
 
+void gcomm::evs::Proto::reset_view_index()
+{
+    view_uuids_.clear();
+    view_nodes_.clear();
+    view_uuids_.reserve(current_view_.members().size());
+    view_nodes_.reserve(current_view_.members().size());
+
+    for (NodeList::const_iterator i(current_view_.members().begin());
+         i != current_view_.members().end(); ++i)
+    {
+        NodeMap::iterator const nmi(known_.find_checked(NodeList::key(i)));
+        gcomm_assert(NodeMap::value(nmi).index() == view_nodes_.size());
+        view_uuids_.push_back(NodeList::key(i));
+        view_nodes_.push_back(nmi);
+    }
+}
+
+
+gcomm::evs::NodeMap::iterator gcomm::evs::Proto::find_node(const UUID& uuid)
+{
+    std::vector<UUID>::const_iterator const i(
+        std::lower_bound(view_uuids_.begin(), view_uuids_.end(), uuid));
+
+    if (i != view_uuids_.end() && *i == uuid)
+    {
+        return view_nodes_[i - view_uuids_.begin()];
+    }
+
+    return known_.find(uuid);
+}
+
+
+gcomm::evs::NodeMap::iterator
+gcomm::evs::Proto::find_node_checked(const UUID& uuid)
+{
+    NodeMap::iterator const ret(find_node(uuid));
+
+    if (ret == known_.end())
+    {
+        gu_throw_fatal << "element " << uuid << " not found";
+    }
+
+    return ret;
+}
+
+
 void gcomm::evs::Proto::handle_user(const UserMessage& msg,
                                     NodeMap::iterator ii,
                                     const Datagram& rb)
@@ -3673,7 +3827,7 @@ bool gcomm::evs::Proto::update_im_safe_seqs(const MessageNodeList& node_list)
          i != node_list.end(); ++i)
     {
         const UUID& node_uuid(MessageNodeList::key(i));
-        const Node& local_node(NodeMap::value(known_.find_checked(node_uuid)));
+        const Node& local_node(NodeMap::value(find_node_checked(node_uuid)));
         const MessageNode& node(MessageNodeList::value(i));
         gcomm_assert(node.view_id() == current_view_.id());
         const seqno_t safe_seq(node.safe_seq());
@@ -3697,7 +3851,7 @@ void gcomm::evs::Proto::retrans_user(const UUID& nl_uuid,
     {
         const UUID& node_uuid(MessageNodeList::key(i));
         const MessageNode& mn(MessageNodeList::value(i));
-        const Node& n(NodeMap::value(known_.find_checked(node_uuid)));
+        const Node& n(NodeMap::value(find_node_checked(node_uuid)));
         const Range r(input_map_->range(n.index()));
 
         if (node_uuid == uuid() &&
@@ -4359,7 +4513,11 @@ void gcomm::evs::Proto::handle_join(const JoinMessage& msg, NodeMap::iterator ii
          curr_join->node_list() != new_nl))
     {
         gu_trace(create_join());
-        if (consensus_.is_consensus() == false)
+        // Even if consensus is reached locally, representative may not
+        // have seen the updated join yet. Send it right away instead of
+        // letting the representative wait for join retransmission.
+        if (consensus_.is_consensus() == false ||
+            is_representative(uuid())  == false)
         {
             send_join(false);
         }
@@ -4405,6 +4563,7 @@ void gcomm::evs::Proto::handle_leave(const LeaveMessage& msg,
     else
     {
         // Always set node nonoperational if leave message is seen
+        const bool was_operational(node.operational());
         node.set_operational(false);
         if (msg.source_view_id()       != current_view_.id() ||
             is_msg_from_previous_view(msg) == true)
@@ -4428,8 +4587,11 @@ void gcomm::evs::Proto::handle_leave(const LeaveMessage& msg,
             profile_leave(shift_to_prof_);
         }
         else if (state() == S_GATHER &&
-                 prev_safe_seq != input_map_->safe_seq(node.index()))
+                 (was_operational == true ||
+                  prev_safe_seq != input_map_->safe_seq(node.index())))
         {
+            // Operational status change must be advertised immediately too,
+            // otherwise consensus is delayed until join retransmission.
             profile_enter(send_join_prof_);
             gu_trace(send_join());
             profile_leave(send_join_prof_);
@@ -4611,6 +4773,7 @@ void gcomm::evs::Proto::handle_install(const InstallMessage& msg,
     if (consensus_.is_consistent(msg) == true)
     {
         inst.set_tstamp(gu::datetime::Date::now());
+        view_install_msg_ = gu::datetime::Date::now();
         install_message_ = new InstallMessage(msg);
         assert(install_message_->source() != UUID::nil());
         assert(install_message_->flags() != 0);
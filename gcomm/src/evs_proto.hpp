@@ -209,6 +209,7 @@ public:
 
     bool is_representative(const UUID& pid) const;
 
+    void update_view_change_stats();
     void shift_to(const State, const bool send_j = true);
     bool is_all_suspected(const UUID& uuid) const;
     const View& current_view() const { return current_view_; }
@@ -230,6 +231,26 @@ private:
      * inactive nodes are allowed to be in
      */
     bool update_im_safe_seqs(const MessageNodeList&);
+
+    /*!
+     * Rebuild dense view index from current view members, must be
+     * called whenever input map indexes are assigned.
+     */
+    void reset_view_index();
+
+    /*!
+     * Find known node by UUID. Members of current view are looked up
+     * from dense view index, other nodes from known map.
+     *
+     * @return Iterator to known map, known_.end() if not found
+     */
+    NodeMap::iterator find_node(const UUID&);
+
+    /*!
+     * Same as find_node() but throws fatal exception if node is not found
+     */
+    NodeMap::iterator find_node_checked(const UUID&);
+
     bool is_msg_from_previous_view(const Message&);
     void check_suspects(const UUID&, const MessageNodeList&);
     void cross_check_inactives(const UUID&, const MessageNodeList&);
@@ -318,7 +339,8 @@ public:
         T_INACTIVITY,
         T_RETRANS,
         T_INSTALL,
-        T_STATS
+        T_STATS,
+        T_AGGREGATE
     };
     /*!
      * Internal timer list
@@ -332,10 +354,14 @@ public:
     void handle_retrans_timer();
     void handle_install_timer();
     void handle_stats_timer();
+    void handle_aggregate_timer();
     gu::datetime::Date next_expiration(const Timer) const;
     void reset_timer(Timer);
     void cancel_timer(Timer);
     gu::datetime::Date handle_timers();
+    // Returns true once after handle_down() has armed aggregate timer,
+    // caller must wake up event loop to reschedule timers
+    bool aggregate_armed();
 
     /*!
      * @brief Flags controlling what debug information is logged if
@@ -378,6 +404,14 @@ private:
     gu::Histogram hs_safe_;
     gu::Histogram hs_local_causal_;
     gu::Stats     safe_deliv_latency_;
+    // View change phases: gather until install message is accepted,
+    // commit until all commit gaps are seen, install until operational
+    gu::Stats     view_gather_latency_;
+    gu::Stats     view_commit_latency_;
+    gu::Stats     view_install_latency_;
+    gu::datetime::Date view_change_start_;  // left operational state
+    gu::datetime::Date view_install_msg_;   // accepted install message
+    gu::datetime::Date view_committed_;     // shifted to S_INSTALL
     long long int send_queue_s_;
     long long int n_send_queue_s_;
     std::vector<long long int> sent_msgs_;
@@ -404,6 +438,11 @@ private:
     friend class InspectNode;
     NodeMap known_;
     NodeMap::iterator self_i_;
+    // Current view members in input map index order. Indexes are assigned
+    // in UUID order, so message sources can be looked up by binary search
+    // over contiguous array instead of walking known_ tree.
+    std::vector<UUID> view_uuids_;
+    std::vector<NodeMap::iterator> view_nodes_;
     //
     gu::datetime::Period view_forget_timeout_;
     gu::datetime::Period inactive_timeout_;
@@ -484,10 +523,11 @@ private:
     seqno_t user_send_window_;
     // Output message queue
     std::deque<std::pair<Datagram, ProtoDownMeta> > output_;
-    std::vector<gu::byte_t> send_buf_;
     uint32_t max_output_size_;
     size_t mtu_;
     bool use_aggregate_;
+    gu::datetime::Period aggregate_wait_;
+    bool aggregate_armed_;
     bool self_loopback_;
     State state_;
     int shift_to_rfcnt_;
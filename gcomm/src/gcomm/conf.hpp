@@ -47,6 +47,16 @@ namespace gcomm
         static std::string const ProtonetBackend;
         static std::string const ProtonetVersion;
 
+        /*!
+         * @brief Number of protonet I/O threads ("protonet.io_threads")
+         *
+         * If greater than zero, socket reads and writes together with
+         * TLS processing and message checksumming are run in a pool of
+         * this many threads. Protocol processing stays in the gcomm
+         * thread. Zero (default) runs everything in the gcomm thread.
+         */
+        static std::string const ProtonetIoThreads;
+
         /*!
          * @brief TCP non-blocking flag ("socket.non_blocking")
          *
@@ -160,6 +170,15 @@ namespace gcomm
          */
         static std::string const GMCastSegment;
 
+        /*!
+         * @brief Compression level for messages sent to other segments
+         *        (0 - no compression, 1 - fastest ... 9 - best)
+         *
+         * Compressed messages are sent only to peers which have
+         * announced support for them during handshake.
+         */
+        static std::string const GMCastSegmentCompress;
+
 
         /*!
          * @brief EVS scheme for transport URI ("evs")
@@ -296,6 +315,20 @@ namespace gcomm
          */
         static std::string const EvsUseAggregate;
 
+        /*!
+         * @brief EVS aggregation wait ("evs.aggregate_wait")
+         *
+         * If set to non-zero period, user message is queued instead of
+         * being sent immediately when the output queue is empty but
+         * previously sent messages from this node have not yet become
+         * safe. Queued messages are sent in aggregate when the next
+         * message from the group arrives or at latest when this period
+         * has passed. Must not exceed Conf::EvsKeepalivePeriod. Has
+         * effect only if Conf::EvsUseAggregate is enabled.
+         * Default is PT0S (disabled).
+         */
+        static std::string const EvsAggregateWait;
+
         /*!
          * @brief Period to generate keepalives for causal messages
          *
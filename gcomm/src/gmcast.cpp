@@ -13,6 +13,7 @@
 #include "gu_convert.hpp"
 #include "gu_resolver.hpp"
 #include "gu_asio.hpp" // gu::conf::use_ssl
+#include "gu_compress.hpp"
 
 using namespace std::rel_ops;
 
@@ -80,8 +81,19 @@ gcomm::GMCast::GMCast(Protonet& net, const gu::URI& uri,
     isolate_      (false),
     proto_map_    (new ProtoMap()),
     relay_set_    (),
+    segment_relay_(0),
     segment_map_  (),
     self_index_   (std::numeric_limits<size_t>::max()),
+    segment_compress_(check_range(
+                          Conf::GMCastSegmentCompress,
+                          param<int>(conf_, uri, Conf::GMCastSegmentCompress,
+                                     Defaults::GMCastSegmentCompress),
+                          0, 10)),
+    compress_set_ (),
+    compress_buf_ (),
+    compress_dg_  (),
+    segment_tx_bytes_(0),
+    segment_tx_saved_(0),
     time_wait_    (param<gu::datetime::Period>(
                        conf_, uri,
                        Conf::GMCastTimeWait, Defaults::GMCastTimeWait)),
@@ -199,6 +211,14 @@ gcomm::GMCast::GMCast(Protonet& net, const gu::URI& uri,
     conf_.set(Conf::GMCastMCastTTL, gu::to_string(mcast_ttl_));
     conf_.set(Conf::GMCastPeerTimeout, gu::to_string(peer_timeout_));
     conf_.set(Conf::GMCastSegment, gu::to_string<int>(segment_));
+    conf_.set(Conf::GMCastSegmentCompress,
+              gu::to_string<int>(segment_compress_));
+
+    if (segment_compress_ > 0 && gu::compress_supported() == false)
+    {
+        log_warn << "compression support not available, "
+                 << Conf::GMCastSegmentCompress << " ignored";
+    }
 }
 
 gcomm::GMCast::~GMCast()
@@ -374,7 +394,12 @@ void gcomm::GMCast::erase_proto(gmcast::ProtoMap::iterator i)
     if (si != relay_set_.end())
     {
         relay_set_.erase(si);
+        if (segment_relay_ == p->socket().get())
+        {
+            segment_relay_ = (relay_set_.empty() ? 0 : *relay_set_.begin());
+        }
     }
+    compress_set_.erase(p->socket().get());
     proto_map_->erase(i);
     delete p;
 }
@@ -902,6 +927,7 @@ void gcomm::GMCast::update_addresses()
     // Build multicast tree
     log_debug << self_string() << " --- mcast tree begin ---";
     segment_map_.clear();
+    compress_set_.clear();
 
     Segment& local_segment(segment_map_[segment_]);
 
@@ -938,6 +964,10 @@ void gcomm::GMCast::update_addresses()
             {
                 Segment& remote_segment(segment_map_[p.remote_segment()]);
                 remote_segment.push_back(p.socket().get());
+                if (p.remote_compress() == true)
+                {
+                    compress_set_.insert(p.socket().get());
+                }
             }
         }
     }
@@ -1150,6 +1180,7 @@ void gcomm::GMCast::check_liveness()
             relaying_ = true;
         }
         relay_set_.clear();
+        segment_relay_ = 0;
         // build set of protos having OK status
         std::set<Proto*> proto_set;
         for (ProtoMap::iterator i(proto_map_->begin()); i != proto_map_->end();
@@ -1174,6 +1205,8 @@ void gcomm::GMCast::check_liveness()
                       << CmpUuidCounts(nonlive_uuids, segment_).count(p);
 
             relay_set_.insert(p->socket().get());
+            // peer reaching most of nonlive peers relays to other segments
+            if (segment_relay_ == 0) segment_relay_ = p->socket().get();
             const LinkMap& lm(p->link_map());
             for (LinkMap::const_iterator lm_i(lm.begin()); lm_i != lm.end();
                  ++lm_i)
@@ -1187,6 +1220,7 @@ void gcomm::GMCast::check_liveness()
     {
         log_info << self_string() << " turning message relay requesting off";
         relay_set_.clear();
+        segment_relay_ = 0;
         relaying_ = false;
     }
 }
@@ -1217,6 +1251,106 @@ void send(gcomm::Socket* s, gcomm::Datagram& dg)
     }
 }
 
+gcomm::Datagram* gcomm::GMCast::compress_datagram(const Datagram& dg)
+{
+    if (segment_compress_ == 0 || compress_set_.empty() == true)
+    {
+        return 0;
+    }
+
+    // gather message into contiguous buffer
+    compress_buf_.clear();
+    size_t off(dg.offset());
+    if (off < dg.header_len())
+    {
+        compress_buf_.insert(compress_buf_.end(),
+                             dg.header() + dg.header_offset() + off,
+                             dg.header() + dg.header_size());
+        off = 0;
+    }
+    else
+    {
+        off -= dg.header_len();
+    }
+    compress_buf_.insert(compress_buf_.end(),
+                         dg.payload().begin() + off, dg.payload().end());
+
+    // compressed payload is prefixed by the original length
+    gu::Buffer buf(4);
+    gu::serialize4(static_cast<uint32_t>(compress_buf_.size()),
+                   &buf[0], buf.size(), 0);
+
+    if (compress_buf_.empty() == true ||
+        gu::compress(&compress_buf_[0], compress_buf_.size(), buf,
+                     segment_compress_) == false)
+    {
+        return 0;
+    }
+
+    compress_dg_ = Datagram(buf);
+    return &compress_dg_;
+}
+
+
+gcomm::Datagram gcomm::GMCast::decompress_datagram(const Datagram& cdg) const
+{
+    gcomm_assert(cdg.header_len() == 0);
+
+    const gu::byte_t* const buf(&cdg.payload()[0] + cdg.offset());
+    size_t const            buflen(cdg.payload().size() - cdg.offset());
+    uint32_t                len;
+    size_t const            off(gu::unserialize4(buf, buflen, 0, len));
+
+    if (len > pnet_.mtu())
+    {
+        gu_throw_error(EMSGSIZE) << "compressed message length " << len
+                                 << " exceeds mtu " << pnet_.mtu();
+    }
+
+    gu::SharedBuffer sb(new gu::Buffer(len));
+    gu::decompress(buf + off, buflen - off, &(*sb)[0], len);
+    return Datagram(sb);
+}
+
+
+void gcomm::GMCast::send_segment(Socket*   s,
+                                 Message&  msg,
+                                 Datagram& dg,
+                                 Datagram* cdg)
+{
+    if (cdg != 0 && compress_set_.find(s) != compress_set_.end())
+    {
+        msg.set_flags(msg.flags() | Message::F_COMPRESSED);
+        gu_trace(push_header(msg, *cdg));
+        send(s, *cdg);
+        segment_tx_bytes_ += cdg->len();
+        gu_trace(pop_header(msg, *cdg));
+        msg.set_flags(msg.flags() & ~Message::F_COMPRESSED);
+        segment_tx_saved_ += static_cast<long long>(dg.len() - dg.offset())
+            - static_cast<long long>(cdg->len());
+    }
+    else
+    {
+        gu_trace(push_header(msg, dg));
+        send(s, dg);
+        segment_tx_bytes_ += dg.len();
+        gu_trace(pop_header(msg, dg));
+    }
+}
+
+
+static bool has_link(const gcomm::gmcast::LinkMap& lm,
+                     const gcomm::UUID&             uuid)
+{
+    for (gcomm::gmcast::LinkMap::const_iterator i(lm.begin()); i != lm.end();
+         ++i)
+    {
+        if (gcomm::gmcast::LinkMap::key(i) == uuid) return true;
+    }
+    return false;
+}
+
+
 void gcomm::GMCast::relay(const Message& msg,
                           const Datagram& dg,
                           const void* exclude_id)
@@ -1227,23 +1361,95 @@ void gcomm::GMCast::relay(const Message& msg,
 
     // reset all relay flags from message to be relayed
     relay_msg.set_flags(relay_msg.flags() &
-                        ~(Message::F_RELAY | Message::F_SEGMENT_RELAY));
-
-    // if F_RELAY is set in received message, relay to all peers except
-    // the originator
+                        ~(Message::F_RELAY | Message::F_SEGMENT_RELAY |
+                          Message::F_COMPRESSED));
+
+    // if F_RELAY is set in received message, relay to all peers in local
+    // segment except the originator. Peers of the originator segment which
+    // the originator has no link to get a copy too. Other segments which
+    // the originator could not reach get one copy via segment gateway
+    // from the relaying peer designated by F_SEGMENT_RELAY, the copy is
+    // relayed further by the receiving peer.
     if (msg.flags() & Message::F_RELAY)
     {
-        gu_trace(push_header(relay_msg, relay_dg));
+        Datagram* const cdg(compress_datagram(relay_dg));
+
+        // F_RELAY comes either from the originator or from a segment
+        // gateway relaying the message to its own segment
+        const LinkMap* sender_links(0);
+        ProtoMap::const_iterator const si(proto_map_->find(exclude_id));
+        if (si != proto_map_->end() &&
+            ProtoMap::value(si)->remote_uuid() == msg.source_uuid())
+        {
+            sender_links = &ProtoMap::value(si)->link_map();
+        }
+
+        // segments where the originator has links of its own have got
+        // the message from it via segment gateway already
+        std::set<uint8_t> sender_segments;
+        if (sender_links != 0)
+        {
+            for (ProtoMap::const_iterator i(proto_map_->begin());
+                 i != proto_map_->end(); ++i)
+            {
+                const Proto* const p(ProtoMap::value(i));
+                if (p->state() == Proto::S_OK &&
+                    has_link(*sender_links, p->remote_uuid()))
+                {
+                    sender_segments.insert(p->remote_segment());
+                }
+            }
+        }
+
+        bool const segment_relay(sender_links != 0 &&
+                                 (msg.flags() & Message::F_SEGMENT_RELAY));
+
         for (SegmentMap::iterator i(segment_map_.begin());
              i != segment_map_.end(); ++i)
         {
             Segment& segment(i->second);
-            for (Segment::iterator j(segment.begin()); j != segment.end(); ++j)
+            if (i->first == segment_)
+            {
+                gu_trace(push_header(relay_msg, relay_dg));
+                for (Segment::iterator j(segment.begin());
+                     j != segment.end(); ++j)
+                {
+                    if ((*j)->id() != exclude_id)
+                    {
+                        send(*j, relay_dg);
+                    }
+                }
+                gu_trace(pop_header(relay_msg, relay_dg));
+            }
+            else if (i->first == msg.segment_id())
             {
-                if ((*j)->id() != exclude_id)
+                if (sender_links == 0) continue;
+
+                gu_trace(push_header(relay_msg, relay_dg));
+                for (Segment::iterator j(segment.begin());
+                     j != segment.end(); ++j)
                 {
-                    send(*j, relay_dg);
+                    ProtoMap::const_iterator const pi
+                        (proto_map_->find((*j)->id()));
+                    if ((*j)->id() != exclude_id &&
+                        pi != proto_map_->end() &&
+                        has_link(*sender_links,
+                                 ProtoMap::value(pi)->remote_uuid()) == false)
+                    {
+                        send(*j, relay_dg);
+                    }
                 }
+                gu_trace(pop_header(relay_msg, relay_dg));
+            }
+            else if (segment_relay == true &&
+                     sender_segments.find(i->first) == sender_segments.end())
+            {
+                Socket* const target(segment_gateway(i->first, segment));
+                relay_msg.set_flags(relay_msg.flags() |
+                                    Message::F_SEGMENT_RELAY);
+                send_segment(target, relay_msg, relay_dg, cdg);
+                relay_msg.set_flags(relay_msg.flags() &
+                                    ~Message::F_SEGMENT_RELAY);
             }
         }
     }
@@ -1371,16 +1577,29 @@ void gcomm::GMCast::handle_up(const void*        id,
                 {
                     return;
                 }
+                Datagram up_dg(dg, dg.offset() + msg.serial_size());
+                if (msg.flags() & Message::F_COMPRESSED)
+                {
+                    try
+                    {
+                        up_dg = decompress_datagram(up_dg);
+                    }
+                    catch (gu::Exception& e)
+                    {
+                        log_warn << "failed to decompress message from "
+                                 << msg.source_uuid() << ": " << e.what();
+                        p->set_state(Proto::S_FAILED);
+                        handle_failed(p);
+                        return;
+                    }
+                }
                 if (msg.flags() &
                     (Message::F_RELAY | Message::F_SEGMENT_RELAY))
                 {
-                    relay(msg,
-                          Datagram(dg, dg.offset() + msg.serial_size()),
-                          id);
+                    relay(msg, up_dg, id);
                 }
                 p->set_tstamp(gu::datetime::Date::now());
-                send_up(Datagram(dg, dg.offset() + msg.serial_size()),
-                        ProtoUpMeta(msg.source_uuid()));
+                send_up(up_dg, ProtoUpMeta(msg.source_uuid()));
                 return;
             }
             else
@@ -1459,14 +1678,28 @@ int gcomm::GMCast::handle_down(Datagram& dg, const ProtoDownMeta& dm)
         for (std::set<Socket*>::iterator ri(relay_set_.begin());
              ri != relay_set_.end(); ++ri)
         {
-            send(*ri, dg);
+            if (*ri != segment_relay_) send(*ri, dg);
         }
         gu_trace(pop_header(msg, dg));
-        msg.set_flags(msg.flags() & ~Message::F_RELAY);
+
+        // F_RELAY | F_SEGMENT_RELAY designates the peer which relays
+        // to other segments, older peers treat it as plain F_RELAY
+        if (segment_relay_ != 0)
+        {
+            msg.set_flags(msg.flags() | Message::F_SEGMENT_RELAY);
+            gu_trace(push_header(msg, dg));
+            send(segment_relay_, dg);
+            gu_trace(pop_header(msg, dg));
+        }
+        msg.set_flags(msg.flags() & ~(Message::F_RELAY |
+                                      Message::F_SEGMENT_RELAY));
     }
 
 
 
+    // compressed copy for other segments
+    Datagram* const cdg(segment_map_.size() > 1 ? compress_datagram(dg) : 0);
+
     for (SegmentMap::iterator si(segment_map_.begin());
          si != segment_map_.end(); ++si)
     {
@@ -1475,15 +1708,13 @@ int gcomm::GMCast::handle_down(Datagram& dg, const ProtoDownMeta& dm)
 
         if (segment_id != segment_)
         {
-            size_t target_idx((self_index_ + segment_id) % segment.size());
+            Socket* const target(segment_gateway(segment_id, segment));
             msg.set_flags(msg.flags() | Message::F_SEGMENT_RELAY);
             // skip peers that are in relay set
             if (relay_set_.empty() == true ||
-                relay_set_.find(segment[target_idx]) == relay_set_.end())
+                relay_set_.find(target) == relay_set_.end())
             {
-                gu_trace(push_header(msg, dg));
-                send(segment[target_idx], dg);
-                gu_trace(pop_header(msg, dg));
+                send_segment(target, msg, dg, cdg);
             }
         }
         else
@@ -1689,6 +1920,15 @@ void gcomm::GMCast::add_or_del_addr(const std::string& val)
 }
 
 
+void gcomm::GMCast::handle_get_status(gu::Status& status) const
+{
+    status.insert("gmcast_segment_tx_bytes",
+                  gu::to_string(segment_tx_bytes_));
+    status.insert("gmcast_segment_tx_bytes_saved",
+                  gu::to_string(segment_tx_saved_));
+}
+
+
 bool gcomm::GMCast::set_param(const std::string& key, const std::string& val)
 {
     try
@@ -1714,6 +1954,13 @@ bool gcomm::GMCast::set_param(const std::string& key, const std::string& val)
             }
             return true;
         }
+        else if (key == Conf::GMCastSegmentCompress)
+        {
+            segment_compress_ = check_range(
+                key, gu::from_string<int>(val), 0, 10);
+            conf_.set(key, gu::to_string<int>(segment_compress_));
+            return true;
+        }
         else if (key == Conf::GMCastIsolate)
         {
             isolate_ = gu::from_string<bool>(val);
@@ -45,6 +45,7 @@ namespace gcomm
         void handle_stable_view(const View& view);
         void handle_evict(const UUID& uuid);
         std::string handle_get_address(const UUID& uuid) const;
+        void handle_get_status(gu::Status& status) const;
         bool set_param(const std::string& key, const std::string& val);
         // Transport interface
         const UUID& uuid() const { return my_uuid_; }
@@ -187,12 +188,24 @@ namespace gcomm
 
         gmcast::ProtoMap*  proto_map_;
         std::set<Socket*>   relay_set_;
+        // member of relay_set_ which relays to segments other than
+        // its own and the originator's
+        Socket*             segment_relay_;
 
         typedef std::vector<Socket*> Segment;
         typedef std::map<uint8_t, Segment> SegmentMap;
         SegmentMap segment_map_;
         // self index in local segment when ordered by UUID
         size_t self_index_;
+        // compression level for messages to other segments, 0 - off
+        int                 segment_compress_;
+        // peers in other segments which accept compressed messages
+        std::set<Socket*>   compress_set_;
+        std::vector<gu::byte_t> compress_buf_;
+        Datagram            compress_dg_;
+        // bytes sent to other segments and bytes saved by compression
+        long long           segment_tx_bytes_;
+        long long           segment_tx_saved_;
         gu::datetime::Period time_wait_;
         gu::datetime::Period check_period_;
         gu::datetime::Period peer_timeout_;
@@ -228,6 +241,23 @@ namespace gcomm
         void check_liveness();
         void relay(const gmcast::Message& msg, const Datagram& dg,
                    const void* exclude_id);
+        // Peer in other segment to send messages to, it will relay
+        // them to the rest of its segment
+        Socket* segment_gateway(uint8_t segment_id, const Segment& segment)
+            const
+        {
+            return segment[(self_index_ + segment_id) % segment.size()];
+        }
+        // Create compressed copy of dg to be sent to other segments.
+        // Returns pointer to the copy, valid until the next call, or
+        // null if compression is disabled or does not pay off.
+        Datagram* compress_datagram(const Datagram& dg);
+        // Restore original datagram from compressed one
+        Datagram decompress_datagram(const Datagram& cdg) const;
+        // Send user message to peer in other segment, compressed copy
+        // of the datagram is used if available and accepted by the peer
+        void send_segment(Socket* s, gmcast::Message& msg, Datagram& dg,
+                          Datagram* cdg);
         // Reconnecting
         void reconnect();
 
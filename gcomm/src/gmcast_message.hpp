@@ -33,7 +33,10 @@ public:
         // and to all other segments except source segment
         F_RELAY                   = 1 << 5,
         // relay message to all peers in the same segment
-        F_SEGMENT_RELAY           = 1 << 6
+        F_SEGMENT_RELAY           = 1 << 6,
+        // user message payload is compressed, in handshake messages
+        // sender is able to receive compressed messages
+        F_COMPRESSED              = 1 << 7
     };
 
     enum Type
@@ -6,6 +6,7 @@
 #include "gmcast.hpp"
 
 #include "gu_uri.hpp"
+#include "gu_compress.hpp"
 
 using std::rel_ops::operator!=;
 
@@ -87,6 +88,10 @@ void gcomm::gmcast::Proto::send_handshake()
     handshake_uuid_ = UUID(0, 0);
     Message hs (version_, Message::T_HANDSHAKE, handshake_uuid_,
                 gmcast_.uuid(), local_segment_);
+    if (gu::compress_supported() == true)
+    {
+        hs.set_flags(hs.flags() | Message::F_COMPRESSED);
+    }
 
     send_msg(hs);
 
@@ -115,6 +120,7 @@ void gcomm::gmcast::Proto::handle_handshake(const Message& hs)
     handshake_uuid_ = hs.handshake_uuid();
     remote_uuid_ = hs.source_uuid();
     remote_segment_ = hs.segment_id();
+    remote_compress_ = (hs.flags() & Message::F_COMPRESSED);
 
     Message hsr (version_, Message::T_HANDSHAKE_RESPONSE,
                  handshake_uuid_,
@@ -122,6 +128,10 @@ void gcomm::gmcast::Proto::handle_handshake(const Message& hs)
                  local_addr_,
                  group_name_,
                  local_segment_);
+    if (gu::compress_supported() == true)
+    {
+        hsr.set_flags(hsr.flags() | Message::F_COMPRESSED);
+    }
     send_msg(hsr);
 
     set_state(S_HANDSHAKE_RESPONSE_SENT);
@@ -148,6 +158,7 @@ void gcomm::gmcast::Proto::handle_handshake_response(const Message& hs)
             }
             remote_uuid_ = hs.source_uuid();
             remote_segment_ = hs.segment_id();
+            remote_compress_ = (hs.flags() & Message::F_COMPRESSED);
             gu::URI remote_uri(tp_->remote_addr());
             remote_addr_ = uri_string(remote_uri.get_scheme(),
                                       remote_uri.get_host(),
@@ -79,6 +79,7 @@ public:
         remote_uuid_      (),
         local_segment_    (local_segment),
         remote_segment_   (0),
+        remote_compress_  (false),
         local_addr_       (local_addr),
         remote_addr_      (remote_addr),
         mcast_addr_       (mcast_addr),
@@ -111,6 +112,8 @@ public:
     const gcomm::UUID& local_uuid() const;
     const gcomm::UUID& remote_uuid() const { return remote_uuid_; }
     uint8_t remote_segment() const { return remote_segment_; }
+    // remote end accepts compressed user messages
+    bool remote_compress() const { return remote_compress_; }
 
     SocketPtr socket() const { return tp_; }
 
@@ -137,6 +140,7 @@ private:
     gcomm::UUID       remote_uuid_;
     uint8_t           local_segment_;
     uint8_t           remote_segment_;
+    bool              remote_compress_;
     std::string       local_addr_;
     std::string       remote_addr_;
     std::string       mcast_addr_;
@@ -40,7 +40,14 @@ int gcomm::PC::handle_down(Datagram& wb, const ProtoDownMeta& dm)
     {
         gu_throw_error(EMSGSIZE);
     }
-    return send_down(wb, dm);
+    int const ret(send_down(wb, dm));
+    if (evs_->aggregate_armed() == true)
+    {
+        // EVS holds the message for aggregation, wake up event loop
+        // to schedule the timer which flushes it
+        pnet().interrupt();
+    }
+    return ret;
 }
 
 
@@ -221,6 +228,11 @@ void gcomm::PC::close(bool force)
 void gcomm::PC::handle_get_status(gu::Status& status) const
 {
     status.insert("gcomm_uuid", uuid().full_str());
+    if (pc_ != 0)
+    {
+        status.insert("pc_state_exch_latency",
+                      pc_->state_exch_latency().to_string());
+    }
 }
 
 gcomm::PC::PC(Protonet& net, const gu::URI& uri) :
@@ -339,12 +339,23 @@ void gcomm::pc::Proto::shift_to(const State s)
                        << to_string(state()) << " -> " << to_string(s);
     }
 
+    if ((state() == S_STATES_EXCH || state() == S_INSTALL) &&
+        (s == S_PRIM || s == S_NON_PRIM))
+    {
+        const double lat(double(gu::datetime::Date::now().get_utc()
+                                - state_exch_start_.get_utc())
+                         /gu::datetime::Sec);
+        state_exch_latency_.insert(lat);
+        log_info << self_id() << " state exchange took " << lat << " s";
+    }
+
     switch (s)
     {
     case S_CLOSED:
         break;
     case S_STATES_EXCH:
         state_msgs_.clear();
+        state_exch_start_ = gu::datetime::Date::now();
         break;
     case S_INSTALL:
         break;
@@ -15,6 +15,8 @@
 #include "defaults.hpp"
 
 #include "gu_uri.hpp"
+#include "gu_datetime.hpp"
+#include "gu_stats.hpp"
 
 #ifndef GCOMM_PC_MAX_VERSION
 #define GCOMM_PC_MAX_VERSION 0
@@ -91,7 +93,9 @@ public:
                                     param<int>(conf, uri, Conf::PcWeight,
                                                Defaults::PcWeight),
                                     0, 0xff)),
-        rst_view_      ()
+        rst_view_      (),
+        state_exch_start_  (gu::datetime::Date::now()),
+        state_exch_latency_()
     {
         set_weight(weight_);
         NodeMap::value(self_i_).set_segment(segment);
@@ -190,6 +194,8 @@ public:
                    rst_view -> id().seq()));
     }
     const View* restored_view() const { return rst_view_; }
+    const gu::Stats& state_exch_latency() const
+    { return state_exch_latency_; }
 private:
     friend std::ostream& operator<<(std::ostream& os, const Proto& p);
     Proto (const Proto&);
@@ -227,6 +233,8 @@ private:
     size_t            mtu_;           // Maximum transmission unit
     int               weight_;        // Node weight in voting
     View*             rst_view_;      // restored PC view
+    gu::datetime::Date state_exch_start_;   // state exchange began
+    gu::Stats          state_exch_latency_; // state exchange durations
 };
 
 
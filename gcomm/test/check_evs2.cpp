@@ -704,6 +704,22 @@ static void send_n(DummyNode* node, const size_t n)
     }
 }
 
+// number of user messages sent by node, requires I_STATISTICS info mask
+static long long sent_user(DummyNode* node)
+{
+    gu::Status status;
+    evs_from_dummy(node)->handle_get_status(status);
+    for (gu::Status::const_iterator i(status.begin()); i != status.end(); ++i)
+    {
+        if (i->first == "evs_sent_user")
+        {
+            return gu::from_string<long long>(i->second);
+        }
+    }
+    fail("evs_sent_user not found in status");
+    return -1;
+}
+
 static void set_cvi(vector<DummyNode*>& nvec, size_t i_begin, size_t i_end,
                     size_t seq)
 {
@@ -930,6 +946,56 @@ START_TEST(test_proto_leave_n)
 }
 END_TEST
 
+// Graceful leaves must be handled without waiting for timers to expire
+// when all remaining members agree on the new view
+START_TEST(test_proto_leave_n_no_timers)
+{
+    gu_conf_self_tstamp_on();
+    log_info << "START (leave_n_no_timers)";
+    init_rand();
+
+    const size_t n_nodes(8);
+    PropagationMatrix prop;
+    vector<DummyNode*> dn;
+
+    for (size_t i = 1; i <= n_nodes; ++i)
+    {
+        gu_trace(dn.push_back(create_dummy_node(i, 0)));
+    }
+
+    for (size_t i = 0; i < n_nodes; ++i)
+    {
+        gu_trace(join_node(&prop, dn[i], i == 0 ? true : false));
+        set_cvi(dn, 0, i, i + 1);
+        gu_trace(prop.propagate_until_cvi(true));
+    }
+
+    uint32_t max_view_seq(get_max_view_seq(dn, 0, n_nodes));
+
+    // Single node leaves, then pairs of nodes leave at the same time
+    size_t n_leave;
+    for (size_t i = 0; i < n_nodes - 1; i += n_leave)
+    {
+        n_leave = (i < 2 || i + 2 >= n_nodes) ? 1 : 2;
+        for (size_t j = i; j < n_nodes; ++j)
+        {
+            gu_trace(send_n(dn[j], 1 + ::rand() % 4));
+        }
+        for (size_t j = i; j < i + n_leave; ++j)
+        {
+            dn[j]->close();
+            dn[j]->set_cvi(V_REG);
+        }
+        set_cvi(dn, i + n_leave, n_nodes - 1, max_view_seq + 1);
+        gu_trace(prop.propagate_until_cvi(false));
+        max_view_seq = get_max_view_seq(dn, i + n_leave, n_nodes);
+    }
+
+    gu_trace(check_trace(dn));
+    for_each(dn.begin(), dn.end(), DeleteObject());
+}
+END_TEST
+
 START_TEST(test_proto_leave_n_w_user_msg)
 {
     gu_conf_self_tstamp_on();
@@ -1415,6 +1481,185 @@ START_TEST(test_aggreg)
 }
 END_TEST
 
+// Runs the same traffic pattern on a fresh group, returns number of user
+// messages sent by all nodes for n_sent messages from the application
+static long long aggreg_wait_run(bool const aggregate_wait, size_t& n_sent)
+{
+    const size_t n_nodes(3);
+    PropagationMatrix prop;
+    vector<DummyNode*> dn;
+
+    for (size_t i = 1; i <= n_nodes; ++i)
+    {
+        gu_trace(dn.push_back(create_dummy_node(i, 0)));
+    }
+
+    for (size_t i = 0; i < n_nodes; ++i)
+    {
+        gu_trace(join_node(&prop, dn[i], i == 0 ? true : false));
+        set_cvi(dn, 0, i, i + 1);
+        gu_trace(prop.propagate_until_cvi(false));
+    }
+
+    long long sent_before(0);
+    for (size_t i = 0; i < n_nodes; ++i)
+    {
+        fail_unless(evs_from_dummy(dn[i])->set_param(
+                        "evs.aggregate_wait",
+                        aggregate_wait ? "PT1S" : "PT0S") == true);
+        fail_unless(evs_from_dummy(dn[i])->set_param(
+                        "evs.info_log_mask", "0x4") == true);
+        sent_before += sent_user(dn[i]);
+    }
+
+    // Messages sent while previous ones are in flight are held in
+    // output queue and must get flushed by the traffic from the group
+    n_sent = 0;
+    for (size_t r = 0; r < 10; ++r)
+    {
+        for (size_t i = 0; i < n_nodes; ++i)
+        {
+            gu_trace(send_n(dn[i], 1 + r % 4));
+            n_sent += 1 + r % 4;
+            gu_trace(prop.propagate_n(1));
+        }
+    }
+
+    gu_trace(prop.propagate_until_empty());
+    gu_trace(check_trace(dn));
+
+    long long sent_after(0);
+    for (size_t i = 0; i < n_nodes; ++i)
+    {
+        sent_after += sent_user(dn[i]);
+    }
+
+    for_each(dn.begin(), dn.end(), DeleteObject());
+
+    return sent_after - sent_before;
+}
+
+START_TEST(test_aggreg_wait)
+{
+    log_info << "START (aggreg_wait)";
+
+    size_t n_sent(0);
+    long long const n_nowait(aggreg_wait_run(false, n_sent));
+    long long const n_wait(aggreg_wait_run(true, n_sent));
+
+    log_info << "aggreg_wait: " << n_sent << " messages sent in "
+             << n_nowait << " user messages without wait, "
+             << n_wait << " with wait";
+
+    // held messages must go out in aggregates
+    fail_unless(n_wait < n_nowait,
+                "%zu messages sent in %lld user messages with wait, "
+                "%lld without", n_sent, n_wait, n_nowait);
+    fail_unless(n_wait < static_cast<long long>(n_sent));
+}
+END_TEST
+
+// Message held for aggregation must be sent by aggregate timer if
+// nothing arrives from the group
+START_TEST(test_aggreg_wait_timer)
+{
+    log_info << "START (aggreg_wait_timer)";
+    const size_t n_nodes(3);
+    PropagationMatrix prop;
+    vector<DummyNode*> dn;
+
+    for (size_t i = 1; i <= n_nodes; ++i)
+    {
+        gu_trace(dn.push_back(create_dummy_node(i, 0)));
+    }
+
+    for (size_t i = 0; i < n_nodes; ++i)
+    {
+        gu_trace(join_node(&prop, dn[i], i == 0 ? true : false));
+        set_cvi(dn, 0, i, i + 1);
+        gu_trace(prop.propagate_until_cvi(false));
+    }
+
+    evs::Proto* proto(evs_from_dummy(dn[0]));
+    fail_unless(proto->set_param("evs.aggregate_wait", "PT0.1S") == true);
+    fail_unless(proto->set_param("evs.info_log_mask", "0x4") == true);
+    long long const sent_before(sent_user(dn[0]));
+
+    // first message goes out immediately, second one is held while
+    // the first one is in flight
+    gu_trace(send_n(dn[0], 2));
+    fail_unless(sent_user(dn[0]) == sent_before + 1);
+    fail_unless(proto->aggregate_armed() == true);
+    fail_unless(proto->aggregate_armed() == false);
+
+    gu_trace(proto->handle_timers());
+    fail_unless(sent_user(dn[0]) == sent_before + 1);
+
+    usleep(150000);
+    gu_trace(proto->handle_timers());
+    fail_unless(sent_user(dn[0]) == sent_before + 2,
+                "held message was not sent by timer: %lld",
+                sent_user(dn[0]) - sent_before);
+
+    gu_trace(prop.propagate_until_empty());
+    gu_trace(check_trace(dn));
+
+    for_each(dn.begin(), dn.end(), DeleteObject());
+}
+END_TEST
+
+// Number of rounds to run in test_proto_user_msg_rate. By default only
+// a few rounds are run to verify delivery, set EVS_USER_MSG_RATE_ROUNDS
+// env variable (e.g. 1000) to run it as a throughput benchmark.
+static size_t user_msg_rate_rounds()
+{
+    const char* const rounds(::getenv("EVS_USER_MSG_RATE_ROUNDS"));
+    return (rounds != 0 ? gu::from_string<size_t>(rounds) : 10);
+}
+
+// Measures user message throughput through EVS input map and delivery
+START_TEST(test_proto_user_msg_rate)
+{
+    log_info << "START (user_msg_rate)";
+    const size_t n_nodes(4);
+    const size_t n_rounds(user_msg_rate_rounds());
+    const size_t n_msgs(10);
+    PropagationMatrix prop;
+    vector<DummyNode*> dn;
+
+    for (size_t i = 1; i <= n_nodes; ++i)
+    {
+        gu_trace(dn.push_back(create_dummy_node(i, 0)));
+    }
+
+    for (size_t i = 0; i < n_nodes; ++i)
+    {
+        gu_trace(join_node(&prop, dn[i], i == 0 ? true : false));
+        set_cvi(dn, 0, i, i + 1);
+        gu_trace(prop.propagate_until_cvi(false));
+    }
+
+    Date start(Date::now());
+    for (size_t r = 0; r < n_rounds; ++r)
+    {
+        for (size_t i = 0; i < n_nodes; ++i)
+        {
+            gu_trace(send_n(dn[i], n_msgs));
+        }
+        gu_trace(prop.propagate_until_empty());
+    }
+    Date stop(Date::now());
+
+    gu_trace(check_trace(dn));
+
+    const double div(double(stop.get_utc() - start.get_utc())/gu::datetime::Sec);
+    const double delivered(double(n_rounds*n_msgs*n_nodes*n_nodes));
+    log_info << "evs user msg delivery rate " << delivered/div;
+
+    for_each(dn.begin(), dn.end(), DeleteObject());
+}
+END_TEST
+
 START_TEST(test_trac_538)
 {
     gu_conf_self_tstamp_on();
@@ -2148,6 +2393,11 @@ Suite* evs2_suite()
             tcase_set_timeout(tc, 20);
             suite_add_tcase(s, tc);
 
+            tc = tcase_create("test_proto_leave_n_no_timers");
+            tcase_add_test(tc, test_proto_leave_n_no_timers);
+            tcase_set_timeout(tc, 20);
+            suite_add_tcase(s, tc);
+
             tc = tcase_create("test_proto_leave_n_w_user_msg");
             tcase_add_test(tc, test_proto_leave_n_w_user_msg);
             tcase_set_timeout(tc, 20);
@@ -2198,6 +2448,20 @@ Suite* evs2_suite()
             tc = tcase_create("test_aggreg");
             tcase_add_test(tc, test_aggreg);
             suite_add_tcase(s, tc);
+
+            tc = tcase_create("test_aggreg_wait");
+            tcase_add_test(tc, test_aggreg_wait);
+            suite_add_tcase(s, tc);
+
+            tc = tcase_create("test_aggreg_wait_timer");
+            tcase_add_test(tc, test_aggreg_wait_timer);
+            suite_add_tcase(s, tc);
+
+            tc = tcase_create("test_proto_user_msg_rate");
+            tcase_add_test(tc, test_proto_user_msg_rate);
+            tcase_set_timeout(tc, ::getenv("EVS_USER_MSG_RATE_ROUNDS") ?
+                              600 : 30);
+            suite_add_tcase(s, tc);
         }
 
         if (run_all_evs_tests() == true)
@@ -10,6 +10,7 @@
 #include "gmcast_message.hpp"
 
 #include "gu_asio.hpp" // gu::ssl_register_params()
+#include "gu_compress.hpp"
 
 using namespace std;
 using namespace gcomm;
@@ -65,7 +66,7 @@ START_TEST(test_gmcast_multicast)
 END_TEST
 
 
-START_TEST(test_gmcast_w_user_messages)
+static void gmcast_w_user_messages(int io_threads)
 {
     class User : public Toplay
     {
@@ -178,6 +179,7 @@ START_TEST(test_gmcast_w_user_messages)
     gu::Config conf;
     gu::ssl_register_params(conf);
     gcomm::Conf::register_params(conf);
+    conf.set(gcomm::Conf::ProtonetIoThreads, io_threads);
     mark_point();
     auto_ptr<Protonet> pnet(Protonet::create(conf));
     mark_point();
@@ -271,6 +273,17 @@ START_TEST(test_gmcast_w_user_messages)
     pnet->event_loop(0);
 
 }
+
+START_TEST(test_gmcast_w_user_messages)
+{
+    gmcast_w_user_messages(0);
+}
+END_TEST
+
+START_TEST(test_gmcast_w_user_messages_io_threads)
+{
+    gmcast_w_user_messages(2);
+}
 END_TEST
 
 
@@ -372,6 +385,190 @@ START_TEST(test_gmcast_forget)
 END_TEST
 
 
+// Counts received user messages, verifies message content
+class SegmentUser : public Toplay
+{
+public:
+    SegmentUser(Protonet& pnet, const std::string& uri)
+        :
+        Toplay(pnet.conf()),
+        tp_(Transport::create(pnet, uri)),
+        pstack_(),
+        recvd_(0)
+    {
+        pstack_.push_proto(tp_);
+        pstack_.push_proto(this);
+    }
+
+    ~SegmentUser()
+    {
+        pstack_.pop_proto(this);
+        pstack_.pop_proto(tp_);
+        delete tp_;
+    }
+
+    void send()
+    {
+        byte_t buf[1024];
+        for (size_t i(0); i < sizeof(buf); ++i) buf[i] = i % 8;
+        Datagram dg(Buffer(buf, buf + sizeof(buf)));
+        send_down(dg, ProtoDownMeta());
+    }
+
+    void handle_up(const void* cid, const Datagram& rb,
+                   const ProtoUpMeta& um)
+    {
+        fail_unless(rb.len() - rb.offset() == 1024);
+        for (size_t i(0); i < 1024; ++i)
+        {
+            fail_unless(rb.payload()[rb.offset() + i] == i % 8);
+        }
+        ++recvd_;
+    }
+
+    Transport* tp() { return tp_; }
+    Protostack& pstack() { return pstack_; }
+    size_t recvd() const { return recvd_; }
+
+private:
+    SegmentUser(const SegmentUser&);
+    void operator=(const SegmentUser&);
+
+    Transport* tp_;
+    Protostack pstack_;
+    size_t     recvd_;
+};
+
+START_TEST(test_gmcast_segment_compress)
+{
+    log_info << "START test_gmcast_segment_compress";
+    gu::Config conf;
+    gu::ssl_register_params(conf);
+    gcomm::Conf::register_params(conf);
+    auto_ptr<Protonet> pnet(Protonet::create(conf));
+
+    std::string const opts("gmcast.group=test&gmcast.segment_compress=6"
+                           "&gmcast.listen_addr=tcp://127.0.0.1:0");
+    SegmentUser u1(*pnet, "gmcast://?gmcast.segment=0&" + opts);
+    pnet->insert(&u1.pstack());
+    u1.tp()->connect();
+
+    std::string const peer(u1.tp()->listen_addr().erase(0, strlen("tcp://")));
+    SegmentUser u2(*pnet, "gmcast://" + peer + "?gmcast.segment=1&" + opts);
+    SegmentUser u3(*pnet, "gmcast://" + peer + "?gmcast.segment=1&" + opts);
+    pnet->insert(&u2.pstack());
+    pnet->insert(&u3.pstack());
+    u2.tp()->connect();
+    u3.tp()->connect();
+
+    pnet->event_loop(Sec);
+
+    for (size_t i(0); i < 10; ++i)
+    {
+        u1.send();
+        pnet->event_loop(Sec/10);
+    }
+
+    // u1 sends one copy to segment 1, gateway relays it to the other
+    fail_unless(u2.recvd() == 10, "u2 recvd %zu", u2.recvd());
+    fail_unless(u3.recvd() == 10, "u3 recvd %zu", u3.recvd());
+
+    gu::Status status;
+    u1.tp()->get_status(status);
+    long long saved(0);
+    for (gu::Status::const_iterator i(status.begin()); i != status.end(); ++i)
+    {
+        if (i->first == "gmcast_segment_tx_bytes_saved")
+        {
+            saved = gu::from_string<long long>(i->second);
+        }
+    }
+    if (gu::compress_supported() == true)
+    {
+        fail_unless(saved > 0, "saved %lld", saved);
+    }
+    else
+    {
+        fail_unless(saved == 0, "saved %lld", saved);
+    }
+
+    pnet->erase(&u3.pstack());
+    pnet->erase(&u2.pstack());
+    pnet->erase(&u1.pstack());
+    u1.tp()->close();
+    u2.tp()->close();
+    u3.tp()->close();
+    pnet->event_loop(0);
+}
+END_TEST
+
+
+START_TEST(test_gmcast_segment_relay)
+{
+    log_info << "START test_gmcast_segment_relay";
+    gu::Config conf;
+    gu::ssl_register_params(conf);
+    gcomm::Conf::register_params(conf);
+    auto_ptr<Protonet> pnet(Protonet::create(conf));
+
+    std::string const opts("gmcast.group=test"
+                           "&gmcast.listen_addr=tcp://127.0.0.1:0");
+    SegmentUser u1(*pnet, "gmcast://?gmcast.segment=0&" + opts);
+    pnet->insert(&u1.pstack());
+    u1.tp()->connect();
+
+    std::string const peer(u1.tp()->listen_addr().erase(0, strlen("tcp://")));
+    SegmentUser u2(*pnet, "gmcast://" + peer + "?gmcast.segment=0&" + opts);
+    SegmentUser u3(*pnet, "gmcast://" + peer + "?gmcast.segment=0&" + opts);
+    SegmentUser u4(*pnet, "gmcast://" + peer + "?gmcast.segment=1&" + opts);
+    SegmentUser u5(*pnet, "gmcast://" + peer + "?gmcast.segment=1&" + opts);
+    pnet->insert(&u2.pstack());
+    pnet->insert(&u3.pstack());
+    pnet->insert(&u4.pstack());
+    pnet->insert(&u5.pstack());
+    u2.tp()->connect();
+    u3.tp()->connect();
+    u4.tp()->connect();
+    u5.tp()->connect();
+
+    pnet->event_loop(Sec);
+
+    // peer which u1 cannot connect to makes all other peers its relay set
+    fail_unless(u1.tp()->set_param("gmcast.peer_addr",
+                                   "add:tcp://127.0.0.1:1") == true);
+    pnet->event_loop(Sec);
+
+    size_t const n(10);
+    for (size_t i(0); i < n; ++i)
+    {
+        u1.send();
+        pnet->event_loop(Sec/10);
+    }
+
+    // u1 sends the message to every peer with F_RELAY. u2 and u3 relay
+    // it to each other, u4 and u5 to each other. Neither segment gets
+    // copies from relaying peers in the other one, u1 has reached all
+    // peers already.
+    fail_unless(u2.recvd() == 2*n, "u2 recvd %zu", u2.recvd());
+    fail_unless(u3.recvd() == 2*n, "u3 recvd %zu", u3.recvd());
+    fail_unless(u4.recvd() == 2*n, "u4 recvd %zu", u4.recvd());
+    fail_unless(u5.recvd() == 2*n, "u5 recvd %zu", u5.recvd());
+
+    pnet->erase(&u5.pstack());
+    pnet->erase(&u4.pstack());
+    pnet->erase(&u3.pstack());
+    pnet->erase(&u2.pstack());
+    pnet->erase(&u1.pstack());
+    u1.tp()->close();
+    u2.tp()->close();
+    u3.tp()->close();
+    u4.tp()->close();
+    u5.tp()->close();
+    pnet->event_loop(0);
+}
+END_TEST
+
+
 // not run by default, hard coded port
 START_TEST(test_trac_380)
 {
@@ -456,11 +653,26 @@ Suite* gmcast_suite()
         tcase_set_timeout(tc, 30);
         suite_add_tcase(s, tc);
 
+        tc = tcase_create("test_gmcast_w_user_messages_io_threads");
+        tcase_add_test(tc, test_gmcast_w_user_messages_io_threads);
+        tcase_set_timeout(tc, 30);
+        suite_add_tcase(s, tc);
+
         // not run by default, hard coded port
         tc = tcase_create("test_gmcast_auto_addr");
         tcase_add_test(tc, test_gmcast_auto_addr);
         suite_add_tcase(s, tc);
 
+        tc = tcase_create("test_gmcast_segment_compress");
+        tcase_add_test(tc, test_gmcast_segment_compress);
+        tcase_set_timeout(tc, 20);
+        suite_add_tcase(s, tc);
+
+        tc = tcase_create("test_gmcast_segment_relay");
+        tcase_add_test(tc, test_gmcast_segment_relay);
+        tcase_set_timeout(tc, 20);
+        suite_add_tcase(s, tc);
+
         tc = tcase_create("test_gmcast_forget");
         tcase_add_test(tc, test_gmcast_forget);
         tcase_set_timeout(tc, 20);
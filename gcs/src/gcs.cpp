@@ -14,9 +14,12 @@
 #include <math.h>
 #include <errno.h>
 #include <assert.h>
+#include <new>
 
 #include <galerautils.h>
 #include "gu_debug_sync.hpp"
+#include "gu_config.hpp"
+#include "gu_thread.hpp"
 
 #include "gcs_priv.hpp"
 #include "gcs_params.hpp"
@@ -189,15 +192,112 @@ struct gcs_repl_act
 {
     const struct gu_buf* act_in;
     struct gcs_action*   action;
+    const void*          orig_buf;
+    gcs_repl_cb_t        cb;     // NULL for gcs_replv() waiting on wait_cond
+    void*                cb_ctx;
     gu_mutex_t           wait_mutex;
     gu_cond_t            wait_cond;
-    gcs_repl_act(const struct gu_buf* a_act_in, struct gcs_action* a_action)
+    gcs_repl_act(const struct gu_buf* a_act_in, struct gcs_action* a_action,
+                 gcs_repl_cb_t a_cb = NULL, void* a_cb_ctx = NULL)
       :
-        act_in(a_act_in),
-        action(a_action)
+        act_in  (a_act_in),
+        action  (a_action),
+        orig_buf(a_action->buf),
+        cb      (a_cb),
+        cb_ctx  (a_cb_ctx)
     { }
 };
 
+/*!
+ * Looks up local action in repl_q. Actions are normally delivered in the order
+ * they were sent, but interleaved ones may complete out of order.
+ *
+ * @return pointer to the head of repl_q where the action was moved to
+ *         (repl_q is locked) or NULL if not found
+ */
+static struct gcs_repl_act**
+_repl_q_find (gcs_fifo_lite_t* const repl_q, const struct gu_buf* const act_in)
+{
+    struct gcs_repl_act** act_ptr =
+        (struct gcs_repl_act**)gcs_fifo_lite_get_head (repl_q);
+
+    if (gu_likely(NULL == act_ptr || (*act_ptr)->act_in == act_in))
+        return act_ptr;
+
+    for (long n = 1; (act_ptr = (struct gcs_repl_act**)
+                      gcs_fifo_lite_get_item (repl_q, n)); n++) {
+        if ((*act_ptr)->act_in == act_in) {
+            gcs_fifo_lite_raise (repl_q, n);
+            return (struct gcs_repl_act**)gcs_fifo_lite_get_item (repl_q, 0);
+        }
+    }
+
+    gcs_fifo_lite_release (repl_q);
+    return NULL;
+}
+
+/*!
+ * Checks the outcome of local action delivery and frees the buffer of
+ * an action which has not been replicated.
+ *
+ * @return ret if the action was replicated, negative error code otherwise
+ */
+static long
+_repl_act_result (gcs_conn_t*          const conn,
+                  struct gcs_repl_act* const repl_act,
+                  long                       ret)
+{
+    struct gcs_action* const act(repl_act->action);
+
+    /* assert (act->buf != 0); */
+    if (act->buf == 0 && gcs_gcache_store (conn->gcache))
+    {
+        /* Recv thread purged repl_q before action was delivered */
+        return -ENOTCONN;
+    }
+
+    if (act->seqno_g < 0) {
+        assert (GCS_SEQNO_ILL    == act->seqno_l ||
+                GCS_ACT_TORDERED != act->type);
+
+        if (act->seqno_g == GCS_SEQNO_ILL) {
+            /* action was not replicated for some reason */
+            assert (repl_act->orig_buf == act->buf);
+            ret = -EINTR;
+        }
+        else {
+            /* core provided an error code in global seqno */
+            assert (repl_act->orig_buf != act->buf);
+            ret = act->seqno_g;
+            act->seqno_g = GCS_SEQNO_ILL;
+        }
+
+        if (repl_act->orig_buf != act->buf) // action was allocated in gcache
+        {
+            gu_debug("Freeing gcache buffer %p after receiving %d",
+                     act->buf, ret);
+            gcs_gcache_free (conn->gcache, act->buf);
+            act->buf = repl_act->orig_buf;
+        }
+    }
+
+    return ret;
+}
+
+/*! Context of gcs_sm_yield() call from gcs_core_send_interleaved() */
+struct gcs_send_yield
+{
+    gcs_sm_t*  sm;
+    gu_cond_t* cond;
+};
+
+static long
+_send_yield (void* const ctx)
+{
+    struct gcs_send_yield* const y(static_cast<struct gcs_send_yield*>(ctx));
+    return gcs_sm_yield (y->sm, y->cond);
+}
+
 /*! Releases resources associated with parameters */
 static void
 _cleanup_params (gcs_conn_t* conn)
@@ -1211,6 +1311,14 @@ _close(gcs_conn_t* conn, bool join_recv_thread)
             struct gcs_repl_act* act = *act_ptr;
             gcs_fifo_lite_pop_head (conn->repl_q);
 
+            if (act->cb)
+            {
+                /* nobody waits for asynchronous ones, complete them here */
+                act->cb (act->cb_ctx, -ENOTCONN, act->action);
+                delete act;
+                continue;
+            }
+
             /* This will wake up repl threads in repl_q -
              * they'll quit on their own,
              * they don't depend on the conn object after waking */
@@ -1230,6 +1338,23 @@ _close(gcs_conn_t* conn, bool join_recv_thread)
     return ret;
 }
 
+/* pins calling thread to the CPUs configured for gcs_recv role, if any */
+static void
+_set_recv_thread_affinity (gcs_conn_t* conn)
+{
+    try
+    {
+        gu::ThreadAffinity const ta(
+            gu::thread_affinity(*reinterpret_cast<gu::Config*>(conn->config),
+                                "gcs_recv"));
+        gu::thread_set_affinity(pthread_self(), ta);
+    }
+    catch (std::exception& e)
+    {
+        gu_warn ("Failed to set recv_thread() CPU affinity: %s", e.what());
+    }
+}
+
 /*
  * gcs_recv_thread() receives whatever actions arrive from group,
  * and performs necessary actions based on action type.
@@ -1245,6 +1370,8 @@ static void *gcs_recv_thread (void *arg)
                        NULL, NULL, NULL);
 #endif /* HAVE_PSI_INTERFACE */
 
+    _set_recv_thread_affinity (conn);
+
     ssize_t     ret  = -ECONNABORTED;
 
     // To avoid race between gcs_open() and the following state check in while()
@@ -1309,13 +1436,8 @@ static void *gcs_recv_thread (void *arg)
             this_act_id = gu_atomic_fetch_and_add(&conn->local_act_id, 1);
         }
 
-        if (NULL != rcvd.local                                          &&
-            (repl_act_ptr = (struct gcs_repl_act**)
-             gcs_fifo_lite_get_head (conn->repl_q))                     &&
-            (gu_likely ((*repl_act_ptr)->act_in == rcvd.local)  ||
-             /* at this point repl_q is locked and we need to unlock it and
-              * return false to fall to the 'else' branch; unlikely case */
-             (gcs_fifo_lite_release (conn->repl_q), false)))
+        if (NULL != rcvd.local &&
+            (repl_act_ptr = _repl_q_find (conn->repl_q, rcvd.local)))
         {
             /* local action from repl_q */
             struct gcs_repl_act* repl_act = *repl_act_ptr;
@@ -1329,9 +1451,19 @@ static void *gcs_recv_thread (void *arg)
             repl_act->action->seqno_g = rcvd.id;
             repl_act->action->seqno_l = this_act_id;
 
-            gu_mutex_lock   (&repl_act->wait_mutex);
-            gu_cond_signal  (&repl_act->wait_cond);
-            gu_mutex_unlock (&repl_act->wait_mutex);
+            if (repl_act->cb)
+            {
+                long const res(_repl_act_result (conn, repl_act,
+                                                 repl_act->action->size));
+                repl_act->cb (repl_act->cb_ctx, res, repl_act->action);
+                delete repl_act;
+            }
+            else
+            {
+                gu_mutex_lock   (&repl_act->wait_mutex);
+                gu_cond_signal  (&repl_act->wait_cond);
+                gu_mutex_unlock (&repl_act->wait_mutex);
+            }
         }
         else if (gu_likely(this_act_id >= 0))
         {
@@ -1586,9 +1718,13 @@ long gcs_sendv (gcs_conn_t*          const conn,
 
     if (!(ret = gcs_sm_enter (conn->sm, &tmp_cond, scheduled, true)))
     {
+        struct gcs_send_yield yield = { conn->sm, &tmp_cond };
+
         while ((GCS_CONN_OPEN >= conn->state) &&
-               (ret = gcs_core_send (conn->core, act_bufs,
-                                     act_size, act_type)) == -ERESTART);
+               (ret = gcs_core_send_interleaved (conn->core, act_bufs,
+                                                 act_size, act_type,
+                                                 _send_yield, &yield))
+               == -ERESTART);
         gcs_sm_leave (conn->sm);
         gu_cond_destroy (&tmp_cond);
     }
@@ -1611,6 +1747,81 @@ gcs_seqno_t gcs_caused(gcs_conn_t* conn)
     return gcs_core_caused(conn->core);
 }
 
+/*!
+ * Puts action in repl_q and sends it, must be called from within send monitor.
+ *
+ * If sending fails, the action is taken back off repl_q, unless gcs_close()
+ * has already purged the queue: then it is gcs_close() who completes the
+ * action, so the caller must not touch it.
+ *
+ * @param queued set to true if completion of the action will be (or has been)
+ *               reported by the recv thread or gcs_close(), false if the
+ *               action is not in repl_q and stays with the caller
+ * @return action size or negative error code
+ */
+static long
+_repl_send (gcs_conn_t*            const conn,
+            struct gcs_repl_act*   const repl_act,
+            struct gcs_send_yield* const yield,
+            bool&                        queued)
+{
+    const struct gu_buf* const act_in(repl_act->act_in);
+    struct gcs_action*   const act   (repl_act->action);
+    /* action may be completed and released as soon as it is sent */
+    ssize_t              const act_size(act->size);
+    gcs_act_type_t       const act_type(act->type);
+    struct gcs_repl_act**      act_ptr;
+    long                       ret;
+
+    queued = false;
+
+    // some hack here to achieve one if() instead of two:
+    // ret = -EAGAIN part is a workaround for #569
+    // if (conn->state >= GCS_CONN_CLOSE) or (act_ptr == NULL)
+    // ret will be -ENOTCONN
+    if ((ret = -EAGAIN,
+         conn->upper_limit >= conn->queue_len ||
+         act_type          != GCS_ACT_TORDERED)         &&
+        (ret = -ENOTCONN, GCS_CONN_OPEN >= conn->state) &&
+        (act_ptr = (struct gcs_repl_act**)gcs_fifo_lite_get_tail (conn->repl_q)))
+    {
+        *act_ptr = repl_act;
+        gcs_fifo_lite_push_tail (conn->repl_q);
+        queued = true;
+
+        // Keep on trying until something else comes out
+        while ((ret = gcs_core_send_interleaved (
+                    conn->core, act_in, act_size, act_type,
+                    _send_yield, yield)) == -ERESTART) {}
+
+        if (ret < 0) {
+            /* remove item from the queue, it will never be delivered */
+            gu_warn ("Send action {%zd, %s} returned %d (%s)",
+                     act_size, gcs_act_type_to_str(act_type),
+                     ret, strerror(-ret));
+
+            /* whoever pops it from repl_q (under repl_q lock) owns it */
+            if (_repl_q_find (conn->repl_q, act_in)) {
+                gcs_fifo_lite_pop_head (conn->repl_q);
+                queued = false;
+            }
+            else {
+                /* gcs_close() purged repl_q and completes the action */
+                gu_debug ("Unsent action {%zd, %s} was purged from repl_q",
+                          act_size, gcs_act_type_to_str(act_type));
+                ret = -ENOTCONN;
+            }
+        }
+        else {
+            assert (ret == act_size);
+        }
+    }
+
+    assert(ret);
+
+    return ret;
+}
+
 /* Puts action in the send queue and returns after it is replicated */
 long gcs_replv (gcs_conn_t*          const conn,      //!<in
                 const struct gu_buf* const act_in,    //!<in
@@ -1633,6 +1844,12 @@ long gcs_replv (gcs_conn_t*          const conn,      //!<in
     gu_mutex_init (&repl_act.wait_mutex, NULL);
     gu_cond_init  (&repl_act.wait_cond,  NULL);
 
+    /* wait_cond can be signaled by gcs_close() once the action is in repl_q,
+     * so it can't be used to wait in send monitor after that */
+    gu_cond_t yield_cond;
+    gu_cond_init (&yield_cond, NULL);
+    struct gcs_send_yield yield = { conn->sm, &yield_cond };
+
     /* Send action and wait for signal from recv_thread
      * we need to lock a mutex before we can go wait for signal */
     if (!(ret = gu_mutex_lock (&repl_act.wait_mutex)))
@@ -1643,98 +1860,25 @@ long gcs_replv (gcs_conn_t*          const conn,      //!<in
         // 2. avoids race with gcs_close() and gcs_destroy()
         if (!(ret = gcs_sm_enter (conn->sm, &repl_act.wait_cond, scheduled, true)))
         {
-            struct gcs_repl_act** act_ptr;
-
-//#ifndef NDEBUG
-            const void* const orig_buf = act->buf;
-//#endif
-
-            // some hack here to achieve one if() instead of two:
-            // ret = -EAGAIN part is a workaround for #569
-            // if (conn->state >= GCS_CONN_CLOSE) or (act_ptr == NULL)
-            // ret will be -ENOTCONN
-            if ((ret = -EAGAIN,
-                 conn->upper_limit >= conn->queue_len ||
-                 act->type         != GCS_ACT_TORDERED)         &&
-                (ret = -ENOTCONN, GCS_CONN_OPEN >= conn->state) &&
-                (act_ptr = (struct gcs_repl_act**)gcs_fifo_lite_get_tail (conn->repl_q)))
-            {
-                *act_ptr = &repl_act;
-                gcs_fifo_lite_push_tail (conn->repl_q);
-
-                // Keep on trying until something else comes out
-                while ((ret = gcs_core_send (conn->core, act_in, act->size,
-                                             act->type)) == -ERESTART) {}
-
-                if (ret < 0) {
-                    /* remove item from the queue, it will never be delivered */
-                    gu_warn ("Send action {%p, %zd, %s} returned %d (%s)",
-                             act->buf, act->size,gcs_act_type_to_str(act->type),
-                             ret, strerror(-ret));
-
-                    if (!gcs_fifo_lite_remove (conn->repl_q)) {
-                        gu_fatal ("Failed to remove unsent item from repl_q");
-                        assert(0);
-                        ret = -ENOTRECOVERABLE;
-                    }
-                }
-                else {
-                    assert (ret == (ssize_t)act->size);
-                }
-            }
+            bool queued;
 
-            gcs_sm_leave (conn->sm);
+            ret = _repl_send (conn, &repl_act, &yield, queued);
 
-            assert(ret);
+            gcs_sm_leave (conn->sm);
 
-            /* now we can go waiting for action delivery */
-            if (ret >= 0) {
+            /* now we can go waiting for action delivery, or for gcs_close()
+             * to release repl_act if it purged repl_q before we could */
+            if (queued) {
                 gu_cond_wait (&repl_act.wait_cond, &repl_act.wait_mutex);
-#ifndef GCS_FOR_GARB
-                /* assert (act->buf != 0); */
-                if (act->buf == 0)
-                {
-                    /* Recv thread purged repl_q before action was delivered */
-                    ret = -ENOTCONN;
-                    goto out;
-                }
-#else
-                assert (act->buf == 0);
-#endif /* GCS_FOR_GARB */
-
-                if (act->seqno_g < 0) {
-                    assert (GCS_SEQNO_ILL    == act->seqno_l ||
-                            GCS_ACT_TORDERED != act->type);
-
-                    if (act->seqno_g == GCS_SEQNO_ILL) {
-                        /* action was not replicated for some reason */
-                        assert (orig_buf == act->buf);
-                        ret = -EINTR;
-                    }
-                    else {
-                        /* core provided an error code in global seqno */
-                        assert (orig_buf != act->buf);
-                        ret = act->seqno_g;
-                        act->seqno_g = GCS_SEQNO_ILL;
-                    }
-
-                    if (orig_buf != act->buf) // action was allocated in gcache
-                    {
-                        gu_debug("Freeing gcache buffer %p after receiving %d",
-                                 act->buf, ret);
-                        gcs_gcache_free (conn->gcache, act->buf);
-                        act->buf = orig_buf;
-                    }
-                }
+                if (ret >= 0) ret = _repl_act_result (conn, &repl_act, ret);
             }
         }
-#ifndef GCS_FOR_GARB
-    out:
-#endif /* GCS_FOR_GARB */
+
         gu_mutex_unlock  (&repl_act.wait_mutex);
     }
     gu_mutex_destroy (&repl_act.wait_mutex);
     gu_cond_destroy  (&repl_act.wait_cond);
+    gu_cond_destroy  (&yield_cond);
 
 #ifdef GCS_DEBUG_GCS
 //    gu_debug ("\nact_size = %u\nact_type = %u\n"
@@ -1744,6 +1888,61 @@ long gcs_replv (gcs_conn_t*          const conn,      //!<in
     return ret;
 }
 
+/* Puts action in the send queue and returns, completion is reported to cb */
+long gcs_replv_async (gcs_conn_t*          const conn,      //!<in
+                      const struct gu_buf* const act_in,    //!<in
+                      struct gcs_action*   const act,       //!<inout
+                      bool                 const scheduled, //!<in
+                      gcs_repl_cb_t        const cb,        //!<in
+                      void*                const cb_ctx)    //!<in
+{
+    if (gu_unlikely((size_t)act->size > GCS_MAX_ACT_SIZE)) return -EMSGSIZE;
+
+    assert (act);
+    assert (act->size > 0);
+    assert (cb);
+
+    act->seqno_l = GCS_SEQNO_ILL;
+    act->seqno_g = GCS_SEQNO_ILL;
+
+    /* outlives the call: freed by whoever takes it off repl_q */
+    struct gcs_repl_act* const repl_act
+        (new (std::nothrow) gcs_repl_act(act_in, act, cb, cb_ctx));
+
+    if (gu_unlikely(NULL == repl_act)) return -ENOMEM;
+
+    /* act may be released by the callback as soon as it is sent */
+    long const act_size(act->size);
+
+    gu_cond_t wait_cond;
+    gu_cond_init (&wait_cond, NULL);
+    struct gcs_send_yield yield = { conn->sm, &wait_cond };
+
+    long ret;
+    bool queued(false);
+
+    if (!(ret = gcs_sm_enter (conn->sm, &wait_cond, scheduled, true)))
+    {
+        /* repl_act may be completed and gone as soon as it is sent */
+        ret = _repl_send (conn, repl_act, &yield, queued);
+
+        gcs_sm_leave (conn->sm);
+    }
+
+    gu_cond_destroy (&wait_cond);
+
+    if (!queued)
+    {
+        assert (ret < 0);
+        delete repl_act;
+        return ret;
+    }
+
+    /* the callback is called exactly once, possibly already with an error
+     * if gcs_close() purged repl_q while the action was being sent */
+    return act_size;
+}
+
 long gcs_request_state_transfer (gcs_conn_t  *conn,
                                  int          version,
                                  const void  *req,
@@ -1813,12 +2012,13 @@ long gcs_request_state_transfer (gcs_conn_t  *conn,
 
         if (ret > 0) {
             assert (action.buf != rst);
-#ifndef GCS_FOR_GARB
-            assert (action.buf != NULL);
-            gcs_gcache_free (conn->gcache, action.buf);
-#else
-            assert (action.buf == NULL);
-#endif
+            if (gcs_gcache_store (conn->gcache)) {
+                assert (action.buf != NULL);
+                gcs_gcache_free (conn->gcache, action.buf);
+            }
+            else {
+                assert (action.buf == NULL);
+            }
             assert (ret == (ssize_t)rst_size);
             assert (action.seqno_g >= 0);
             assert (action.seqno_l >  0);
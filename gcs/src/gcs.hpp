@@ -218,6 +218,40 @@ extern long gcs_replv (gcs_conn_t*          conn,
                        struct gcs_action*   action,
                        bool                 scheduled);
 
+/*! @brief Completion callback of gcs_replv_async().
+ * Called once the action is delivered from the group, with action filled
+ * in like gcs_replv() would do, or fails to be. It is called from the GCS
+ * receiving thread (or gcs_close()), so it must not block.
+ *
+ * @param ctx    context passed to gcs_replv_async()
+ * @param ret    what gcs_replv() would return
+ * @param action action struct passed to gcs_replv_async()
+ */
+typedef void (*gcs_repl_cb_t) (void* ctx, long ret, struct gcs_action* action);
+
+/*! @brief Replicates a vector of buffers as a single action asynchronously.
+ * Same as gcs_replv() but returns as soon as the action is sent. Completion
+ * is reported through the callback, which lets the caller keep many actions
+ * in flight without blocking a thread per action. Action buffers and struct
+ * must remain valid until then.
+ *
+ * Completion means that the action was ordered (or failed to be), it says
+ * nothing about what the application does with it after that.
+ *
+ * @param cb     completion callback
+ * @param cb_ctx context to pass to the callback
+ * @return       negative error code, in which case the callback is not
+ *               called, action size otherwise, in which case the callback
+ *               is called exactly once, maybe even before this returns
+ * @see gcs_replv()
+ */
+extern long gcs_replv_async (gcs_conn_t*          conn,
+                             const struct gu_buf* act_in,
+                             struct gcs_action*   action,
+                             bool                 scheduled,
+                             gcs_repl_cb_t        cb,
+                             void*                cb_ctx);
+
 /*! A wrapper for single buffer communication */
 static inline long gcs_repl (gcs_conn_t*        const conn,
                              struct gcs_action* const action,
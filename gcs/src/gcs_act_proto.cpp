@@ -58,7 +58,7 @@ gcs_act_proto_write (gcs_act_frag_t* frag, void* buf, size_t buf_len)
                   frag->act_type, PROTO_AT_MAX);
         return -EOVERFLOW;
     }
-    if (frag->proto_ver != PROTO_VERSION) return -EPROTO;
+    if (frag->proto_ver > PROTO_VERSION) return -EPROTO;
     if (buf_len      < PROTO_DATA_OFFSET) return -EMSGSIZE;
 #endif
 
@@ -17,8 +17,11 @@
 #include <stdint.h>
 typedef uint8_t gcs_proto_t;
 
-/*! Supported protocol range (for now only version 0 is supported) */
-#define GCS_ACT_PROTO_MAX 0
+/*! Supported protocol range:
+ *  0 - fragments of different actions from the same sender never interleave,
+ *  1 - same header, but fragments of several actions may interleave, each
+ *      action is identified by its act_id */
+#define GCS_ACT_PROTO_MAX 1
 
 /*! Internal action fragment data representation */
 typedef struct gcs_act_frag
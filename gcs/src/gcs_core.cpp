@@ -33,6 +33,7 @@ gcs_core_register (gu_config_t* conf)
 
 const size_t CORE_FIFO_LEN = (1 << 10); // 1024 elements (no need to have more)
 const size_t CORE_INIT_BUF_SIZE = (1 << 16); // 65K - IP packet size
+const int    CORE_SEND_IOV_MAX  = 16;        // header + action buffer slices
 
 typedef enum core_state
 {
@@ -65,6 +66,7 @@ struct gcs_core
     void*           send_buf;
     size_t          send_buf_len;
     gcs_seqno_t     send_act_no;
+    long            send_streams; // actions being sent interleaved
 
     /* recv part */
     gcs_recv_msg_t  recv_msg;
@@ -101,7 +103,7 @@ typedef struct causal_act
     gu_cond_t*   cond;
 } causal_act_t;
 
-static int const GCS_PROTO_MAX = 0;
+static int const GCS_PROTO_MAX = 1;
 
 gcs_core_t*
 gcs_core_create (gu_config_t* const conf,
@@ -240,10 +242,11 @@ core_error (core_state_t state)
  * actions.
  */
 static inline ssize_t
-core_msg_send (gcs_core_t*    core,
-               const void*    msg,
-               size_t         msg_len,
-               gcs_msg_type_t msg_type)
+core_msg_sendv (gcs_core_t*          core,
+                const struct gu_buf* msg,
+                int                  msg_bufs,
+                size_t               msg_len,
+                gcs_msg_type_t       msg_type)
 {
     ssize_t ret;
 
@@ -253,7 +256,15 @@ core_msg_send (gcs_core_t*    core,
                       (CORE_EXCHANGE == core->state && GCS_MSG_STATE_MSG ==
                        msg_type))) {
 
-            ret = core->backend.send (&core->backend, msg, msg_len, msg_type);
+            if (gu_likely(1 == msg_bufs)) {
+                ret = core->backend.send (&core->backend, msg[0].ptr, msg_len,
+                                          msg_type);
+            }
+            else {
+                assert (core->backend.sendv);
+                ret = core->backend.sendv (&core->backend, msg, msg_bufs,
+                                           msg_type);
+            }
 
             if (ret > 0 && ret != (ssize_t)msg_len &&
                 GCS_MSG_ACTION != msg_type) {
@@ -279,6 +290,37 @@ core_msg_send (gcs_core_t*    core,
     return ret;
 }
 
+static inline ssize_t
+core_msg_send (gcs_core_t*    core,
+               const void*    msg,
+               size_t         msg_len,
+               gcs_msg_type_t msg_type)
+{
+    struct gu_buf const buf = { msg, static_cast<ssize_t>(msg_len) };
+    return core_msg_sendv (core, &buf, 1, msg_len, msg_type);
+}
+
+/*!
+ * Repeats attempt at sending the message if -EAGAIN was returned
+ * by core_msg_sendv()
+ */
+static inline ssize_t
+core_msg_sendv_retry (gcs_core_t*          core,
+                      const struct gu_buf* bufs,
+                      int                  bufs_num,
+                      size_t               len,
+                      gcs_msg_type_t       type)
+{
+    ssize_t ret;
+    while ((ret = core_msg_sendv (core, bufs, bufs_num, len, type)) == -EAGAIN){
+        /* wait for primary configuration - sleep 0.01 sec */
+        gu_debug ("Backend requested wait");
+        usleep (10000);
+    }
+//    gu_debug ("returning: %d (%s)", ret, strerror(-ret));
+    return ret;
+}
+
 /*!
  * Repeats attempt at sending the message if -EAGAIN was returned
  * by core_msg_send()
@@ -299,11 +341,36 @@ core_msg_send_retry (gcs_core_t*    core,
     return ret;
 }
 
-ssize_t
-gcs_core_send (gcs_core_t*          const conn,
-               const struct gu_buf* const action,
-               size_t                     act_size,
-               gcs_act_type_t       const act_type)
+/*!
+ * Removes unsent local action from FIFO. Normally it is the last one queued,
+ * but actions queued after it could be interleaved with it.
+ */
+static void
+core_fifo_remove (gcs_core_t* const core, gcs_seqno_t const act_id)
+{
+    if (gcs_fifo_lite_get_head (core->fifo)) {
+        for (long n = core->fifo->used - 1; n >= 0; n--) {
+            const core_act_t* const act = static_cast<const core_act_t*>(
+                gcs_fifo_lite_get_item (core->fifo, n));
+
+            if (act->sent_act_id == act_id) {
+                gcs_fifo_lite_raise (core->fifo, n);
+                gcs_fifo_lite_pop_head (core->fifo);
+                return;
+            }
+        }
+
+        gcs_fifo_lite_release (core->fifo);
+    }
+}
+
+static ssize_t
+core_send (gcs_core_t*          const conn,
+           const struct gu_buf* const action,
+           size_t                     act_size,
+           gcs_act_type_t       const act_type,
+           gcs_core_yield_t     const yield,
+           void*                const yield_ctx)
 {
     ssize_t        ret  = 0;
     ssize_t        sent = 0;
@@ -311,6 +378,25 @@ gcs_core_send (gcs_core_t*          const conn,
     ssize_t        send_size;
     const unsigned char proto_ver = conn->proto_ver;
     const ssize_t  hdr_size       = gcs_act_proto_hdr_size (proto_ver);
+    void*          send_buf       = conn->send_buf;
+    size_t   const send_buf_len   = conn->send_buf_len;
+
+    /* Long actions may let others through between fragments since protocol 1.
+     * Limit is set so that a non-interleaved action always has a receiving
+     * slot too. */
+    bool interleave = (yield && proto_ver >= 1                    &&
+                       GCS_ACT_TORDERED == act_type                 &&
+                       act_size > send_buf_len - hdr_size           &&
+                       conn->send_streams < GCS_NODE_APP_STREAMS - 1);
+
+    if (interleave) {
+        /* shared send_buf will be used by others in between */
+        send_buf = gu_malloc (send_buf_len);
+        if (!send_buf) {
+            send_buf   = conn->send_buf;
+            interleave = false;
+        }
+    }
 
     core_act_t*    local_act;
 
@@ -330,8 +416,10 @@ gcs_core_send (gcs_core_t*          const conn,
     frg.frag_no   = 0;
     frg.proto_ver = proto_ver;
 
-    if ((ret = gcs_act_proto_write (&frg, conn->send_buf, conn->send_buf_len)))
+    if ((ret = gcs_act_proto_write (&frg, send_buf, send_buf_len))) {
+        if (interleave) gu_free (send_buf);
         return ret;
+    }
 
     if ((local_act = (core_act_t*)gcs_fifo_lite_get_tail (conn->fifo))) {
         *local_act = (core_act_t){ conn->send_act_no, action, act_size };
@@ -340,36 +428,83 @@ gcs_core_send (gcs_core_t*          const conn,
     else {
         ret = core_error (conn->state);
         gu_error ("Failed to access core FIFO: %d (%s)", ret, strerror (-ret));
+        if (interleave) gu_free (send_buf);
         return ret;
     }
 
+    if (interleave) {
+        /* other actions may be sent before this one is finished, so it can't
+         * reuse its id on failure */
+        conn->send_act_no++;
+        conn->send_streams++;
+    }
+
     int            idx  = 0;
     const uint8_t* ptr  = (const uint8_t*)action[idx].ptr;
     size_t         left = action[idx].size;
 
+    struct gu_buf  iov[CORE_SEND_IOV_MAX];
+    int            iov_num;
+
     do {
-        const size_t chunk_size =
-            act_size < frg.frag_len ? act_size : frg.frag_len;
-
-        /* Here is the only time we have to cast frg.frag */
-        char* dst = (char*)frg.frag;
-        size_t to_copy = chunk_size;
-
-        while (to_copy > 0) {        // gather action bufs into one
-            if (to_copy < left) {
-                memcpy (dst, ptr, to_copy);
-                ptr     += to_copy;
-                left    -= to_copy;
-                to_copy = 0;
+        size_t chunk_size = act_size < frg.frag_len ? act_size : frg.frag_len;
+
+        if (conn->backend.sendv) {
+            /* Hand header and slices of action buffers to backend as they are,
+             * it will gather them into its own message buffer. */
+            size_t to_send = chunk_size;
+
+            iov[0].ptr  = send_buf;
+            iov[0].size = hdr_size;
+            iov_num     = 1;
+
+            while (to_send > 0 && iov_num < CORE_SEND_IOV_MAX) {
+                if (0 == left) {
+                    idx++;
+                    ptr  = (const uint8_t*)action[idx].ptr;
+                    left = action[idx].size;
+                    continue;
+                }
+
+                size_t const slice = to_send < left ? to_send : left;
+
+                iov[iov_num].ptr  = ptr;
+                iov[iov_num].size = slice;
+                iov_num++;
+
+                ptr     += slice;
+                left    -= slice;
+                to_send -= slice;
             }
-            else {
-                memcpy (dst, ptr, left);
-                dst     += left;
-                to_copy -= left;
-                idx++;
-                ptr  = (const uint8_t*)action[idx].ptr;
-                left = action[idx].size;
+
+            /* too many small buffers, the rest goes to the next fragment */
+            chunk_size -= to_send;
+        }
+        else {
+            /* Here is the only time we have to cast frg.frag */
+            char* dst = (char*)frg.frag;
+            size_t to_copy = chunk_size;
+
+            while (to_copy > 0) {        // gather action bufs into one
+                if (to_copy < left) {
+                    memcpy (dst, ptr, to_copy);
+                    ptr     += to_copy;
+                    left    -= to_copy;
+                    to_copy = 0;
+                }
+                else {
+                    memcpy (dst, ptr, left);
+                    dst     += left;
+                    to_copy -= left;
+                    idx++;
+                    ptr  = (const uint8_t*)action[idx].ptr;
+                    left = action[idx].size;
+                }
             }
+
+            iov[0].ptr  = send_buf;
+            iov[0].size = hdr_size + chunk_size;
+            iov_num     = 1;
         }
 
         send_size = hdr_size + chunk_size;
@@ -377,10 +512,10 @@ gcs_core_send (gcs_core_t*          const conn,
 #ifdef GCS_CORE_TESTING
         gu_lock_step_wait (&conn->ls); // pause after every fragment
         gu_info ("Sent %p of size %zu. Total sent: %zu, left: %zu",
-                 (char*)conn->send_buf + hdr_size, chunk_size, sent, act_size);
+                 (char*)send_buf + hdr_size, chunk_size, sent, act_size);
 #endif
-        ret = core_msg_send_retry (conn, conn->send_buf, send_size,
-                                   GCS_MSG_ACTION);
+        ret = core_msg_sendv_retry (conn, iov, iov_num, send_size,
+                                    GCS_MSG_ACTION);
         GU_DBUG_SYNC_WAIT("gcs_core_after_frag_send");
 #ifdef GCS_CORE_TESTING
 //        gu_lock_step_wait (&conn->ls); // pause after every fragment
@@ -420,6 +555,13 @@ gcs_core_send (gcs_core_t*          const conn,
                     }
                 } while (true);
             }
+
+            if (interleave && act_size > 0 && (ret = yield (yield_ctx)) < 0) {
+                gu_debug ("Interrupted sending action %lld: %zd (%s)",
+                          frg.act_id, ret, strerror (-ret));
+                core_fifo_remove (conn, frg.act_id);
+                goto out;
+            }
         }
         else {
             if (ret >= 0) {
@@ -435,7 +577,7 @@ gcs_core_send (gcs_core_t*          const conn,
              *
              * 1. Action will never be received completely by this node. Hence
              *    action must be removed from fifo on behalf of sending thr.: */
-            gcs_fifo_lite_remove (conn->fifo);
+            core_fifo_remove (conn, frg.act_id);
             /* 2. Members will have to discard received fragments.
              * Two reasons could lead us here: new member(s) in configuration
              * change or broken connection (leave group). In both cases other
@@ -443,19 +585,43 @@ gcs_core_send (gcs_core_t*          const conn,
             goto out;
         }
 
-    } while (act_size && gcs_act_proto_inc(conn->send_buf));
+    } while (act_size && gcs_act_proto_inc(send_buf));
 
     assert (0 == act_size);
 
     /* successfully sent action, increment send counter */
-    conn->send_act_no++;
+    if (!interleave) conn->send_act_no++;
     ret = sent;
 
 out:
+    if (interleave) {
+        conn->send_streams--;
+        gu_free (send_buf);
+    }
 //    gu_debug ("returning: %d (%s)", ret, strerror(-ret));
     return ret;
 }
 
+ssize_t
+gcs_core_send (gcs_core_t*          const conn,
+               const struct gu_buf* const action,
+               size_t               const act_size,
+               gcs_act_type_t       const act_type)
+{
+    return core_send (conn, action, act_size, act_type, NULL, NULL);
+}
+
+ssize_t
+gcs_core_send_interleaved (gcs_core_t*          const conn,
+                           const struct gu_buf* const action,
+                           size_t               const act_size,
+                           gcs_act_type_t       const act_type,
+                           gcs_core_yield_t     const yield,
+                           void*                const yield_ctx)
+{
+    return core_send (conn, action, act_size, act_type, yield, yield_ctx);
+}
+
 /* A helper for gcs_core_recv().
  * Deals with fetching complete message from backend
  * and reallocates recv buf if needed */
@@ -549,11 +715,7 @@ core_handle_act_msg (gcs_core_t*          core,
 
         if (ret > 0) { /* complete action received */
             assert (act->act.buf_len == ret);
-#ifndef GCS_FOR_GARB
-            assert (NULL != act->act.buf);
-#else
-            assert (NULL == act->act.buf);
-#endif
+            assert ((NULL != act->act.buf) == gcs_gcache_store(core->cache));
             act->sender_idx = msg->sender_idx;
 
             if (gu_likely(!my_msg)) {
@@ -567,6 +729,19 @@ core_handle_act_msg (gcs_core_t*          core,
 
                 if ((local_act = (core_act_t*)gcs_fifo_lite_get_head (
                          core->fifo))){
+                    if (gu_unlikely(local_act->sent_act_id != frg.act_id)) {
+                        /* interleaved actions may complete out of order */
+                        for (long n = 1; (local_act = (core_act_t*)
+                                 gcs_fifo_lite_get_item (core->fifo, n)); n++) {
+                            if (local_act->sent_act_id == frg.act_id) {
+                                gcs_fifo_lite_raise (core->fifo, n);
+                                break;
+                            }
+                        }
+                        local_act = (core_act_t*)
+                            gcs_fifo_lite_get_item (core->fifo, 0);
+                    }
+
                     act->local       = (const struct gu_buf*)local_act->action;
                     act->act.buf_len = local_act->action_size;
                     sent_act_id      = local_act->sent_act_id;
@@ -608,19 +783,20 @@ core_handle_act_msg (gcs_core_t*          core,
                             // if lingering STR sneaks in when core->state != CORE_PRIMARY
                             // act->id != GCS_SEQNO_ILL (most likely act->id == -EAGAIN)
                             core->state == CORE_PRIMARY)) {
-#ifdef GCS_FOR_GARB
+            if (gcs_gcache_store (core->cache)) {
+                ret = gcs_group_handle_state_request (group, act);
+                assert (ret <= 0 || ret == act->act.buf_len);
+            }
             /* ignoring state requests from other nodes (not allocated) */
-            if (my_msg) {
+            else if (my_msg) {
                 if (act->act.buf_len != act->local[0].size) {
                     gu_fatal ("Protocol violation: state request is fragmented."
                               " Aborting.");
                     abort();
                 }
                 act->act.buf = act->local[0].ptr;
-#endif
                 ret = gcs_group_handle_state_request (group, act);
                 assert (ret <= 0 || ret == act->act.buf_len);
-#ifdef GCS_FOR_GARB
                 if (ret < 0) gu_fatal ("Handling state request failed: %d",ret);
                 act->act.buf = NULL;
             }
@@ -631,7 +807,6 @@ core_handle_act_msg (gcs_core_t*          core,
                 act->sender_idx  = -1;
                 ret = 0;
             }
-#endif
             }
 //          gu_debug ("Received action: seqno: %lld, sender: %d, size: %d, "
 //                    "act: %p", act->id, msg->sender_idx, ret, act->buf);
@@ -105,6 +105,25 @@ gcs_core_send (gcs_core_t*          core,
                size_t               act_size,
                gcs_act_type_t       act_type);
 
+/*! Called in between fragments of interleaved action,
+ *  negative return value aborts sending */
+typedef long (*gcs_core_yield_t) (void* ctx);
+
+/*
+ * gcs_core_send_interleaved() is the same as gcs_core_send(), but lets other
+ * actions be sent in between the fragments of a long action by calling
+ * yield(ctx) after each fragment. The caller is expected to let other threads
+ * call gcs_core_send() from within yield(). Has effect only since GCS
+ * protocol 1, as receivers must be able to handle interleaved fragments.
+ */
+extern ssize_t
+gcs_core_send_interleaved (gcs_core_t*          core,
+                           const struct gu_buf* act,
+                           size_t               act_size,
+                           gcs_act_type_t       act_type,
+                           gcs_core_yield_t     yield,
+                           void*                yield_ctx);
+
 /*
  * gcs_core_recv() blocks until some action is received from group.
  *
@@ -33,6 +33,7 @@
  *
  * @return 0              - success,
  *         size of action - success, full action received,
+ *         -ERESTART      - full local action received after reset,
  *         negative       - error.
  *
  * TODO: this function is too long, figure out a way to factor it into several
@@ -69,16 +70,11 @@ gcs_defrag_handle_frag (gcs_defrag_t*         df,
 
                     df->size = frg->act_size;
 
-#ifndef GCS_FOR_GARB
-                    if (df->cache !=NULL) {
-                        gcache_free (df->cache, df->head);
-                    }
-                    else {
-                        free ((void*)df->head);
-                    }
+                    if (gcs_gcache_store (df->cache)) {
+                        gcs_gcache_free (df->cache, df->head);
 
-                    DF_ALLOC();
-#endif /* GCS_FOR_GARB */
+                        DF_ALLOC();
+                    }
                 }
             }
             else if (frg->act_id == df->sent_id && frg->frag_no < df->frag_no) {
@@ -109,13 +105,14 @@ gcs_defrag_handle_frag (gcs_defrag_t*         df,
             df->sent_id = frg->act_id;
             df->reset   = false;
 
-#ifndef GCS_FOR_GARB
-            DF_ALLOC();
-#else
-            /* we don't store actions locally at all */
-            df->head = NULL;
-            df->tail = df->head;
-#endif
+            if (gcs_gcache_store (df->cache)) {
+                DF_ALLOC();
+            }
+            else {
+                /* we don't store actions locally at all */
+                df->head = NULL;
+                df->tail = df->head;
+            }
         }
         else {
             /* not a first fragment */
@@ -143,34 +140,23 @@ gcs_defrag_handle_frag (gcs_defrag_t*         df,
     df->received += frg->frag_len;
     assert (df->received <= df->size);
 
-#ifndef GCS_FOR_GARB
-    assert (df->tail);
-    memcpy (df->tail, frg->frag, frg->frag_len);
-    df->tail += frg->frag_len;
-#else
-    /* we skip memcpy since have not allocated any buffer */
-    assert (NULL == df->tail);
-    assert (NULL == df->head);
-#endif
-
-#if 1
-    if (df->received == df->size) {
-        act->buf     = df->head;
-        act->buf_len = df->received;
-        gcs_defrag_init (df, df->cache);
-        return act->buf_len;
+    if (gcs_gcache_store (df->cache)) {
+        assert (df->tail);
+        memcpy (df->tail, frg->frag, frg->frag_len);
+        df->tail += frg->frag_len;
     }
     else {
-        return 0;
+        /* we skip memcpy since have not allocated any buffer */
+        assert (NULL == df->tail);
+        assert (NULL == df->head);
     }
-#else
-    /* Refs gh185. Above original logic is preserved which relies on resetting
-     * group->frag_reset when local action needs to be resent. However a proper
-     * solution seems to be to use reset flag of own defrag channel (at least
-     * it is per channel, not global like group->frag_reset). This proper logic
-     * is shown below. Note that for it to work gcs_group_handle_act_msg()
-     * must be able to handle -ERESTART return code. */
-    int ret;
+
+    /* Refs gh185. Reset flag of own defrag channel is used to tell the sender
+     * that local action did not make it to the group: with interleaved
+     * actions group-wide frag_reset is not enough since it can be cleared by
+     * the first fragment of another action. gcs_group_handle_act_msg() handles
+     * -ERESTART return code. */
+    ssize_t ret;
 
     if (df->received == df->size) {
         act->buf     = df->head;
@@ -195,5 +181,4 @@ gcs_defrag_handle_frag (gcs_defrag_t*         df,
     }
 
     return ret;
-#endif
 }
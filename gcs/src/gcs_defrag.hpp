@@ -45,6 +45,8 @@ gcs_defrag_init (gcs_defrag_t* df, gcache_t* cache)
  *
  * @return 0              - success,
  *         size of action - success, full action received,
+ *         -ERESTART      - full local action received, but it was reset
+ *                          halfway (act is filled as in case of success),
  *         negative       - error.
  */
 extern ssize_t
@@ -64,14 +66,10 @@ gcs_defrag_forget (gcs_defrag_t* df)
 static inline void
 gcs_defrag_free (gcs_defrag_t* df)
 {
-#ifndef GCS_FOR_GARB
     if (df->head) {
         gcs_gcache_free (df->cache, df->head);
         // df->head, df->tail will be zeroed in gcs_defrag_init() below
     }
-#else
-    assert(NULL == df->head);
-#endif
 
     gcs_defrag_init (df, df->cache);
 }
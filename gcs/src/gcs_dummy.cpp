@@ -124,6 +124,29 @@ GCS_BACKEND_SEND_FN(dummy_send)
     return err;
 }
 
+static
+GCS_BACKEND_SENDV_FN(dummy_sendv)
+{
+    size_t len = 0;
+    for (int i = 0; i < bufs_num; i++) len += bufs[i].size;
+
+    /* message queue needs a contiguous copy anyway */
+    uint8_t* const buf = static_cast<uint8_t*>(gu_malloc (len));
+    if (gu_unlikely(NULL == buf)) return -ENOMEM;
+
+    uint8_t* ptr = buf;
+    for (int i = 0; i < bufs_num; i++) {
+        memcpy (ptr, bufs[i].ptr, bufs[i].size);
+        ptr += bufs[i].size;
+    }
+
+    long const ret = dummy_send (backend, buf, len, msg_type);
+
+    gu_free (buf);
+
+    return ret;
+}
+
 static
 GCS_BACKEND_RECV_FN(dummy_recv)
 {
@@ -298,6 +321,7 @@ GCS_BACKEND_CREATE_FN(gcs_dummy_create)
     backend->close     = dummy_close;
     backend->destroy   = dummy_destroy;
     backend->send      = dummy_send;
+    backend->sendv     = dummy_sendv;
     backend->recv      = dummy_recv;
     backend->name      = dummy_name;
     backend->msg_size  = dummy_msg_size;
@@ -156,6 +156,36 @@ gcs_fifo_lite_pop_head (gcs_fifo_lite_t* fifo)
     gu_mutex_unlock (&fifo->lock);
 }
 
+/*! Returns pointer to the item n positions behind the head or NULL if there is
+ *  no such item. FIFO must be locked by gcs_fifo_lite_get_head() */
+static inline void*
+gcs_fifo_lite_get_item (gcs_fifo_lite_t* fifo, long n)
+{
+    if (n >= fifo->used) return NULL;
+
+    return ((char*)fifo->queue + ((fifo->head + n) & fifo->mask) *
+            fifo->item_size);
+}
+
+/*! Moves the item n positions behind the head to the head preserving the
+ *  order of the rest, so that it can be popped. Needed when items are not
+ *  always consumed in the order they were queued.
+ *  FIFO must be locked by gcs_fifo_lite_get_head() */
+static inline void
+gcs_fifo_lite_raise (gcs_fifo_lite_t* fifo, long n)
+{
+    assert (n < fifo->used);
+
+    for (; n > 0; n--) {
+        char* const a = (char*)gcs_fifo_lite_get_item (fifo, n - 1);
+        char* const b = (char*)gcs_fifo_lite_get_item (fifo, n);
+
+        for (ulong i = 0; i < fifo->item_size; i++) {
+            char const tmp = a[i]; a[i] = b[i]; b[i] = tmp;
+        }
+    }
+}
+
 /*! Unlocks FIFO */
 static inline long
 gcs_fifo_lite_release (gcs_fifo_lite_t* fifo)
@@ -7,37 +7,40 @@
 #ifndef _gcs_gcache_h_
 #define _gcs_gcache_h_
 
-#ifndef GCS_FOR_GARB
-    #include <gcache.h>
-#else
-    #ifndef gcache_t
-        struct gcache_t;
-    #endif
-#endif
+#include <gcache.h>
 
 #include <gu_macros.h>
 
 #include <cstdlib>
 
+/*! Whether received actions should be stored locally. Arbitrator does it only
+ *  when it was given a cache to serve IST from. */
+static inline bool
+gcs_gcache_store (const gcache_t* gcache)
+{
+#ifdef GCS_FOR_GARB
+    return (gcache != NULL);
+#else
+    (void)gcache;
+    return true;
+#endif /* GCS_FOR_GARB */
+}
+
 static inline void*
 gcs_gcache_malloc (gcache_t* gcache, size_t size)
 {
-#ifndef GCS_FOR_GARB
     if (gu_likely(gcache != NULL))
         return gcache_malloc (gcache, size);
     else
-#endif
         return ::malloc (size);
 }
 
 static inline void
 gcs_gcache_free (gcache_t* gcache, const void* buf)
 {
-#ifndef GCS_FOR_GARB
     if (gu_likely (gcache != NULL))
         gcache_free (gcache, buf);
     else
-#endif
         ::free (const_cast<void*>(buf));
 }
 
@@ -196,6 +196,7 @@ public:
         uuid_(),
         thd_(),
         schedparam_(conf_.get(gcomm_thread_schedparam_opt)),
+        affinity_(thread_affinity(conf_, "gcomm")),
         barrier_(2),
         uri_(u),
         net_(Protonet::create(conf_)),
@@ -279,6 +280,12 @@ public:
         log_info << "gcomm thread scheduling priority set to "
                  << thread_get_schedparam(thd_) << " ";
 
+        if (!affinity_.any())
+        {
+            thread_set_affinity(thd_, affinity_);
+            log_info << "gcomm thread CPU affinity set to " << affinity_;
+        }
+
         uri_.set_option("gmcast.group", channel);
         tp_ = Transport::create(*net_, uri_);
         gcomm::connect(tp_, this);
@@ -441,6 +448,7 @@ private:
     gcomm::UUID       uuid_;
     pthread_t         thd_;
     ThreadSchedparam  schedparam_;
+    ThreadAffinity    affinity_;
     Barrier           barrier_;
     URI               uri_;
     Protonet*         net_;
@@ -599,7 +607,10 @@ static GCS_BACKEND_MSG_SIZE_FN(gcomm_msg_size)
 }
 
 
-static GCS_BACKEND_SEND_FN(gcomm_send)
+static long gcomm_send_dg(gcs_backend_t* const backend,
+                          Datagram&            dg,
+                          size_t         const len,
+                          gcs_msg_type_t const msg_type)
 {
     GCommConn::Ref ref(backend);
 
@@ -610,11 +621,6 @@ static GCS_BACKEND_SEND_FN(gcomm_send)
 
     GCommConn& conn(*ref.get());
 
-    Datagram dg(
-        SharedBuffer(
-            new Buffer(reinterpret_cast<const byte_t*>(buf),
-                       reinterpret_cast<const byte_t*>(buf) + len)));
-
     int err;
     // Set thread scheduling params if gcomm thread runs with
     // non-default params
@@ -664,6 +670,40 @@ static GCS_BACKEND_SEND_FN(gcomm_send)
 }
 
 
+static GCS_BACKEND_SEND_FN(gcomm_send)
+{
+    Datagram dg(
+        SharedBuffer(
+            new Buffer(reinterpret_cast<const byte_t*>(buf),
+                       reinterpret_cast<const byte_t*>(buf) + len)));
+
+    return gcomm_send_dg(backend, dg, len, msg_type);
+}
+
+
+static GCS_BACKEND_SENDV_FN(gcomm_sendv)
+{
+    size_t len(0);
+
+    for (int i(0); i < bufs_num; ++i) len += bufs[i].size;
+
+    // gcomm keeps the message for retransmission and delivery,
+    // so it has to be owned by the datagram: gather it right there
+    Buffer* const b(new Buffer());
+    b->reserve(len);
+
+    for (int i(0); i < bufs_num; ++i)
+    {
+        const byte_t* const ptr(static_cast<const byte_t*>(bufs[i].ptr));
+        b->insert(b->end(), ptr, ptr + bufs[i].size);
+    }
+
+    Datagram dg((SharedBuffer(b)));
+
+    return gcomm_send_dg(backend, dg, len, msg_type);
+}
+
+
 static void fill_cmp_msg(const View& view, const gcomm::UUID& my_uuid,
                          gcs_comp_msg_t* cm)
 {
@@ -977,6 +1017,7 @@ GCS_BACKEND_REGISTER_FN(gcs_gcomm_register)
     try
     {
         reinterpret_cast<gu::Config*>(cnf)->add(gcomm_thread_schedparam_opt, "");
+        gu::thread_register_params(*reinterpret_cast<gu::Config*>(cnf));
         gcomm::Conf::register_params(*reinterpret_cast<gu::Config*>(cnf));
         return false;
     }
@@ -1015,6 +1056,7 @@ GCS_BACKEND_CREATE_FN(gcs_gcomm_create)
     backend->close     = gcomm_close;
     backend->destroy   = gcomm_destroy;
     backend->send      = gcomm_send;
+    backend->sendv     = gcomm_sendv;
     backend->recv      = gcomm_recv;
     backend->name      = gcomm_name;
     backend->msg_size  = gcomm_msg_size;
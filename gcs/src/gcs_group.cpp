@@ -30,6 +30,7 @@ gcs_group_init (gcs_group_t* group, gcache_t* const cache,
     group->act_id_      = GCS_SEQNO_ILL;
     group->conf_id      = GCS_SEQNO_ILL;
     group->state_uuid   = GU_UUID_NIL;
+    group->state_exch_start = 0;
     group->group_uuid   = GU_UUID_NIL;
     group->num          = 1; // this must be removed (#474)
     group->my_idx       = 0; // this must be -1 (#474)
@@ -284,8 +285,16 @@ group_post_state_exchange (gcs_group_t* group)
                               gcs_state_msg_uuid(states[i]))))
             return; // not all states from THIS state exch. received, wait
     }
-    gu_debug ("STATE EXCHANGE: " GU_UUID_FORMAT " complete.",
-              GU_UUID_ARGS(&group->state_uuid));
+    if (group->state_exch_start) {
+        gu_info ("STATE EXCHANGE: " GU_UUID_FORMAT " complete in %.3f ms.",
+                 GU_UUID_ARGS(&group->state_uuid),
+                 (gu_time_monotonic() - group->state_exch_start) * 1.0e-6);
+        group->state_exch_start = 0;
+    }
+    else {
+        gu_debug ("STATE EXCHANGE: " GU_UUID_FORMAT " complete.",
+                  GU_UUID_ARGS(&group->state_uuid));
+    }
 
     gcs_state_msg_get_quorum (states, group->num, quorum);
 
@@ -531,6 +540,7 @@ gcs_group_handle_comp_msg (gcs_group_t* group, const gcs_comp_msg_t* comp)
             group_nodes_reset (group);
             group->state      = GCS_GROUP_WAIT_STATE_UUID;
             group->state_uuid = GU_UUID_NIL; // prepare for state exchange
+            group->state_exch_start = gu_time_monotonic();
         }
         else {
             if (GCS_GROUP_PRIMARY == group->state) {
@@ -1006,13 +1016,29 @@ group_for_each_donor_in_string (const gcs_group_t* const group,
     return err;
 }
 
+/* Arbitrator cache is considered only for IST-only requests and only if all
+ * members are aware of it, see gcs_state_msg_write() */
+static inline gcs_seqno_t
+group_node_cached (const gcs_group_t* const group,
+                   const gcs_node_t*  const node,
+                   bool               const ist_only)
+{
+    if (!group_node_is_stateful (group, node) &&
+        (!ist_only || group->quorum.version < 5)) {
+        return GCS_SEQNO_ILL;
+    }
+
+    return gcs_node_cached (node);
+}
+
 static gcs_seqno_t
-group_lowest_cached_seqno(const gcs_group_t* const group)
+group_lowest_cached_seqno(const gcs_group_t* const group, bool const ist_only)
 {
     gcs_seqno_t ret = GCS_SEQNO_ILL;
     int idx = 0;
     for (idx = 0; idx < group->num; idx++) {
-        gcs_seqno_t seq = gcs_node_cached(&group->nodes[idx]);
+        gcs_seqno_t seq = group_node_cached(group, &group->nodes[idx],
+                                            ist_only);
         if (seq != GCS_SEQNO_ILL)
         {
             if (ret == GCS_SEQNO_ILL ||
@@ -1030,13 +1056,14 @@ group_find_ist_donor_by_name (const gcs_group_t* const group,
                               int joiner_idx,
                               const char* name, int  name_len,
                               gcs_seqno_t ist_seqno,
-                              gcs_node_state_t status)
+                              gcs_node_state_t status,
+                              bool const ist_only)
 {
     int idx = 0;
     for (idx = 0; idx < group->num; idx++)
     {
         gcs_node_t* node = &group->nodes[idx];
-        gcs_seqno_t cached = gcs_node_cached(node);
+        gcs_seqno_t cached = group_node_cached(group, node, ist_only);
         if (strncmp(node->name, name, name_len) == 0 &&
             joiner_idx != idx &&
             node->status >= status &&
@@ -1056,7 +1083,8 @@ group_find_ist_donor_by_name_in_string (
     int joiner_idx,
     const char* str, int str_len,
     gcs_seqno_t ist_seqno,
-    gcs_node_state_t status)
+    gcs_node_state_t status,
+    bool const ist_only)
 {
     assert (str != NULL);
 
@@ -1078,7 +1106,7 @@ group_find_ist_donor_by_name_in_string (
         if (len == 0) break;
         int idx = group_find_ist_donor_by_name(
             group, joiner_idx, begin, len,
-            ist_seqno, status);
+            ist_seqno, status, ist_only);
         if (idx >= 0)
         {
             if (ret == -1 ||
@@ -1105,15 +1133,18 @@ static int
 group_find_ist_donor_by_state (const gcs_group_t* const group,
                                int joiner_idx,
                                gcs_seqno_t ist_seqno,
-                               gcs_node_state_t status)
+                               gcs_node_state_t status,
+                               bool const ist_only)
 {
     gcs_node_t* joiner = &group->nodes[joiner_idx];
     gcs_segment_t joiner_segment = joiner->segment;
 
     // find node who is ist potentially possible.
-    // first highest cached seqno local node.
+    // first highest cached seqno arbitrator: it does not need to desync.
+    // then highest cached seqno local node.
     // then highest cached seqno remote node.
     int idx = 0;
+    int arb_idx = -1;
     int local_idx = -1;
     int remote_idx = -1;
     for (idx = 0; idx < group->num; idx++)
@@ -1121,14 +1152,15 @@ group_find_ist_donor_by_state (const gcs_group_t* const group,
         if (joiner_idx == idx) continue;
 
         gcs_node_t* const node = &group->nodes[idx];
-        gcs_seqno_t const node_cached = gcs_node_cached(node);
+        gcs_seqno_t const node_cached = group_node_cached(group, node,
+                                                          ist_only);
 
         if (node->status >= status &&
-            group_node_is_stateful(group, node) &&
             node_cached != GCS_SEQNO_ILL &&
             node_cached <= (ist_seqno + 1))
         {
             int* const idx_ptr =
+                !group_node_is_stateful(group, node) ? &arb_idx :
                 (joiner_segment == node->segment) ? &local_idx : &remote_idx;
 
             if (*idx_ptr == -1 ||
@@ -1138,6 +1170,13 @@ group_find_ist_donor_by_state (const gcs_group_t* const group,
             }
         }
     }
+    if (arb_idx >= 0)
+    {
+        gu_debug("arbitrator found. name[%s], seqno[%lld]",
+                 group->nodes[arb_idx].name,
+                 (long long)gcs_node_cached(&group->nodes[arb_idx]));
+        return arb_idx;
+    }
     if (local_idx >= 0)
     {
         gu_debug("local found. name[%s], seqno[%lld]",
@@ -1168,7 +1207,8 @@ group_find_ist_donor (const gcs_group_t* const group,
     int idx = -1;
 
     gcs_seqno_t conf_seqno = group->quorum.act_id;
-    gcs_seqno_t lowest_cached_seqno = group_lowest_cached_seqno(group);
+    gcs_seqno_t lowest_cached_seqno = group_lowest_cached_seqno(group,
+                                                                ist_only);
     if (lowest_cached_seqno == GCS_SEQNO_ILL)
     {
         gu_debug("fallback to sst. lowest_cached_seqno == GCS_SEQNO_ILL");
@@ -1197,12 +1237,12 @@ group_find_ist_donor (const gcs_group_t* const group,
     if (str_len) {
         // find ist donor by name.
         idx = group_find_ist_donor_by_name_in_string(
-            group, joiner_idx, str, str_len, ist_seqno, status);
+            group, joiner_idx, str, str_len, ist_seqno, status, ist_only);
         if (idx >= 0) return idx;
     }
     // find ist donor by status.
     idx = group_find_ist_donor_by_state(
-        group, joiner_idx, ist_seqno, status);
+        group, joiner_idx, ist_seqno, status, ist_only);
     if (idx >= 0) return idx;
     return -1;
 }
@@ -1593,12 +1633,12 @@ group_get_node_state (const gcs_group_t* const group, long const node_idx)
     if (node->bootstrap)          flags |= GCS_STATE_FBOOTSTRAP;
 #ifdef GCS_FOR_GARB
     flags |= GCS_STATE_ARBITRATOR;
+#endif /* GCS_FOR_GARB */
 
-    int64_t const cached = GCS_SEQNO_ILL;
-#else
-    int64_t const cached = /* group->cache check is needed for unit tests */
+    /* group->cache check is needed for unit tests and for arbitrator which
+     * does not keep IST cache */
+    int64_t const cached =
         group->cache ? gcache_seqno_min(group->cache) : GCS_SEQNO_ILL;
-#endif /* GCS_FOR_GARB */
 
     return gcs_state_msg_create (
         &group->state_uuid,
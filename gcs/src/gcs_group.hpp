@@ -40,6 +40,7 @@ typedef struct gcs_group
     gcs_seqno_t   act_id_;      // current(last) action seqno
     gcs_seqno_t   conf_id;      // current configuration seqno
     gu_uuid_t     state_uuid;   // state exchange id
+    long long     state_exch_start; // when state exchange began (monotonic ns)
     gu_uuid_t     group_uuid;   // group UUID
     long          num;          // number of nodes
     long          my_idx;       // my index in the group
@@ -163,6 +164,10 @@ gcs_group_handle_act_msg (gcs_group_t*          const group,
     ret = gcs_node_handle_act_frag (&group->nodes[sender_idx], frg, &rcvd->act,
                                     local);
 
+    /* local action was reset halfway, sender must be told for TO actions */
+    bool const reset = (-ERESTART == ret);
+    if (gu_unlikely(reset)) ret = rcvd->act.buf_len;
+
     if (ret > 0) {
 
         assert (ret == rcvd->act.buf_len);
@@ -172,7 +177,7 @@ gcs_group_handle_act_msg (gcs_group_t*          const group,
         if (gu_likely(GCS_ACT_TORDERED  == rcvd->act.type &&
                       GCS_GROUP_PRIMARY == group->state   &&
                       group->nodes[sender_idx].status >= GCS_NODE_STATE_DONOR &&
-                      !(group->frag_reset && local) &&
+                      !(group->frag_reset && local) && !reset &&
                       commonly_supported_version)) {
             /* Common situation -
              * increment and assign act_id only for totally ordered actions
@@ -186,10 +191,11 @@ gcs_group_handle_act_msg (gcs_group_t*          const group,
                 rcvd->id = -ERESTART;
                 gu_debug("Returning -ERESTART for TORDERED action: group->state"
                          " = %s, sender->status = %s, frag_reset = %s, "
-                         "buf = %p",
+                         "reset = %s, buf = %p",
                          gcs_group_state_str[group->state],
                          gcs_node_state_to_str(group->nodes[sender_idx].status),
-                         group->frag_reset ? "true" : "false", rcvd->act.buf);
+                         group->frag_reset ? "true" : "false",
+                         reset ? "true" : "false", rcvd->act.buf);
             }
             else {
                 /* Just ignore it */
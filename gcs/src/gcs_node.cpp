@@ -29,7 +29,9 @@ gcs_node_init (gcs_node_t* const node,
     node->status    = GCS_NODE_STATE_NON_PRIM;
     node->name      = strdup (name     ? name     : NODE_NO_NAME);
     node->inc_addr  = strdup (inc_addr ? inc_addr : NODE_NO_ADDR);
-    gcs_defrag_init (&node->app, cache); // GCS_ACT_TORDERED goes only here
+    for (int i = 0; i < GCS_NODE_APP_STREAMS; i++) {
+        gcs_defrag_init (&node->app[i], cache); // GCS_ACT_TORDERED goes here
+    }
     gcs_defrag_init (&node->oob, NULL);
 
     node->gcs_proto_ver  = gcs_proto_ver;
@@ -49,7 +51,9 @@ gcs_node_move (gcs_node_t* dst, gcs_node_t* src)
         gcs_state_msg_destroy ((gcs_state_msg_t*)dst->state_msg);
 
     memcpy (dst, src, sizeof (gcs_node_t));
-    gcs_defrag_forget (&src->app);
+    for (int i = 0; i < GCS_NODE_APP_STREAMS; i++) {
+        gcs_defrag_forget (&src->app[i]);
+    }
     gcs_defrag_forget (&src->oob);
     src->name      = NULL;
     src->inc_addr  = NULL;
@@ -60,16 +64,75 @@ gcs_node_move (gcs_node_t* dst, gcs_node_t* src)
 void
 gcs_node_reset_local (gcs_node_t* node)
 {
-    gcs_defrag_reset (&node->app);
+    for (int i = 0; i < GCS_NODE_APP_STREAMS; i++) {
+        gcs_defrag_reset (&node->app[i]);
+    }
     gcs_defrag_reset (&node->oob);
 }
 
 /*! Reset node's receive buffers */
 void
 gcs_node_reset (gcs_node_t* node) {
-    gcs_defrag_free (&node->app);
+    for (int i = 0; i < GCS_NODE_APP_STREAMS; i++) {
+        gcs_defrag_free (&node->app[i]);
+    }
     gcs_defrag_free (&node->oob);
     gcs_node_reset_local (node);
+    /* remaining fragments of the actions in progress are to be ignored */
+    node->app_reset_id = node->app_last_id;
+}
+
+ssize_t
+gcs_node_handle_app_frag (gcs_node_t*           const node,
+                          const gcs_act_frag_t* const frg,
+                          struct gcs_act*       const act,
+                          bool                  const local)
+{
+    gcs_defrag_t* vacant    = NULL;
+    gcs_defrag_t* abandoned = NULL;
+
+    for (int i = 0; i < GCS_NODE_APP_STREAMS; i++) {
+        gcs_defrag_t* const df = &node->app[i];
+
+        if (df->received > 0) {
+            if (df->sent_id == frg->act_id) {
+                return gcs_defrag_handle_frag (df, frg, act, local);
+            }
+            if (df->reset && NULL == abandoned) abandoned = df;
+        }
+        else if (NULL == vacant) {
+            vacant = df;
+        }
+    }
+
+    if (0 == frg->frag_no) {
+        if (frg->act_id > node->app_last_id) node->app_last_id = frg->act_id;
+
+        if (gu_unlikely(NULL == vacant && NULL != abandoned)) {
+            /* local send failed halfway, the rest is never coming */
+            gu_debug ("Discarding local action %lld abandoned after reset",
+                      abandoned->sent_id);
+            gcs_defrag_free (abandoned);
+            vacant = abandoned;
+        }
+    }
+    else if (!local && frg->act_id <= node->app_reset_id) {
+        /* can happen after configuration change, just ignore it calmly */
+        gu_debug ("Ignoring fragment %lld:%ld (size %zu) after reset",
+                  frg->act_id, frg->frag_no, frg->act_size);
+        return 0;
+    }
+
+    if (gu_likely(NULL != vacant)) {
+        return gcs_defrag_handle_frag (vacant, frg, act, local);
+    }
+
+    gu_error ("Unordered fragment received. Protocol error.");
+    gu_error ("Node %s: no room for action %lld:%ld, "
+              "more than %d actions in progress.",
+              node->id, frg->act_id, frg->frag_no, GCS_NODE_APP_STREAMS);
+    assert(0);
+    return -EPROTO;
 }
 
 /*! Deallocate resources associated with the node object */
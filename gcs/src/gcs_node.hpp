@@ -22,10 +22,17 @@
 #define NODE_NO_NAME "unspecified"
 #define NODE_NO_ADDR "unspecified"
 
+/*! Maximum number of application actions from one node which fragments can
+ *  be interleaved (GCS protocol 1 and above) */
+#define GCS_NODE_APP_STREAMS 4
+
 struct gcs_node
 {
-    gcs_defrag_t     app;        // defragmenter for application actions
+    gcs_defrag_t     app[GCS_NODE_APP_STREAMS]; // defragmenters for
+                                                // application actions
     gcs_defrag_t     oob;        // defragmenter for out-of-band service acts.
+    gcs_seqno_t      app_last_id;  // id of the last action started by node
+    gcs_seqno_t      app_reset_id; // actions up to this id discarded by reset
 
     // globally unique id from a component message
     char             id[GCS_COMP_MEMB_ID_MAX_LEN + 1];
@@ -78,6 +85,18 @@ gcs_node_reset (gcs_node_t* node);
 extern void
 gcs_node_reset_local (gcs_node_t* node);
 
+/*!
+ * Handles application action fragment which does not continue the action in
+ * the first defragmenter. Actions are told apart by sender's action id, new
+ * action takes a vacant defragmenter or the one holding a local action
+ * abandoned after reset.
+ */
+extern ssize_t
+gcs_node_handle_app_frag (gcs_node_t*           node,
+                          const gcs_act_frag_t* frg,
+                          struct gcs_act*       act,
+                          bool                  local);
+
 /*!
  * Handles action message. Is called often - therefore, inlined
  *
@@ -90,7 +109,13 @@ gcs_node_handle_act_frag (gcs_node_t*           node,
                           bool                  local)
 {
     if (gu_likely(GCS_ACT_SERVICE != frg->act_type)) {
-        return gcs_defrag_handle_frag (&node->app, frg, act, local);
+        /* common case: continuation of the only action in progress */
+        if (gu_likely(node->app[0].sent_id == frg->act_id &&
+                      frg->frag_no > 0)) {
+            return gcs_defrag_handle_frag (&node->app[0], frg, act, local);
+        }
+
+        return gcs_node_handle_app_frag (node, frg, act, local);
     }
     else if (GCS_ACT_SERVICE == frg->act_type) {
         return gcs_defrag_handle_frag (&node->oob, frg, act, local);
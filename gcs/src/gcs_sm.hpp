@@ -342,6 +342,57 @@ gcs_sm_leave (gcs_sm_t* sm)
     gu_mutex_unlock (&sm->lock);
 }
 
+/*!
+ * Lets users waiting in the queue enter the monitor before the caller:
+ * atomically leaves the monitor, queues the caller at the tail and enters
+ * again when its turn comes. Does nothing if there is nobody waiting, the
+ * monitor is paused or the queue is full.
+ *
+ * @param cond condition to signal to wake up thread (as in gcs_sm_enter())
+ *
+ * @retval -EBADFD - monitor was closed while waiting (still entered)
+ * @retval 0 - success, monitor entered
+ */
+static inline long
+gcs_sm_yield (gcs_sm_t* sm, gu_cond_t* cond)
+{
+    long ret;
+
+    if (gu_unlikely(gu_mutex_lock (&sm->lock))) abort();
+
+#ifndef GCS_SM_CONCURRENCY
+    if (sm->users > 1 && sm->users < (long)sm->wait_q_len &&
+        !sm->pause && 0 == sm->ret &&
+        /* make sure that it is not us who is woken up next */
+        sm->wait_q[(sm->wait_q_head + 1) & sm->wait_q_mask].wait) {
+
+        sm->users++;
+        if (gu_unlikely(sm->users > sm->users_max)) {
+            sm->users_max = sm->users;
+        }
+        GCS_SM_INCREMENT(sm->wait_q_tail);
+
+        sm->entered--;
+        _gcs_sm_leave_common(sm);
+
+        while (!_gcs_sm_enqueue_common (sm, cond, true)) {
+            /* interrupted (by a stale handle), the spot will be skipped */
+            sm->users++;
+            GCS_SM_INCREMENT(sm->wait_q_tail);
+            if (!GCS_SM_HAS_TO_WAIT) break;
+        }
+
+        sm->entered++;
+    }
+#endif /* GCS_SM_CONCURRENCY */
+
+    ret = sm->ret;
+
+    gu_mutex_unlock (&sm->lock);
+
+    return ret;
+}
+
 static inline void
 gcs_sm_pause (gcs_sm_t* sm)
 {
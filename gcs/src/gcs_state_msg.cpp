@@ -13,7 +13,7 @@
 #include <string.h>
 #include <galerautils.h>
 
-#define GCS_STATE_MSG_VER 4
+#define GCS_STATE_MSG_VER 5
 
 #define GCS_STATE_MSG_ACCESS
 #include "gcs_state_msg.hpp"
@@ -113,7 +113,9 @@ gcs_state_msg_len (gcs_state_msg_t* state)
 // V3 stuff
         sizeof (int64_t)     +   // cached
 // V4 stuff
-        sizeof (int32_t)         // desync count
+        sizeof (int32_t)     +   // desync count
+// V5 stuff
+        sizeof (int64_t)         // cached, including arbitrator IST cache
         );
 }
 
@@ -158,6 +160,11 @@ gcs_state_msg_write (void* buf, const gcs_state_msg_t* state)
     uint8_t*  appl_proto_ver = (uint8_t*)(inc_addr + strlen(state->inc_addr) + 1);
     int64_t*  cached         = (int64_t*)(appl_proto_ver + 1);
     int32_t*  desync_count   = (int32_t*)(cached + 1);
+    int64_t*  cached_v5      = (int64_t*)(desync_count + 1);
+
+    /* Arbitrator cache must be invisible to V4 and older members: they would
+     * consider arbitrator for IST requests with SST part. */
+    bool const arbitrator(state->flags & GCS_STATE_ARBITRATOR);
 
     *version        = GCS_STATE_MSG_VER;
     *flags          = state->flags;
@@ -174,10 +181,11 @@ gcs_state_msg_write (void* buf, const gcs_state_msg_t* state)
     strcpy (name,     state->name);
     strcpy (inc_addr, state->inc_addr);
     *appl_proto_ver = state->appl_proto_ver; // in preparation for V1
-    *cached         = htog64(state->cached);
+    *cached         = htog64(arbitrator ? GCS_SEQNO_ILL : state->cached);
     *desync_count   = htog32(state->desync_count);
+    *cached_v5      = htog64(state->cached);
 
-    return ((uint8_t*)(desync_count + 1) - (uint8_t*)buf);
+    return ((uint8_t*)(cached_v5 + 1) - (uint8_t*)buf);
 }
 
 /* De-serialize gcs_state_msg_t from buf */
@@ -211,6 +219,12 @@ gcs_state_msg_read (const void* const buf, ssize_t const buf_len)
         desync_count = gtoh32(*desync_count_ptr);
     }
 
+    int64_t* cached_v5_ptr = (int64_t*)(desync_count_ptr + 1);
+    if (*version >= 5) {
+        assert(buf_len >= (uint8_t*)(cached_v5_ptr + 1) - (uint8_t*)buf);
+        cached = gtoh64(*cached_v5_ptr);
+    }
+
     gcs_state_msg_t* ret = gcs_state_msg_create (
         state_uuid,
         group_uuid,
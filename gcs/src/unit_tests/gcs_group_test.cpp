@@ -593,6 +593,31 @@ START_TEST(test_gcs_group_find_donor)
     nodes[0].status = GCS_NODE_STATE_SYNCED;
     nodes[1].status = GCS_NODE_STATE_SYNCED;
     nodes[2].status = GCS_NODE_STATE_SYNCED;
+
+    // ========== arbitrator ==========
+    // arbitrator with IST cache is preferred for IST-only requests
+    gcs_state_msg_destroy((gcs_state_msg_t*)nodes[4].state_msg);
+    nodes[4].state_msg = gcs_state_msg_create(
+        &empty_uuid, &empty_uuid, &empty_uuid,
+        0, 0, seqnos[4], 0,
+        GCS_NODE_STATE_SYNCED,
+        GCS_NODE_STATE_SYNCED,
+        "", "", 0, 0, 0, 0, GCS_STATE_ARBITRATOR);
+    group.quorum.version = 5;
+    donor = gcs_group_find_donor(&group, sv, joiner, SARGS(""),
+                                 group_uuid, ist_seqno, true);
+    fail_if(donor != 4, "donor: %d", donor);
+
+    // but it can't do SST
+    donor = gcs_group_find_donor(&group, sv, joiner, SARGS(""),
+                                 group_uuid, ist_seqno, false);
+    fail_if(donor == 4);
+
+    // and older members don't know about its cache
+    group.quorum.version = 4;
+    donor = gcs_group_find_donor(&group, sv, joiner, SARGS(""),
+                                 group_uuid, ist_seqno, true);
+    fail_if(donor == 4);
 #undef SARGS
 
     // todo: free
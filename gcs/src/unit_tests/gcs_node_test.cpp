@@ -55,6 +55,61 @@ START_TEST (gcs_node_test)
 }
 END_TEST
 
+static ssize_t
+node_test_frag (gcs_node_t* node, gcs_seqno_t act_id, unsigned long frag_no,
+                size_t act_size, bool local)
+{
+    static const char data[] = "0123456789";
+    struct gcs_act act;
+    gcs_act_frag_t frg;
+
+    frg.act_id    = act_id;
+    frg.act_size  = act_size;
+    frg.frag      = data;
+    frg.frag_len  = act_size / 2; // action is sent in 2 fragments
+    frg.frag_no   = frag_no;
+    frg.act_type  = GCS_ACT_TORDERED;
+    frg.proto_ver = 1;
+
+    return gcs_node_handle_act_frag (node, &frg, &act, local);
+}
+
+START_TEST (gcs_node_test_interleave)
+{
+    gcs_node_t node;
+    ssize_t    ret;
+
+    gcs_node_init (&node, NULL, NODE_ID, NODE_NAME, NODE_ADDR, 1, 0, 0, 0);
+
+    fail_if (0 != node_test_frag (&node, 1, 0, 10, false));
+    fail_if (0 != node_test_frag (&node, 2, 0, 8,  false));
+    fail_if (0 != node_test_frag (&node, 3, 0, 6,  false));
+    ret = node_test_frag (&node, 2, 1, 8, false);
+    fail_if (8 != ret, "expected 8, got %zd", ret);
+    ret = node_test_frag (&node, 1, 1, 10, false);
+    fail_if (10 != ret, "expected 10, got %zd", ret);
+
+    /* remainder of the action interrupted by reset is ignored even when
+     * interleaved with new ones */
+    gcs_node_reset (&node);
+    fail_if (0 != node_test_frag (&node, 4, 0, 4, false));
+    fail_if (0 != node_test_frag (&node, 3, 1, 6, false));
+    ret = node_test_frag (&node, 4, 1, 4, false);
+    fail_if (4 != ret, "expected 4, got %zd", ret);
+
+    /* local action interrupted by reset completes with -ERESTART */
+    fail_if (0 != node_test_frag (&node, 5, 0, 10, true));
+    gcs_node_reset_local (&node);
+    fail_if (0 != node_test_frag (&node, 6, 0, 8,  true));
+    ret = node_test_frag (&node, 6, 1, 8, true);
+    fail_if (8 != ret, "expected 8, got %zd", ret);
+    ret = node_test_frag (&node, 5, 1, 10, true);
+    fail_if (-ERESTART != ret, "expected %d, got %zd", -ERESTART, ret);
+
+    gcs_node_free (&node);
+}
+END_TEST
+
 Suite *gcs_node_suite(void)
 {
     Suite *suite = suite_create("GCS node context");
@@ -62,6 +117,7 @@ Suite *gcs_node_suite(void)
 
     suite_add_tcase (suite, tcase);
     tcase_add_test  (tcase, gcs_node_test);
+    tcase_add_test  (tcase, gcs_node_test_interleave);
     return suite;
 }
 
@@ -0,0 +1,278 @@
+// Copyright (C) 2026 Codership Oy <info@codership.com>
+
+// $Id$
+
+/*
+ * Tests asynchronous replication of actions through a whole GCS connection
+ * over the dummy backend.
+ */
+
+#include "gcs_repl_test.hpp"
+#include "../gcs.hpp"
+
+#include <galerautils.h>
+
+#include <string.h>
+#include <unistd.h>
+
+#define REPL_TEST_ACTS 1024
+
+/* we can't use pthread functions for waiting for certain conditions */
+#define WAIT_FOR(cond)                                                  \
+    { int count = 5000; while (--count && !(cond)) { usleep (1000); }}
+
+struct repl_test_act
+{
+    struct gcs_action act;
+    struct gu_buf     buf;
+    char              data[16];
+    long              ret;    // result reported to callback
+    long              calls;  // number of callback invocations
+};
+
+static struct repl_test_act repl_acts[REPL_TEST_ACTS];
+static gu_mutex_t           repl_mtx = GU_MUTEX_INITIALIZER;
+static long                 repl_done;
+
+static void
+repl_test_cb (void* const ctx, long const ret, struct gcs_action* const act)
+{
+    struct repl_test_act* const a(static_cast<struct repl_test_act*>(ctx));
+
+    fail_if (&a->act != act, "Callback got foreign action");
+
+    gu_mutex_lock (&repl_mtx);
+    a->ret = ret;
+    a->calls++;
+    repl_done++;
+    gu_mutex_unlock (&repl_mtx);
+
+    /* delivered buffer is owned by application */
+    if (ret > 0) ::free (const_cast<void*>(act->buf));
+}
+
+static long
+repl_test_done()
+{
+    gu_mutex_lock (&repl_mtx);
+    long const ret(repl_done);
+    gu_mutex_unlock (&repl_mtx);
+    return ret;
+}
+
+static long
+repl_test_send (gcs_conn_t* const conn, int const i)
+{
+    struct repl_test_act* const a(&repl_acts[i]);
+
+    snprintf (a->data, sizeof(a->data), "action %d", i);
+    a->buf.ptr     = a->data;
+    a->buf.size    = strlen(a->data) + 1;
+    a->act.buf     = NULL;
+    a->act.size    = a->buf.size;
+    a->act.type    = GCS_ACT_TORDERED;
+    a->ret         = 0;
+    a->calls       = 0;
+
+    return gcs_replv_async (conn, &a->buf, &a->act, false, repl_test_cb, a);
+}
+
+static gu_config_t* repl_conf = NULL;
+
+static gcs_conn_t*
+repl_test_create()
+{
+    repl_done = 0;
+
+    repl_conf = gu_config_create();
+    fail_if (NULL == repl_conf);
+    gcs_register_params (repl_conf);
+
+    gcs_conn_t* const conn(gcs_create (repl_conf, NULL, "repl_test", NULL,
+                                       0, 0));
+    fail_if (NULL == conn);
+
+    return conn;
+}
+
+static gu_thread_t repl_recv_thd;
+static long        repl_confs;
+
+/* application receiving thread, needed for gcs_close() to return */
+static void*
+repl_test_recv (void* arg)
+{
+    gcs_conn_t* const conn(static_cast<gcs_conn_t*>(arg));
+    struct gcs_action act;
+
+    while (gcs_recv (conn, &act) > 0)
+    {
+        ::free (const_cast<void*>(act.buf));
+
+        if (GCS_ACT_CONF == act.type)
+        {
+            gu_mutex_lock (&repl_mtx);
+            repl_confs++;
+            gu_mutex_unlock (&repl_mtx);
+
+            /* configuration change processed, receiving was suspended */
+            gcs_resume_recv (conn);
+        }
+    }
+
+    return NULL;
+}
+
+static long
+repl_test_confs()
+{
+    gu_mutex_lock (&repl_mtx);
+    long const ret(repl_confs);
+    gu_mutex_unlock (&repl_mtx);
+    return ret;
+}
+
+static void
+repl_test_open (gcs_conn_t* const conn)
+{
+    repl_confs = 0;
+
+    long ret(gcs_open (conn, "repl_test", "dummy://", true));
+    fail_if (ret, "gcs_open() failed: %ld (%s)", ret, strerror(-ret));
+
+    fail_if (gu_thread_create (&repl_recv_thd, NULL, repl_test_recv, conn));
+
+    WAIT_FOR(repl_test_confs() > 0);
+    fail_if (0 == repl_test_confs(), "No configuration received");
+}
+
+static void
+repl_test_destroy (gcs_conn_t* const conn)
+{
+    gu_thread_join (repl_recv_thd, NULL);
+
+    fail_if (gcs_destroy (conn));
+    gu_config_destroy (repl_conf);
+    repl_conf = NULL;
+}
+
+START_TEST (gcs_repl_test_async)
+{
+    gcs_conn_t* const conn(repl_test_create());
+    repl_test_open (conn);
+
+    for (int i(0); i < REPL_TEST_ACTS; ++i)
+    {
+        struct repl_test_act* const a(&repl_acts[i]);
+        long const ret(repl_test_send (conn, i));
+        fail_if (ret != a->buf.size, "gcs_replv_async(): %ld (%s)",
+                 ret, strerror(-ret));
+    }
+
+    WAIT_FOR(REPL_TEST_ACTS == repl_test_done());
+    fail_if (REPL_TEST_ACTS != repl_test_done(), "Completed %ld of %d",
+             repl_test_done(), REPL_TEST_ACTS);
+
+    gcs_seqno_t last_seqno(0);
+
+    for (int i(0); i < REPL_TEST_ACTS; ++i)
+    {
+        struct repl_test_act* const a(&repl_acts[i]);
+        fail_if (1 != a->calls, "Action %d completed %ld times", i, a->calls);
+        fail_if (a->ret != a->buf.size, "Action %d result %ld", i, a->ret);
+        fail_if (a->act.seqno_g != last_seqno + 1,
+                 "Action %d seqno %lld, expected %lld", i,
+                 (long long)a->act.seqno_g, (long long)last_seqno + 1);
+        last_seqno = a->act.seqno_g;
+    }
+
+    fail_if (gcs_close (conn));
+    repl_test_destroy (conn);
+}
+END_TEST
+
+START_TEST (gcs_repl_test_async_error)
+{
+    gcs_conn_t* const conn(repl_test_create());
+
+    /* not open yet */
+    long ret(repl_test_send (conn, 0));
+    fail_if (ret >= 0, "Sending on closed connection returned %ld", ret);
+
+    repl_test_open (conn);
+    fail_if (gcs_close (conn));
+
+    /* closed again */
+    ret = repl_test_send (conn, 1);
+    fail_if (ret >= 0, "Sending on closed connection returned %ld", ret);
+
+    usleep (10000);
+    fail_if (0 != repl_acts[0].calls || 0 != repl_acts[1].calls ||
+             0 != repl_test_done(),
+             "Callback called for action which was not sent");
+
+    repl_test_destroy (conn);
+}
+END_TEST
+
+static void*
+repl_test_sender (void* arg)
+{
+    gcs_conn_t* const conn(static_cast<gcs_conn_t*>(arg));
+    long sent(0);
+
+    for (int i(0); i < REPL_TEST_ACTS; ++i)
+    {
+        if (repl_test_send (conn, i) >= 0) sent++;
+        else repl_acts[i].ret = -1; // never to be completed
+    }
+
+    return reinterpret_cast<void*>(sent);
+}
+
+START_TEST (gcs_repl_test_async_close)
+{
+    gcs_conn_t* const conn(repl_test_create());
+    repl_test_open (conn);
+
+    gu_thread_t sender;
+    fail_if (gu_thread_create (&sender, NULL, repl_test_sender, conn));
+
+    /* close while actions are being sent and delivered */
+    WAIT_FOR(repl_test_done() > 0);
+    fail_if (gcs_close (conn));
+
+    void* sent;
+    gu_thread_join (sender, &sent);
+
+    /* every action that was accepted must be completed exactly once, either
+     * delivered or failed by gcs_close(), others must not be completed */
+    WAIT_FOR(reinterpret_cast<long>(sent) == repl_test_done());
+    fail_if (reinterpret_cast<long>(sent) != repl_test_done(),
+             "Sent %ld, completed %ld", reinterpret_cast<long>(sent),
+             repl_test_done());
+
+    for (int i(0); i < REPL_TEST_ACTS; ++i)
+    {
+        struct repl_test_act* const a(&repl_acts[i]);
+        long const expected(-1 == a->ret ? 0 : 1);
+        fail_if (expected != a->calls, "Action %d completed %ld times",
+                 i, a->calls);
+    }
+
+    repl_test_destroy (conn);
+}
+END_TEST
+
+Suite *gcs_repl_suite(void)
+{
+    Suite *s  = suite_create("GCS async replication");
+    TCase *tc = tcase_create("gcs_repl");
+
+    suite_add_tcase (s, tc);
+    tcase_add_test  (tc, gcs_repl_test_async);
+    tcase_add_test  (tc, gcs_repl_test_async_error);
+    tcase_add_test  (tc, gcs_repl_test_async_close);
+
+    return s;
+}
@@ -514,6 +514,77 @@ START_TEST (gcs_sm_test_interrupt)
 }
 END_TEST
 
+static volatile long yield_count = 0;
+
+static void* yield_thread (void* arg)
+{
+    gcs_sm_t* sm = (gcs_sm_t*) arg;
+
+    gu_cond_t cond;
+    gu_cond_init (&cond, NULL);
+
+    if (0 == gcs_sm_enter (sm, &cond, false, true)) {
+        yield_count++;
+        gcs_sm_leave (sm);
+    }
+
+    gu_cond_destroy (&cond);
+
+    return NULL;
+}
+
+START_TEST (gcs_sm_test_yield)
+{
+    gcs_sm_t* sm = gcs_sm_create(4, 1);
+    fail_if(!sm);
+
+    gu_cond_t cond;
+    gu_cond_init (&cond, NULL);
+
+    long ret = gcs_sm_enter (sm, &cond, false, true);
+    fail_if (ret != 0);
+
+    /* nobody is waiting - should return right away */
+    ret = gcs_sm_yield (sm, &cond);
+    fail_if (ret != 0);
+    fail_if (sm->entered != 1, "entered = %ld, expected 1", sm->entered);
+    fail_if (sm->users   != 1, "users = %ld, expected 1", sm->users);
+
+    gu_thread_t thr1, thr2;
+    gu_thread_create (&thr1, NULL, yield_thread, sm);
+    gu_thread_create (&thr2, NULL, yield_thread, sm);
+    WAIT_FOR (3 == sm->users);
+    fail_if (sm->users != 3, "users = %ld, expected 3", sm->users);
+
+    /* both waiters should get in before yield returns */
+    ret = gcs_sm_yield (sm, &cond);
+    fail_if (ret != 0);
+    fail_if (yield_count != 2, "yield_count = %ld, expected 2", yield_count);
+    fail_if (sm->entered != 1, "entered = %ld, expected 1", sm->entered);
+    fail_if (sm->users   != 1, "users = %ld, expected 1", sm->users);
+
+    gu_thread_join (thr1, NULL);
+    gu_thread_join (thr2, NULL);
+
+    /* paused monitor should not be yielded */
+    gcs_sm_pause (sm);
+    gu_thread_create (&thr1, NULL, yield_thread, sm);
+    WAIT_FOR (2 == sm->users);
+    ret = gcs_sm_yield (sm, &cond);
+    fail_if (ret != 0);
+    fail_if (yield_count != 2, "yield_count = %ld, expected 2", yield_count);
+
+    gcs_sm_leave (sm);
+    gcs_sm_continue (sm);
+    gu_thread_join (thr1, NULL);
+    fail_if (yield_count != 3, "yield_count = %ld, expected 3", yield_count);
+    fail_if (sm->users   != 0, "users = %ld, expected 0", sm->users);
+
+    gu_cond_destroy (&cond);
+    gcs_sm_close (sm);
+    gcs_sm_destroy (sm);
+}
+END_TEST
 
 Suite *gcs_send_monitor_suite(void)
 {
@@ -526,6 +597,7 @@ Suite *gcs_send_monitor_suite(void)
   tcase_add_test  (tc, gcs_sm_test_close);
   tcase_add_test  (tc, gcs_sm_test_pause);
   tcase_add_test  (tc, gcs_sm_test_interrupt);
+  tcase_add_test  (tc, gcs_sm_test_yield);
   return s;
 }
 
@@ -8,7 +8,7 @@
 #define GCS_STATE_MSG_ACCESS
 #include "../gcs_state_msg.hpp"
 
-static int const QUORUM_VERSION = 4;
+static int const QUORUM_VERSION = 5;
 
 START_TEST (gcs_state_msg_test_basic)
 {
@@ -94,6 +94,41 @@ START_TEST (gcs_state_msg_test_basic)
 }
 END_TEST
 
+/* arbitrator cache is visible only to V5 readers */
+START_TEST (gcs_state_msg_test_arbitrator)
+{
+    gu_uuid_t uuid;
+    gu_uuid_generate (&uuid, NULL, 0);
+
+    gcs_state_msg_t* send_state =
+        gcs_state_msg_create (&uuid, &uuid, &uuid, 457, 3465, 2345, 5,
+                              GCS_NODE_STATE_JOINED, GCS_NODE_STATE_NON_PRIM,
+                              "garb", "", 0, 1, 1, 0, GCS_STATE_ARBITRATOR);
+    fail_if (NULL == send_state);
+
+    ssize_t const send_len = gcs_state_msg_len (send_state);
+    uint8_t send_buf[send_len];
+
+    fail_if (gcs_state_msg_write (send_buf, send_state) != send_len);
+
+    gcs_state_msg_t* recv_state = gcs_state_msg_read (send_buf, send_len);
+    fail_if (NULL == recv_state);
+    fail_if (recv_state->cached != 2345, "Last cached seqno: %lld",
+             recv_state->cached);
+    fail_if (!(recv_state->flags & GCS_STATE_ARBITRATOR));
+    gcs_state_msg_destroy (recv_state);
+
+    send_buf[0] = 4; // pretend V4 reader
+    recv_state = gcs_state_msg_read (send_buf, send_len);
+    fail_if (NULL == recv_state);
+    fail_if (recv_state->cached != GCS_SEQNO_ILL, "Last cached seqno: %lld",
+             recv_state->cached);
+    gcs_state_msg_destroy (recv_state);
+
+    gcs_state_msg_destroy (send_state);
+}
+END_TEST
+
 START_TEST (gcs_state_msg_test_quorum_inherit)
 {
     gcs_state_msg_t* st[3] = { NULL, };
@@ -510,6 +545,7 @@ Suite *gcs_state_msg_suite(void)
 
   suite_add_tcase (s, tc_basic);
   tcase_add_test  (tc_basic, gcs_state_msg_test_basic);
+  tcase_add_test  (tc_basic, gcs_state_msg_test_arbitrator);
 
   suite_add_tcase (s, tc_inherit);
   tcase_add_test  (tc_inherit, gcs_state_msg_test_quorum_inherit);
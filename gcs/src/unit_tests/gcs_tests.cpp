@@ -22,6 +22,7 @@
 #include "gcs_backend_test.hpp"
 #include "gcs_core_test.hpp"
 #include "gcs_fc_test.hpp"
+#include "gcs_repl_test.hpp"
 
 typedef Suite *(*suite_creator_t)(void);
 
@@ -39,6 +40,7 @@ static suite_creator_t suites[] =
 	gcs_backend_suite,
 	gcs_core_suite,
 	gcs_fc_suite,
+	gcs_repl_suite,
 	NULL
     };
 